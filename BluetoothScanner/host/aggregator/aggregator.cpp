@@ -0,0 +1,386 @@
+#include "aggregator.h"
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+
+namespace aggregator {
+
+namespace {
+
+constexpr size_t WINDOW_SAMPLES = 8;
+// Wiadomości pobierane przez parser przy jednym przejęciu blokady kolejki
+constexpr size_t PARSE_BATCH = 16;
+// Znaczniki sprzed 2001 roku pochodzą z płytki bez synchronizacji czasu (czas od startu)
+constexpr int64_t MIN_EPOCH_US = 978307200LL * 1000000;
+
+struct board_window {
+    uint16_t board;
+    uint8_t next;
+    uint8_t count;
+    int8_t rssi[WINDOW_SAMPLES];
+    int64_t time_us[WINDOW_SAMPLES];
+};
+
+struct device_state {
+    int64_t last_seen_us = 0;
+    uint16_t last_nearest = board_map::NONE;
+    std::vector<board_window> windows;
+};
+
+struct raw_message {
+    uint16_t board;
+    bool binary;
+    int64_t received_us;
+    std::string payload;
+};
+
+// Finalizator splitmix64 - kolejne adresy MAC tego samego producenta rozkładają się równo
+uint64_t mix(uint64_t x) {
+    x ^= x >> 30;
+    x *= 0xbf58476d1ce4e5b9ULL;
+    x ^= x >> 27;
+    x *= 0x94d049bb133111ebULL;
+    x ^= x >> 31;
+    return x;
+}
+
+}  // namespace
+
+struct aggregator::shard {
+    explicit shard(const board_map &boards, const aggregator_config &config) : boards(boards), config(config) {
+        worker = std::thread([this] { run(); });
+    }
+
+    ~shard() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stop = true;
+        }
+        wake.notify_one();
+        worker.join();
+    }
+
+    void run() {
+        std::vector<routed_sighting> batch;
+        std::vector<std::function<void()>> work;
+        for (;;) {
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                wake.wait(lock, [this] { return stop || !pending.empty() || !tasks.empty(); });
+                if (stop && pending.empty() && tasks.empty()) {
+                    return;
+                }
+                batch.swap(pending);
+                work.swap(tasks);
+                busy = true;
+            }
+            space.notify_all();
+
+            for (const routed_sighting &sighting : batch) {
+                apply(sighting);
+            }
+            processed.fetch_add(batch.size(), std::memory_order_relaxed);
+            batch.clear();
+            // Zadania po obserwacjach - snapshot() widzi wszystko, co przekazano przed nim
+            for (auto &task : work) {
+                task();
+            }
+            work.clear();
+            device_count.store(devices.size(), std::memory_order_relaxed);
+
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                busy = false;
+            }
+            idle.notify_all();
+        }
+    }
+
+    void apply(const routed_sighting &sighting) {
+        device_state &device = devices[sighting.address];
+        device.last_seen_us = std::max(device.last_seen_us, sighting.timestamp_us);
+
+        auto window = std::find_if(device.windows.begin(), device.windows.end(),
+                                   [&](const board_window &w) { return w.board == sighting.board; });
+        if (window == device.windows.end()) {
+            device.windows.push_back(board_window{sighting.board, 0, 0, {}, {}});
+            window = device.windows.end() - 1;
+        }
+        window->rssi[window->next] = sighting.rssi;
+        window->time_us[window->next] = sighting.timestamp_us;
+        window->next = static_cast<uint8_t>((window->next + 1) % WINDOW_SAMPLES);
+        if (window->count < WINDOW_SAMPLES) {
+            window->count++;
+        }
+    }
+
+    void estimate(int64_t now_us, std::vector<device_estimate> &out) {
+        const int64_t window_start = now_us - config.window_us;
+        std::vector<board_reading> readings;
+
+        for (auto it = devices.begin(); it != devices.end();) {
+            device_state &device = it->second;
+            if (now_us - device.last_seen_us > config.expiry_us) {
+                it = devices.erase(it);
+                continue;
+            }
+
+            readings.clear();
+            for (auto window = device.windows.begin(); window != device.windows.end();) {
+                int sum = 0;
+                int samples = 0;
+                for (uint8_t i = 0; i < window->count; i++) {
+                    if (window->time_us[i] >= window_start) {
+                        sum += window->rssi[i];
+                        samples++;
+                    }
+                }
+                if (samples == 0) {
+                    // Płytka przestała widzieć urządzenie
+                    window = device.windows.erase(window);
+                    continue;
+                }
+                readings.push_back(board_reading{window->board, static_cast<double>(sum) / samples});
+                ++window;
+            }
+
+            device_estimate estimate{};
+            estimate.address = it->first;
+            estimate.where = locate(boards, readings.data(), readings.size());
+            estimate.boards = static_cast<uint16_t>(readings.size());
+            estimate.room_changed = estimate.where.nearest_board != device.last_nearest;
+            estimate.last_seen_us = device.last_seen_us;
+            device.last_nearest = estimate.where.nearest_board;
+            out.push_back(estimate);
+            ++it;
+        }
+    }
+
+    const board_map &boards;
+    const aggregator_config &config;
+
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::condition_variable idle;
+    std::condition_variable space;  // pending zwolnione dla parserów
+    std::vector<routed_sighting> pending;
+    std::vector<std::function<void()>> tasks;
+    bool busy = false;
+    bool stop = false;
+
+    // Tylko wątek sharda
+    std::unordered_map<uint64_t, device_state> devices;
+
+    std::atomic<uint64_t> processed{0};
+    std::atomic<uint64_t> device_count{0};
+    std::thread worker;
+};
+
+struct aggregator::parser_pool {
+    parser_pool(aggregator &owner, size_t count) : owner(owner) {
+        for (size_t i = 0; i < count; i++) {
+            workers.emplace_back([this] { run(); });
+        }
+    }
+
+    // Parsery kończą wiadomości z kolejki przed wyjściem
+    ~parser_pool() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stop = true;
+        }
+        wake.notify_all();
+        for (std::thread &worker : workers) {
+            worker.join();
+        }
+    }
+
+    void submit(uint16_t board, std::string_view payload, bool binary, int64_t received_us) {
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            space.wait(lock, [this] { return queue.size() < owner.config_.max_queued_messages; });
+            // Bufory zwrócone przez parsery - bez alokacji na każdą wiadomość
+            std::string copy;
+            if (!spare.empty()) {
+                copy = std::move(spare.back());
+                spare.pop_back();
+            }
+            copy.assign(payload.data(), payload.size());
+            queue.push_back(raw_message{board, binary, received_us, std::move(copy)});
+        }
+        wake.notify_one();
+    }
+
+    void drain() {
+        std::unique_lock<std::mutex> lock(mutex);
+        idle.wait(lock, [this] { return queue.empty() && busy == 0; });
+    }
+
+    void run() {
+        std::vector<raw_message> batch;
+        std::vector<sighting> parsed;
+        std::vector<std::vector<routed_sighting>> routing(owner.shards_.size());
+        for (;;) {
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                wake.wait(lock, [this] { return stop || !queue.empty(); });
+                if (queue.empty()) {
+                    return;
+                }
+                size_t take = std::min(queue.size(), PARSE_BATCH);
+                for (size_t i = 0; i < take; i++) {
+                    batch.push_back(std::move(queue.front()));
+                    queue.pop_front();
+                }
+                busy++;
+            }
+            space.notify_one();
+
+            for (const raw_message &message : batch) {
+                parsed.clear();
+                bool ok = message.binary ? parse_devices_binary(message.payload, parsed)
+                                         : parse_devices_json(message.payload, parsed);
+                if (!ok) {
+                    rejected.fetch_add(1, std::memory_order_relaxed);
+                }
+                route(message.board, parsed, message.received_us, routing);
+            }
+
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                for (raw_message &message : batch) {
+                    if (spare.size() < owner.config_.max_queued_messages) {
+                        spare.push_back(std::move(message.payload));
+                    }
+                }
+                busy--;
+            }
+            batch.clear();
+            idle.notify_all();
+        }
+    }
+
+    void route(uint16_t board, const std::vector<sighting> &sightings, int64_t received_us,
+               std::vector<std::vector<routed_sighting>> &routing) {
+        for (auto &routed : routing) {
+            routed.clear();
+        }
+        for (const sighting &s : sightings) {
+            int64_t timestamp = s.timestamp_us >= MIN_EPOCH_US ? s.timestamp_us : received_us;
+            routing[mix(s.address) % routing.size()].push_back(routed_sighting{s.address, timestamp, board, s.rssi});
+        }
+
+        // Jedno przejęcie blokady na shard na wiadomość, nie na obserwację. Pełny
+        // shard zatrzymuje parser, a z nim (przez kolejkę) wątek odbierający.
+        for (size_t i = 0; i < owner.shards_.size(); i++) {
+            if (routing[i].empty()) {
+                continue;
+            }
+            shard &target = *owner.shards_[i];
+            {
+                std::unique_lock<std::mutex> lock(target.mutex);
+                target.space.wait(lock,
+                                  [&] { return target.pending.size() < owner.config_.max_pending_sightings; });
+                target.pending.insert(target.pending.end(), routing[i].begin(), routing[i].end());
+            }
+            target.wake.notify_one();
+        }
+    }
+
+    aggregator &owner;
+
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::condition_variable space;  // Miejsce w kolejce dla submit
+    std::condition_variable idle;
+    std::deque<raw_message> queue;
+    std::vector<std::string> spare;
+    size_t busy = 0;  // Parsery w trakcie pracy nad pobranymi wiadomościami
+    bool stop = false;
+
+    std::atomic<uint64_t> rejected{0};
+    std::vector<std::thread> workers;
+};
+
+aggregator::aggregator(const board_map &boards, const aggregator_config &config)
+    : boards_(boards), config_(config) {
+    size_t count = std::max<size_t>(config_.shards, 1);
+    config_.shards = count;
+    config_.parsers = config_.parsers > 0 ? config_.parsers : count;
+    config_.max_queued_messages = std::max<size_t>(config_.max_queued_messages, 1);
+    config_.max_pending_sightings = std::max<size_t>(config_.max_pending_sightings, 1);
+    for (size_t i = 0; i < count; i++) {
+        shards_.push_back(std::make_unique<shard>(boards_, config_));
+    }
+    parsers_ = std::make_unique<parser_pool>(*this, config_.parsers);
+}
+
+// parsers_ jest niszczona pierwsza (odwrotna kolejność pól) i oddaje resztę kolejki shardom
+aggregator::~aggregator() = default;
+
+void aggregator::submit(uint16_t board, std::string_view payload, bool binary, int64_t received_us) {
+    parsers_->submit(board, payload, binary, received_us);
+}
+
+void aggregator::drain() {
+    parsers_->drain();
+    for (auto &target : shards_) {
+        std::unique_lock<std::mutex> lock(target->mutex);
+        target->idle.wait(lock, [&] { return target->pending.empty() && target->tasks.empty() && !target->busy; });
+    }
+}
+
+void aggregator::run_on_all(const std::function<void(shard &)> &task) {
+    // Zadanie widzi wszystkie wiadomości przekazane do submit przed nim
+    parsers_->drain();
+    for (auto &target : shards_) {
+        shard *s = target.get();
+        {
+            std::lock_guard<std::mutex> lock(s->mutex);
+            s->tasks.push_back([&task, s] { task(*s); });
+        }
+        s->wake.notify_one();
+    }
+    drain();
+}
+
+std::vector<device_estimate> aggregator::snapshot(int64_t now_us) {
+    std::vector<std::vector<device_estimate>> partial(shards_.size());
+    run_on_all([&](shard &s) {
+        size_t index = 0;
+        while (shards_[index].get() != &s) {
+            index++;
+        }
+        s.estimate(now_us, partial[index]);
+    });
+
+    std::vector<device_estimate> estimates;
+    size_t total = 0;
+    for (const auto &p : partial) {
+        total += p.size();
+    }
+    estimates.reserve(total);
+    for (const auto &p : partial) {
+        estimates.insert(estimates.end(), p.begin(), p.end());
+    }
+    return estimates;
+}
+
+aggregator_stats aggregator::stats() const {
+    aggregator_stats stats{0, 0, parsers_->rejected.load(std::memory_order_relaxed), {}};
+    for (const auto &s : shards_) {
+        uint64_t processed = s->processed.load(std::memory_order_relaxed);
+        stats.sightings += processed;
+        stats.devices += s->device_count.load(std::memory_order_relaxed);
+        stats.shard_sightings.push_back(processed);
+    }
+    return stats;
+}
+
+}  // namespace aggregator
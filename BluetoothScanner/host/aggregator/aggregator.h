@@ -0,0 +1,96 @@
+#ifndef HOST_AGGREGATOR_AGGREGATOR_H_
+#define HOST_AGGREGATOR_AGGREGATOR_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string_view>
+#include <vector>
+
+#include "board_map.h"
+#include "locator.h"
+#include "sighting_parser.h"
+
+// Stan urządzeń widzianych przez wszystkie płytki. Wątek odbierający przekazuje
+// surowe wiadomości do puli parserów, które rozdzielają obserwacje między shardy
+// według skrótu adresu; każdy shard ma własny wątek i własną tablicę, więc
+// przetwarzanie obserwacji nie wymaga blokad poza przekazaniem paczki do kolejki.
+// Obie kolejki są ograniczone: gdy shard nie nadąża, parsery czekają na miejsce,
+// a submit() blokuje wątek odbierający (i dalej połączenie z brokerem).
+// Dla każdej pary (urządzenie, płytka) trzymane jest okno ostatnich odczytów RSSI.
+
+namespace aggregator {
+
+struct aggregator_config {
+    size_t shards = 1;
+    size_t parsers = 0;                   // 0 - tyle wątków parsujących, ile shardów
+    size_t max_queued_messages = 1024;    // Wiadomości czekające na parser
+    size_t max_pending_sightings = 65536; // Obserwacje czekające w jednym shardzie
+    int64_t window_us = 30 * 1000000LL;   // Odczyty starsze niż okno nie liczą się do średniej
+    int64_t expiry_us = 120 * 1000000LL;  // Urządzenie niewidziane tak długo jest usuwane
+};
+
+struct device_estimate {
+    uint64_t address;
+    location where;
+    uint16_t boards;     // Płytki z odczytem w oknie
+    bool room_changed;   // Inna najbliższa płytka niż w poprzednim snapshot()
+    int64_t last_seen_us;
+};
+
+// Obserwacja przypisana do płytki, w drodze do sharda
+struct routed_sighting {
+    uint64_t address;
+    int64_t timestamp_us;
+    uint16_t board;
+    int8_t rssi;
+};
+
+struct aggregator_stats {
+    uint64_t sightings;
+    uint64_t devices;
+    uint64_t rejected;  // Wiadomości z błędnym (albo za głęboko zagnieżdżonym) JSON lub formatem binarnym
+    std::vector<uint64_t> shard_sightings;
+};
+
+class aggregator {
+public:
+    aggregator(const board_map &boards, const aggregator_config &config);
+    ~aggregator();
+    aggregator(const aggregator &) = delete;
+    aggregator &operator=(const aggregator &) = delete;
+
+    // Wiadomość płytki z /<board>/devices (binary: /<board>/devices/bin), parsowana
+    // w puli parserów. Wywoływane z jednego wątku odbierającego; blokuje, gdy kolejka
+    // parserów jest pełna. received_us zastępuje brakujące lub niezsynchronizowane
+    // znaczniki czasu. Wiadomości różnych płytek mogą zostać zastosowane w innej
+    // kolejności niż nadeszły.
+    void submit(uint16_t board, std::string_view payload, bool binary, int64_t received_us);
+
+    // Czeka, aż parsery i shardy przetworzą wszystko, co przekazano do submit
+    void drain();
+
+    // Oszacowania wszystkich urządzeń na chwilę now_us, liczone równolegle w shardach.
+    // Usuwa urządzenia niewidziane dłużej niż expiry_us.
+    std::vector<device_estimate> snapshot(int64_t now_us);
+
+    aggregator_stats stats() const;
+
+    size_t shard_count() const { return shards_.size(); }
+
+private:
+    struct shard;
+    struct parser_pool;
+
+    void run_on_all(const std::function<void(shard &)> &task);
+
+    const board_map &boards_;
+    aggregator_config config_;
+    std::vector<std::unique_ptr<shard>> shards_;
+    std::unique_ptr<parser_pool> parsers_;  // Zatrzymywana przed shardami
+};
+
+}  // namespace aggregator
+
+#endif
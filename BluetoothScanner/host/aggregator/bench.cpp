@@ -0,0 +1,429 @@
+// Benchmark agregatora na syntetycznym budynku:
+//
+//   aggregator_bench [--boards N] [--devices N] [--rounds N] [--format batch|device|binary]
+//                    [--shards 1,2,4,8] [--seed N] [--broker host[:port]]
+//
+// Płytki stoją w siatce co 10 m, urządzenia w losowych punktach. RSSI wynika
+// z modelu log-distance z szumem; płytka słyszy urządzenie do -95 dBm. Wiadomości
+// są formatowane kodem firmware (main/sighting_format.c), tak jak publikuje je
+// płytka w danym trybie. Dla każdej liczby shardów mierzona jest przepustowość
+// parsowania i agregacji oraz czas snapshot(), a także trafność pokoju i błąd
+// pozycji względem prawdziwego położenia.
+//
+// Z --broker wiadomości przechodzą przez brokera MQTT: osobny wątek publikuje
+// je na /<board>/devices, a agregator odbiera je przez subskrypcję.
+// Kończy się kodem 1, gdy agregator zgubi urządzenia albo trafność pokoju spadnie
+// poniżej 75% (przy domyślnym szumie granice pokoi dają ok. 85%).
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cinttypes>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <string>
+#include <thread>
+#include <unordered_map>
+
+#include "aggregator.h"
+#include "mqtt_lite.h"
+
+extern "C" {
+#include "rssi_filter.h"
+#include "sighting_format.h"
+#include "time_sync.h"
+}
+
+using namespace aggregator;
+
+namespace {
+
+constexpr double BOARD_SPACING_M = 10.0;
+constexpr double RSSI_NOISE_DB = 4.0;
+constexpr double HEARING_THRESHOLD_DBM = -95.0;
+constexpr int64_t SCAN_PERIOD_US = 10 * 1000000LL;
+// Domyślne CONFIG_SIGHTING_BATCH_MAX_DEVICES i CONFIG_SIGHTING_BATCH_BUFFER_SIZE
+constexpr uint32_t BATCH_MAX_DEVICES = 32;
+constexpr size_t BATCH_BUFFER_SIZE = 4096;
+constexpr double MIN_ROOM_HITS = 0.75;
+constexpr const char *DONE_TOPIC = "/aggregator_bench/done";
+
+struct simulated_device {
+    uint64_t address;
+    double x;
+    double y;
+    uint16_t nearest_board;
+};
+
+struct message {
+    uint16_t board;
+    bool binary;
+    std::string payload;
+};
+
+using bench_clock = std::chrono::steady_clock;
+
+double seconds_since(bench_clock::time_point start) {
+    return std::chrono::duration<double>(bench_clock::now() - start).count();
+}
+
+int64_t wall_clock_us() {
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+               std::chrono::system_clock::now().time_since_epoch())
+        .count();
+}
+
+device_entry_t make_entry(uint64_t address, int8_t rssi, int64_t seen_us) {
+    device_entry_t entry;
+    std::memset(&entry, 0, sizeof(entry));
+    entry.used = true;
+    for (int i = 0; i < SIGHTING_BDA_LEN; i++) {
+        entry.bda[i] = static_cast<uint8_t>(address >> (8 * (SIGHTING_BDA_LEN - 1 - i)));
+    }
+    entry.first_seen_us = seen_us;
+    entry.last_seen_us = seen_us;
+    entry.count = 1;
+    entry.rssi_min = rssi;
+    entry.rssi_max = rssi;
+    entry.rssi_sum = rssi;
+    rssi_filter_seed(&entry.rssi_filter, rssi);
+    return entry;
+}
+
+// Wiadomości jednego okna skanowania wszystkich płytek
+void generate_round(const board_map &boards, const std::vector<simulated_device> &devices, const std::string &format,
+                    int64_t window_us, std::mt19937_64 &random, std::vector<message> &out, uint64_t &sightings) {
+    std::normal_distribution<double> noise(0.0, RSSI_NOISE_DB);
+    std::vector<device_entry_t> heard;
+    char buffer[BATCH_BUFFER_SIZE];
+
+    for (uint16_t board_id = 0; board_id < boards.size(); board_id++) {
+        const board_info &board = boards.board(board_id);
+        heard.clear();
+        for (const simulated_device &device : devices) {
+            double distance = std::max(std::hypot(device.x - board.x, device.y - board.y), 0.5);
+            double rssi = board.rssi_at_1m - 10 * board.path_loss_exponent * std::log10(distance) + noise(random);
+            if (rssi < HEARING_THRESHOLD_DBM) {
+                continue;
+            }
+            int64_t seen_us = window_us + static_cast<int64_t>(random() % SCAN_PERIOD_US);
+            heard.push_back(make_entry(device.address, static_cast<int8_t>(std::lround(std::max(rssi, -127.0))), seen_us));
+        }
+        sightings += heard.size();
+
+        if (format == "device") {
+            for (const device_entry_t &entry : heard) {
+                size_t length = sighting_format_device_json(&entry, buffer, sizeof(buffer));
+                out.push_back(message{board_id, false, std::string(buffer, length)});
+            }
+            continue;
+        }
+
+        bool binary = format == "binary";
+        sighting_payload_format_t payload_format = binary ? SIGHTING_PAYLOAD_BINARY : SIGHTING_PAYLOAD_JSON;
+        sighting_batch_t batch;
+        sighting_batch_begin(&batch, payload_format, buffer, sizeof(buffer), board.name.c_str(), window_us);
+        for (const device_entry_t &entry : heard) {
+            if (batch.count >= BATCH_MAX_DEVICES || !sighting_batch_add(&batch, &entry)) {
+                size_t length = sighting_batch_finish(&batch);
+                out.push_back(message{board_id, binary, std::string(buffer, length)});
+                sighting_batch_begin(&batch, payload_format, buffer, sizeof(buffer), board.name.c_str(), window_us);
+                sighting_batch_add(&batch, &entry);
+            }
+        }
+        if (batch.count > 0) {
+            size_t length = sighting_batch_finish(&batch);
+            out.push_back(message{board_id, binary, std::string(buffer, length)});
+        }
+    }
+}
+
+struct accuracy {
+    double room_hits = 0;
+    double mean_error_m = 0;
+    size_t located = 0;
+};
+
+accuracy evaluate(const std::vector<simulated_device> &devices, const std::vector<device_estimate> &estimates) {
+    std::unordered_map<uint64_t, const simulated_device *> truth;
+    for (const simulated_device &device : devices) {
+        truth.emplace(device.address, &device);
+    }
+    accuracy result;
+    size_t hits = 0;
+    double error_sum = 0;
+    for (const device_estimate &estimate : estimates) {
+        auto device = truth.find(estimate.address);
+        if (device == truth.end() || estimate.where.method == locate_method::none) {
+            continue;
+        }
+        result.located++;
+        hits += estimate.where.nearest_board == device->second->nearest_board;
+        error_sum += std::hypot(estimate.where.x - device->second->x, estimate.where.y - device->second->y);
+    }
+    if (result.located > 0) {
+        result.room_hits = static_cast<double>(hits) / result.located;
+        result.mean_error_m = error_sum / result.located;
+    }
+    return result;
+}
+
+bool parse_message(std::string_view payload, bool binary, std::vector<sighting> &out) {
+    return binary ? parse_devices_binary(payload, out) : parse_devices_json(payload, out);
+}
+
+// Wątek publikujący wszystkie wiadomości, a na końcu znacznik DONE_TOPIC
+void publish_all(const std::string &host, uint16_t port, const board_map &boards, const std::vector<message> &messages,
+                 std::atomic<bool> &failed) {
+    mqtt_lite::client publisher;
+    if (!publisher.connect(host, port, "aggregator_bench_pub")) {
+        std::fprintf(stderr, "publisher: %s\n", publisher.error().c_str());
+        failed = true;
+        return;
+    }
+    for (const message &m : messages) {
+        std::string topic = "/" + boards.board(m.board).name + (m.binary ? "/devices/bin" : "/devices");
+        if (publisher.publish(topic, m.payload) < 0) {
+            std::fprintf(stderr, "publisher: %s\n", publisher.error().c_str());
+            failed = true;
+            return;
+        }
+    }
+    publisher.publish(DONE_TOPIC, "done", 1);
+    publisher.flush();
+    // Czeka na PUBACK znacznika, żeby broker zdążył odebrać całość przed rozłączeniem
+    bool acked = false;
+    publisher.on_puback = [&](uint16_t) { acked = true; };
+    auto start = bench_clock::now();
+    while (!acked && seconds_since(start) < 30 && publisher.poll(100)) {
+    }
+    publisher.disconnect();
+}
+
+bool run_broker(const std::string &host, uint16_t port, board_map &boards, size_t shards,
+                const std::vector<simulated_device> &devices, const std::vector<message> &messages,
+                uint64_t sightings, int64_t now_us) {
+    aggregator_config config;
+    config.shards = shards;
+    class aggregator state(boards, config);
+    mqtt_lite::client subscriber;
+    bool done = false;
+    uint64_t received = 0;
+    subscriber.on_message = [&](std::string_view topic, std::string_view payload) {
+        if (topic == DONE_TOPIC) {
+            done = true;
+            return;
+        }
+        std::string_view name = topic.substr(1, topic.find('/', 1) - 1);
+        received++;
+        state.submit(boards.id(name), payload, topic.size() > 4 && topic.substr(topic.size() - 4) == "/bin", now_us);
+    };
+    if (!subscriber.connect(host, port, "aggregator_bench_sub") ||
+        !subscriber.subscribe({"/+/devices", "/+/devices/bin", DONE_TOPIC}, 0)) {
+        std::fprintf(stderr, "subscriber: %s\n", subscriber.error().c_str());
+        return false;
+    }
+
+    std::atomic<bool> failed{false};
+    auto start = bench_clock::now();
+    std::thread publisher(publish_all, host, port, std::cref(boards), std::cref(messages), std::ref(failed));
+    while (!done && !failed && seconds_since(start) < 120) {
+        if (!subscriber.poll(100)) {
+            std::fprintf(stderr, "subscriber: %s\n", subscriber.error().c_str());
+            failed = true;
+        }
+    }
+    state.drain();
+    double elapsed = seconds_since(start);
+    publisher.join();
+    subscriber.disconnect();
+
+    aggregator_stats stats = state.stats();
+    accuracy result = evaluate(devices, state.snapshot(now_us));
+    std::printf("broker %s:%u, %zu shards: %" PRIu64 "/%zu messages, %" PRIu64 "/%" PRIu64
+                " sightings in %.2f s (%.0f sightings/s), room %.1f%%\n",
+                host.c_str(), port, shards, received, messages.size(), stats.sightings, sightings, elapsed,
+                stats.sightings / elapsed, 100 * result.room_hits);
+    return !failed && done;
+}
+
+int usage(const char *program) {
+    std::fprintf(stderr,
+                 "Usage: %s [--boards N] [--devices N] [--rounds N] [--format batch|device|binary]\n"
+                 "          [--shards 1,2,4,8] [--seed N] [--broker host[:port]]\n",
+                 program);
+    return 2;
+}
+
+}  // namespace
+
+int main(int argc, char **argv) {
+    size_t board_count = 100;
+    size_t device_count = 5000;
+    int rounds = 3;
+    std::string format = "batch";
+    std::vector<size_t> shard_counts = {1, 2, 4, 8};
+    uint64_t seed = 1;
+    std::string broker;
+
+    for (int i = 1; i < argc; i += 2) {
+        if (i + 1 >= argc) {
+            return usage(argv[0]);
+        }
+        std::string option = argv[i];
+        std::string value = argv[i + 1];
+        if (option == "--boards") {
+            board_count = std::strtoul(value.c_str(), nullptr, 10);
+        } else if (option == "--devices") {
+            device_count = std::strtoul(value.c_str(), nullptr, 10);
+        } else if (option == "--rounds") {
+            rounds = std::max(1, std::atoi(value.c_str()));
+        } else if (option == "--format") {
+            format = value;
+        } else if (option == "--shards") {
+            shard_counts.clear();
+            for (const char *p = value.c_str(); *p;) {
+                char *end;
+                shard_counts.push_back(std::max<size_t>(1, std::strtoul(p, &end, 10)));
+                p = *end == ',' ? end + 1 : end;
+                if (end == p && *p) {
+                    return usage(argv[0]);
+                }
+            }
+        } else if (option == "--seed") {
+            seed = std::strtoull(value.c_str(), nullptr, 10);
+        } else if (option == "--broker") {
+            broker = value;
+        } else {
+            std::fprintf(stderr, "Unknown option %s\n", option.c_str());
+            return usage(argv[0]);
+        }
+    }
+    if (format != "batch" && format != "device" && format != "binary") {
+        return usage(argv[0]);
+    }
+    if (board_count == 0 || board_count > board_map::MAX_BOARDS || shard_counts.empty()) {
+        return usage(argv[0]);
+    }
+
+    // Płytki w siatce, każda we własnym pokoju
+    board_map boards;
+    size_t columns = static_cast<size_t>(std::ceil(std::sqrt(static_cast<double>(board_count))));
+    for (size_t i = 0; i < board_count; i++) {
+        board_info board;
+        board.name = "bench" + std::to_string(i);
+        board.room = "room" + std::to_string(i);
+        board.x = BOARD_SPACING_M * static_cast<double>(i % columns);
+        board.y = BOARD_SPACING_M * static_cast<double>(i / columns);
+        board.placed = true;
+        boards.add(board);
+    }
+    double width = BOARD_SPACING_M * static_cast<double>(columns - 1);
+    double height = BOARD_SPACING_M * static_cast<double>((board_count - 1) / columns);
+
+    std::mt19937_64 random(seed);
+    std::uniform_real_distribution<double> along_x(0, width);
+    std::uniform_real_distribution<double> along_y(0, height);
+    std::vector<simulated_device> devices(device_count);
+    for (size_t i = 0; i < device_count; i++) {
+        simulated_device &device = devices[i];
+        device.address = 0xC00000000000ULL | (random() & 0x3FFFFFFFFFFFULL);
+        device.x = along_x(random);
+        device.y = along_y(random);
+        double best = INFINITY;
+        for (uint16_t b = 0; b < boards.size(); b++) {
+            double distance = std::hypot(device.x - boards.board(b).x, device.y - boards.board(b).y);
+            if (distance < best) {
+                best = distance;
+                device.nearest_board = b;
+            }
+        }
+    }
+
+    // Czas płytek zsynchronizowany: znaczniki w wiadomościach to czas UNIX
+    int64_t epoch_us = wall_clock_us();
+    time_sync_set(epoch_us, 0);
+    std::vector<message> messages;
+    uint64_t sightings = 0;
+    for (int round = 0; round < rounds; round++) {
+        generate_round(boards, devices, format, round * SCAN_PERIOD_US, random, messages, sightings);
+    }
+    int64_t now_us = epoch_us + rounds * SCAN_PERIOD_US;
+    size_t payload_bytes = 0;
+    for (const message &m : messages) {
+        payload_bytes += m.payload.size();
+    }
+    std::printf("%zu boards, %zu devices, %d rounds (%s): %zu messages, %.1f MB, %" PRIu64
+                " sightings (%.1f boards per device)\n",
+                board_count, device_count, rounds, format.c_str(), messages.size(), payload_bytes / 1e6, sightings,
+                static_cast<double>(sightings) / (static_cast<double>(device_count) * rounds));
+    std::printf("%u hardware threads\n", std::thread::hardware_concurrency());
+
+    // Samo parsowanie w jednym wątku - w agregatorze robi to pula parserów (tylu, ile shardów)
+    std::vector<sighting> parsed;
+    auto start = bench_clock::now();
+    uint64_t parsed_count = 0;
+    for (const message &m : messages) {
+        parsed.clear();
+        parse_message(m.payload, m.binary, parsed);
+        parsed_count += parsed.size();
+    }
+    double parse_s = seconds_since(start);
+    std::printf("parse only: %.0f sightings/s\n", parsed_count / parse_s);
+    if (parsed_count != sightings) {
+        std::fprintf(stderr, "parsed %" PRIu64 " of %" PRIu64 " sightings\n", parsed_count, sightings);
+        return 1;
+    }
+
+    // Jedyna praca wątku odbierającego na wiadomość: kopia treści do kolejki parserów
+    std::string copy;
+    size_t copied = 0;
+    start = bench_clock::now();
+    for (const message &m : messages) {
+        copy.assign(m.payload);
+        copied += copy.size();
+    }
+    double handoff_s = seconds_since(start);
+    std::printf("receive hand-off only: %.0f sightings/s (%zu bytes)\n", sightings / handoff_s, copied);
+
+    bool ok = true;
+    for (size_t shards : shard_counts) {
+        aggregator_config config;
+        config.shards = shards;
+        class aggregator state(boards, config);
+
+        start = bench_clock::now();
+        for (const message &m : messages) {
+            state.submit(m.board, m.payload, m.binary, now_us);
+        }
+        state.drain();
+        double ingest_s = seconds_since(start);
+
+        start = bench_clock::now();
+        std::vector<device_estimate> estimates = state.snapshot(now_us);
+        double snapshot_s = seconds_since(start);
+
+        accuracy result = evaluate(devices, estimates);
+        std::printf("%2zu shards: ingest %.0f sightings/s (%.0f msg/s), snapshot %.1f ms, %zu devices, "
+                    "room %.1f%%, position error %.2f m\n",
+                    shards, sightings / ingest_s, messages.size() / ingest_s, snapshot_s * 1e3, estimates.size(),
+                    100 * result.room_hits, result.mean_error_m);
+        if (estimates.size() != device_count || result.room_hits < MIN_ROOM_HITS) {
+            ok = false;
+        }
+    }
+
+    if (!broker.empty()) {
+        std::string host = broker;
+        uint16_t port = 1883;
+        size_t colon = broker.rfind(':');
+        if (colon != std::string::npos) {
+            host = broker.substr(0, colon);
+            port = static_cast<uint16_t>(std::strtoul(broker.c_str() + colon + 1, nullptr, 10));
+        }
+        ok = run_broker(host, port, boards, shard_counts.back(), devices, messages, sightings, now_us) && ok;
+    }
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,64 @@
+#include "board_map.h"
+
+#include <fstream>
+#include <sstream>
+
+namespace aggregator {
+
+bool board_map::load(const std::string &path, std::string &error) {
+    std::ifstream input(path);
+    if (!input) {
+        error = "cannot open " + path;
+        return false;
+    }
+
+    std::string line;
+    unsigned line_number = 0;
+    while (std::getline(input, line)) {
+        line_number++;
+        std::istringstream fields(line);
+        board_info board;
+        if (!(fields >> board.name) || board.name[0] == '#') {
+            continue;
+        }
+        if (!(fields >> board.room >> board.x >> board.y)) {
+            error = path + ":" + std::to_string(line_number) + ": expected <board> <room> <x> <y>";
+            return false;
+        }
+        fields >> board.rssi_at_1m >> board.path_loss_exponent;
+        board.placed = true;
+        if (add(board) == NONE) {
+            error = path + ":" + std::to_string(line_number) + ": too many boards";
+            return false;
+        }
+    }
+    return true;
+}
+
+uint16_t board_map::add(const board_info &board) {
+    auto existing = ids_.find(board.name);
+    if (existing != ids_.end()) {
+        boards_[existing->second] = board;
+        return existing->second;
+    }
+    if (boards_.size() >= MAX_BOARDS) {
+        return NONE;
+    }
+    uint16_t id = static_cast<uint16_t>(boards_.size());
+    boards_.push_back(board);
+    ids_.emplace(board.name, id);
+    return id;
+}
+
+uint16_t board_map::id(std::string_view name) {
+    auto existing = ids_.find(std::string(name));
+    if (existing != ids_.end()) {
+        return existing->second;
+    }
+    board_info board;
+    board.name = std::string(name);
+    board.room = board.name;
+    return add(board);
+}
+
+}  // namespace aggregator
@@ -0,0 +1,62 @@
+#ifndef HOST_AGGREGATOR_BOARD_MAP_H_
+#define HOST_AGGREGATOR_BOARD_MAP_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+// Rozmieszczenie płytek wczytywane z pliku tekstowego, po jednej płytce w linii:
+//
+//   <board_name> <room> <x_m> <y_m> [rssi_at_1m_dbm] [path_loss_exponent]
+//
+// Puste linie i linie zaczynające się od '#' są pomijane. Płytki spoza pliku
+// (np. ogłoszone na /boards) są dodawane bez pozycji, a ich pokojem jest nazwa płytki.
+
+namespace aggregator {
+
+constexpr double DEFAULT_RSSI_AT_1M = -59.0;
+constexpr double DEFAULT_PATH_LOSS_EXPONENT = 2.5;
+
+struct board_info {
+    std::string name;
+    std::string room;
+    double x = 0;
+    double y = 0;
+    double rssi_at_1m = DEFAULT_RSSI_AT_1M;
+    double path_loss_exponent = DEFAULT_PATH_LOSS_EXPONENT;
+    bool placed = false;  // Pozycja znana z pliku
+};
+
+class board_map {
+public:
+    static constexpr size_t MAX_BOARDS = 4096;
+    static constexpr uint16_t NONE = 0xFFFF;
+
+    board_map() { boards_.reserve(MAX_BOARDS); }
+
+    bool load(const std::string &path, std::string &error);
+
+    uint16_t add(const board_info &board);
+
+    // Identyfikator płytki o danej nazwie; nieznana płytka jest dodawana bez pozycji.
+    // NONE, gdy zabrakło miejsca.
+    uint16_t id(std::string_view name);
+
+    // Wywoływane tylko z wątku odbierającego wiadomości. Wpisy nie są przenoszone
+    // (pojemność zarezerwowana z góry), więc shardy mogą czytać płytki o identyfikatorach,
+    // które otrzymały przez kolejkę.
+    const board_info &board(uint16_t id) const { return boards_[id]; }
+
+    size_t size() const { return boards_.size(); }
+
+private:
+    std::vector<board_info> boards_;
+    std::unordered_map<std::string, uint16_t> ids_;
+};
+
+}  // namespace aggregator
+
+#endif
@@ -0,0 +1,139 @@
+#include "locator.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace aggregator {
+
+namespace {
+
+// Do pozycji brane są najsilniejsze odczyty - dalsze płytki wnoszą głównie szum
+constexpr size_t MAX_READINGS = 8;
+constexpr double MIN_DISTANCE_M = 0.5;
+constexpr int MAX_ITERATIONS = 10;
+constexpr double CONVERGED_M = 0.01;
+
+struct ranged_board {
+    const board_info *board;
+    double distance;
+    double weight;
+};
+
+}  // namespace
+
+double path_loss_distance_m(const board_info &board, double rssi) {
+    double distance = std::pow(10.0, (board.rssi_at_1m - rssi) / (10.0 * board.path_loss_exponent));
+    return std::max(distance, MIN_DISTANCE_M);
+}
+
+location locate(const board_map &boards, const board_reading *readings, size_t count) {
+    location result;
+    ranged_board ranged[MAX_READINGS];
+    size_t ranged_count = 0;
+
+    for (size_t i = 0; i < count; i++) {
+        if (result.nearest_board == board_map::NONE || readings[i].rssi > result.nearest_rssi) {
+            result.nearest_board = readings[i].board;
+            result.nearest_rssi = readings[i].rssi;
+        }
+
+        const board_info &board = boards.board(readings[i].board);
+        if (!board.placed) {
+            continue;
+        }
+        double distance = path_loss_distance_m(board, readings[i].rssi);
+        ranged_board candidate{&board, distance, 1.0 / (distance * distance)};
+        if (ranged_count < MAX_READINGS) {
+            ranged[ranged_count++] = candidate;
+        } else {
+            // Zastępuje najdalszą płytkę, jeśli nowa jest bliżej
+            ranged_board *farthest = std::max_element(
+                ranged, ranged + ranged_count,
+                [](const ranged_board &a, const ranged_board &b) { return a.distance < b.distance; });
+            if (distance < farthest->distance) {
+                *farthest = candidate;
+            }
+        }
+    }
+    if (ranged_count == 0) {
+        return result;
+    }
+
+    double weight_sum = 0;
+    double centroid_x = 0;
+    double centroid_y = 0;
+    for (size_t i = 0; i < ranged_count; i++) {
+        weight_sum += ranged[i].weight;
+        centroid_x += ranged[i].weight * ranged[i].board->x;
+        centroid_y += ranged[i].weight * ranged[i].board->y;
+    }
+    result.x = centroid_x / weight_sum;
+    result.y = centroid_y / weight_sum;
+    result.method = locate_method::centroid;
+    if (ranged_count < 3) {
+        return result;
+    }
+
+    // Ważona nieliniowa metoda najmniejszych kwadratów (Gauss-Newton) startująca ze środka
+    // ciężkości: minimalizuje sum w_i (|p - b_i| - d_i)^2. Błąd odległości z modelu
+    // log-distance rośnie proporcjonalnie do d, stąd wagi 1/d^2.
+    double x = result.x;
+    double y = result.y;
+    for (int iteration = 0; iteration < MAX_ITERATIONS; iteration++) {
+        double a11 = 0, a12 = 0, a22 = 0, b1 = 0, b2 = 0;
+        for (size_t i = 0; i < ranged_count; i++) {
+            double dx = x - ranged[i].board->x;
+            double dy = y - ranged[i].board->y;
+            double range = std::max(std::hypot(dx, dy), 1e-3);
+            double ux = dx / range;
+            double uy = dy / range;
+            double residual = ranged[i].distance - range;
+            double w = ranged[i].weight;
+            a11 += w * ux * ux;
+            a12 += w * ux * uy;
+            a22 += w * uy * uy;
+            b1 += w * ux * residual;
+            b2 += w * uy * residual;
+        }
+        double determinant = a11 * a22 - a12 * a12;
+        double scale = (a11 + a22) * (a11 + a22);
+        if (scale <= 0 || std::fabs(determinant) < 1e-6 * scale) {
+            return result;  // Płytki prawie współliniowe względem urządzenia
+        }
+        double step_x = (b1 * a22 - b2 * a12) / determinant;
+        double step_y = (a11 * b2 - a12 * b1) / determinant;
+        x += step_x;
+        y += step_y;
+        if (std::hypot(step_x, step_y) < CONVERGED_M) {
+            break;
+        }
+    }
+
+    // Przy dużym szumie RSSI rozwiązanie potrafi uciec daleko od płytek - wtedy zostaje środek ciężkości
+    const ranged_board *nearest = std::min_element(
+        ranged, ranged + ranged_count, [](const ranged_board &a, const ranged_board &b) { return a.distance < b.distance; });
+    double limit = 0;
+    for (size_t i = 0; i < ranged_count; i++) {
+        limit = std::max(limit, 2 * ranged[i].distance);
+    }
+    if (!std::isfinite(x) || !std::isfinite(y) || std::hypot(x - nearest->board->x, y - nearest->board->y) > limit) {
+        return result;
+    }
+    result.x = x;
+    result.y = y;
+    result.method = locate_method::trilateration;
+    return result;
+}
+
+const char *locate_method_name(locate_method method) {
+    switch (method) {
+        case locate_method::centroid:
+            return "centroid";
+        case locate_method::trilateration:
+            return "trilateration";
+        default:
+            return "none";
+    }
+}
+
+}  // namespace aggregator
@@ -0,0 +1,48 @@
+#ifndef HOST_AGGREGATOR_LOCATOR_H_
+#define HOST_AGGREGATOR_LOCATOR_H_
+
+#include <cstddef>
+#include <cstdint>
+
+#include "board_map.h"
+
+// Położenie urządzenia z uśrednionych RSSI na kilku płytkach. Odległość od płytki
+// wynika z modelu propagacji log-distance:
+//
+//   rssi = rssi_at_1m - 10 * n * log10(d)
+//
+// Pokój to pokój płytki z najsilniejszym sygnałem. Pozycja pochodzi z ważonej
+// trilateracji (Gauss-Newton od środka ciężkości, wagi 1/d^2) dla co najmniej
+// trzech płytek o znanej pozycji, a gdy układ jest źle uwarunkowany lub płytek jest
+// mniej - z ważonego środka ciężkości płytek.
+
+namespace aggregator {
+
+struct board_reading {
+    uint16_t board;
+    double rssi;
+};
+
+enum class locate_method : uint8_t {
+    none,          // Żadna płytka z pozycją nie widzi urządzenia
+    centroid,
+    trilateration,
+};
+
+struct location {
+    uint16_t nearest_board = board_map::NONE;
+    double nearest_rssi = 0;
+    double x = 0;
+    double y = 0;
+    locate_method method = locate_method::none;
+};
+
+double path_loss_distance_m(const board_info &board, double rssi);
+
+location locate(const board_map &boards, const board_reading *readings, size_t count);
+
+const char *locate_method_name(locate_method method);
+
+}  // namespace aggregator
+
+#endif
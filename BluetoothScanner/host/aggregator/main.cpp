@@ -0,0 +1,218 @@
+// Usługa łącząca obserwacje wszystkich płytek w położenie urządzeń:
+//
+//   ble_aggregator [--broker host[:port]] [--boards boards.txt] [--shards N]
+//                  [--parsers N] [--window S] [--interval S] [--publish] [-v]
+//
+// Subskrybuje /+/devices, /+/devices/bin i /boards, a po połączeniu wysyła
+// "introduce" na /boards_command, żeby poznać wszystkie płytki. Co --interval
+// sekund liczy pokój (płytka z najsilniejszym uśrednionym RSSI) i pozycję
+// każdego urządzenia i wypisuje podsumowanie. Z --publish zmiany pokoju trafiają
+// na /aggregator/positions jako JSON.
+#include <chrono>
+#include <cinttypes>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <thread>
+
+#include "aggregator.h"
+#include "mqtt_lite.h"
+
+using namespace aggregator;
+
+namespace {
+
+constexpr const char *POSITIONS_TOPIC = "/aggregator/positions";
+
+int64_t wall_clock_us() {
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+               std::chrono::system_clock::now().time_since_epoch())
+        .count();
+}
+
+bool ends_with(std::string_view text, std::string_view suffix) {
+    return text.size() >= suffix.size() && text.substr(text.size() - suffix.size()) == suffix;
+}
+
+// "/<board>/devices" -> "<board>"; pusty widok dla innych tematów
+std::string_view board_from_topic(std::string_view topic, std::string_view suffix) {
+    if (topic.size() < 2 || topic[0] != '/' || !ends_with(topic, suffix)) {
+        return {};
+    }
+    std::string_view board = topic.substr(1, topic.size() - 1 - suffix.size());
+    if (board.empty() || board.find('/') != std::string_view::npos) {
+        return {};
+    }
+    return board;
+}
+
+int usage(const char *program) {
+    std::fprintf(stderr,
+                 "Usage: %s [--broker host[:port]] [--boards boards.txt] [--shards N]\n"
+                 "          [--parsers N] [--window S] [--interval S] [--publish] [-v]\n",
+                 program);
+    return 2;
+}
+
+}  // namespace
+
+int main(int argc, char **argv) {
+    std::string host = "localhost";
+    uint16_t port = 1883;
+    std::string boards_path;
+    aggregator_config config;
+    config.shards = std::max(1u, std::thread::hardware_concurrency());
+    int interval_s = 5;
+    bool publish = false;
+    bool verbose = false;
+
+    for (int i = 1; i < argc; i++) {
+        std::string option = argv[i];
+        if (option == "--publish") {
+            publish = true;
+            continue;
+        }
+        if (option == "-v") {
+            verbose = true;
+            continue;
+        }
+        if (i + 1 >= argc) {
+            return usage(argv[0]);
+        }
+        std::string value = argv[++i];
+        if (option == "--broker") {
+            size_t colon = value.rfind(':');
+            host = value.substr(0, colon);
+            if (colon != std::string::npos) {
+                port = static_cast<uint16_t>(std::strtoul(value.c_str() + colon + 1, nullptr, 10));
+            }
+        } else if (option == "--boards") {
+            boards_path = value;
+        } else if (option == "--shards") {
+            config.shards = std::strtoul(value.c_str(), nullptr, 10);
+        } else if (option == "--parsers") {
+            config.parsers = std::strtoul(value.c_str(), nullptr, 10);
+        } else if (option == "--window") {
+            config.window_us = std::strtoll(value.c_str(), nullptr, 10) * 1000000LL;
+        } else if (option == "--interval") {
+            interval_s = std::max(1, std::atoi(value.c_str()));
+        } else {
+            std::fprintf(stderr, "Unknown option %s\n", option.c_str());
+            return usage(argv[0]);
+        }
+    }
+    config.expiry_us = std::max(config.expiry_us, 4 * config.window_us);
+
+    board_map boards;
+    if (!boards_path.empty()) {
+        std::string error;
+        if (!boards.load(boards_path, error)) {
+            std::fprintf(stderr, "%s\n", error.c_str());
+            return 1;
+        }
+        std::fprintf(stderr, "%zu boards placed from %s\n", boards.size(), boards_path.c_str());
+    }
+
+    class aggregator state(boards, config);
+    uint64_t messages = 0;
+    uint64_t unknown_boards = 0;
+
+    mqtt_lite::client client;
+    client.on_message = [&](std::string_view topic, std::string_view payload) {
+        if (topic == "/boards") {
+            if (boards.id(payload) != board_map::NONE && verbose) {
+                std::fprintf(stderr, "board %.*s\n", static_cast<int>(payload.size()), payload.data());
+            }
+            return;
+        }
+
+        bool binary = false;
+        std::string_view board = board_from_topic(topic, "/devices");
+        if (board.empty()) {
+            board = board_from_topic(topic, "/devices/bin");
+            binary = true;
+        }
+        if (board.empty()) {
+            return;
+        }
+        uint16_t board_id = boards.id(board);
+        if (board_id == board_map::NONE) {
+            unknown_boards++;
+            return;
+        }
+
+        messages++;
+        state.submit(board_id, payload, binary, wall_clock_us());
+    };
+
+    if (!client.connect(host, port, "ble_aggregator_" + std::to_string(wall_clock_us() % 100000))) {
+        std::fprintf(stderr, "connect to %s:%u failed: %s\n", host.c_str(), port, client.error().c_str());
+        return 1;
+    }
+    if (!client.subscribe({"/boards", "/+/devices", "/+/devices/bin"}, 0)) {
+        std::fprintf(stderr, "subscribe failed: %s\n", client.error().c_str());
+        return 1;
+    }
+    client.publish("/boards_command", "introduce");
+    std::fprintf(stderr, "connected to %s:%u, %zu shards\n", host.c_str(), port, state.shard_count());
+
+    int64_t next_report_us = wall_clock_us() + interval_s * 1000000LL;
+    uint64_t last_sightings = 0;
+    uint64_t last_messages = 0;
+    for (;;) {
+        if (!client.poll(100)) {
+            std::fprintf(stderr, "connection lost: %s\n", client.error().c_str());
+            return 1;
+        }
+        int64_t now_us = wall_clock_us();
+        if (now_us < next_report_us) {
+            continue;
+        }
+        next_report_us = now_us + interval_s * 1000000LL;
+
+        std::vector<device_estimate> estimates = state.snapshot(now_us);
+        aggregator_stats stats = state.stats();
+        size_t changed = 0;
+        size_t trilaterated = 0;
+        char payload[256];
+        for (const device_estimate &estimate : estimates) {
+            if (estimate.where.method == locate_method::trilateration) {
+                trilaterated++;
+            }
+            if (!estimate.room_changed || estimate.where.nearest_board == board_map::NONE) {
+                continue;
+            }
+            changed++;
+            const board_info &nearest = boards.board(estimate.where.nearest_board);
+            std::string address = format_address(estimate.address);
+            if (verbose) {
+                std::printf("%s -> %s (%s, %.1f dBm, %u boards)\n", address.c_str(), nearest.room.c_str(),
+                            nearest.name.c_str(), estimate.where.nearest_rssi, estimate.boards);
+            }
+            if (publish) {
+                int length = std::snprintf(payload, sizeof(payload),
+                                           "{\"address\":\"%s\",\"room\":\"%s\",\"board\":\"%s\",\"rssi\":%.1f,"
+                                           "\"x\":%.2f,\"y\":%.2f,\"method\":\"%s\",\"boards\":%u,\"timestamp_us\":%" PRId64
+                                           "}",
+                                           address.c_str(), nearest.room.c_str(), nearest.name.c_str(),
+                                           estimate.where.nearest_rssi, estimate.where.x, estimate.where.y,
+                                           locate_method_name(estimate.where.method), estimate.boards,
+                                           estimate.last_seen_us);
+                if (length > 0 && static_cast<size_t>(length) < sizeof(payload)) {
+                    client.publish(POSITIONS_TOPIC, std::string_view(payload, static_cast<size_t>(length)));
+                }
+            }
+        }
+
+        std::printf("%zu boards, %zu devices (%zu trilaterated), %zu room changes, %.0f msg/s, %.0f sightings/s, "
+                    "%" PRIu64 " rejected\n",
+                    boards.size(), estimates.size(), trilaterated, changed,
+                    static_cast<double>(messages - last_messages) / interval_s,
+                    static_cast<double>(stats.sightings - last_sightings) / interval_s,
+                    stats.rejected + unknown_boards);
+        std::fflush(stdout);
+        last_messages = messages;
+        last_sightings = stats.sightings;
+    }
+}
@@ -0,0 +1,240 @@
+#include "sighting_parser.h"
+
+#include <charconv>
+#include <cstdio>
+
+#include "sighting_wire.h"
+
+namespace aggregator {
+
+namespace {
+
+// Parser JSON wyciągający z obiektów pola "address", "rssi" i "timestamp_us".
+// Obiekty bez adresu (nagłówek paczki) są przechodzone w głąb, najwyżej do
+// JSON_MAX_DEPTH poziomów.
+class json_scanner {
+public:
+    json_scanner(std::string_view text, std::vector<sighting> &out) : text_(text), out_(out) {}
+
+    bool parse() {
+        skip_space();
+        if (!value()) {
+            return false;
+        }
+        skip_space();
+        return pos_ == text_.size();
+    }
+
+private:
+    void skip_space() {
+        while (pos_ < text_.size() && (text_[pos_] == ' ' || text_[pos_] == '\t' || text_[pos_] == '\n' ||
+                                       text_[pos_] == '\r')) {
+            pos_++;
+        }
+    }
+
+    bool consume(char c) {
+        skip_space();
+        if (pos_ < text_.size() && text_[pos_] == c) {
+            pos_++;
+            return true;
+        }
+        return false;
+    }
+
+    // Widok do tekstu bez rozwijania sekwencji ucieczki - wystarcza dla adresów
+    bool string(std::string_view &result) {
+        if (!consume('"')) {
+            return false;
+        }
+        size_t start = pos_;
+        while (pos_ < text_.size() && text_[pos_] != '"') {
+            pos_ += text_[pos_] == '\\' ? 2 : 1;
+        }
+        if (pos_ >= text_.size()) {
+            return false;
+        }
+        result = text_.substr(start, pos_ - start);
+        pos_++;
+        return true;
+    }
+
+    bool number(double &result) {
+        skip_space();
+        const char *start = text_.data() + pos_;
+        std::from_chars_result parsed = std::from_chars(start, text_.data() + text_.size(), result);
+        if (parsed.ec != std::errc()) {
+            return false;
+        }
+        pos_ += static_cast<size_t>(parsed.ptr - start);
+        return true;
+    }
+
+    bool literal(std::string_view word) {
+        skip_space();
+        if (text_.substr(pos_, word.size()) != word) {
+            return false;
+        }
+        pos_ += word.size();
+        return true;
+    }
+
+    bool value() {
+        skip_space();
+        if (pos_ >= text_.size()) {
+            return false;
+        }
+        switch (text_[pos_]) {
+            case '{':
+            case '[': {
+                if (depth_ == JSON_MAX_DEPTH) {
+                    return false;
+                }
+                depth_++;
+                bool ok = text_[pos_] == '{' ? object() : array();
+                depth_--;
+                return ok;
+            }
+            case '"': {
+                std::string_view ignored;
+                return string(ignored);
+            }
+            case 't':
+                return literal("true");
+            case 'f':
+                return literal("false");
+            case 'n':
+                return literal("null");
+            default: {
+                double ignored;
+                return number(ignored);
+            }
+        }
+    }
+
+    bool array() {
+        consume('[');
+        if (consume(']')) {
+            return true;
+        }
+        do {
+            if (!value()) {
+                return false;
+            }
+        } while (consume(','));
+        return consume(']');
+    }
+
+    bool object() {
+        consume('{');
+        sighting found{};
+        bool has_address = false;
+        bool has_rssi = false;
+        if (!consume('}')) {
+            do {
+                std::string_view key;
+                if (!string(key) || !consume(':')) {
+                    return false;
+                }
+                skip_space();
+                double numeric = 0;
+                if (key == "address") {
+                    std::string_view text;
+                    if (!string(text)) {
+                        return false;
+                    }
+                    has_address = parse_address(text, found.address);
+                } else if (key == "rssi") {
+                    if (!number(numeric)) {
+                        return false;
+                    }
+                    found.rssi = static_cast<int8_t>(numeric);
+                    has_rssi = true;
+                } else if (key == "timestamp_us") {
+                    if (!number(numeric)) {
+                        return false;
+                    }
+                    found.timestamp_us = static_cast<int64_t>(numeric);
+                } else if (!value()) {
+                    return false;
+                }
+            } while (consume(','));
+            if (!consume('}')) {
+                return false;
+            }
+        }
+        if (has_address && has_rssi) {
+            out_.push_back(found);
+        }
+        return true;
+    }
+
+    std::string_view text_;
+    size_t pos_ = 0;
+    size_t depth_ = 0;
+    std::vector<sighting> &out_;
+};
+
+int hex_digit(char c) {
+    if (c >= '0' && c <= '9') {
+        return c - '0';
+    }
+    if (c >= 'a' && c <= 'f') {
+        return c - 'a' + 10;
+    }
+    if (c >= 'A' && c <= 'F') {
+        return c - 'A' + 10;
+    }
+    return -1;
+}
+
+}  // namespace
+
+bool parse_devices_json(std::string_view payload, std::vector<sighting> &out) {
+    return json_scanner(payload, out).parse();
+}
+
+bool parse_devices_binary(std::string_view payload, std::vector<sighting> &out) {
+    sighting_wire_reader_t reader;
+    if (sighting_wire_reader_init(&reader, reinterpret_cast<const uint8_t *>(payload.data()), payload.size()) !=
+        SIGHTING_WIRE_OK) {
+        return false;
+    }
+    sighting_wire_record_t record;
+    sighting_wire_status_t status;
+    while ((status = sighting_wire_reader_next(&reader, &record)) == SIGHTING_WIRE_OK) {
+        uint64_t address = 0;
+        for (int i = 0; i < SIGHTING_WIRE_BDA_LEN; i++) {
+            address = address << 8 | record.bda[i];
+        }
+        out.push_back({address, record.rssi, record.timestamp_us});
+    }
+    return status == SIGHTING_WIRE_END;
+}
+
+bool parse_address(std::string_view text, uint64_t &address) {
+    if (text.size() != 17) {
+        return false;
+    }
+    address = 0;
+    for (size_t i = 0; i < 6; i++) {
+        int high = hex_digit(text[i * 3]);
+        int low = hex_digit(text[i * 3 + 1]);
+        if (high < 0 || low < 0 || (i < 5 && text[i * 3 + 2] != ':')) {
+            return false;
+        }
+        address = address << 8 | static_cast<uint64_t>(high << 4 | low);
+    }
+    return true;
+}
+
+std::string format_address(uint64_t address) {
+    char text[18];
+    std::snprintf(text, sizeof(text), "%02x:%02x:%02x:%02x:%02x:%02x", static_cast<unsigned>(address >> 40 & 0xFF),
+                  static_cast<unsigned>(address >> 32 & 0xFF), static_cast<unsigned>(address >> 24 & 0xFF),
+                  static_cast<unsigned>(address >> 16 & 0xFF), static_cast<unsigned>(address >> 8 & 0xFF),
+                  static_cast<unsigned>(address & 0xFF));
+    return text;
+}
+
+}  // namespace aggregator
@@ -0,0 +1,38 @@
+#ifndef HOST_AGGREGATOR_SIGHTING_PARSER_H_
+#define HOST_AGGREGATOR_SIGHTING_PARSER_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Odczyt wiadomości publikowanych przez płytki na /<board_name>/devices:
+// JSON z jednym urządzeniem albo paczka {"board", "timestamp_ms", "devices": [...]}
+// (main/sighting_format.c) oraz format binarny z /<board_name>/devices/bin.
+
+namespace aggregator {
+
+struct sighting {
+    uint64_t address;      // 48-bitowy adres, pierwszy bajt BDA najstarszy
+    int8_t rssi;
+    int64_t timestamp_us;  // Z wiadomości; 0, gdy płytka go nie podała
+};
+
+// Największe zagnieżdżenie obiektów i tablic; paczka z płytki ma 3 poziomy. Głębsza
+// wiadomość jest odrzucana, zanim rekurencja wyczerpie stos wątku parsera.
+constexpr size_t JSON_MAX_DEPTH = 16;
+
+// Dopisuje obserwacje do out; false przy błędnym JSON lub zagnieżdżeniu ponad
+// JSON_MAX_DEPTH (poprawne obiekty sprzed błędu zostają)
+bool parse_devices_json(std::string_view payload, std::vector<sighting> &out);
+
+bool parse_devices_binary(std::string_view payload, std::vector<sighting> &out);
+
+bool parse_address(std::string_view text, uint64_t &address);
+
+std::string format_address(uint64_t address);
+
+}  // namespace aggregator
+
+#endif
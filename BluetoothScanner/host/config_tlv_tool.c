@@ -0,0 +1,150 @@
+// Narzędzie do konfiguracji zbiorczej (main/config_tlv.h):
+//
+//   config_tlv_tool pack <plik.bin> [ssid=...] [password=...] [broker=...] [board=...]
+//                   [filter=...] [scan=...] [restart]
+//     Koduje podane pola w wartość charakterystyki zbiorczej (UUID ...ff06...), którą
+//     można zapisać jednym zapisem z dowolnego klienta GATT, np. nRF Connect. Pola
+//     pominięte zostają na płytce bez zmian; restart uruchamia płytkę ponownie po
+//     zapisaniu konfiguracji.
+//
+//   config_tlv_tool dump <plik.bin>
+//     Wypisuje rekordy odczytane z charakterystyki (lub przygotowane przez pack).
+//     Kończy się kodem 1, jeśli dane są niepoprawne albo płytka zgłosiła błąd zapisu.
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "config_tlv.h"
+
+typedef struct {
+    const char *key;
+    app_config_field_t field;
+} tool_key_t;
+
+static const tool_key_t keys[] = {
+    {"ssid", APP_CONFIG_WIFI_SSID},     {"password", APP_CONFIG_WIFI_PASSWORD},
+    {"broker", APP_CONFIG_BROKER_URI},  {"board", APP_CONFIG_BOARD_NAME},
+    {"filter", APP_CONFIG_SCAN_FILTER}, {"scan", APP_CONFIG_SCAN_PARAMS},
+};
+
+static const char *key_name(app_config_field_t field) {
+    for (size_t i = 0; i < sizeof(keys) / sizeof(keys[0]); i++) {
+        if (keys[i].field == field) {
+            return keys[i].key;
+        }
+    }
+    return "?";
+}
+
+static int pack(int argc, char **argv) {
+    static app_config_t config;
+    uint32_t fields = 0;
+    bool restart = false;
+
+    for (int i = 3; i < argc; i++) {
+        if (strcmp(argv[i], "restart") == 0) {
+            restart = true;
+            continue;
+        }
+        const char *equals = strchr(argv[i], '=');
+        const tool_key_t *key = NULL;
+        for (size_t k = 0; equals && k < sizeof(keys) / sizeof(keys[0]); k++) {
+            if (strlen(keys[k].key) == (size_t)(equals - argv[i]) &&
+                strncmp(argv[i], keys[k].key, equals - argv[i]) == 0) {
+                key = &keys[k];
+            }
+        }
+        if (key == NULL) {
+            fprintf(stderr, "Unknown field: %s\n", argv[i]);
+            return 2;
+        }
+        size_t size;
+        char *value = config_tlv_value(&config, key->field, &size);
+        if (strlen(equals + 1) >= size) {
+            fprintf(stderr, "%s longer than %zu characters\n", key->key, size - 1);
+            return 1;
+        }
+        strcpy(value, equals + 1);
+        fields |= 1u << key->field;
+    }
+
+    uint8_t out[CONFIG_TLV_MAX_LEN];
+    size_t len = config_tlv_encode(&config, fields, NULL, out, sizeof(out) - 2);
+    if (len == 0 && fields != 0) {
+        fprintf(stderr, "Configuration does not fit in %d bytes\n", CONFIG_TLV_MAX_LEN);
+        return 1;
+    }
+    if (restart) {
+        out[len++] = CONFIG_TLV_RESTART;
+        out[len++] = 0;
+    }
+
+    FILE *output = fopen(argv[2], "wb");
+    if (output == NULL || fwrite(out, 1, len, output) != len || fclose(output) != 0) {
+        perror(argv[2]);
+        return 1;
+    }
+    printf("%zu bytes\n", len);
+    return 0;
+}
+
+static int dump(const char *path) {
+    uint8_t data[CONFIG_TLV_MAX_LEN + 1];
+    FILE *input = fopen(path, "rb");
+    if (input == NULL) {
+        perror(path);
+        return 1;
+    }
+    size_t len = fread(data, 1, sizeof(data), input);
+    fclose(input);
+    if (len > CONFIG_TLV_MAX_LEN) {
+        fprintf(stderr, "Longer than %d bytes\n", CONFIG_TLV_MAX_LEN);
+        return 1;
+    }
+
+    // Rekord błędu występuje tylko w odczycie - decode go nie przyjmuje
+    size_t error_pos = len;
+    for (size_t pos = 0; pos + 2 <= len; pos += 2 + (size_t)data[pos + 1]) {
+        if (data[pos] == CONFIG_TLV_ERROR) {
+            error_pos = pos;
+            break;
+        }
+    }
+
+    static config_tlv_update_t update;
+    char error[64];
+    if (!config_tlv_decode(data, error_pos, &update, error, sizeof(error))) {
+        fprintf(stderr, "Invalid data: %s\n", error);
+        return 1;
+    }
+    for (int field = 0; field < APP_CONFIG_FIELD_COUNT; field++) {
+        if (update.fields & (1u << field)) {
+            size_t size;
+            printf("%s=%s\n", key_name(field), config_tlv_value(&update.values, field, &size));
+        }
+    }
+    if (update.restart) {
+        printf("restart\n");
+    }
+    if (error_pos < len) {
+        size_t error_len = error_pos + 2 + data[error_pos + 1] <= len ? data[error_pos + 1] : 0;
+        printf("last write rejected: %.*s\n", (int)error_len, (const char *)data + error_pos + 2);
+        return 1;
+    }
+    return 0;
+}
+
+int main(int argc, char **argv) {
+    if (argc >= 3 && strcmp(argv[1], "pack") == 0) {
+        return pack(argc, argv);
+    }
+    if (argc == 3 && strcmp(argv[1], "dump") == 0) {
+        return dump(argv[2]);
+    }
+    fprintf(stderr,
+            "Usage: %s pack <file.bin> [ssid=...] [password=...] [broker=...] [board=...]\n"
+            "                [filter=...] [scan=...] [restart]\n"
+            "       %s dump <file.bin>\n",
+            argv[0], argv[0]);
+    return 2;
+}
@@ -0,0 +1,633 @@
+// Generator ruchu MQTT udający flotę płytek skanujących:
+//
+//   fleet_sim [--broker host[:port]] [--boards N] [--devices N] [--threads N]
+//             [--window S] [--pause S] [--format device|batch|binary] [--qos 0|1]
+//             [--rate MSG_PER_S] [--duration S] [--spacing M] [--seed N] [--prefix NAME]
+//
+// Każda płytka ma własne połączenie z brokerem i zachowuje się jak firmware:
+// po połączeniu publikuje swoją nazwę na /boards, odpowiada na "introduce"
+// z /boards_command, a po każdym oknie skanowania publikuje wyniki na
+// /<board>/devices kodem z main/sighting_format.c (jedna wiadomość na urządzenie,
+// paczka albo format binarny). Płytki stoją w siatce pokoi co --spacing metrów,
+// urządzenia przechodzą między sąsiednimi pokojami i reklamują się co 100-1000 ms;
+// odbiór reklamy zależy od RSSI z modelu log-distance z szumem.
+//
+// Płytki są rozdzielone między wątki. Co sekundę wypisywane są: osiągnięta liczba
+// publikacji, przepływność, czas publish->PUBACK (QoS 1, próbkowany) oraz czas
+// obiegu wiadomości przez brokera z osobnego klienta próbkującego.
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cinttypes>
+#include <cmath>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "mqtt_lite.h"
+
+extern "C" {
+#include "rssi_filter.h"
+#include "sdkconfig.h"
+#include "sighting_format.h"
+#include "time_sync.h"
+}
+
+namespace {
+
+constexpr double RSSI_AT_1M = -59.0;
+constexpr double PATH_LOSS_EXPONENT = 2.5;
+constexpr double RSSI_NOISE_DB = 4.0;
+constexpr double SENSITIVITY_DBM = -95.0;
+constexpr double ADVERT_LOSS = 0.1;         // Reklamy gubione mimo wystarczającego RSSI
+constexpr int MAX_SIMULATED_ADVERTS = 64;   // Powyżej liczba reklam jest skalowana
+constexpr int64_t ROOM_PERIOD_US = 60 * 1000000LL;  // Jedno przejście między pokojami na minutę
+constexpr double WALK_FRACTION = 0.25;      // Część okresu spędzana w drodze
+constexpr double ROOM_JITTER_M = 3.0;
+// Domyślne CONFIG_SIGHTING_BATCH_MAX_DEVICES i CONFIG_SIGHTING_BATCH_BUFFER_SIZE
+constexpr uint32_t BATCH_MAX_DEVICES = 32;
+constexpr size_t BATCH_BUFFER_SIZE = 4096;
+constexpr uint16_t ACK_SAMPLE_EVERY = 64;   // Czas PUBACK mierzony dla co 64. pakietu
+constexpr const char *PROBE_TOPIC = "/fleet_sim/probe";
+constexpr int PROBE_INTERVAL_MS = 100;
+
+std::atomic<bool> stop_requested{false};
+
+int64_t steady_us() {
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+}
+
+int64_t wall_clock_us() {
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+               std::chrono::system_clock::now().time_since_epoch())
+        .count();
+}
+
+uint64_t mix(uint64_t x) {
+    x ^= x >> 30;
+    x *= 0xbf58476d1ce4e5b9ULL;
+    x ^= x >> 27;
+    x *= 0x94d049bb133111ebULL;
+    x ^= x >> 31;
+    return x;
+}
+
+double unit(uint64_t hash) {
+    return static_cast<double>(hash >> 11) * (1.0 / 9007199254740992.0);
+}
+
+struct options {
+    std::string host = "localhost";
+    uint16_t port = 1883;
+    size_t boards = 100;
+    size_t devices = 2000;
+    size_t threads = std::max(1u, std::thread::hardware_concurrency());
+    double window_s = CONFIG_SCAN_DURATION_S;
+#if CONFIG_SCAN_MODE_DUTY_CYCLE
+    double pause_s = CONFIG_SCAN_INTERVAL_S;
+#else
+    double pause_s = 0;
+#endif
+    std::string format = "device";
+    uint8_t qos = 1;  // Jak mqtt_publish w main.c
+    double rate = 0;  // 0 - bez limitu, tempo wynika z okien
+    double duration_s = 60;
+    double spacing_m = 10;
+    uint64_t seed = 1;
+    std::string prefix = "sim";
+};
+
+// Rozkład pokoi w siatce wspólny dla wszystkich wątków
+struct building {
+    size_t columns;
+    size_t rooms;
+    double spacing_m;
+    int64_t origin_us;  // Początek symulacji ruchu
+
+    double room_x(size_t room) const { return spacing_m * static_cast<double>(room % columns); }
+    double room_y(size_t room) const { return spacing_m * static_cast<double>(room / columns); }
+
+    // Sąsiedni pokój (albo ten sam) wybrany skrótem - ta sama sekwencja w każdym wątku
+    size_t next_room(size_t room, uint64_t hash) const {
+        size_t candidates[5] = {room, room, room, room, room};
+        size_t count = 1;
+        size_t column = room % columns;
+        if (column > 0) candidates[count++] = room - 1;
+        if (column + 1 < columns && room + 1 < rooms) candidates[count++] = room + 1;
+        if (room >= columns) candidates[count++] = room - columns;
+        if (room + columns < rooms) candidates[count++] = room + columns;
+        return candidates[hash % count];
+    }
+};
+
+// Ruch urządzenia jest deterministyczną funkcją czasu, więc każdy wątek liczy go
+// niezależnie na własnej kopii stanu, bez współdzielenia i blokad
+struct device_motion {
+    uint64_t address;
+    uint64_t hash;
+    int64_t phase_us;
+    uint32_t advert_interval_ms;
+    char name[SIGHTING_NAME_MAX_LEN];
+    int64_t segment = 0;
+    size_t from_room;
+    size_t to_room;
+
+    void position(const building &layout, int64_t time_us, double &x, double &y) {
+        int64_t shifted = std::max<int64_t>(time_us - layout.origin_us + phase_us, 0);
+        int64_t segment_now = shifted / ROOM_PERIOD_US;
+        while (segment < segment_now) {
+            segment++;
+            from_room = to_room;
+            to_room = layout.next_room(from_room, mix(hash ^ static_cast<uint64_t>(segment)));
+        }
+        double progress = static_cast<double>(shifted % ROOM_PERIOD_US) / ROOM_PERIOD_US / WALK_FRACTION;
+        progress = std::min(progress, 1.0);
+        double jitter_from_x = ROOM_JITTER_M * (unit(mix(hash + 2 * segment)) - 0.5);
+        double jitter_from_y = ROOM_JITTER_M * (unit(mix(hash + 2 * segment + 1)) - 0.5);
+        double jitter_to_x = ROOM_JITTER_M * (unit(mix(hash + 2 * segment + 2)) - 0.5);
+        double jitter_to_y = ROOM_JITTER_M * (unit(mix(hash + 2 * segment + 3)) - 0.5);
+        double from_x = layout.room_x(from_room) + jitter_from_x;
+        double from_y = layout.room_y(from_room) + jitter_from_y;
+        x = from_x + (layout.room_x(to_room) + jitter_to_x - from_x) * progress;
+        y = from_y + (layout.room_y(to_room) + jitter_to_y - from_y) * progress;
+    }
+};
+
+std::vector<device_motion> make_devices(const options &opts, const building &layout) {
+    std::vector<device_motion> devices(opts.devices);
+    for (size_t i = 0; i < opts.devices; i++) {
+        device_motion &device = devices[i];
+        device.hash = mix(opts.seed * 0x9e3779b97f4a7c15ULL + i);
+        device.address = 0xC00000000000ULL | (device.hash & 0x3FFFFFFFFFFFULL);
+        device.phase_us = static_cast<int64_t>(device.hash % ROOM_PERIOD_US);
+        device.advert_interval_ms = 100 + static_cast<uint32_t>(mix(device.hash) % 901);
+        device.to_room = mix(device.hash + 1) % layout.rooms;
+        device.from_room = device.to_room;
+        // Co trzecie urządzenie ma nazwę w reklamie
+        if (i % 3 == 0) {
+            std::snprintf(device.name, sizeof(device.name), "tag-%04zu", i % 10000);
+        } else {
+            device.name[0] = '\0';
+        }
+    }
+    return devices;
+}
+
+struct thread_stats {
+    std::atomic<uint64_t> messages{0};
+    std::atomic<uint64_t> bytes{0};
+    std::atomic<uint64_t> acks{0};
+    std::atomic<uint64_t> errors{0};
+    std::atomic<int64_t> max_lag_us{0};  // Najdłuższe opóźnienie końca okna względem planu
+    std::mutex latency_mutex;
+    std::vector<uint32_t> ack_latency_us;
+};
+
+struct simulated_board {
+    std::string name;
+    std::string devices_topic;
+    size_t room;
+    mqtt_lite::client client;
+    int64_t window_start_us;
+    int64_t sent_us[65536 / ACK_SAMPLE_EVERY] = {};
+};
+
+class board_thread {
+public:
+    board_thread(const options &opts, const building &layout, thread_stats &stats, size_t index)
+        : opts_(opts), layout_(layout), stats_(stats), random_(mix(opts.seed + 1000003 * (index + 1))),
+          devices_(make_devices(opts, layout)) {}
+
+    void add_board(size_t room) {
+        auto board = std::make_unique<simulated_board>();
+        board->name = opts_.prefix + std::to_string(room);
+        board->devices_topic = "/" + board->name + (opts_.format == "binary" ? "/devices/bin" : "/devices");
+        board->room = room;
+        boards_.push_back(std::move(board));
+    }
+
+    bool connect_all() {
+        for (auto &board : boards_) {
+            simulated_board *b = board.get();
+            b->client.on_message = [b](std::string_view topic, std::string_view payload) {
+                if (topic == "/boards_command" && payload == "introduce") {
+                    b->client.publish("/boards", b->name, 1);
+                }
+            };
+            b->client.on_puback = [this, b](uint16_t packet_id) {
+                stats_.acks.fetch_add(1, std::memory_order_relaxed);
+                if (packet_id % ACK_SAMPLE_EVERY != 0) {
+                    return;
+                }
+                int64_t &sent = b->sent_us[packet_id / ACK_SAMPLE_EVERY];
+                if (sent != 0) {
+                    ack_samples_.push_back(static_cast<uint32_t>(std::min<int64_t>(steady_us() - sent, UINT32_MAX)));
+                    sent = 0;
+                }
+            };
+            if (!b->client.connect(opts_.host, opts_.port, b->name) ||
+                !b->client.subscribe({"/boards_command"}, 0)) {
+                std::fprintf(stderr, "%s: %s\n", b->name.c_str(), b->client.error().c_str());
+                return false;
+            }
+            b->client.publish("/boards", b->name, 1);
+            // Płytki zaczynają okna w różnych chwilach, jak po niezależnym starcie
+            b->window_start_us = steady_us() - static_cast<int64_t>(unit(random_()) * period_us());
+        }
+        return true;
+    }
+
+    void run(int64_t end_us) {
+        tokens_ = 0;
+        last_refill_us_ = steady_us();
+        while (!stop_requested.load(std::memory_order_relaxed) && steady_us() < end_us) {
+            int64_t now = steady_us();
+            int64_t next_due = end_us;
+            for (auto &board : boards_) {
+                int64_t window_end = board->window_start_us + static_cast<int64_t>(opts_.window_s * 1e6);
+                if (window_end <= now && now < end_us) {
+                    stats_.max_lag_us.store(std::max(stats_.max_lag_us.load(std::memory_order_relaxed), now - window_end),
+                                            std::memory_order_relaxed);
+                    publish_window(*board, board->window_start_us, window_end);
+                    board->window_start_us += period_us();
+                    window_end += period_us();
+                    // Przy limicie --rate publikacja okna trwa - czas mógł się skończyć
+                    now = steady_us();
+                }
+                next_due = std::min(next_due, window_end);
+            }
+            if (!poll_all()) {
+                return;
+            }
+            int64_t idle_us = std::min<int64_t>(next_due - steady_us(), 1000);
+            if (idle_us > 0) {
+                std::this_thread::sleep_for(std::chrono::microseconds(idle_us));
+            }
+        }
+        // Ostatnie PUBACK przed rozłączeniem
+        int64_t deadline = steady_us() + 1000000;
+        while (steady_us() < deadline) {
+            for (auto &board : boards_) {
+                board->client.poll(1);
+            }
+        }
+        flush_samples();
+        for (auto &board : boards_) {
+            board->client.disconnect();
+        }
+    }
+
+private:
+    int64_t period_us() const { return static_cast<int64_t>((opts_.window_s + opts_.pause_s) * 1e6); }
+
+    // Urządzenia usłyszane przez płytkę w oknie [start, end)
+    void simulate_window(const simulated_board &board, int64_t start_us, int64_t end_us) {
+        heard_.clear();
+        double board_x = layout_.room_x(board.room);
+        double board_y = layout_.room_y(board.room);
+        int64_t middle_us = start_us + (end_us - start_us) / 2;
+        double window_ms = static_cast<double>(end_us - start_us) / 1000.0;
+
+        for (device_motion &device : devices_) {
+            double x, y;
+            device.position(layout_, middle_us, x, y);
+            double distance = std::max(std::hypot(x - board_x, y - board_y), 0.5);
+            double mean = RSSI_AT_1M - 10 * PATH_LOSS_EXPONENT * std::log10(distance);
+            if (mean < SENSITIVITY_DBM - 3 * RSSI_NOISE_DB) {
+                continue;
+            }
+            int adverts = static_cast<int>(window_ms / device.advert_interval_ms);
+            int simulated = std::min(adverts, MAX_SIMULATED_ADVERTS);
+            int received = 0;
+            int sum = 0;
+            int rssi_min = 127;
+            int rssi_max = -128;
+            for (int i = 0; i < simulated; i++) {
+                int rssi = static_cast<int>(std::lround(mean + noise_(random_)));
+                if (rssi < SENSITIVITY_DBM || loss_(random_) < ADVERT_LOSS) {
+                    continue;
+                }
+                rssi = std::max(rssi, -127);
+                received++;
+                sum += rssi;
+                rssi_min = std::min(rssi_min, rssi);
+                rssi_max = std::max(rssi_max, rssi);
+            }
+            if (received == 0) {
+                continue;
+            }
+            int scale = std::max(1, adverts / std::max(simulated, 1));
+
+            device_entry_t entry;
+            std::memset(&entry, 0, sizeof(entry));
+            entry.used = true;
+            for (int i = 0; i < SIGHTING_BDA_LEN; i++) {
+                entry.bda[i] = static_cast<uint8_t>(device.address >> (8 * (SIGHTING_BDA_LEN - 1 - i)));
+            }
+            std::memcpy(entry.name, device.name, sizeof(entry.name));
+            entry.first_seen_us = start_us + static_cast<int64_t>(unit(random_()) * device.advert_interval_ms * 1000);
+            entry.last_seen_us = end_us - static_cast<int64_t>(unit(random_()) * device.advert_interval_ms * 1000);
+            entry.count = static_cast<uint32_t>(received * scale);
+            entry.rssi_min = static_cast<int8_t>(rssi_min);
+            entry.rssi_max = static_cast<int8_t>(rssi_max);
+            entry.rssi_sum = sum * scale;
+            rssi_filter_seed(&entry.rssi_filter, static_cast<int8_t>(sum / received));
+            heard_.push_back(entry);
+        }
+    }
+
+    void publish_window(simulated_board &board, int64_t start_us, int64_t end_us) {
+        simulate_window(board, start_us, end_us);
+        char buffer[BATCH_BUFFER_SIZE];
+
+        if (opts_.format == "device") {
+            for (const device_entry_t &entry : heard_) {
+                size_t length = sighting_format_device_json(&entry, buffer, sizeof(buffer));
+                publish(board, std::string_view(buffer, length));
+            }
+        } else {
+            sighting_payload_format_t format = opts_.format == "binary" ? SIGHTING_PAYLOAD_BINARY : SIGHTING_PAYLOAD_JSON;
+            sighting_batch_t batch;
+            sighting_batch_begin(&batch, format, buffer, sizeof(buffer), board.name.c_str(), start_us);
+            for (const device_entry_t &entry : heard_) {
+                if (batch.count >= BATCH_MAX_DEVICES || !sighting_batch_add(&batch, &entry)) {
+                    publish(board, std::string_view(buffer, sighting_batch_finish(&batch)));
+                    sighting_batch_begin(&batch, format, buffer, sizeof(buffer), board.name.c_str(), start_us);
+                    sighting_batch_add(&batch, &entry);
+                }
+            }
+            if (batch.count > 0) {
+                publish(board, std::string_view(buffer, sighting_batch_finish(&batch)));
+            }
+        }
+        board.client.flush();
+    }
+
+    void publish(simulated_board &board, std::string_view payload) {
+        if (opts_.rate > 0) {
+            wait_for_token(board);
+        }
+        int packet_id = board.client.publish(board.devices_topic, payload, opts_.qos);
+        if (packet_id < 0) {
+            stats_.errors.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+        if (packet_id > 0 && packet_id % ACK_SAMPLE_EVERY == 0) {
+            board.sent_us[packet_id / ACK_SAMPLE_EVERY] = steady_us();
+        }
+        stats_.messages.fetch_add(1, std::memory_order_relaxed);
+        stats_.bytes.fetch_add(payload.size(), std::memory_order_relaxed);
+    }
+
+    // Kubełek żetonów: --rate dzielone równo między wątki, zapas najwyżej na 10 ms
+    bool poll_all() {
+        for (auto &board : boards_) {
+            if (board->client.connected() && !board->client.poll(0)) {
+                stats_.errors.fetch_add(1, std::memory_order_relaxed);
+                std::fprintf(stderr, "%s: %s\n", board->name.c_str(), board->client.error().c_str());
+                return false;
+            }
+        }
+        flush_samples();
+        return true;
+    }
+
+    void wait_for_token(simulated_board &board) {
+        double rate = opts_.rate / static_cast<double>(opts_.threads);
+        for (;;) {
+            int64_t now = steady_us();
+            tokens_ = std::min(tokens_ + (now - last_refill_us_) * rate / 1e6, std::max(1.0, rate / 100));
+            last_refill_us_ = now;
+            if (tokens_ >= 1) {
+                tokens_ -= 1;
+                return;
+            }
+            // Czekające publikacje wychodzą od razu, a PUBACK są odbierane w trakcie
+            // czekania, żeby zmierzony czas nie obejmował limitu
+            board.client.flush();
+            poll_all();
+            std::this_thread::sleep_for(std::chrono::microseconds(static_cast<int64_t>((1 - tokens_) * 1e6 / rate)));
+        }
+    }
+
+    void flush_samples() {
+        if (ack_samples_.empty()) {
+            return;
+        }
+        std::lock_guard<std::mutex> lock(stats_.latency_mutex);
+        stats_.ack_latency_us.insert(stats_.ack_latency_us.end(), ack_samples_.begin(), ack_samples_.end());
+        ack_samples_.clear();
+    }
+
+    const options &opts_;
+    const building &layout_;
+    thread_stats &stats_;
+    std::mt19937_64 random_;
+    std::normal_distribution<double> noise_{0.0, RSSI_NOISE_DB};
+    std::uniform_real_distribution<double> loss_{0.0, 1.0};
+    std::vector<device_motion> devices_;
+    std::vector<std::unique_ptr<simulated_board>> boards_;
+    std::vector<device_entry_t> heard_;
+    std::vector<uint32_t> ack_samples_;
+    double tokens_ = 0;
+    int64_t last_refill_us_ = 0;
+};
+
+double percentile_ms(std::vector<uint32_t> &samples, double fraction) {
+    if (samples.empty()) {
+        return 0;
+    }
+    size_t index = std::min(samples.size() - 1, static_cast<size_t>(fraction * samples.size()));
+    std::nth_element(samples.begin(), samples.begin() + static_cast<std::ptrdiff_t>(index), samples.end());
+    return samples[index] / 1000.0;
+}
+
+int usage(const char *program) {
+    std::fprintf(stderr,
+                 "Usage: %s [--broker host[:port]] [--boards N] [--devices N] [--threads N]\n"
+                 "          [--window S] [--pause S] [--format device|batch|binary] [--qos 0|1]\n"
+                 "          [--rate MSG_PER_S] [--duration S] [--spacing M] [--seed N] [--prefix NAME]\n",
+                 program);
+    return 2;
+}
+
+bool parse_options(int argc, char **argv, options &opts) {
+    for (int i = 1; i < argc; i += 2) {
+        if (i + 1 >= argc) {
+            return false;
+        }
+        std::string option = argv[i];
+        std::string value = argv[i + 1];
+        if (option == "--broker") {
+            size_t colon = value.rfind(':');
+            opts.host = value.substr(0, colon);
+            if (colon != std::string::npos) {
+                opts.port = static_cast<uint16_t>(std::strtoul(value.c_str() + colon + 1, nullptr, 10));
+            }
+        } else if (option == "--boards") {
+            opts.boards = std::strtoul(value.c_str(), nullptr, 10);
+        } else if (option == "--devices") {
+            opts.devices = std::strtoul(value.c_str(), nullptr, 10);
+        } else if (option == "--threads") {
+            opts.threads = std::max<size_t>(1, std::strtoul(value.c_str(), nullptr, 10));
+        } else if (option == "--window") {
+            opts.window_s = std::strtod(value.c_str(), nullptr);
+        } else if (option == "--pause") {
+            opts.pause_s = std::strtod(value.c_str(), nullptr);
+        } else if (option == "--format") {
+            opts.format = value;
+        } else if (option == "--qos") {
+            opts.qos = static_cast<uint8_t>(std::atoi(value.c_str()) > 0);
+        } else if (option == "--rate") {
+            opts.rate = std::strtod(value.c_str(), nullptr);
+        } else if (option == "--duration") {
+            opts.duration_s = std::strtod(value.c_str(), nullptr);
+        } else if (option == "--spacing") {
+            opts.spacing_m = std::strtod(value.c_str(), nullptr);
+        } else if (option == "--seed") {
+            opts.seed = std::strtoull(value.c_str(), nullptr, 10);
+        } else if (option == "--prefix") {
+            opts.prefix = value;
+        } else {
+            std::fprintf(stderr, "Unknown option %s\n", option.c_str());
+            return false;
+        }
+    }
+    return opts.boards > 0 && opts.window_s > 0 && opts.pause_s >= 0 && opts.spacing_m > 0 &&
+           (opts.format == "device" || opts.format == "batch" || opts.format == "binary");
+}
+
+}  // namespace
+
+int main(int argc, char **argv) {
+    options opts;
+    if (!parse_options(argc, argv, opts)) {
+        return usage(argv[0]);
+    }
+    opts.threads = std::min(opts.threads, opts.boards);
+    std::signal(SIGINT, [](int) { stop_requested = true; });
+
+    // Płytki z czasem zsynchronizowanym - znaczniki w wiadomościach to czas UNIX
+    time_sync_set(wall_clock_us(), steady_us());
+
+    building layout;
+    layout.rooms = opts.boards;
+    layout.columns = static_cast<size_t>(std::ceil(std::sqrt(static_cast<double>(opts.boards))));
+    layout.spacing_m = opts.spacing_m;
+    layout.origin_us = steady_us();
+
+    std::vector<std::unique_ptr<thread_stats>> stats;
+    std::vector<std::unique_ptr<board_thread>> workers;
+    for (size_t t = 0; t < opts.threads; t++) {
+        stats.push_back(std::make_unique<thread_stats>());
+        workers.push_back(std::make_unique<board_thread>(opts, layout, *stats.back(), t));
+    }
+    for (size_t room = 0; room < opts.boards; room++) {
+        workers[room % opts.threads]->add_board(room);
+    }
+    for (auto &worker : workers) {
+        if (!worker->connect_all()) {
+            return 1;
+        }
+    }
+    std::printf("%zu boards, %zu devices, %zu threads, %s QoS %u, window %.1f s + pause %.1f s\n", opts.boards,
+                opts.devices, opts.threads, opts.format.c_str(), opts.qos, opts.window_s, opts.pause_s);
+
+    // Klient próbkujący: wiadomość do samego siebie przez brokera
+    mqtt_lite::client probe;
+    std::vector<uint32_t> probe_rtt_us;
+    probe.on_message = [&](std::string_view, std::string_view payload) {
+        int64_t sent = std::strtoll(std::string(payload).c_str(), nullptr, 10);
+        probe_rtt_us.push_back(static_cast<uint32_t>(std::min<int64_t>(steady_us() - sent, UINT32_MAX)));
+    };
+    if (!probe.connect(opts.host, opts.port, opts.prefix + "_probe") || !probe.subscribe({PROBE_TOPIC}, 0)) {
+        std::fprintf(stderr, "probe: %s\n", probe.error().c_str());
+        return 1;
+    }
+
+    int64_t start_us = steady_us();
+    int64_t end_us = start_us + static_cast<int64_t>(opts.duration_s * 1e6);
+    std::vector<std::thread> threads;
+    for (auto &worker : workers) {
+        threads.emplace_back([&worker, end_us] { worker->run(end_us); });
+    }
+
+    uint64_t total_messages = 0;
+    uint64_t total_bytes = 0;
+    uint64_t last_messages = 0;
+    uint64_t last_bytes = 0;
+    std::vector<uint32_t> all_ack_latency;
+    std::vector<uint32_t> all_probe_rtt;
+    int64_t next_probe_us = start_us;
+    int64_t next_report_us = start_us + 1000000;
+    while (!stop_requested && steady_us() < end_us) {
+        int64_t now = steady_us();
+        if (now >= next_probe_us) {
+            probe.publish(PROBE_TOPIC, std::to_string(now));
+            next_probe_us = now + PROBE_INTERVAL_MS * 1000;
+        }
+        if (!probe.poll(10)) {
+            std::fprintf(stderr, "probe: %s\n", probe.error().c_str());
+            stop_requested = true;
+            break;
+        }
+        if (now < next_report_us) {
+            continue;
+        }
+        next_report_us += 1000000;
+
+        uint64_t messages = 0;
+        uint64_t bytes = 0;
+        int64_t lag_us = 0;
+        std::vector<uint32_t> ack_latency;
+        for (auto &s : stats) {
+            messages += s->messages.load(std::memory_order_relaxed);
+            bytes += s->bytes.load(std::memory_order_relaxed);
+            lag_us = std::max(lag_us, s->max_lag_us.exchange(0, std::memory_order_relaxed));
+            std::lock_guard<std::mutex> lock(s->latency_mutex);
+            ack_latency.insert(ack_latency.end(), s->ack_latency_us.begin(), s->ack_latency_us.end());
+            s->ack_latency_us.clear();
+        }
+        all_ack_latency.insert(all_ack_latency.end(), ack_latency.begin(), ack_latency.end());
+        all_probe_rtt.insert(all_probe_rtt.end(), probe_rtt_us.begin(), probe_rtt_us.end());
+        std::printf("%4.0f s: %8" PRIu64 " msg/s %7.2f MB/s  puback p50 %7.2f p99 %7.2f ms  "
+                    "probe p50 %7.2f p99 %7.2f ms  window lag %.0f ms\n",
+                    (now - start_us) / 1e6, messages - last_messages, (bytes - last_bytes) / 1e6,
+                    percentile_ms(ack_latency, 0.5), percentile_ms(ack_latency, 0.99),
+                    percentile_ms(probe_rtt_us, 0.5), percentile_ms(probe_rtt_us, 0.99), lag_us / 1e3);
+        std::fflush(stdout);
+        probe_rtt_us.clear();
+        last_messages = messages;
+        last_bytes = bytes;
+    }
+    for (std::thread &thread : threads) {
+        thread.join();
+    }
+    probe.disconnect();
+
+    uint64_t acks = 0;
+    uint64_t errors = 0;
+    for (auto &s : stats) {
+        total_messages += s->messages.load();
+        total_bytes += s->bytes.load();
+        acks += s->acks.load();
+        errors += s->errors.load();
+        all_ack_latency.insert(all_ack_latency.end(), s->ack_latency_us.begin(), s->ack_latency_us.end());
+    }
+    double elapsed_s = (std::min(steady_us(), end_us) - start_us) / 1e6;
+    std::printf("total: %" PRIu64 " messages (%.0f msg/s), %.1f MB, %" PRIu64 " PUBACKs, %" PRIu64
+                " errors; puback p50 %.2f p99 %.2f ms, probe p50 %.2f p99 %.2f ms\n",
+                total_messages, total_messages / elapsed_s, total_bytes / 1e6, acks, errors,
+                percentile_ms(all_ack_latency, 0.5), percentile_ms(all_ack_latency, 0.99),
+                percentile_ms(all_probe_rtt, 0.5), percentile_ms(all_probe_rtt, 0.99));
+    return errors == 0 && (opts.qos == 0 || acks > 0 || total_messages == 0) ? 0 : 1;
+}
@@ -0,0 +1,130 @@
+#!/usr/bin/env python3
+"""End-to-end latency check of boards against a broker and an NTP server.
+
+Subscribes (through mosquitto_sub) to the JSON sighting topics of all boards
+and compares the timestamp_us of every device with the arrival time on this
+machine, which should be synchronized with the same NTP server as the boards
+(CONFIG_TIME_SYNC_SERVER). The capture->receive latency is reported per board
+together with the board's own capture->publish->PUBACK histograms taken from
+/<board_name>/stats.
+
+    latency_check.py [--host localhost] [--port 1883] [--seconds 60]
+
+Exits with 1 when no timestamped sighting was received or a board published
+timestamps that are not UNIX time (no SNTP synchronization).
+"""
+
+import argparse
+import json
+import subprocess
+import sys
+import threading
+import time
+from collections import defaultdict
+
+TOPICS = ["/+/devices", "/+/devices/replay", "/+/presence", "/+/stats"]
+STATS_HISTOGRAMS = ["capture_to_publish_ms", "publish_to_ack_ms", "capture_to_ack_ms"]
+
+# Znaczniki mniejsze niż rok 2001 w mikrosekundach to czas od startu płytki
+EPOCH_MIN_US = 978307200 * 1000000
+
+
+def device_timestamps(payload):
+    if "devices" in payload:
+        return [device.get("timestamp_us") for device in payload["devices"]]
+    return [payload.get("timestamp_us")]
+
+
+def percentile(values, p):
+    ordered = sorted(values)
+    return ordered[min(len(ordered) - 1, int(p * (len(ordered) - 1) + 0.5))]
+
+
+def histogram_line(buckets):
+    # Koszyk i obejmuje [2^(i-1), 2^i) ms (main/perf_counters.h)
+    parts = []
+    for i, count in enumerate(buckets):
+        if count:
+            parts.append("%s:%d" % ("0" if i == 0 else "<%d" % (1 << i), count))
+    return " ".join(parts) or "empty"
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.strip().splitlines()[0])
+    parser.add_argument("--host", default="localhost")
+    parser.add_argument("--port", type=int, default=1883)
+    parser.add_argument("--seconds", type=float, default=60)
+    args = parser.parse_args()
+
+    command = ["mosquitto_sub", "-h", args.host, "-p", str(args.port), "-v"]
+    for topic in TOPICS:
+        command += ["-t", topic]
+    process = subprocess.Popen(command, stdout=subprocess.PIPE, text=True, errors="replace")
+
+    latencies = defaultdict(list)  # board -> ms
+    unsynced = defaultdict(int)
+    replayed = defaultdict(int)
+    stats = {}
+    # Odczyt blokuje do następnej wiadomości - zakończenie mosquitto_sub kończy pętlę
+    timer = threading.Timer(args.seconds, process.terminate)
+    timer.start()
+    try:
+        for line in process.stdout:
+            received_us = time.time() * 1e6
+            topic, _, body = line.rstrip("\n").partition(" ")
+            board = topic.split("/")[1]
+            try:
+                payload = json.loads(body)
+            except ValueError:
+                continue
+
+            if topic.endswith("/stats"):
+                stats[board] = payload
+            else:
+                for timestamp_us in device_timestamps(payload):
+                    if timestamp_us is None:
+                        continue
+                    if timestamp_us < EPOCH_MIN_US:
+                        unsynced[board] += 1
+                    elif topic.endswith("/replay"):
+                        replayed[board] += 1
+                    else:
+                        latencies[board].append((received_us - timestamp_us) / 1000)
+    except KeyboardInterrupt:
+        pass
+    finally:
+        timer.cancel()
+        process.terminate()
+
+    boards = sorted(set(latencies) | set(unsynced) | set(stats))
+    for board in boards:
+        values = latencies.get(board, [])
+        print(board)
+        if values:
+            print("  capture->receive: %d sightings, p50 %.0f ms, p90 %.0f ms, p99 %.0f ms, min %.0f ms"
+                  % (len(values), percentile(values, 0.5), percentile(values, 0.9),
+                     percentile(values, 0.99), min(values)))
+        if replayed.get(board):
+            print("  replayed from the flash log: %d sightings (not counted)" % replayed[board])
+        if unsynced.get(board):
+            print("  NOT SYNCHRONIZED: %d sightings with boot-relative timestamps" % unsynced[board])
+        board_stats = stats.get(board)
+        if board_stats:
+            for name in STATS_HISTOGRAMS:
+                if name in board_stats:
+                    print("  %-22s %s" % (name + ":", histogram_line(board_stats[name])))
+
+    # Ujemne opóźnienie oznacza rozjazd zegarów płytki i tej maszyny
+    for board, values in latencies.items():
+        if values and min(values) < -50:
+            print("warning: %s timestamps are %.0f ms ahead of this machine" % (board, -min(values)),
+                  file=sys.stderr)
+
+    if not any(latencies.values()):
+        print("No timestamped sightings received", file=sys.stderr)
+        return 1
+    return 1 if unsynced else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
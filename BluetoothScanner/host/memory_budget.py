@@ -0,0 +1,172 @@
+#!/usr/bin/env python3
+"""Memory budget report of the application component from the linker map.
+
+Run after every firmware build (see the top-level CMakeLists.txt); the report
+is written to memory_budget.txt in the build directory:
+
+    memory_budget.py --sdkconfig sdkconfig [--output report.txt] build/app-template.map
+
+Static RAM (.data/.bss input sections) of main/ is listed per module and per
+object, task stacks separately. Heap allocations made by the application at
+boot are derived from sdkconfig: with CONFIG_STATIC_ALLOCATION there are none.
+"""
+
+import argparse
+import math
+import re
+import sys
+from collections import defaultdict
+
+COMPONENT_RE = re.compile(r"libmain\.a\(([^)]+)\.obj\)")
+SECTION_RE = re.compile(r"^ (\.(?:s?bss|data|dram1)(?:\.(\S+))?|COMMON)(?:\s+(0x[0-9a-f]+)\s+(0x[0-9a-f]+)\s+(\S+))?\s*$")
+CONTINUATION_RE = re.compile(r"^\s+(0x[0-9a-f]+)\s+(0x[0-9a-f]+)\s+(\S+)\s*$")
+OUTPUT_SECTION_RE = re.compile(r"^(\.dram0\.(?:data|bss))\s+(0x[0-9a-f]+)\s+(0x[0-9a-f]+)")
+
+TASK_STACK_PREFIX = "task_stack_"
+STACK_OPTION_RE = re.compile(r"^CONFIG_TASK_(\w+)_STACK_SIZE=(\d+)$")
+
+
+def read_sdkconfig(path):
+    config = {}
+    with open(path) as source:
+        for line in source:
+            line = line.strip()
+            if line.startswith("CONFIG_") and "=" in line:
+                key, value = line.split("=", 1)
+                config[key] = value.strip('"')
+    return config
+
+
+def parse_map(lines):
+    objects = []  # (module, symbol, size)
+    output_sections = {}
+    in_memory_map = False
+    pending = None
+
+    for line in lines:
+        if not in_memory_map:
+            # Sekcje odrzucone przez --gc-sections są wypisane przed mapą pamięci
+            in_memory_map = line.startswith("Linker script and memory map")
+            continue
+
+        match = OUTPUT_SECTION_RE.match(line)
+        if match:
+            output_sections[match.group(1)] = int(match.group(3), 16)
+            continue
+
+        if pending is not None:
+            match = CONTINUATION_RE.match(line)
+            pending_name, pending = pending, None
+            if match:
+                add_object(objects, pending_name, int(match.group(2), 16), match.group(3))
+            continue
+
+        match = SECTION_RE.match(line)
+        if not match:
+            continue
+        name = match.group(2) or match.group(1)
+        if match.group(3) is None:
+            # Długa nazwa sekcji - adres, rozmiar i plik są w następnej linii
+            pending = name
+        else:
+            add_object(objects, name, int(match.group(4), 16), match.group(5))
+
+    return objects, output_sections
+
+
+def add_object(objects, name, size, source):
+    match = COMPONENT_RE.search(source)
+    if not match or size == 0:
+        return
+    # Zmienne statyczne w funkcjach mają przyrostek .N
+    symbol = re.sub(r"\.\d+$", "", name)
+    objects.append((match.group(1), symbol, size))
+
+
+def tag_filter_bytes(config):
+    capacity = int(config.get("CONFIG_TAG_ALLOWLIST_CAPACITY", 0))
+    ppm = int(config.get("CONFIG_TAG_ALLOWLIST_FP_RATE_PPM", 0))
+    if capacity == 0 or ppm == 0:
+        return 0
+    bits = math.ceil(-capacity * math.log(ppm / 1e6) / math.log(2) ** 2)
+    return (bits + 31) // 32 * 4
+
+
+def report(objects, output_sections, config, out):
+    static = config.get("CONFIG_STATIC_ALLOCATION") == "y"
+    total = sum(size for _, _, size in objects)
+
+    out.write("Memory budget of the main component (%s allocation)\n\n"
+              % ("static" if static else "dynamic"))
+
+    stacks = [(symbol, size) for _, symbol, size in objects if symbol.startswith(TASK_STACK_PREFIX)]
+    configured = {}
+    for key, value in config.items():
+        match = STACK_OPTION_RE.match("%s=%s" % (key, value))
+        if match:
+            configured[match.group(1)] = int(match.group(2))
+
+    out.write("Task stacks%s\n" % (" (static)" if static else " (heap, from sdkconfig)"))
+    if static:
+        for symbol, size in sorted(stacks):
+            out.write("  %-32s %8d\n" % (symbol[len(TASK_STACK_PREFIX):].lower() + "_task", size))
+        stack_total = sum(size for _, size in stacks)
+    else:
+        for option, size in sorted(configured.items()):
+            out.write("  %-32s %8d\n" % (option.lower() + "_task", size))
+        stack_total = sum(configured.values())
+    out.write("  %-32s %8d\n\n" % ("total", stack_total))
+
+    modules = defaultdict(int)
+    for module, _, size in objects:
+        modules[module] += size
+    out.write("Static RAM by module\n")
+    for module, size in sorted(modules.items(), key=lambda item: -item[1]):
+        out.write("  %-32s %8d\n" % (module, size))
+    out.write("  %-32s %8d\n\n" % ("total", total))
+
+    out.write("Largest static objects\n")
+    for module, symbol, size in sorted(objects, key=lambda item: -item[2])[:15]:
+        out.write("  %-32s %8d  %s\n" % (symbol, size, module))
+    out.write("\n")
+
+    heap = []
+    if not static:
+        heap.append(("task stacks", stack_total))
+        if config.get("CONFIG_TAG_ALLOWLIST") == "y":
+            heap.append(("tag allowlist filter", tag_filter_bytes(config)))
+    out.write("Application heap allocations at boot\n")
+    if not heap:
+        out.write("  none\n")
+    for name, size in heap:
+        out.write("  %-32s %8d\n" % (name, size))
+    out.write("\n")
+
+    if output_sections:
+        out.write("Image DRAM (all components)\n")
+        for name, size in sorted(output_sections.items()):
+            out.write("  %-32s %8d\n" % (name, size))
+        out.write("  %-32s %8d\n" % ("main component share", total))
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.strip().splitlines()[0])
+    parser.add_argument("map")
+    parser.add_argument("--sdkconfig", required=True)
+    parser.add_argument("--output")
+    args = parser.parse_args()
+
+    config = read_sdkconfig(args.sdkconfig)
+    with open(args.map, errors="replace") as source:
+        objects, output_sections = parse_map(source)
+
+    if args.output:
+        with open(args.output, "w") as out:
+            report(objects, output_sections, config, out)
+    else:
+        report(objects, output_sections, config, sys.stdout)
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
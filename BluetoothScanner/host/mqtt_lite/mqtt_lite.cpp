@@ -0,0 +1,316 @@
+#include "mqtt_lite.h"
+
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+namespace mqtt_lite {
+
+namespace {
+
+enum packet_type : uint8_t {
+    CONNECT = 1,
+    CONNACK = 2,
+    PUBLISH = 3,
+    PUBACK = 4,
+    SUBSCRIBE = 8,
+    SUBACK = 9,
+    PINGREQ = 12,
+    PINGRESP = 13,
+    DISCONNECT = 14,
+};
+
+constexpr size_t FLUSH_THRESHOLD = 64 * 1024;
+constexpr int HANDSHAKE_TIMEOUT_MS = 5000;
+
+int64_t now_ms() {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+}
+
+}  // namespace
+
+client::~client() {
+    disconnect();
+}
+
+bool client::fail(const std::string &what) {
+    error_ = what;
+    if (fd_ >= 0) {
+        close(fd_);
+        fd_ = -1;
+    }
+    return false;
+}
+
+bool client::connect(const std::string &host, uint16_t port, const std::string &client_id, uint16_t keepalive_s) {
+    disconnect();
+    out_.clear();
+    in_.clear();
+
+    addrinfo hints{};
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    addrinfo *addresses = nullptr;
+    std::string service = std::to_string(port);
+    if (getaddrinfo(host.c_str(), service.c_str(), &hints, &addresses) != 0) {
+        return fail("cannot resolve " + host);
+    }
+    for (addrinfo *address = addresses; address && fd_ < 0; address = address->ai_next) {
+        fd_ = socket(address->ai_family, address->ai_socktype, address->ai_protocol);
+        if (fd_ >= 0 && ::connect(fd_, address->ai_addr, address->ai_addrlen) != 0) {
+            close(fd_);
+            fd_ = -1;
+        }
+    }
+    freeaddrinfo(addresses);
+    if (fd_ < 0) {
+        return fail("cannot connect to " + host + ":" + service);
+    }
+    int one = 1;
+    setsockopt(fd_, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+
+    keepalive_s_ = keepalive_s;
+    begin_packet(CONNECT << 4, 10 + 2 + client_id.size());
+    put_string("MQTT");
+    out_.push_back(4);     // Wersja 3.1.1
+    out_.push_back(0x02);  // Czysta sesja
+    out_.push_back(static_cast<uint8_t>(keepalive_s >> 8));
+    out_.push_back(static_cast<uint8_t>(keepalive_s));
+    put_string(client_id);
+    if (!flush() || !wait_for(CONNACK, HANDSHAKE_TIMEOUT_MS)) {
+        return fail(error_.empty() ? "no CONNACK" : error_);
+    }
+    return true;
+}
+
+bool client::subscribe(const std::vector<std::string> &filters, uint8_t qos) {
+    size_t remaining = 2;
+    for (const std::string &filter : filters) {
+        remaining += 2 + filter.size() + 1;
+    }
+    uint16_t packet_id = next_packet_id_++;
+    if (next_packet_id_ == 0) {
+        next_packet_id_ = 1;
+    }
+    begin_packet(SUBSCRIBE << 4 | 0x02, remaining);
+    out_.push_back(static_cast<uint8_t>(packet_id >> 8));
+    out_.push_back(static_cast<uint8_t>(packet_id));
+    for (const std::string &filter : filters) {
+        put_string(filter);
+        out_.push_back(qos);
+    }
+    return flush() && wait_for(SUBACK, HANDSHAKE_TIMEOUT_MS);
+}
+
+int client::publish(std::string_view topic, std::string_view payload, uint8_t qos, bool retain) {
+    if (fd_ < 0) {
+        return -1;
+    }
+    uint16_t packet_id = 0;
+    size_t remaining = 2 + topic.size() + payload.size();
+    if (qos > 0) {
+        qos = 1;
+        packet_id = next_packet_id_++;
+        if (next_packet_id_ == 0) {
+            next_packet_id_ = 1;
+        }
+        remaining += 2;
+    }
+    begin_packet(static_cast<uint8_t>(PUBLISH << 4 | qos << 1 | (retain ? 1 : 0)), remaining);
+    put_string(topic);
+    if (qos > 0) {
+        out_.push_back(static_cast<uint8_t>(packet_id >> 8));
+        out_.push_back(static_cast<uint8_t>(packet_id));
+    }
+    out_.insert(out_.end(), payload.begin(), payload.end());
+    if (out_.size() >= FLUSH_THRESHOLD && !flush()) {
+        return -1;
+    }
+    return packet_id;
+}
+
+bool client::flush() {
+    if (out_.empty()) {
+        return fd_ >= 0;
+    }
+    bool ok = send_all(out_.data(), out_.size());
+    out_.clear();
+    return ok;
+}
+
+bool client::poll(int timeout_ms) {
+    if (!flush()) {
+        return false;
+    }
+    if (keepalive_s_ > 0 && now_ms() - last_send_ms_ >= keepalive_s_ * 500) {
+        uint8_t ping[] = {PINGREQ << 4, 0};
+        if (!send_all(ping, sizeof(ping))) {
+            return false;
+        }
+    }
+    // PUBACK dla odebranych wiadomości QoS 1 wychodzi od razu
+    return read_available(timeout_ms) && handle_packets() && flush();
+}
+
+void client::disconnect() {
+    if (fd_ >= 0) {
+        flush();
+        uint8_t packet[] = {DISCONNECT << 4, 0};
+        send_all(packet, sizeof(packet));
+        close(fd_);
+        fd_ = -1;
+    }
+}
+
+bool client::send_all(const uint8_t *data, size_t length) {
+    if (fd_ < 0) {
+        return false;
+    }
+    while (length > 0) {
+        ssize_t sent = send(fd_, data, length, MSG_NOSIGNAL);
+        if (sent <= 0) {
+            return fail(std::string("send: ") + strerror(errno));
+        }
+        data += sent;
+        length -= static_cast<size_t>(sent);
+    }
+    last_send_ms_ = now_ms();
+    return true;
+}
+
+void client::begin_packet(uint8_t header, size_t remaining) {
+    out_.push_back(header);
+    // Długość pozostałej części: 7 bitów na bajt, najstarszy bit oznacza kontynuację
+    do {
+        uint8_t byte = remaining % 128;
+        remaining /= 128;
+        out_.push_back(remaining > 0 ? byte | 0x80 : byte);
+    } while (remaining > 0);
+}
+
+void client::put_string(std::string_view value) {
+    out_.push_back(static_cast<uint8_t>(value.size() >> 8));
+    out_.push_back(static_cast<uint8_t>(value.size()));
+    out_.insert(out_.end(), value.begin(), value.end());
+}
+
+bool client::read_available(int timeout_ms) {
+    if (fd_ < 0) {
+        return false;
+    }
+    pollfd descriptor{fd_, POLLIN, 0};
+    int ready = ::poll(&descriptor, 1, timeout_ms);
+    if (ready < 0) {
+        return errno == EINTR || fail(std::string("poll: ") + strerror(errno));
+    }
+    if (ready == 0) {
+        return true;
+    }
+
+    // Czyta wszystko, co jest dostępne, bez ponownego blokowania
+    uint8_t chunk[64 * 1024];
+    for (;;) {
+        ssize_t received = recv(fd_, chunk, sizeof(chunk), MSG_DONTWAIT);
+        if (received > 0) {
+            in_.insert(in_.end(), chunk, chunk + received);
+            if (static_cast<size_t>(received) < sizeof(chunk)) {
+                return true;
+            }
+            continue;
+        }
+        if (received == 0) {
+            return fail("connection closed by broker");
+        }
+        if (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR) {
+            return true;
+        }
+        return fail(std::string("recv: ") + strerror(errno));
+    }
+}
+
+bool client::handle_packets() {
+    size_t offset = 0;
+    while (offset < in_.size()) {
+        size_t remaining = 0;
+        size_t length_bytes = 0;
+        bool complete_length = false;
+        for (size_t i = offset + 1; i < in_.size() && length_bytes < 4; i++) {
+            remaining |= static_cast<size_t>(in_[i] & 0x7F) << (7 * length_bytes);
+            length_bytes++;
+            if ((in_[i] & 0x80) == 0) {
+                complete_length = true;
+                break;
+            }
+        }
+        if (!complete_length) {
+            if (length_bytes >= 4) {
+                return fail("malformed packet length");
+            }
+            break;
+        }
+        size_t body = offset + 1 + length_bytes;
+        if (in_.size() - body < remaining) {
+            break;
+        }
+
+        uint8_t header = in_[offset];
+        const uint8_t *data = in_.data() + body;
+        uint8_t type = header >> 4;
+        seen_types_ |= 1u << type;
+
+        if (type == PUBLISH && remaining >= 2) {
+            size_t topic_len = static_cast<size_t>(data[0]) << 8 | data[1];
+            uint8_t qos = (header >> 1) & 0x03;
+            size_t payload_start = 2 + topic_len + (qos > 0 ? 2 : 0);
+            if (payload_start > remaining) {
+                return fail("malformed PUBLISH");
+            }
+            if (qos > 0) {
+                uint8_t ack[] = {PUBACK << 4, 2, data[2 + topic_len], data[3 + topic_len]};
+                out_.insert(out_.end(), ack, ack + sizeof(ack));
+            }
+            if (on_message) {
+                on_message(std::string_view(reinterpret_cast<const char *>(data + 2), topic_len),
+                           std::string_view(reinterpret_cast<const char *>(data + payload_start),
+                                            remaining - payload_start));
+            }
+        } else if (type == PUBACK && remaining >= 2) {
+            if (on_puback) {
+                on_puback(static_cast<uint16_t>(data[0] << 8 | data[1]));
+            }
+        } else if (type == CONNACK && remaining >= 2 && data[1] != 0) {
+            return fail("connection refused, code " + std::to_string(data[1]));
+        }
+        offset = body + remaining;
+    }
+    in_.erase(in_.begin(), in_.begin() + static_cast<std::ptrdiff_t>(offset));
+    return true;
+}
+
+bool client::wait_for(uint8_t packet_type, int timeout_ms) {
+    int64_t deadline = now_ms() + timeout_ms;
+    seen_types_ = 0;
+    while ((seen_types_ & (1u << packet_type)) == 0) {
+        int64_t left = deadline - now_ms();
+        if (left <= 0) {
+            error_ = "timeout";
+            return false;
+        }
+        // Wiadomości odebrane w międzyczasie są przekazywane do on_message
+        if (!read_available(static_cast<int>(left)) || !handle_packets()) {
+            return false;
+        }
+    }
+    return flush();
+}
+
+}  // namespace mqtt_lite
@@ -0,0 +1,72 @@
+#ifndef HOST_MQTT_LITE_H_
+#define HOST_MQTT_LITE_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Minimalny klient MQTT 3.1.1 dla narzędzi w host/ (bez zewnętrznych bibliotek):
+// CONNECT z czystą sesją, SUBSCRIBE, PUBLISH QoS 0/1 w obie strony, PUBACK,
+// PINGREQ. Jeden obiekt na wątek - klient nie ma blokad. Publikacje są
+// buforowane i wysyłane przez flush() albo poll().
+
+namespace mqtt_lite {
+
+class client {
+public:
+    using message_handler = std::function<void(std::string_view topic, std::string_view payload)>;
+    using puback_handler = std::function<void(uint16_t packet_id)>;
+
+    client() = default;
+    ~client();
+    client(const client &) = delete;
+    client &operator=(const client &) = delete;
+
+    // Blokuje do otrzymania CONNACK
+    bool connect(const std::string &host, uint16_t port, const std::string &client_id, uint16_t keepalive_s = 60);
+
+    // Blokuje do otrzymania SUBACK; wiadomości odebrane w międzyczasie trafiają do on_message
+    bool subscribe(const std::vector<std::string> &filters, uint8_t qos);
+
+    // Zwraca identyfikator pakietu (QoS 1) albo 0 (QoS 0); -1 przy błędzie
+    int publish(std::string_view topic, std::string_view payload, uint8_t qos = 0, bool retain = false);
+
+    bool flush();
+
+    // Wysyła zbuforowane publikacje i obsługuje przychodzące pakiety przez maksymalnie timeout_ms.
+    // Zwraca false po utracie połączenia.
+    bool poll(int timeout_ms);
+
+    void disconnect();
+
+    bool connected() const { return fd_ >= 0; }
+    const std::string &error() const { return error_; }
+
+    message_handler on_message;
+    puback_handler on_puback;
+
+private:
+    bool fail(const std::string &what);
+    bool send_all(const uint8_t *data, size_t length);
+    void begin_packet(uint8_t header, size_t remaining);
+    void put_string(std::string_view value);
+    bool read_available(int timeout_ms);
+    bool handle_packets();
+    bool wait_for(uint8_t packet_type, int timeout_ms);
+
+    int fd_ = -1;
+    uint16_t keepalive_s_ = 0;
+    uint16_t next_packet_id_ = 1;
+    int64_t last_send_ms_ = 0;
+    std::vector<uint8_t> out_;
+    std::vector<uint8_t> in_;
+    uint32_t seen_types_ = 0; // Typy pakietów odebrane od początku wait_for
+    std::string error_;
+};
+
+}  // namespace mqtt_lite
+
+#endif
@@ -0,0 +1,334 @@
+// Symulacja wykrywania obecności (main/presence.h) na syntetycznych przebiegach RSSI:
+//
+//   presence_sim [--seed N] [-v]
+//
+// Każdy scenariusz generuje obserwacje jednego urządzenia (co sekundę, z szumem
+// RSSI) przez tablicę urządzeń i automat obecności z domyślnymi progami z
+// Kconfig, a następnie porównuje przejścia z oczekiwanymi. Na koniec scenariusz
+// "crowd" (wiele urządzeń, skanowanie z przerwami) porównuje liczbę wiadomości
+// MQTT trybu obecności z trybem jednej wiadomości na urządzenie i okno, a scenariusz
+// "eviction" sprawdza wyjście obecnego urządzenia wypartego z pełnej tablicy.
+// Kończy się kodem 1, jeśli którykolwiek scenariusz się nie zgadza.
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "device_table.h"
+#include "presence.h"
+#include "sdkconfig.h"
+
+#define SAMPLE_PERIOD_MS 1000
+#define POLL_PERIOD_MS 100
+#define RSSI_NOISE_DB 2
+#define MAX_SEGMENTS 8
+#define MAX_EVENTS 8
+#define SILENT 0 // Brak reklam w odcinku
+
+typedef struct {
+    uint32_t until_s; // Koniec odcinka od początku scenariusza
+    int8_t rssi;      // SILENT - urządzenie niewidoczne
+    int8_t swing;     // Naprzemienne odchylenie kolejnych próbek (+swing, -swing)
+} segment_t;
+
+typedef struct {
+    presence_event_t event;
+    uint32_t from_s;
+    uint32_t to_s;
+} expected_event_t;
+
+typedef struct {
+    const char *name;
+    segment_t segments[MAX_SEGMENTS];
+    expected_event_t expected[MAX_EVENTS];
+    uint32_t expected_count;
+} scenario_t;
+
+typedef struct {
+    presence_event_t event;
+    int64_t at_us;
+} recorded_event_t;
+
+static const scenario_t scenarios[] = {
+    {
+        .name = "walk-in",
+        .segments = {{10, -95, 0}, {70, -70, 0}},
+        .expected = {{PRESENCE_EVENT_ENTER, 12, 15}},
+        .expected_count = 1,
+    },
+    {
+        .name = "short blip",
+        .segments = {{10, -95, 0}, {12, -70, 0}, {60, -95, 0}},
+        .expected_count = 0,
+    },
+    {
+        // Między progami i przez próg wyjścia co drugą próbkę - bez wyjścia
+        .name = "flicker",
+        .segments = {{20, -70, 0}, {80, -85, 3}, {140, -89, 3}},
+        .expected = {{PRESENCE_EVENT_ENTER, 2, 5}},
+        .expected_count = 1,
+    },
+    {
+        .name = "walk-out",
+        .segments = {{30, -70, 0}, {90, -97, 0}},
+        .expected = {{PRESENCE_EVENT_ENTER, 2, 5}, {PRESENCE_EVENT_LEAVE, 39, 42}},
+        .expected_count = 2,
+    },
+    {
+        .name = "vanish",
+        .segments = {{30, -70, 0}, {90, SILENT, 0}},
+        .expected = {{PRESENCE_EVENT_ENTER, 2, 5}, {PRESENCE_EVENT_LEAVE, 58, 61}},
+        .expected_count = 2,
+    },
+    {
+        .name = "come back",
+        .segments = {{20, -70, 0}, {80, SILENT, 0}, {120, -72, 0}},
+        .expected = {{PRESENCE_EVENT_ENTER, 2, 5},
+                     {PRESENCE_EVENT_LEAVE, 48, 51},
+                     {PRESENCE_EVENT_ENTER, 82, 85}},
+        .expected_count = 3,
+    },
+};
+
+static recorded_event_t recorded[64];
+static uint32_t recorded_count = 0;
+static uint32_t transition_count = 0;
+static bool verbose = false;
+static int64_t observe_us = 0; // Czas obserwacji przetwarzanej przez device_table_update
+
+static void on_transition(presence_event_t event, const device_entry_t *entry, int64_t now_us, void *ctx) {
+    if (recorded_count < sizeof(recorded) / sizeof(recorded[0])) {
+        recorded[recorded_count].event = event;
+        recorded[recorded_count].at_us = now_us;
+        recorded_count++;
+    }
+    transition_count++;
+    if (verbose) {
+        printf("    %8.1f s  %s %02x:%02x  rssi %d\n", now_us / 1e6, presence_event_name(event), entry->bda[4],
+               entry->bda[5], entry->presence_rssi);
+    }
+}
+
+// Jak w sighting_publisher.c: wyparcie z tablicy w chwili obserwacji nowego urządzenia
+static void on_evicted(const device_entry_t *entry, void *ctx) {
+    presence_evict(entry, observe_us);
+}
+
+static int noise(void) {
+    return rand() % (2 * RSSI_NOISE_DB + 1) - RSSI_NOISE_DB;
+}
+
+static void init_presence(void) {
+    presence_config_t config = {
+        .enter_rssi = CONFIG_PRESENCE_ENTER_RSSI,
+        .exit_rssi = CONFIG_PRESENCE_EXIT_RSSI,
+        .enter_dwell_ms = CONFIG_PRESENCE_ENTER_DWELL_MS,
+        .exit_dwell_ms = CONFIG_PRESENCE_EXIT_DWELL_MS,
+        .absence_timeout_ms = CONFIG_PRESENCE_ABSENCE_TIMEOUT_MS,
+    };
+    device_table_clear();
+    device_table_set_evict_callback(on_evicted, NULL);
+    presence_init(&config, on_transition, NULL);
+    recorded_count = 0;
+    transition_count = 0;
+}
+
+static void observe(uint32_t device, int rssi, int64_t now_us) {
+    ble_sighting_t sighting = {
+        .kind = SIGHTING_KIND_ADV,
+        .bda = {0x02, 0x00, 0x00, 0x00, (uint8_t)(device >> 8), (uint8_t)device},
+        .rssi = (int8_t)rssi,
+        .timestamp_us = now_us,
+    };
+    observe_us = now_us;
+    presence_update(device_table_update(&sighting), sighting.rssi, now_us);
+}
+
+static bool run_scenario(const scenario_t *scenario) {
+    init_presence();
+
+    uint32_t end_s = 0;
+    for (int i = 0; i < MAX_SEGMENTS && scenario->segments[i].until_s; i++) {
+        end_s = scenario->segments[i].until_s;
+    }
+
+    int segment = 0;
+    uint32_t sample = 0;
+    for (int64_t now_ms = 0; now_ms <= (int64_t)end_s * 1000; now_ms += POLL_PERIOD_MS) {
+        while (now_ms >= (int64_t)scenario->segments[segment].until_s * 1000 && segment + 1 < MAX_SEGMENTS &&
+               scenario->segments[segment + 1].until_s) {
+            segment++;
+        }
+        const segment_t *current = &scenario->segments[segment];
+        if (now_ms % SAMPLE_PERIOD_MS == 0 && current->rssi != SILENT && now_ms < (int64_t)end_s * 1000) {
+            int swing = (sample++ % 2) ? -current->swing : current->swing;
+            observe(1, current->rssi + swing + (current->swing ? 0 : noise()), now_ms * 1000);
+        }
+        presence_poll(now_ms * 1000);
+    }
+
+    bool ok = recorded_count == scenario->expected_count;
+    for (uint32_t i = 0; ok && i < recorded_count; i++) {
+        const expected_event_t *expected = &scenario->expected[i];
+        ok = recorded[i].event == expected->event && recorded[i].at_us >= (int64_t)expected->from_s * 1000000 &&
+             recorded[i].at_us <= (int64_t)expected->to_s * 1000000;
+    }
+
+    printf("%-12s %-4s", scenario->name, ok ? "ok" : "FAIL");
+    for (uint32_t i = 0; i < recorded_count; i++) {
+        printf("  %s@%.1fs", presence_event_name(recorded[i].event), recorded[i].at_us / 1e6);
+    }
+    printf("\n");
+    if (!ok) {
+        printf("             expected:");
+        for (uint32_t i = 0; i < scenario->expected_count; i++) {
+            printf("  %s@%" PRIu32 "-%" PRIu32 "s", presence_event_name(scenario->expected[i].event),
+                   scenario->expected[i].from_s, scenario->expected[i].to_s);
+        }
+        printf("\n");
+    }
+    return ok;
+}
+
+// Obecne urządzenie wypierane z pełnej tablicy przez tłum słabych urządzeń - ze
+// statystykami bieżącego okna albo bez nich (po końcu okna) - wychodzi od razu
+static bool run_eviction(bool window_reset) {
+    init_presence();
+    int64_t now_ms = 0;
+    for (; now_ms < 10000; now_ms += SAMPLE_PERIOD_MS) {
+        observe(1, -70, now_ms * 1000);
+        presence_poll(now_ms * 1000);
+    }
+    if (window_reset) {
+        device_table_reset_window();
+    }
+    uint32_t enters = recorded_count;
+    for (uint32_t device = 2; device <= DEVICE_TABLE_MAX_ENTRIES + 1; device++) {
+        observe(device, -95, now_ms * 1000);
+    }
+    presence_poll(now_ms * 1000);
+
+    uint8_t bda[SIGHTING_BDA_LEN] = {0x02, 0x00, 0x00, 0x00, 0x00, 0x01};
+    presence_stats_t stats;
+    presence_get_stats(&stats);
+    bool ok = enters == 1 && recorded_count == 2 && recorded[1].event == PRESENCE_EVENT_LEAVE &&
+              recorded[1].at_us == now_ms * 1000 && device_table_find(bda) == NULL && stats.present == 0 &&
+              stats.leaves == 1;
+
+    printf("%-12s %-4s", window_reset ? "evict idle" : "evict", ok ? "ok" : "FAIL");
+    for (uint32_t i = 0; i < recorded_count; i++) {
+        printf("  %s@%.1fs", presence_event_name(recorded[i].event), recorded[i].at_us / 1e6);
+    }
+    printf("\n");
+    return ok;
+}
+
+typedef struct {
+    int64_t arrive_s;
+    int64_t leave_s;
+    int8_t rssi;
+} visitor_t;
+
+static void count_window_entry(const device_entry_t *entry, void *ctx) {
+    (*(uint32_t *)ctx)++;
+}
+
+// Wiele urządzeń w skanowaniu z przerwami (CONFIG_SCAN_DURATION_S + CONFIG_SCAN_INTERVAL_S):
+// tryb jednej wiadomości na urządzenie wysyła wpis za każde okno, w którym urządzenie
+// było widziane, tryb obecności - przejścia i heartbeat
+static bool run_crowd(uint32_t minutes) {
+    enum { RESIDENTS = 20, VISITORS = 40, FAR_AWAY = 30 };
+    static visitor_t visitors[VISITORS];
+
+    init_presence();
+    int64_t end_s = (int64_t)minutes * 60;
+    for (int i = 0; i < VISITORS; i++) {
+        visitors[i].arrive_s = rand() % end_s;
+        visitors[i].leave_s = visitors[i].arrive_s + 60 + rand() % 600;
+        visitors[i].rssi = (int8_t)(-60 - rand() % 15);
+    }
+
+    uint32_t window_messages = 0;
+    uint32_t heartbeats = 0;
+    int64_t window_s = CONFIG_SCAN_DURATION_S + CONFIG_SCAN_INTERVAL_S;
+    for (int64_t now_ms = 0; now_ms < end_s * 1000; now_ms += POLL_PERIOD_MS) {
+        int64_t now_us = now_ms * 1000;
+        bool scanning = now_ms % (window_s * 1000) < CONFIG_SCAN_DURATION_S * 1000;
+
+        if (scanning && now_ms % SAMPLE_PERIOD_MS == 0) {
+            int64_t now_s = now_ms / 1000;
+            for (uint32_t i = 0; i < RESIDENTS; i++) {
+                observe(i, -65 + noise(), now_us);
+            }
+            for (uint32_t i = 0; i < VISITORS; i++) {
+                if (now_s >= visitors[i].arrive_s && now_s < visitors[i].leave_s) {
+                    observe(RESIDENTS + i, visitors[i].rssi + noise(), now_us);
+                }
+            }
+            // Urządzenia za ścianą - widoczne, ale nigdy obecne
+            for (uint32_t i = 0; i < FAR_AWAY; i++) {
+                observe(RESIDENTS + VISITORS + i, -94 + noise(), now_us);
+            }
+        }
+
+        // Koniec okna skanowania
+        if (now_ms % (window_s * 1000) == CONFIG_SCAN_DURATION_S * 1000) {
+            device_table_foreach_in_window(count_window_entry, &window_messages);
+            device_table_reset_window();
+        }
+        if (CONFIG_PRESENCE_HEARTBEAT_INTERVAL_S > 0 && now_ms % (CONFIG_PRESENCE_HEARTBEAT_INTERVAL_S * 1000) == 0) {
+            heartbeats++;
+        }
+        presence_poll(now_us);
+    }
+
+    presence_stats_t stats;
+    presence_get_stats(&stats);
+    uint32_t presence_messages = transition_count + heartbeats;
+    printf("\ncrowd, %" PRIu32 " min: %d residents, %d visitors, %d devices out of range\n", minutes, RESIDENTS,
+           VISITORS, FAR_AWAY);
+    printf("  per-device mode: %7" PRIu32 " messages (%.1f/min)\n", window_messages,
+           (double)window_messages / minutes);
+    printf("  presence mode:   %7" PRIu32 " messages (%.1f/min): %" PRIu32 " enters, %" PRIu32 " leaves, %" PRIu32
+           " heartbeats\n",
+           presence_messages, (double)presence_messages / minutes, stats.enters, stats.leaves, heartbeats);
+
+    // Każdy mieszkaniec wchodzi raz, każdy gość wchodzi i (jeśli wyszedł przed końcem) wychodzi raz
+    uint32_t expected_leaves = 0;
+    for (int i = 0; i < VISITORS; i++) {
+        expected_leaves += visitors[i].leave_s + CONFIG_PRESENCE_ABSENCE_TIMEOUT_MS / 1000 + window_s < end_s;
+    }
+    bool ok = stats.enters == RESIDENTS + VISITORS && stats.leaves >= expected_leaves &&
+              stats.leaves <= VISITORS && presence_messages * 10 < window_messages;
+    printf("  %s\n", ok ? "ok" : "FAIL");
+    return ok;
+}
+
+int main(int argc, char **argv) {
+    unsigned seed = 1;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc) {
+            seed = (unsigned)strtoul(argv[++i], NULL, 0);
+        } else if (strcmp(argv[i], "-v") == 0) {
+            verbose = true;
+        } else {
+            fprintf(stderr, "Usage: %s [--seed N] [-v]\n", argv[0]);
+            return 2;
+        }
+    }
+    srand(seed);
+
+    printf("enter %d dBm / %d ms, exit %d dBm / %d ms, absence %d ms\n\n", CONFIG_PRESENCE_ENTER_RSSI,
+           CONFIG_PRESENCE_ENTER_DWELL_MS, CONFIG_PRESENCE_EXIT_RSSI, CONFIG_PRESENCE_EXIT_DWELL_MS,
+           CONFIG_PRESENCE_ABSENCE_TIMEOUT_MS);
+
+    bool ok = true;
+    for (size_t i = 0; i < sizeof(scenarios) / sizeof(scenarios[0]); i++) {
+        ok &= run_scenario(&scenarios[i]);
+    }
+    ok &= run_eviction(false);
+    ok &= run_eviction(true);
+    ok &= run_crowd(30);
+    return ok ? 0 : 1;
+}
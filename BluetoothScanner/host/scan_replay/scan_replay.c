@@ -0,0 +1,318 @@
+// Odtwarza plik przechwycenia zdarzeń skanowania (main/scan_capture.h) przez
+// gap_scan_event_handler z main/ble_scanner.c oraz kolejkę i publisher z main/,
+// a następnie raportuje przepustowość, opóźnienia i alokacje na zdarzenie.
+//
+//   scan_replay [--realtime] [--loops N] [--log] [--legacy] <capture-file>
+//
+// --legacy dostarcza wyniki przez adapter dawnego API (nazwa, adres jako tekst, RSSI),
+// a odbiorca odtwarza z nich rekord do kolejki - porównanie kosztu zdarzenia obu API.
+#define _POSIX_C_SOURCE 200809L
+
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "ble_scanner.h"
+#include "device_table.h"
+#include "latency_probe.h"
+#include "perf_counters.h"
+#include "scan_capture.h"
+#include "scan_replay.h"
+#include "sighting_publisher.h"
+#include "sighting_queue.h"
+
+#define REPLAY_BOARD_NAME "replay"
+
+extern int host_log_enabled;
+
+static int64_t clock_us = 0;
+
+static uint64_t published_messages = 0;
+static uint64_t published_bytes = 0;
+static int next_msg_id = 1;
+
+// Liczniki alokacji z kodu firmware (linkowanego z -Wl,--wrap=malloc,...)
+static uint64_t allocations = 0;
+
+void *__real_malloc(size_t size);
+void *__real_calloc(size_t count, size_t size);
+void *__real_realloc(void *ptr, size_t size);
+
+void *__wrap_malloc(size_t size) {
+    allocations++;
+    return __real_malloc(size);
+}
+
+void *__wrap_calloc(size_t count, size_t size) {
+    allocations++;
+    return __real_calloc(count, size);
+}
+
+void *__wrap_realloc(void *ptr, size_t size) {
+    allocations++;
+    return __real_realloc(ptr, size);
+}
+
+int64_t replay_clock_us(void) {
+    return clock_us;
+}
+
+static uint64_t monotonic_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+}
+
+// Jak mqtt_publish w main.c; PUBACK przychodzi od razu, w czasie odtwarzania
+static bool publish_stub(const char *topic, const char *payload, size_t length, int64_t capture_us) {
+    published_messages++;
+    published_bytes += length;
+    int msg_id = next_msg_id++;
+    latency_probe_sent(msg_id, capture_us, clock_us);
+    latency_probe_acked(msg_id, clock_us);
+    return true;
+}
+
+// Odpowiedniki callbacków z main.c
+static void on_discovery(const ble_scan_result_t *result) {
+    sighting_queue_push(&result->sighting);
+}
+
+// Odbiorca dawnego API musi odtworzyć adres z tekstu, aby agregować po BDA
+static void on_legacy_discovery(const char *name, const char *address, int rssi) {
+    ble_sighting_t sighting = {
+        .timestamp_us = clock_us,
+        .kind = SIGHTING_KIND_ADV,
+        .rssi = (int8_t)rssi,
+    };
+    unsigned int b[SIGHTING_BDA_LEN];
+    if (sscanf(address, "%2x:%2x:%2x:%2x:%2x:%2x", &b[0], &b[1], &b[2], &b[3], &b[4], &b[5]) != SIGHTING_BDA_LEN) {
+        return;
+    }
+    for (int i = 0; i < SIGHTING_BDA_LEN; i++) {
+        sighting.bda[i] = (uint8_t)b[i];
+    }
+    size_t name_len = strlen(name);
+    sighting.name_len = (uint8_t)(name_len < SIGHTING_NAME_MAX_LEN ? name_len : SIGHTING_NAME_MAX_LEN - 1);
+    memcpy(sighting.name, name, sighting.name_len);
+    sighting_queue_push(&sighting);
+}
+
+static void on_window_end(int64_t timestamp_us) {
+    ble_sighting_t marker = {
+        .timestamp_us = timestamp_us,
+        .kind = SIGHTING_KIND_WINDOW_END,
+    };
+    sighting_queue_push(&marker);
+}
+
+static scan_capture_event_t *load_capture(const char *path, size_t *count) {
+    FILE *file = fopen(path, "r");
+    if (!file) {
+        perror(path);
+        return NULL;
+    }
+
+    size_t capacity = 1024;
+    scan_capture_event_t *events = malloc(capacity * sizeof(*events));
+    char line[512];
+    *count = 0;
+
+    while (events && fgets(line, sizeof(line), file)) {
+        if (*count == capacity) {
+            capacity *= 2;
+            events = realloc(events, capacity * sizeof(*events));
+            if (!events) {
+                break;
+            }
+        }
+        if (scan_capture_parse(line, &events[*count])) {
+            (*count)++;
+        }
+    }
+
+    fclose(file);
+    return events;
+}
+
+static void dispatch_event(const scan_capture_event_t *event) {
+    esp_ble_gap_cb_param_t param;
+    memset(&param, 0, sizeof(param));
+
+    if (event->kind == SCAN_CAPTURE_WINDOW_END) {
+        param.scan_rst.search_evt = ESP_GAP_SEARCH_INQ_CMPL_EVT;
+    } else {
+        param.scan_rst.search_evt = ESP_GAP_SEARCH_INQ_RES_EVT;
+        memcpy(param.scan_rst.bda, event->bda, sizeof(event->bda));
+        param.scan_rst.ble_addr_type = (esp_ble_addr_type_t)event->addr_type;
+        param.scan_rst.ble_evt_type = (esp_ble_evt_type_t)event->evt_type;
+        param.scan_rst.rssi = event->rssi;
+        param.scan_rst.adv_data_len = event->adv_len;
+        param.scan_rst.scan_rsp_len = event->scan_rsp_len;
+        memcpy(param.scan_rst.ble_adv, event->data, event->adv_len + event->scan_rsp_len);
+    }
+
+    gap_scan_event_handler(ESP_GAP_BLE_SCAN_RESULT_EVT, &param);
+}
+
+static void drain_queue(void) {
+    ble_sighting_t sighting;
+    while (sighting_queue_pop(&sighting)) {
+        sighting_publisher_handle(&sighting);
+    }
+    sighting_publisher_poll(clock_us);
+}
+
+static void sleep_until(uint64_t deadline_ns) {
+    uint64_t now = monotonic_ns();
+    if (deadline_ns > now) {
+        struct timespec ts = {
+            .tv_sec = (time_t)((deadline_ns - now) / 1000000000u),
+            .tv_nsec = (long)((deadline_ns - now) % 1000000000u),
+        };
+        nanosleep(&ts, NULL);
+    }
+}
+
+static int compare_u32(const void *a, const void *b) {
+    uint32_t x = *(const uint32_t *)a, y = *(const uint32_t *)b;
+    return (x > y) - (x < y);
+}
+
+static uint32_t percentile(const uint32_t *sorted, size_t count, double p) {
+    size_t index = (size_t)(p * (double)(count - 1) + 0.5);
+    return sorted[index];
+}
+
+// Górna granica koszyka histogramu (perf_counters.h), w którym wypada percentyl p
+static uint32_t histogram_percentile(const uint32_t *buckets, double p) {
+    uint64_t total = 0;
+    for (int i = 0; i < PERF_HISTOGRAM_BUCKETS; i++) {
+        total += buckets[i];
+    }
+    uint64_t seen = 0;
+    for (int i = 0; i < PERF_HISTOGRAM_BUCKETS; i++) {
+        seen += buckets[i];
+        if (total > 0 && (double)seen >= p * (double)total) {
+            return i == 0 ? 0 : 1u << i;
+        }
+    }
+    return 1u << (PERF_HISTOGRAM_BUCKETS - 1);
+}
+
+static void usage(const char *program) {
+    fprintf(stderr, "Usage: %s [--realtime] [--loops N] [--log] [--legacy] <capture-file>\n", program);
+}
+
+int main(int argc, char **argv) {
+    bool realtime = false;
+    bool legacy = false;
+    int loops = 1;
+    const char *path = NULL;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--realtime") == 0) {
+            realtime = true;
+        } else if (strcmp(argv[i], "--loops") == 0 && i + 1 < argc) {
+            loops = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--log") == 0) {
+            host_log_enabled = 1;
+        } else if (strcmp(argv[i], "--legacy") == 0) {
+            legacy = true;
+        } else if (argv[i][0] != '-' && !path) {
+            path = argv[i];
+        } else {
+            usage(argv[0]);
+            return 2;
+        }
+    }
+    if (!path || loops < 1) {
+        usage(argv[0]);
+        return 2;
+    }
+
+    size_t event_count = 0;
+    scan_capture_event_t *events = load_capture(path, &event_count);
+    if (!events || event_count == 0) {
+        fprintf(stderr, "No scan events in %s\n", path);
+        return 1;
+    }
+
+    size_t total = event_count * (size_t)loops;
+    uint32_t *latencies = malloc(total * sizeof(*latencies));
+    if (!latencies) {
+        fprintf(stderr, "Out of memory\n");
+        return 1;
+    }
+
+    if (legacy) {
+        ble_scanner_set_legacy_callback(on_legacy_discovery);
+        initialize_ble_scanner(ble_scanner_legacy_adapter, on_window_end);
+    } else {
+        initialize_ble_scanner(on_discovery, on_window_end);
+    }
+    sighting_publisher_init(REPLAY_BOARD_NAME, 1, publish_stub);
+    sighting_publisher_set_connected(true);
+
+    int64_t first_us = events[0].timestamp_us;
+    int64_t span_us = events[event_count - 1].timestamp_us - first_us + 1;
+    uint64_t adv_events = 0;
+    allocations = 0;
+
+    uint64_t start_ns = monotonic_ns();
+    size_t processed = 0;
+    for (int loop = 0; loop < loops; loop++) {
+        for (size_t i = 0; i < event_count; i++) {
+            int64_t offset_us = events[i].timestamp_us - first_us + (int64_t)loop * span_us;
+            if (realtime) {
+                sleep_until(start_ns + (uint64_t)offset_us * 1000u);
+            }
+            clock_us = first_us + offset_us;
+
+            uint64_t event_start = monotonic_ns();
+            dispatch_event(&events[i]);
+            drain_queue();
+            uint64_t event_ns = monotonic_ns() - event_start;
+
+            latencies[processed++] = event_ns > UINT32_MAX ? UINT32_MAX : (uint32_t)event_ns;
+            if (events[i].kind == SCAN_CAPTURE_ADV) {
+                adv_events++;
+            }
+        }
+    }
+    double elapsed_s = (double)(monotonic_ns() - start_ns) / 1e9;
+
+    qsort(latencies, processed, sizeof(*latencies), compare_u32);
+
+    sighting_queue_stats_t queue_stats;
+    sighting_queue_get_stats(&queue_stats);
+
+    printf("callback API:      %s\n", legacy ? "legacy (name, address string, rssi)" : "ble_scan_result_t");
+    printf("events:            %zu (%" PRIu64 " advertisements)\n", processed, adv_events);
+    printf("elapsed:           %.3f s\n", elapsed_s);
+    printf("throughput:        %.0f adv/s\n", (double)adv_events / elapsed_s);
+    printf("latency p50:       %" PRIu32 " ns\n", percentile(latencies, processed, 0.50));
+    printf("latency p90:       %" PRIu32 " ns\n", percentile(latencies, processed, 0.90));
+    printf("latency p99:       %" PRIu32 " ns\n", percentile(latencies, processed, 0.99));
+    printf("latency max:       %" PRIu32 " ns\n", latencies[processed - 1]);
+    printf("published:         %" PRIu64 " messages, %" PRIu64 " bytes\n", published_messages,
+           published_bytes);
+    printf("bytes per adv:     %.2f\n", adv_events ? (double)published_bytes / (double)adv_events : 0.0);
+    printf("allocs per event:  %.3f\n", (double)allocations / (double)processed);
+    printf("queue overflows:   %" PRIu32 "\n", queue_stats.overflows);
+    printf("table evictions:   %" PRIu32 " (%" PRIu32 " published before the window end)\n",
+           device_table_evictions(), device_table_window_evictions());
+
+    // Czas od przechwycenia do publikacji w czasie przechwycenia - głównie czekanie na koniec okna
+    uint32_t buckets[PERF_HISTOGRAM_BUCKETS];
+    perf_histogram_get(PERF_HIST_CAPTURE_TO_PUBLISH_MS, buckets);
+    printf("capture->publish:  p50 < %" PRIu32 " ms, p99 < %" PRIu32 " ms (capture time)\n",
+           histogram_percentile(buckets, 0.50), histogram_percentile(buckets, 0.99));
+
+    free(latencies);
+    free(events);
+    return 0;
+}
@@ -0,0 +1,9 @@
+#ifndef HOST_SCAN_REPLAY_H_
+#define HOST_SCAN_REPLAY_H_
+
+#include <stdint.h>
+
+// Zegar widziany przez kod firmware (esp_timer_get_time) - czas z pliku przechwycenia
+int64_t replay_clock_us(void);
+
+#endif
@@ -0,0 +1,87 @@
+// Implementacje zaślepek ESP-IDF z host/stubs dla scan_replay
+#include <stdarg.h>
+#include <stdio.h>
+#include <time.h>
+
+#include "esp_err.h"
+#include "esp_gap_ble_api.h"
+#include "esp_log.h"
+#include "esp_system.h"
+#include "esp_timer.h"
+#include "freertos/task.h"
+
+#include "scan_replay.h"
+
+int host_log_enabled = 0;
+
+void host_log(char level, const char *tag, const char *format, ...) {
+    if (!host_log_enabled) {
+        return;
+    }
+    va_list args;
+    va_start(args, format);
+    fprintf(stderr, "%c %s: ", level, tag);
+    vfprintf(stderr, format, args);
+    fputc('\n', stderr);
+    va_end(args);
+}
+
+const char *esp_err_to_name(esp_err_t code) {
+    return code == ESP_OK ? "ESP_OK" : "ESP_FAIL";
+}
+
+void esp_restart(void) {
+    fprintf(stderr, "esp_restart() called\n");
+    abort();
+}
+
+int64_t esp_timer_get_time(void) {
+    return replay_clock_us();
+}
+
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t task, const char *name, uint32_t stack_depth, void *param,
+                                   UBaseType_t priority, TaskHandle_t *handle, BaseType_t core) {
+    // Zadania nie są uruchamiane - harness sam steruje przepływem zdarzeń
+    return pdPASS;
+}
+
+TaskHandle_t xTaskCreateStaticPinnedToCore(TaskFunction_t task, const char *name, uint32_t stack_depth, void *param,
+                                           UBaseType_t priority, StackType_t *stack, StaticTask_t *buffer,
+                                           BaseType_t core) {
+    return buffer;
+}
+
+UBaseType_t uxTaskGetStackHighWaterMark(TaskHandle_t task) {
+    return 0;
+}
+
+void vTaskDelay(TickType_t ticks) {
+}
+
+uint32_t ulTaskNotifyTake(BaseType_t clear_on_exit, TickType_t ticks_to_wait) {
+    return 0;
+}
+
+BaseType_t xTaskNotifyGive(TaskHandle_t task) {
+    return pdPASS;
+}
+
+TickType_t xTaskGetTickCount(void) {
+    return (TickType_t)(replay_clock_us() / 1000);
+}
+
+esp_err_t esp_ble_gap_register_callback(esp_gap_ble_cb_t callback) {
+    return ESP_OK;
+}
+
+esp_err_t esp_ble_gap_set_scan_params(esp_ble_scan_params_t *scan_params) {
+    return ESP_OK;
+}
+
+esp_err_t esp_ble_gap_start_scanning(uint32_t duration) {
+    return ESP_OK;
+}
+
+esp_err_t esp_ble_gap_stop_scanning(void) {
+    return ESP_OK;
+}
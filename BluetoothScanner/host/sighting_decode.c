@@ -0,0 +1,39 @@
+// Dekoduje binarną wiadomość z /<board_name>/devices/bin (stdin) do JSON (stdout),
+// np.: mosquitto_sub -t /pokoj_1/devices/bin -C 1 | sighting_decode
+#include <stdio.h>
+#include <inttypes.h>
+
+#include "sighting_wire.h"
+
+#define MAX_MESSAGE_LEN 65536
+
+int main(void) {
+    static uint8_t message[MAX_MESSAGE_LEN];
+    size_t length = fread(message, 1, sizeof(message), stdin);
+
+    sighting_wire_reader_t reader;
+    sighting_wire_status_t status = sighting_wire_reader_init(&reader, message, length);
+    if (status != SIGHTING_WIRE_OK) {
+        fprintf(stderr, "Invalid message: %s\n", sighting_wire_status_str(status));
+        return 1;
+    }
+
+    printf("{\"base_timestamp_us\": %" PRId64 ", \"devices\": [", reader.base_timestamp_us);
+
+    sighting_wire_record_t record;
+    int index = 0;
+    while ((status = sighting_wire_reader_next(&reader, &record)) == SIGHTING_WIRE_OK) {
+        printf("%s{\"name\": \"%.*s\", \"address\": \"%02x:%02x:%02x:%02x:%02x:%02x\", "
+               "\"addr_type\": %u, \"rssi\": %d, \"timestamp_us\": %" PRId64 "}",
+               index++ > 0 ? ", " : "", record.name_len, record.name,
+               record.bda[0], record.bda[1], record.bda[2], record.bda[3], record.bda[4], record.bda[5],
+               record.addr_type, record.rssi, record.timestamp_us);
+    }
+    printf("]}\n");
+
+    if (status != SIGHTING_WIRE_END) {
+        fprintf(stderr, "Invalid message: %s\n", sighting_wire_status_str(status));
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,118 @@
+// Wypisuje niewysłane rekordy dziennika obserwacji (main/sighting_log.h) z obrazu
+// partycji, jeden obiekt JSON na linię, np.:
+//   parttool.py read_partition --partition-name sightings --output sightings.bin
+//   sighting_log_dump sightings.bin
+// Plik jest wczytywany do pamięci i nie jest modyfikowany.
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "sighting_log.h"
+
+typedef struct {
+    uint8_t *data;
+    size_t size;
+} memory_flash_t;
+
+static bool memory_read(void *ctx, size_t offset, void *data, size_t length) {
+    memory_flash_t *flash = ctx;
+    if (offset + length > flash->size) {
+        return false;
+    }
+    memcpy(data, flash->data + offset, length);
+    return true;
+}
+
+// Zapis jak w NOR flash: bity mogą być tylko zerowane
+static bool memory_write(void *ctx, size_t offset, const void *data, size_t length) {
+    memory_flash_t *flash = ctx;
+    if (offset + length > flash->size) {
+        return false;
+    }
+    const uint8_t *bytes = data;
+    for (size_t i = 0; i < length; i++) {
+        flash->data[offset + i] &= bytes[i];
+    }
+    return true;
+}
+
+static bool memory_erase_sector(void *ctx, size_t offset) {
+    memory_flash_t *flash = ctx;
+    if (offset + SIGHTING_LOG_SECTOR_SIZE > flash->size) {
+        return false;
+    }
+    memset(flash->data + offset, 0xFF, SIGHTING_LOG_SECTOR_SIZE);
+    return true;
+}
+
+static uint8_t *load_file(const char *path, size_t *size) {
+    FILE *file = fopen(path, "rb");
+    if (!file) {
+        perror(path);
+        return NULL;
+    }
+    fseek(file, 0, SEEK_END);
+    long length = ftell(file);
+    fseek(file, 0, SEEK_SET);
+
+    uint8_t *data = length > 0 ? malloc((size_t)length) : NULL;
+    if (data && fread(data, 1, (size_t)length, file) != (size_t)length) {
+        free(data);
+        data = NULL;
+    }
+    fclose(file);
+    *size = data ? (size_t)length : 0;
+    return data;
+}
+
+int main(int argc, char **argv) {
+    if (argc != 2) {
+        fprintf(stderr, "Usage: %s <partition-image>\n", argv[0]);
+        return 2;
+    }
+
+    memory_flash_t image;
+    image.data = load_file(argv[1], &image.size);
+    if (!image.data) {
+        return 1;
+    }
+
+    sighting_log_flash_t flash = {
+        .ctx = &image,
+        .size = image.size,
+        .read = memory_read,
+        .write = memory_write,
+        .erase_sector = memory_erase_sector,
+    };
+    if (!sighting_log_init(&flash, 0)) {
+        fprintf(stderr, "%s: image smaller than two %d-byte sectors\n", argv[1], SIGHTING_LOG_SECTOR_SIZE);
+        return 1;
+    }
+
+    // Przechodzenie przez dziennik tak jak przy wysyłaniu, ale na kopii w pamięci
+    sighting_log_record_t records[SIGHTING_LOG_PEEK_MAX];
+    size_t count;
+    while ((count = sighting_log_peek(records, SIGHTING_LOG_PEEK_MAX)) > 0) {
+        for (size_t i = 0; i < count; i++) {
+            const sighting_log_record_t *record = &records[i];
+            printf("{\"window_start_us\": %" PRId64 ", \"last_seen_us\": %" PRId64 ", \"name\": \"%s\", "
+                   "\"address\": \"%02x:%02x:%02x:%02x:%02x:%02x\", \"addr_type\": %u, \"rssi\": %d, "
+                   "\"rssi_min\": %d, \"rssi_max\": %d, \"count\": %u, \"epoch\": %s, \"boot_id\": %u}\n",
+                   record->window_start_us, record->last_seen_us, record->name,
+                   record->bda[0], record->bda[1], record->bda[2], record->bda[3], record->bda[4],
+                   record->bda[5], record->addr_type, record->rssi, record->rssi_min, record->rssi_max,
+                   record->count, (record->flags & SIGHTING_LOG_FLAG_EPOCH) ? "true" : "false",
+                   record->boot_id);
+        }
+        sighting_log_consume(count);
+    }
+
+    sighting_log_stats_t stats;
+    sighting_log_get_stats(&stats);
+    fprintf(stderr, "%" PRIu32 " sectors, %" PRIu32 " pending records, %" PRIu32 " corrupted\n",
+            stats.sectors, stats.replayed, stats.corrupted);
+
+    free(image.data);
+    return 0;
+}
@@ -0,0 +1,3 @@
+#ifndef HOST_DRIVER_GPIO_H_
+#define HOST_DRIVER_GPIO_H_
+#endif
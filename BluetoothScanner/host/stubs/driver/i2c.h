@@ -0,0 +1,33 @@
+#ifndef HOST_DRIVER_I2C_H_
+#define HOST_DRIVER_I2C_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "esp_err.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+typedef int i2c_port_t;
+
+#define I2C_NUM_0 0
+#define I2C_MODE_MASTER 1
+#define GPIO_PULLUP_ENABLE 1
+
+typedef struct {
+    int mode;
+    int sda_io_num;
+    int scl_io_num;
+    int sda_pullup_en;
+    int scl_pullup_en;
+    struct {
+        uint32_t clk_speed;
+    } master;
+} i2c_config_t;
+
+esp_err_t i2c_param_config(i2c_port_t port, const i2c_config_t *conf);
+esp_err_t i2c_driver_install(i2c_port_t port, int mode, size_t rx_buffer_len, size_t tx_buffer_len, int flags);
+esp_err_t i2c_master_write_to_device(i2c_port_t port, uint8_t address, const uint8_t *data, size_t length,
+                                     TickType_t ticks_to_wait);
+
+#endif
@@ -0,0 +1,3 @@
+#ifndef HOST_ESP_BT_H_
+#define HOST_ESP_BT_H_
+#endif
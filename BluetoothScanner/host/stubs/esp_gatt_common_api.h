@@ -0,0 +1,3 @@
+#ifndef HOST_ESP_GATT_COMMON_API_H_
+#define HOST_ESP_GATT_COMMON_API_H_
+#endif
@@ -0,0 +1,14 @@
+#ifndef HOST_ESP_LOG_H_
+#define HOST_ESP_LOG_H_
+
+// Logi są domyślnie wyciszone, aby nie zaburzać pomiarów na hoście
+extern int host_log_enabled;
+
+void host_log(char level, const char *tag, const char *format, ...);
+
+#define ESP_LOGE(tag, format, ...) host_log('E', tag, format, ##__VA_ARGS__)
+#define ESP_LOGW(tag, format, ...) host_log('W', tag, format, ##__VA_ARGS__)
+#define ESP_LOGI(tag, format, ...) host_log('I', tag, format, ##__VA_ARGS__)
+#define ESP_LOGD(tag, format, ...) host_log('D', tag, format, ##__VA_ARGS__)
+
+#endif
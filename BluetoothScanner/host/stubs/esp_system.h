@@ -0,0 +1,8 @@
+#ifndef HOST_ESP_SYSTEM_H_
+#define HOST_ESP_SYSTEM_H_
+
+#include "esp_err.h"
+
+void esp_restart(void);
+
+#endif
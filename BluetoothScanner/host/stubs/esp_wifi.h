@@ -0,0 +1,3 @@
+#ifndef HOST_ESP_WIFI_H_
+#define HOST_ESP_WIFI_H_
+#endif
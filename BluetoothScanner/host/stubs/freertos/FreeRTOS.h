@@ -0,0 +1,20 @@
+#ifndef HOST_FREERTOS_H_
+#define HOST_FREERTOS_H_
+
+#include <stdint.h>
+
+#include "sdkconfig.h"
+
+typedef uint32_t TickType_t;
+typedef int BaseType_t;
+typedef unsigned int UBaseType_t;
+typedef uint8_t StackType_t; // Jak w ESP-IDF: głębokość stosu w bajtach
+
+#define pdTRUE 1
+#define pdFALSE 0
+#define pdPASS pdTRUE
+#define portMAX_DELAY 0xFFFFFFFFu
+#define portTICK_PERIOD_MS 1
+#define pdMS_TO_TICKS(ms) ((TickType_t)(ms))
+
+#endif
@@ -0,0 +1,9 @@
+#ifndef HOST_FREERTOS_EVENT_GROUPS_H_
+#define HOST_FREERTOS_EVENT_GROUPS_H_
+
+#include "FreeRTOS.h"
+
+typedef void *EventGroupHandle_t;
+typedef uint32_t EventBits_t;
+
+#endif
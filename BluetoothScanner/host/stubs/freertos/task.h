@@ -0,0 +1,26 @@
+#ifndef HOST_FREERTOS_TASK_H_
+#define HOST_FREERTOS_TASK_H_
+
+#include "FreeRTOS.h"
+
+typedef void *TaskHandle_t;
+typedef void (*TaskFunction_t)(void *);
+
+#define tskNO_AFFINITY 0x7FFFFFFF
+
+typedef struct {
+    void *unused;
+} StaticTask_t;
+
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t task, const char *name, uint32_t stack_depth, void *param,
+                                   UBaseType_t priority, TaskHandle_t *handle, BaseType_t core);
+TaskHandle_t xTaskCreateStaticPinnedToCore(TaskFunction_t task, const char *name, uint32_t stack_depth, void *param,
+                                           UBaseType_t priority, StackType_t *stack, StaticTask_t *buffer,
+                                           BaseType_t core);
+UBaseType_t uxTaskGetStackHighWaterMark(TaskHandle_t task);
+void vTaskDelay(TickType_t ticks);
+uint32_t ulTaskNotifyTake(BaseType_t clear_on_exit, TickType_t ticks_to_wait);
+BaseType_t xTaskNotifyGive(TaskHandle_t task);
+TickType_t xTaskGetTickCount(void);
+
+#endif
@@ -0,0 +1,3 @@
+#ifndef HOST_NVS_H_
+#define HOST_NVS_H_
+#endif
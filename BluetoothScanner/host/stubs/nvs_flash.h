@@ -0,0 +1,3 @@
+#ifndef HOST_NVS_FLASH_H_
+#define HOST_NVS_FLASH_H_
+#endif
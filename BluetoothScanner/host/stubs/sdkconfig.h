@@ -0,0 +1,53 @@
+#ifndef HOST_SDKCONFIG_H_
+#define HOST_SDKCONFIG_H_
+
+// Domyślne wartości z main/Kconfig.projbuild dla buildów na hoście
+
+#define CONFIG_SCAN_MODE_DUTY_CYCLE 1
+#define CONFIG_SCAN_DURATION_S 10
+#define CONFIG_SCAN_INTERVAL_S 5
+#define CONFIG_SCAN_RADIO_INTERVAL 160
+#define CONFIG_SCAN_RADIO_WINDOW 160
+#define CONFIG_SIGHTING_QUEUE_LENGTH 64
+#define CONFIG_SIGHTING_PUBLISH_PERIOD_MS 20
+#define CONFIG_SIGHTING_QUEUE_STATS_INTERVAL_MS 10000
+#define CONFIG_DEVICE_TABLE_CAPACITY 256
+#define CONFIG_RSSI_FILTER_NONE 1
+#define CONFIG_SIGHTING_PUBLISH_MODE_PER_DEVICE 1
+#define CONFIG_SIGHTING_WIRE_FORMAT_JSON 1
+#define CONFIG_PRESENCE_ENTER_RSSI -80
+#define CONFIG_PRESENCE_EXIT_RSSI -90
+#define CONFIG_PRESENCE_ENTER_DWELL_MS 3000
+#define CONFIG_PRESENCE_EXIT_DWELL_MS 10000
+#define CONFIG_PRESENCE_ABSENCE_TIMEOUT_MS 30000
+#define CONFIG_PRESENCE_HEARTBEAT_INTERVAL_S 60
+#define CONFIG_SIGHTING_LOG 1
+#define CONFIG_SIGHTING_LOG_PARTITION_LABEL "sightings"
+#define CONFIG_SIGHTING_LOG_RETENTION_KB 256
+#define CONFIG_SIGHTING_LOG_REPLAY_BATCH 16
+#define CONFIG_SIGHTING_LOG_REPLAY_INTERVAL_MS 500
+#define CONFIG_SCAN_FILTER_MAX_RULES 16
+#define CONFIG_TAG_ALLOWLIST 1
+#define CONFIG_TAG_ALLOWLIST_PARTITION_LABEL "tags"
+#define CONFIG_TAG_ALLOWLIST_CAPACITY 5000
+#define CONFIG_TAG_ALLOWLIST_FP_RATE_PPM 10000
+#define CONFIG_TAG_ALLOWLIST_EXACT_CHECK 1
+#define CONFIG_STATIC_ALLOCATION 1
+#define CONFIG_MEMORY_BUDGET_STACK_MARGIN 512
+#define CONFIG_TASK_SCANNER_CORE 0
+#define CONFIG_TASK_SCANNER_PRIORITY 5
+#define CONFIG_TASK_SCANNER_STACK_SIZE 4096
+#define CONFIG_TASK_MQTT_CORE 1
+#define CONFIG_TASK_MQTT_PRIORITY 4
+#define CONFIG_TASK_MQTT_STACK_SIZE 6144
+#define CONFIG_TASK_BUTTON_CORE -1
+#define CONFIG_TASK_BUTTON_PRIORITY 3
+#define CONFIG_TASK_BUTTON_STACK_SIZE 4096
+#define CONFIG_TASK_DISPLAY_CORE -1
+#define CONFIG_TASK_DISPLAY_PRIORITY 2
+#define CONFIG_TASK_DISPLAY_STACK_SIZE 3072
+#define CONFIG_TASK_BLINK_LED_CORE -1
+#define CONFIG_TASK_BLINK_LED_PRIORITY 1
+#define CONFIG_TASK_BLINK_LED_STACK_SIZE 2048
+
+#endif
@@ -0,0 +1,276 @@
+// Narzędzie do listy zarejestrowanych tagów (main/tag_allowlist.h):
+//
+//   tag_allowlist_tool pack <lista.txt> <lista.bin>
+//     Zamienia adresy "aa:bb:cc:dd:ee:ff" (po jednym w linii) na posortowaną
+//     listę bez powtórzeń w formacie /<board_name>/tags, np.:
+//       mosquitto_pub -t /pokoj_1/tags -f lista.bin
+//
+//   tag_allowlist_tool bench [--tags N] [--capacity N] [--fp PPM] [--probes N] [--seed N]
+//     Wgrywa N losowych adresów do obszaru w pamięci tak jak firmware (fragmentami),
+//     a następnie mierzy odsetek fałszywych trafień filtra Blooma na adresach spoza
+//     listy, zajętość RAM i koszt wyszukiwania. Kończy się kodem 1, jeśli któryś tag
+//     nie został znaleziony albo odsetek fałszywych trafień przekracza dwukrotność
+//     oczekiwanego.
+#define _POSIX_C_SOURCE 200809L
+
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "tag_allowlist.h"
+
+#define AREA_SIZE 0x10000 // Jak partycja "tags" w partitions.csv
+
+typedef struct {
+    uint8_t data[AREA_SIZE];
+} memory_flash_t;
+
+static bool memory_read(void *ctx, size_t offset, void *data, size_t length) {
+    memory_flash_t *flash = ctx;
+    if (offset + length > AREA_SIZE) {
+        return false;
+    }
+    memcpy(data, flash->data + offset, length);
+    return true;
+}
+
+// Zapis jak w NOR flash: bity mogą być tylko zerowane
+static bool memory_write(void *ctx, size_t offset, const void *data, size_t length) {
+    memory_flash_t *flash = ctx;
+    if (offset + length > AREA_SIZE) {
+        return false;
+    }
+    const uint8_t *bytes = data;
+    for (size_t i = 0; i < length; i++) {
+        flash->data[offset + i] &= bytes[i];
+    }
+    return true;
+}
+
+static bool memory_erase_sector(void *ctx, size_t offset) {
+    memory_flash_t *flash = ctx;
+    if (offset + TAG_ALLOWLIST_SECTOR_SIZE > AREA_SIZE) {
+        return false;
+    }
+    memset(flash->data + offset, 0xFF, TAG_ALLOWLIST_SECTOR_SIZE);
+    return true;
+}
+
+static int compare_bda(const void *a, const void *b) {
+    return memcmp(a, b, SIGHTING_BDA_LEN);
+}
+
+// Sortuje i usuwa powtórzenia; zwraca nową liczbę adresów
+static size_t sort_unique(uint8_t *bdas, size_t count) {
+    qsort(bdas, count, SIGHTING_BDA_LEN, compare_bda);
+    size_t unique = 0;
+    for (size_t i = 0; i < count; i++) {
+        if (unique == 0 || memcmp(bdas + (unique - 1) * SIGHTING_BDA_LEN, bdas + i * SIGHTING_BDA_LEN,
+                                  SIGHTING_BDA_LEN) != 0) {
+            memmove(bdas + unique * SIGHTING_BDA_LEN, bdas + i * SIGHTING_BDA_LEN, SIGHTING_BDA_LEN);
+            unique++;
+        }
+    }
+    return unique;
+}
+
+static int pack(const char *input_path, const char *output_path) {
+    FILE *input = fopen(input_path, "r");
+    if (!input) {
+        perror(input_path);
+        return 1;
+    }
+
+    size_t count = 0;
+    size_t capacity = 1024;
+    uint8_t *bdas = malloc(capacity * SIGHTING_BDA_LEN);
+    char line[128];
+    unsigned line_number = 0;
+    while (fgets(line, sizeof(line), input)) {
+        line_number++;
+        unsigned int b[6];
+        char extra;
+        if (line[strspn(line, " \t\r\n")] == '\0' || line[0] == '#') {
+            continue;
+        }
+        if (sscanf(line, " %2x:%2x:%2x:%2x:%2x:%2x %c", &b[0], &b[1], &b[2], &b[3], &b[4], &b[5], &extra) != 6) {
+            fprintf(stderr, "%s:%u: invalid address\n", input_path, line_number);
+            fclose(input);
+            free(bdas);
+            return 1;
+        }
+        if (count == capacity) {
+            capacity *= 2;
+            bdas = realloc(bdas, capacity * SIGHTING_BDA_LEN);
+        }
+        for (int i = 0; i < SIGHTING_BDA_LEN; i++) {
+            bdas[count * SIGHTING_BDA_LEN + i] = (uint8_t)b[i];
+        }
+        count++;
+    }
+    fclose(input);
+
+    size_t unique = sort_unique(bdas, count);
+    size_t max_tags = (AREA_SIZE - TAG_ALLOWLIST_HEADER_LEN) / SIGHTING_BDA_LEN;
+    if (unique > max_tags) {
+        fprintf(stderr, "%zu tags do not fit in the %d-byte partition (max %zu)\n", unique, AREA_SIZE, max_tags);
+        free(bdas);
+        return 1;
+    }
+
+    FILE *output = fopen(output_path, "wb");
+    if (!output || fwrite(bdas, SIGHTING_BDA_LEN, unique, output) != unique) {
+        perror(output_path);
+        free(bdas);
+        return 1;
+    }
+    fclose(output);
+    fprintf(stderr, "%zu tags (%zu duplicates removed)\n", unique, count - unique);
+    free(bdas);
+    return 0;
+}
+
+static void random_bda(uint8_t *bda) {
+    for (int i = 0; i < SIGHTING_BDA_LEN; i++) {
+        bda[i] = (uint8_t)(rand() >> 7);
+    }
+}
+
+static uint64_t monotonic_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+}
+
+static int bench(int argc, char **argv) {
+    uint32_t tags = 5000;
+    uint32_t capacity = 5000;
+    uint32_t fp_ppm = 10000;
+    uint32_t probes = 1000000;
+    unsigned seed = 1;
+    for (int i = 0; i + 1 < argc; i += 2) {
+        uint32_t value = (uint32_t)strtoul(argv[i + 1], NULL, 0);
+        if (strcmp(argv[i], "--tags") == 0) {
+            tags = value;
+        } else if (strcmp(argv[i], "--capacity") == 0) {
+            capacity = value;
+        } else if (strcmp(argv[i], "--fp") == 0) {
+            fp_ppm = value;
+        } else if (strcmp(argv[i], "--probes") == 0) {
+            probes = value;
+        } else if (strcmp(argv[i], "--seed") == 0) {
+            seed = value;
+        } else {
+            fprintf(stderr, "Unknown option %s\n", argv[i]);
+            return 2;
+        }
+    }
+    srand(seed);
+
+    uint8_t *bdas = malloc((size_t)tags * SIGHTING_BDA_LEN);
+    for (uint32_t i = 0; i < tags; i++) {
+        random_bda(bdas + (size_t)i * SIGHTING_BDA_LEN);
+    }
+    tags = (uint32_t)sort_unique(bdas, tags);
+
+    static memory_flash_t area;
+    memset(area.data, 0xFF, sizeof(area.data));
+    tag_allowlist_flash_t flash = {
+        .ctx = &area,
+        .size = AREA_SIZE,
+        .read = memory_read,
+        .write = memory_write,
+        .erase_sector = memory_erase_sector,
+    };
+    // Filtr w buforze o rozmiarze ze wzoru dla CONFIG_STATIC_ALLOCATION - sprawdza też to oszacowanie
+    size_t filter_size = TAG_ALLOWLIST_FILTER_MAX_BYTES(capacity, fp_ppm);
+    uint32_t *filter = malloc(filter_size);
+    tag_allowlist_use_buffer(filter, filter_size);
+    if (!tag_allowlist_init(&flash, capacity, fp_ppm, true)) {
+        fprintf(stderr, "init failed\n");
+        return 1;
+    }
+
+    // Wgrywanie fragmentami o losowej długości, jak dane z esp-mqtt
+    size_t total = (size_t)tags * SIGHTING_BDA_LEN;
+    bool uploaded = tag_allowlist_begin(tags);
+    for (size_t offset = 0; uploaded && offset < total;) {
+        size_t length = 1 + (size_t)rand() % 1024;
+        if (length > total - offset) {
+            length = total - offset;
+        }
+        uploaded = tag_allowlist_append(bdas + offset, length);
+        offset += length;
+    }
+    if (!uploaded || !tag_allowlist_commit()) {
+        fprintf(stderr, "upload failed: %s\n", tag_allowlist_error());
+        return 1;
+    }
+
+    uint32_t missing = 0;
+    uint64_t start = monotonic_ns();
+    for (uint32_t i = 0; i < tags; i++) {
+        missing += !tag_allowlist_contains(bdas + (size_t)i * SIGHTING_BDA_LEN);
+    }
+    uint64_t member_ns = monotonic_ns() - start;
+
+    tag_allowlist_stats_t before;
+    tag_allowlist_get_stats(&before);
+
+    // Losowe adresy spoza listy - każde trafienie filtra jest fałszywe
+    uint32_t non_members = 0;
+    uint8_t *queries = malloc((size_t)probes * SIGHTING_BDA_LEN);
+    for (uint32_t i = 0; i < probes; i++) {
+        uint8_t *bda = queries + (size_t)non_members * SIGHTING_BDA_LEN;
+        random_bda(bda);
+        if (!bsearch(bda, bdas, tags, SIGHTING_BDA_LEN, compare_bda)) {
+            non_members++;
+        }
+    }
+    start = monotonic_ns();
+    uint32_t accepted = 0;
+    for (uint32_t i = 0; i < non_members; i++) {
+        accepted += tag_allowlist_contains(queries + (size_t)i * SIGHTING_BDA_LEN);
+    }
+    uint64_t non_member_ns = monotonic_ns() - start;
+
+    tag_allowlist_stats_t after;
+    tag_allowlist_get_stats(&after);
+    uint32_t filter_positives = after.filter_positives - before.filter_positives;
+    double measured_ppm = non_members ? 1e6 * filter_positives / non_members : 0;
+
+    printf("tags:              %" PRIu32 " (capacity %" PRIu32 ", target FP %" PRIu32 " ppm)\n", tags, capacity,
+           fp_ppm);
+    printf("filter:            %" PRIu32 " bits, %" PRIu32 " hashes, %" PRIu32 " bytes RAM (static buffer %zu)\n",
+           after.filter_bits, after.hash_count, after.memory_bytes, filter_size);
+    printf("expected FP:       %" PRIu32 " ppm\n", after.expected_fp_ppm);
+    printf("measured FP:       %.0f ppm (%" PRIu32 " of %" PRIu32 " non-members)\n", measured_ppm,
+           filter_positives, non_members);
+    printf("exact check:       %" PRIu32 " accepted after check, %" PRIu32 " missing tags\n", accepted, missing);
+    printf("bit probes/lookup: %.2f (non-members)\n",
+           non_members ? (double)(after.bit_probes - before.bit_probes) / non_members : 0);
+    printf("flash reads/hit:   %.2f\n",
+           after.exact_checks ? (double)after.flash_reads / after.exact_checks : 0);
+    printf("lookup member:     %.0f ns\n", tags ? (double)member_ns / tags : 0);
+    printf("lookup non-member: %.0f ns\n", non_members ? (double)non_member_ns / non_members : 0);
+
+    free(queries);
+    free(bdas);
+    free(filter);
+    return missing == 0 && accepted == 0 && measured_ppm <= 2.0 * after.expected_fp_ppm + 100 ? 0 : 1;
+}
+
+int main(int argc, char **argv) {
+    if (argc == 4 && strcmp(argv[1], "pack") == 0) {
+        return pack(argv[2], argv[3]);
+    }
+    if (argc >= 2 && strcmp(argv[1], "bench") == 0) {
+        return bench(argc - 2, argv + 2);
+    }
+    fprintf(stderr, "Usage: %s pack <list.txt> <list.bin>\n"
+                    "       %s bench [--tags N] [--capacity N] [--fp PPM] [--probes N] [--seed N]\n",
+            argv[0], argv[0]);
+    return 2;
+}
@@ -0,0 +1,229 @@
+// Test adv_parser: struktury AD o zerowej i obciętej długości, długości wychodzące
+// poza reklamę albo odpowiedź na skanowanie, pierwszeństwo pełnej nazwy oraz widoki
+// UUID, danych usług i producenta. Na koniec pomiar czasu parsowania jednego
+// zdarzenia na mieszance typowych reklam:
+//
+//   adv_parser_test [iterations]
+
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "adv_parser.h"
+#include "test_check.h"
+
+#define BENCH_ITERATIONS 200000
+
+typedef struct {
+    uint8_t data[62];
+    size_t adv_len;
+    size_t scan_rsp_len;
+} event_t;
+
+// Nazwy z testów porównywane z widokiem do bufora
+static bool view_equals(adv_view_t view, const char *text) {
+    return view.data != NULL && view.len == strlen(text) && memcmp(view.data, text, view.len) == 0;
+}
+
+static bool view_bytes(adv_view_t view, const uint8_t *bytes, uint8_t len) {
+    return view.data != NULL && view.len == len && memcmp(view.data, bytes, len) == 0;
+}
+
+static bool parse(const event_t *event, adv_fields_t *fields) {
+    return adv_parse(event->data, event->adv_len, event->scan_rsp_len, fields);
+}
+
+static void test_empty_and_zero_length(void) {
+    adv_fields_t fields;
+    event_t empty = {{0}, 0, 0};
+    CHECK(parse(&empty, &fields));
+    CHECK(!fields.malformed && fields.name.data == NULL && fields.uuid16_count == 0);
+
+    // Zerowa długość kończy dane segmentu - dalsze bajty to wypełnienie
+    event_t padded = {{0x02, 0x01, 0x06, 0x00, 0x05, 0x09, 'x', 'y', 'z', 'w'}, 10, 0};
+    CHECK(parse(&padded, &fields));
+    CHECK(fields.has_flags && fields.flags == 0x06);
+    CHECK(fields.name.data == NULL);
+
+    // Pole o długości 1 ma tylko typ; flagi i moc nadawania wymagają wartości
+    event_t no_value = {{0x01, 0x09, 0x01, 0x01, 0x01, 0x0A}, 6, 0};
+    CHECK(!parse(&no_value, &fields));
+    CHECK(fields.malformed);
+    CHECK(fields.name.len == 0 && fields.name_complete);
+    CHECK(!fields.has_flags && !fields.has_tx_power);
+}
+
+static void test_truncated(void) {
+    adv_fields_t fields;
+
+    // Ostatnia struktura wychodzi poza reklamę - poprzednie pola zostają
+    event_t truncated = {{0x02, 0x01, 0x06, 0x05, 0xFF, 0x4C, 0x00}, 7, 0};
+    CHECK(!parse(&truncated, &fields));
+    CHECK(fields.malformed && fields.has_flags && fields.manufacturer_count == 0);
+
+    // Sam bajt długości na końcu
+    event_t length_only = {{0x02, 0x0A, 0xF4, 0x03}, 4, 0};
+    CHECK(!parse(&length_only, &fields));
+    CHECK(fields.has_tx_power && fields.tx_power == -12);
+
+    // Długość reklamy sięgająca do odpowiedzi na skanowanie nie czyta jej bajtów
+    event_t past_adv = {{0x05, 0x09, 'a', 'b', 0x03, 0x09, 'c', 'd'}, 4, 4};
+    CHECK(!parse(&past_adv, &fields));
+    CHECK(view_equals(fields.name, "cd"));
+
+    // Długość odpowiedzi wychodząca poza scan_rsp_len, choć bufor jest dłuższy
+    event_t past_scan_rsp = {{0x03, 0x08, 'a', 'b', 0x04, 0x09, 'c', 'd', 'e'}, 4, 4};
+    CHECK(!parse(&past_scan_rsp, &fields));
+    CHECK(view_equals(fields.name, "ab") && !fields.name_complete);
+
+    // Obie części obcięte, pola przed błędem w każdej z nich są wypełnione
+    event_t both = {{0x02, 0x01, 0x1A, 0x05, 0x09, 'a', 0x03, 0x03, 0xAA, 0xFE, 0x7F, 0x09}, 6, 6};
+    CHECK(!parse(&both, &fields));
+    CHECK(fields.has_flags && fields.uuid16_count == 1 && fields.name.data == NULL);
+}
+
+static void test_name_precedence(void) {
+    adv_fields_t fields;
+
+    // Skrócona w reklamie, pełna w odpowiedzi
+    event_t short_then_complete = {{0x04, 0x08, 'M', 'i', 'T', 0x07, 0x09, 'M', 'i', 'T', 'a', 'g', '7'}, 5, 8};
+    CHECK(parse(&short_then_complete, &fields));
+    CHECK(view_equals(fields.name, "MiTag7") && fields.name_complete);
+
+    // Pełna w reklamie, skrócona w odpowiedzi
+    event_t complete_then_short = {{0x07, 0x09, 'M', 'i', 'T', 'a', 'g', '7', 0x04, 0x08, 'M', 'i', 'T'}, 8, 5};
+    CHECK(parse(&complete_then_short, &fields));
+    CHECK(view_equals(fields.name, "MiTag7") && fields.name_complete);
+
+    // Obie skrócone - wygrywa ostatnia
+    event_t two_short = {{0x03, 0x08, 'a', 'b', 0x04, 0x08, 'a', 'b', 'c'}, 4, 5};
+    CHECK(parse(&two_short, &fields));
+    CHECK(view_equals(fields.name, "abc") && !fields.name_complete);
+
+    // Pełna i skrócona w jednej części, w dowolnej kolejności
+    event_t same_segment = {{0x03, 0x09, 'a', 'b', 0x02, 0x08, 'a'}, 7, 0};
+    CHECK(parse(&same_segment, &fields));
+    CHECK(view_equals(fields.name, "ab") && fields.name_complete);
+}
+
+static void test_uuid_views(void) {
+    static const uint8_t uuid128[16] = {0xFB, 0x34, 0x9B, 0x5F, 0x80, 0x00, 0x00, 0x80,
+                                        0x00, 0x10, 0x00, 0x00, 0xAA, 0xFE, 0x00, 0x00};
+    event_t event = {{0}, 0, 0};
+    uint8_t *p = event.data;
+    const uint8_t adv[] = {0x05, 0x03, 0xAA, 0xFE, 0x0F, 0x18, 0x05, 0x05, 0xAA, 0xFE, 0x34, 0x12, 0x11, 0x07};
+    memcpy(p, adv, sizeof(adv));
+    memcpy(p + sizeof(adv), uuid128, sizeof(uuid128));
+    event.adv_len = sizeof(adv) + sizeof(uuid128);
+    // Druga lista UUID16 w odpowiedzi na skanowanie
+    const uint8_t scan_rsp[] = {0x03, 0x02, 0x0D, 0x18};
+    memcpy(p + event.adv_len, scan_rsp, sizeof(scan_rsp));
+    event.scan_rsp_len = sizeof(scan_rsp);
+
+    adv_fields_t fields;
+    CHECK(parse(&event, &fields));
+    CHECK(fields.uuid16_count == 2 && fields.uuid32_count == 1 && fields.uuid128_count == 1);
+    CHECK(view_bytes(fields.uuid16[0], (const uint8_t[]){0xAA, 0xFE, 0x0F, 0x18}, 4));
+    CHECK(view_bytes(fields.uuid16[1], (const uint8_t[]){0x0D, 0x18}, 2));
+    CHECK(view_bytes(fields.uuid32[0], (const uint8_t[]){0xAA, 0xFE, 0x34, 0x12}, 4));
+    CHECK(view_bytes(fields.uuid128[0], uuid128, 16));
+    // Widoki wskazują na bufor wejściowy
+    CHECK(fields.uuid16[0].data == event.data + 2);
+
+    // Długość listy niebędąca wielokrotnością rozmiaru UUID
+    event_t odd = {{0x04, 0x03, 0xAA, 0xFE, 0x0F, 0x04, 0x05, 0x01, 0x02, 0x03}, 10, 0};
+    CHECK(!parse(&odd, &fields));
+    CHECK(fields.uuid16_count == 0 && fields.uuid32_count == 0);
+
+    // Więcej list niż ADV_MAX_UUID_LISTS
+    event_t many = {{0x03, 0x02, 0x01, 0x00, 0x03, 0x02, 0x02, 0x00, 0x03, 0x03, 0x03, 0x00}, 12, 0};
+    CHECK(!parse(&many, &fields));
+    CHECK(fields.uuid16_count == ADV_MAX_UUID_LISTS);
+}
+
+static void test_service_and_manufacturer(void) {
+    // Eddystone (dane usługi FEAA), iBeacon (producent 0x004C) i dane usługi 32/128 w odpowiedzi
+    event_t event = {{0x06, 0x16, 0xAA, 0xFE, 0x10, 0xF4, 0x00,
+                      0x07, 0xFF, 0x4C, 0x00, 0x02, 0x15, 0x01, 0x02,
+                      0x06, 0x20, 0x34, 0x12, 0xAA, 0xFE, 0x7E,
+                      0x11, 0x21, 0xFB, 0x34, 0x9B, 0x5F, 0x80, 0x00, 0x00, 0x80,
+                      0x00, 0x10, 0x00, 0x00, 0xAA, 0xFE, 0x00, 0x00,
+                      0x03, 0xFF, 0x59, 0x00},
+                     15, 29};
+    adv_fields_t fields;
+    CHECK(parse(&event, &fields));
+    CHECK(fields.service_data_count == 3 && fields.manufacturer_count == 2);
+
+    CHECK(fields.service_data[0].type == ADV_TYPE_SERVICE_DATA16);
+    CHECK(view_bytes(fields.service_data[0].uuid, (const uint8_t[]){0xAA, 0xFE}, 2));
+    CHECK(view_bytes(fields.service_data[0].data, (const uint8_t[]){0x10, 0xF4, 0x00}, 3));
+    CHECK(fields.service_data[1].type == ADV_TYPE_SERVICE_DATA32);
+    CHECK(view_bytes(fields.service_data[1].uuid, (const uint8_t[]){0x34, 0x12, 0xAA, 0xFE}, 4));
+    CHECK(view_bytes(fields.service_data[1].data, (const uint8_t[]){0x7E}, 1));
+    CHECK(fields.service_data[2].type == ADV_TYPE_SERVICE_DATA128);
+    CHECK(fields.service_data[2].uuid.len == 16 && fields.service_data[2].uuid.data[12] == 0xAA);
+    CHECK(fields.service_data[2].data.len == 0);
+
+    CHECK(fields.manufacturer[0].company_id == 0x004C);
+    CHECK(view_bytes(fields.manufacturer[0].data, (const uint8_t[]){0x02, 0x15, 0x01, 0x02}, 4));
+    // Sam identyfikator firmy - pusty widok danych
+    CHECK(fields.manufacturer[1].company_id == 0x0059 && fields.manufacturer[1].data.len == 0);
+
+    // Dane usługi krótsze niż UUID i dane producenta bez pełnego identyfikatora
+    event_t short_fields = {{0x02, 0x16, 0xAA, 0x02, 0xFF, 0x4C, 0x03, 0x16, 0xAA, 0xFE}, 10, 0};
+    CHECK(!parse(&short_fields, &fields));
+    CHECK(fields.service_data_count == 1 && fields.manufacturer_count == 0);
+    CHECK(fields.service_data[0].data.len == 0);
+}
+
+// Mieszanka zdarzeń jak w typowym otoczeniu: beacony, urządzenie z nazwą
+// w odpowiedzi na skanowanie i uszkodzona reklama
+static const event_t bench_events[] = {
+    {{0x02, 0x01, 0x06, 0x1A, 0xFF, 0x4C, 0x00, 0x02, 0x15, 0xE2, 0xC5, 0x6D, 0xB5, 0xDF, 0xFB, 0x48,
+      0xD2, 0xB0, 0x60, 0xD0, 0xF5, 0xA7, 0x10, 0x96, 0xE0, 0x00, 0x01, 0x00, 0x02, 0xC5},
+     30, 0},
+    {{0x02, 0x01, 0x06, 0x03, 0x03, 0xAA, 0xFE, 0x12, 0x16, 0xAA, 0xFE, 0x10, 0xF4, 0x00, 0x65, 0x78,
+      0x61, 0x6D, 0x70, 0x6C, 0x65, 0x2E, 0x63, 0x6F, 0x6D, 0x00},
+     26, 0},
+    {{0x02, 0x01, 0x06, 0x05, 0x03, 0x0F, 0x18, 0x0D, 0x18, 0x02, 0x0A, 0x04,
+      0x09, 0x09, 'M', 'i', ' ', 'T', 'a', 'g', ' ', '7', 0x05, 0xFF, 0x59, 0x00, 0x01, 0x02},
+     12, 16},
+    {{0x02, 0x01, 0x06, 0x1E, 0xFF, 0x06, 0x00}, 7, 0},
+};
+
+static void bench(long iterations) {
+    const size_t count = sizeof(bench_events) / sizeof(bench_events[0]);
+    adv_fields_t fields;
+    uint32_t names = 0;
+    struct timespec start;
+    struct timespec end;
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (long i = 0; i < iterations; i++) {
+        parse(&bench_events[(size_t)i % count], &fields);
+        names += fields.name.len;
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+
+    double ns = (end.tv_sec - start.tv_sec) * 1e9 + (end.tv_nsec - start.tv_nsec);
+    printf("adv_parse: %ld events, %.1f ns/event (%" PRIu32 " name bytes)\n", iterations, ns / iterations, names);
+    // Tylko wykrycie rażącego spowolnienia - zdarzenie GAP na ESP32 ma rzędu mikrosekund
+    CHECK(ns / iterations < 10000);
+}
+
+int main(int argc, char **argv) {
+    long iterations = argc > 1 ? strtol(argv[1], NULL, 0) : BENCH_ITERATIONS;
+
+    test_empty_and_zero_length();
+    test_truncated();
+    test_name_precedence();
+    test_uuid_views();
+    test_service_and_manufacturer();
+    if (iterations > 0) {
+        bench(iterations);
+    }
+    return test_result("adv_parser_test");
+}
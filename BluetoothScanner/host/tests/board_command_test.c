@@ -0,0 +1,115 @@
+// Test board_command: potwierdzenia dla poleceń z sieci - zwykłe, zbyt długie
+// i złożone z samych znaków do escapowania - mieszczą się w buforze ack.
+
+#include <stdbool.h>
+#include <string.h>
+
+#include "board_command.h"
+#include "json_string.h"
+#include "test_check.h"
+
+#define GUARD_BYTE 0xA5
+#define GUARD_LEN 64
+
+// Bufor potwierdzenia ze strażnikiem - zapis poza ack zmienia guard
+static struct {
+    char ack[BOARD_COMMAND_ACK_LEN];
+    unsigned char guard[GUARD_LEN];
+} output;
+
+static const char *handler_result = "";
+
+static bool echo_handler(const char *args, char *result, size_t result_len) {
+    snprintf(result, result_len, "%s%s", handler_result, args);
+    return true;
+}
+
+static const board_command_t table[] = {
+    {"echo", echo_handler, 0},
+};
+
+static size_t dispatch(board_command_source_t source, const char *text, size_t capacity) {
+    memset(&output, GUARD_BYTE, sizeof(output));
+    size_t len = board_command_dispatch(source, text, strlen(text), output.ack, capacity);
+    for (size_t i = capacity; i < sizeof(output.ack); i++) {
+        CHECK((unsigned char)output.ack[i] == GUARD_BYTE);
+    }
+    for (size_t i = 0; i < GUARD_LEN; i++) {
+        CHECK(output.guard[i] == GUARD_BYTE);
+    }
+    CHECK(len < capacity);
+    if (len > 0) {
+        CHECK(strlen(output.ack) == len);
+        CHECK(strcmp(output.ack + len - 2, "\"}") == 0);
+    }
+    return len;
+}
+
+static void fill(char *text, size_t count, char c) {
+    memset(text, c, count);
+    text[count] = '\0';
+}
+
+static void test_ack(void) {
+    handler_result = "";
+    CHECK(dispatch(BOARD_COMMAND_DIRECT, "@17 echo a b\n", sizeof(output.ack)) > 0);
+    CHECK(strcmp(output.ack, "{\"id\": \"17\", \"command\": \"echo\", \"status\": \"ok\", \"result\": \"a b\"}") == 0);
+
+    CHECK(dispatch(BOARD_COMMAND_DIRECT, "nope", sizeof(output.ack)) > 0);
+    CHECK(strstr(output.ack, "\"command\": \"nope\", \"status\": \"error\", \"result\": \"unknown command\"") != NULL);
+    CHECK(dispatch(BOARD_COMMAND_BROADCAST, "nope *", sizeof(output.ack)) == 0);
+}
+
+// Nieznane polecenie z ~300 znaków '"' - powtarzany jest tylko jego początek
+static void test_oversized_unknown(void) {
+    char text[BOARD_COMMAND_MAX_LEN + 1];
+    fill(text, BOARD_COMMAND_MAX_LEN, '"');
+    CHECK(dispatch(BOARD_COMMAND_DIRECT, text, sizeof(output.ack)) > 0);
+    CHECK(strstr(output.ack, "command too long") != NULL);
+
+    fill(text, 300, '"');
+    CHECK(dispatch(BOARD_COMMAND_DIRECT, text, sizeof(output.ack)) > 0);
+    CHECK(strstr(output.ack, "unknown command") != NULL);
+    CHECK(strlen(output.ack) < 2 * BOARD_COMMAND_ECHO_LEN + 100);
+
+    // Mały bufor: potwierdzenie się nie mieści albo jest kompletne
+    for (size_t capacity = 64; capacity <= sizeof(output.ack); capacity += 7) {
+        dispatch(BOARD_COMMAND_DIRECT, text, capacity);
+    }
+}
+
+// Identyfikator, wynik i argumenty z samych znaków do escapowania
+static void test_escape_heavy(void) {
+    char result[BOARD_COMMAND_RESULT_LEN];
+    fill(result, sizeof(result) - 1, '\\');
+    handler_result = result;
+
+    char text[BOARD_COMMAND_MAX_LEN];
+    size_t len = (size_t)snprintf(text, sizeof(text), "@");
+    memset(text + len, '"', BOARD_COMMAND_ID_LEN);
+    len += BOARD_COMMAND_ID_LEN;
+    len += (size_t)snprintf(text + len, sizeof(text) - len, " echo ");
+    fill(text + len, sizeof(text) - 1 - len, '"');
+
+    for (size_t capacity = 64; capacity <= sizeof(output.ack); capacity++) {
+        dispatch(BOARD_COMMAND_DIRECT, text, capacity);
+    }
+    CHECK(dispatch(BOARD_COMMAND_DIRECT, text, sizeof(output.ack)) > 0);
+    handler_result = "";
+}
+
+static void test_json_append_full(void) {
+    char out[8] = "abcdefg";
+    CHECK(json_append_string(out, sizeof(out), sizeof(out), "x") == sizeof(out));
+    CHECK(json_append_string(out, sizeof(out), sizeof(out) + 5, "x") == sizeof(out) + 5);
+    CHECK(strcmp(out, "abcdefg") == 0);
+}
+
+int main(void) {
+    board_command_init(table, sizeof(table) / sizeof(table[0]), "hall");
+    test_ack();
+    test_oversized_unknown();
+    test_escape_heavy();
+    test_json_append_full();
+    return test_result("board_command_test");
+}
@@ -0,0 +1,124 @@
+// Test device_table: po zapełnieniu tablicy usuwane są najpierw wpisy spoza
+// bieżącego okna, a każdy usuwany wpis, razem ze statystykami okna, trafia do
+// callbacku - żadna obserwacja nie ginie.
+
+#include <stdint.h>
+#include <string.h>
+
+#include "device_table.h"
+#include "test_check.h"
+
+typedef struct {
+    uint32_t all; // Także wpisy spoza okna
+    uint32_t entries;
+    uint32_t sightings;
+    uint8_t last_bda[SIGHTING_BDA_LEN];
+} evicted_t;
+
+static evicted_t evicted;
+
+static void on_evicted(const device_entry_t *entry, void *ctx) {
+    evicted_t *out = ctx;
+    CHECK(entry->used);
+    out->all++;
+    if (entry->count == 0) {
+        return;
+    }
+    out->entries++;
+    out->sightings += entry->count;
+    memcpy(out->last_bda, entry->bda, SIGHTING_BDA_LEN);
+}
+
+static void count_window(const device_entry_t *entry, void *ctx) {
+    *(uint32_t *)ctx += entry->count;
+}
+
+static uint32_t window_sightings(void) {
+    uint32_t sightings = 0;
+    device_table_foreach_in_window(count_window, &sightings);
+    return sightings;
+}
+
+static void update(uint32_t device, int64_t timestamp_us) {
+    ble_sighting_t sighting = {
+        .timestamp_us = timestamp_us,
+        .kind = SIGHTING_KIND_ADV,
+        .bda = {0xC0, 0, 0, (uint8_t)(device >> 16), (uint8_t)(device >> 8), (uint8_t)device},
+        .rssi = -60,
+    };
+    device_table_update(&sighting);
+}
+
+static void setup(void) {
+    device_table_clear();
+    memset(&evicted, 0, sizeof(evicted));
+}
+
+// Urządzenie nowe w oknie wypiera najdawniej widziane spoza okna, bez statystyk w callbacku
+static void test_prefers_outside_window(void) {
+    setup();
+    int64_t now = 0;
+    for (uint32_t device = 0; device < DEVICE_TABLE_MAX_ENTRIES; device++) {
+        update(device, ++now);
+    }
+    device_table_reset_window();
+
+    // Najstarsze urządzenie widziane ponownie - teraz najdawniej widziane jest urządzenie 1
+    update(0, ++now);
+    update(DEVICE_TABLE_MAX_ENTRIES, ++now);
+
+    CHECK(device_table_size() == DEVICE_TABLE_MAX_ENTRIES);
+    CHECK(device_table_evictions() == 1 && device_table_window_evictions() == 0);
+    CHECK(evicted.entries == 0 && evicted.all == 1);
+    uint8_t device_0[SIGHTING_BDA_LEN] = {0xC0, 0, 0, 0, 0, 0};
+    uint8_t device_1[SIGHTING_BDA_LEN] = {0xC0, 0, 0, 0, 0, 1};
+    CHECK(device_table_find(device_0) != NULL);
+    CHECK(device_table_find(device_1) == NULL);
+}
+
+// Gdy wszystkie wpisy są w oknie, usuwany jest najdawniej widziany i trafia do callbacku
+static void test_window_eviction_reported(void) {
+    setup();
+    int64_t now = 0;
+    for (uint32_t device = 0; device < DEVICE_TABLE_MAX_ENTRIES; device++) {
+        update(device, ++now);
+    }
+    update(0, ++now);
+    update(DEVICE_TABLE_MAX_ENTRIES, ++now);
+
+    CHECK(device_table_window_evictions() == 1);
+    CHECK(evicted.entries == 1 && evicted.sightings == 1);
+    uint8_t device_1[SIGHTING_BDA_LEN] = {0xC0, 0, 0, 0, 0, 1};
+    CHECK(memcmp(evicted.last_bda, device_1, SIGHTING_BDA_LEN) == 0);
+}
+
+// Więcej urządzeń w oknie niż miejsca: suma obserwacji z callbacku i z okna jest pełna
+static void test_no_sightings_lost(void) {
+    setup();
+    const uint32_t devices = DEVICE_TABLE_MAX_ENTRIES + DEVICE_TABLE_MAX_ENTRIES / 2;
+    const uint32_t updates = 10 * devices;
+    uint32_t random_state = 1;
+    for (uint32_t i = 0; i < updates; i++) {
+        random_state = random_state * 1664525u + 1013904223u;
+        update((random_state >> 8) % devices, i + 1);
+    }
+
+    CHECK(device_table_size() == DEVICE_TABLE_MAX_ENTRIES);
+    CHECK(evicted.entries == device_table_window_evictions());
+    CHECK(evicted.all == device_table_evictions());
+    CHECK(evicted.sightings + window_sightings() == updates);
+
+    // Wpisy przeżywające koniec okna nie mają już statystyk do zgubienia
+    device_table_reset_window();
+    uint32_t window_evictions = device_table_window_evictions();
+    update(devices, updates + 1);
+    CHECK(device_table_window_evictions() == window_evictions);
+}
+
+int main(void) {
+    device_table_set_evict_callback(on_evicted, &evicted);
+    test_prefers_outside_window();
+    test_window_eviction_reported();
+    test_no_sightings_lost();
+    return test_result("device_table_test");
+}
@@ -0,0 +1,204 @@
+// Test lcd_flush: zapisy do PCF8574 są przechwytywane przez zaślepkę
+// i2c_master_write_to_device, dekodowane do komend HD44780 i wykonywane na
+// modelu pamięci DDRAM wyświetlacza.
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "lcd_i2c.h"
+#include "test_check.h"
+
+#define CAPTURE_CAPACITY 4096
+
+static uint8_t capture[CAPTURE_CAPACITY];
+static size_t capture_length;
+
+void vTaskDelay(TickType_t ticks) {
+    (void)ticks;
+}
+
+esp_err_t i2c_param_config(i2c_port_t port, const i2c_config_t *conf) {
+    (void)port;
+    (void)conf;
+    return ESP_OK;
+}
+
+esp_err_t i2c_driver_install(i2c_port_t port, int mode, size_t rx_buffer_len, size_t tx_buffer_len, int flags) {
+    (void)port;
+    (void)mode;
+    (void)rx_buffer_len;
+    (void)tx_buffer_len;
+    (void)flags;
+    return ESP_OK;
+}
+
+esp_err_t i2c_master_write_to_device(i2c_port_t port, uint8_t address, const uint8_t *data, size_t length,
+                                     TickType_t ticks_to_wait) {
+    (void)port;
+    (void)ticks_to_wait;
+    CHECK(address == LCD_ADDR);
+    for (size_t i = 0; i < length && capture_length < CAPTURE_CAPACITY; i++) {
+        capture[capture_length++] = data[i];
+    }
+    return ESP_OK;
+}
+
+// Model HD44780 po lcd_init: wyczyszczona pamięć, licznik adresu na początku linii 1
+typedef struct {
+    char ddram[0x80];
+    uint8_t address;
+    unsigned commands;
+    unsigned characters;
+    bool home_first; // Pierwszą komendą strumienia był powrót kursora (0x02)
+} display_t;
+
+static display_t display;
+
+static void reset_display(void) {
+    memset(display.ddram, ' ', sizeof(display.ddram));
+    display.address = LCD_LINE_ADDRESS_1;
+}
+
+static void execute(uint8_t value, bool data) {
+    if (data) {
+        display.ddram[display.address] = (char)value;
+        display.address = (display.address + 1) & 0x7F;
+        display.characters++;
+        return;
+    }
+    if (display.commands == 0 && display.characters == 0) {
+        display.home_first = value == 0x02;
+    }
+    display.commands++;
+    if (value & LCD_SET_DDRAM_ADDR) {
+        display.address = value & 0x7F;
+    } else if (value == 0x01 || value == 0x02) {
+        if (value == 0x01) {
+            memset(display.ddram, ' ', sizeof(display.ddram));
+        }
+        display.address = LCD_LINE_ADDRESS_1;
+    }
+    // Przesunięcie ekranu (0x18/0x1C) nie zmienia DDRAM
+}
+
+// Każdy półbajt to dwa zapisy: z ustawionym EN i bez niego (zbocze opadające
+// zatrzaskuje dane); dwa półbajty składają się na bajt HD44780.
+static void decode_capture(void) {
+    display.commands = 0;
+    display.characters = 0;
+    display.home_first = false;
+
+    CHECK(capture_length % 4 == 0);
+    for (size_t i = 0; i + 4 <= capture_length; i += 4) {
+        const uint8_t *w = &capture[i];
+        CHECK((w[0] & LCD_ENABLE) && !(w[1] & LCD_ENABLE));
+        CHECK((w[2] & LCD_ENABLE) && !(w[3] & LCD_ENABLE));
+        CHECK((w[0] | LCD_ENABLE) == (w[1] | LCD_ENABLE) && (w[2] | LCD_ENABLE) == (w[3] | LCD_ENABLE));
+        CHECK((w[1] & LCD_BACKLIGHT) && (w[3] & LCD_BACKLIGHT));
+        CHECK((w[1] & LCD_RS) == (w[3] & LCD_RS));
+
+        uint8_t value = (w[1] & 0xF0) | (w[3] >> 4);
+        execute(value, w[1] & LCD_RS);
+    }
+    capture_length = 0;
+}
+
+static bool display_shows(const char *line1, const char *line2) {
+    char expected[LCD_LINES][LCD_CHARACTERS];
+    memset(expected, ' ', sizeof(expected));
+    memcpy(expected[0], line1, strlen(line1));
+    memcpy(expected[1], line2, strlen(line2));
+    return memcmp(&display.ddram[LCD_LINE_ADDRESS_1], expected[0], LCD_CHARACTERS) == 0 &&
+           memcmp(&display.ddram[LCD_LINE_ADDRESS_2], expected[1], LCD_CHARACTERS) == 0;
+}
+
+static void draw(const char *line1, const char *line2) {
+    lcd_clear();
+    lcd_send_string(line1);
+    lcd_second_line();
+    lcd_send_string(line2);
+}
+
+// Flush z kontrolą liczników: zwraca bajty HD44780 wysłane na wyświetlacz
+static unsigned flush_and_decode(void) {
+    lcd_stats_t before;
+    lcd_stats_t after;
+    lcd_get_stats(&before);
+    lcd_flush();
+    lcd_get_stats(&after);
+
+    CHECK(after.bytes_sent - before.bytes_sent == capture_length);
+    CHECK(after.flushes == before.flushes + 1);
+    // Oszczędność liczona względem pełnego przerysowania nigdy nie jest ujemna
+    CHECK(after.bytes_saved >= before.bytes_saved);
+    CHECK(after.bytes_saved - before.bytes_saved <= LCD_LINES * (1 + LCD_CHARACTERS) * 4);
+
+    decode_capture();
+    return display.commands + display.characters;
+}
+
+static void test_first_flush(void) {
+    draw("WiFi attempt 1", "office-ap");
+    unsigned sent = flush_and_decode();
+
+    CHECK(display_shows("WiFi attempt 1", "office-ap"));
+    // Spacje są już na ekranie: przeskok nad każdą i zmiana linii to komenda adresu
+    CHECK(sent == 4 + (1 + 7) + (1 + 1) + (1 + 9));
+}
+
+static void test_single_digit(void) {
+    draw("WiFi attempt 2", "office-ap");
+    unsigned sent = flush_and_decode();
+
+    CHECK(display_shows("WiFi attempt 2", "office-ap"));
+    CHECK(display.commands == 1 && display.characters == 1);
+    CHECK(sent == 2);
+}
+
+static void test_unchanged(void) {
+    draw("WiFi attempt 2", "office-ap");
+    CHECK(flush_and_decode() == 0);
+}
+
+// Co druga komórka zmieniona na obu liniach: każda wymaga komendy adresu
+static void test_scattered(void) {
+    draw("W F  t e p   2", "o f c - p");
+    unsigned sent = flush_and_decode();
+
+    CHECK(display_shows("W F  t e p   2", "o f c - p"));
+    CHECK(sent <= LCD_LINES * (1 + LCD_CHARACTERS));
+
+    draw("aBcDeFgHiJkLmNoP", "QrStUvWxYz012345");
+    CHECK(flush_and_decode() <= LCD_LINES * (1 + LCD_CHARACTERS));
+    draw("AbCdEfGhIjKlMnOp", "qRsTuVwXyZ012345");
+    CHECK(flush_and_decode() <= LCD_LINES * (1 + LCD_CHARACTERS));
+    CHECK(display_shows("AbCdEfGhIjKlMnOp", "qRsTuVwXyZ012345"));
+}
+
+// Po przewinięciu stan ekranu jest nieznany: powrót kursora i pełne przerysowanie
+static void test_after_scroll(void) {
+    lcd_scroll_left();
+    decode_capture();
+
+    draw("Scanning", "3 devices");
+    unsigned sent = flush_and_decode();
+
+    CHECK(display.home_first);
+    CHECK(display_shows("Scanning", "3 devices"));
+    CHECK(sent == 1 + LCD_CHARACTERS + 1 + LCD_CHARACTERS);
+}
+
+int main(void) {
+    i2c_master_init();
+    lcd_init();
+    capture_length = 0;
+    reset_display();
+
+    test_first_flush();
+    test_single_digit();
+    test_unchanged();
+    test_scattered();
+    test_after_scroll();
+    return test_result("lcd_i2c_test");
+}
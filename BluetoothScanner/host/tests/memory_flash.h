@@ -0,0 +1,61 @@
+#ifndef HOST_TESTS_MEMORY_FLASH_H_
+#define HOST_TESTS_MEMORY_FLASH_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "tag_allowlist.h"
+
+// Obszar flash listy tagów w pamięci dla testów hosta. Zapis jak w NOR flash:
+// bity mogą być tylko zerowane, kasowanie ustawia cały sektor na 0xFF.
+
+#define MEMORY_FLASH_SIZE 0x10000 // Jak partycja "tags" w partitions.csv
+
+typedef struct {
+    uint8_t data[MEMORY_FLASH_SIZE];
+} memory_flash_t;
+
+static inline bool memory_flash_read(void *ctx, size_t offset, void *data, size_t length) {
+    memory_flash_t *flash = ctx;
+    if (offset + length > MEMORY_FLASH_SIZE) {
+        return false;
+    }
+    memcpy(data, flash->data + offset, length);
+    return true;
+}
+
+static inline bool memory_flash_write(void *ctx, size_t offset, const void *data, size_t length) {
+    memory_flash_t *flash = ctx;
+    if (offset + length > MEMORY_FLASH_SIZE) {
+        return false;
+    }
+    const uint8_t *bytes = data;
+    for (size_t i = 0; i < length; i++) {
+        flash->data[offset + i] &= bytes[i];
+    }
+    return true;
+}
+
+static inline bool memory_flash_erase_sector(void *ctx, size_t offset) {
+    memory_flash_t *flash = ctx;
+    if (offset + TAG_ALLOWLIST_SECTOR_SIZE > MEMORY_FLASH_SIZE) {
+        return false;
+    }
+    memset(flash->data + offset, 0xFF, TAG_ALLOWLIST_SECTOR_SIZE);
+    return true;
+}
+
+static inline tag_allowlist_flash_t memory_flash_init(memory_flash_t *flash) {
+    memset(flash->data, 0xFF, sizeof(flash->data));
+    tag_allowlist_flash_t access = {
+        .ctx = flash,
+        .size = MEMORY_FLASH_SIZE,
+        .read = memory_flash_read,
+        .write = memory_flash_write,
+        .erase_sector = memory_flash_erase_sector,
+    };
+    return access;
+}
+
+#endif
@@ -0,0 +1,180 @@
+// Test rssi_filter: filtry stałoprzecinkowe (Q8) porównywane z tymi samymi
+// wzorami w double na sekwencjach RSSI. Dopuszczalny błąd estymaty to
+// ESTIMATE_TOLERANCE dB, wariancji VARIANCE_TOLERANCE dB^2 (zaokrąglenia Q8
+// kumulują się w wariancji wolniej, niż filtr je wygasza).
+
+#include <math.h>
+#include <stdint.h>
+
+#include "rssi_filter.h"
+#include "test_check.h"
+
+#define ESTIMATE_TOLERANCE 0.05
+#define VARIANCE_TOLERANCE 0.1
+#define SEQUENCE_LENGTH 2000
+
+typedef struct {
+    double estimate;
+    double variance;
+    double error;
+    int initialized;
+} reference_filter_t;
+
+static void reference_variance(reference_filter_t *filter, double innovation, double gain) {
+    filter->variance += gain * (innovation * innovation - filter->variance);
+}
+
+static void reference_ema(reference_filter_t *filter, int8_t rssi, double alpha) {
+    if (!filter->initialized) {
+        *filter = (reference_filter_t){rssi, 0, 0, 1};
+        return;
+    }
+    double innovation = rssi - filter->estimate;
+    filter->estimate += alpha * innovation;
+    reference_variance(filter, innovation, alpha);
+}
+
+static void reference_kalman(reference_filter_t *filter, int8_t rssi, double process_noise,
+                             double measurement_noise) {
+    if (!filter->initialized) {
+        *filter = (reference_filter_t){rssi, 0, measurement_noise, 1};
+        return;
+    }
+    double predicted_error = filter->error + process_noise;
+    double gain = predicted_error / (predicted_error + measurement_noise);
+    double innovation = rssi - filter->estimate;
+    filter->estimate += gain * innovation;
+    filter->error = (1 - gain) * predicted_error;
+    reference_variance(filter, innovation, gain);
+}
+
+static double q8(int32_t value) {
+    return (double)value / RSSI_FILTER_ONE;
+}
+
+// P filtru Kalmana jest w Q16
+static double q16(int32_t value) {
+    return (double)value / 65536;
+}
+
+// Sekwencje testowe: stała, skok, naprzemienna i szum wokół wolno zmiennego poziomu
+typedef enum {
+    SEQUENCE_CONSTANT,
+    SEQUENCE_STEP,
+    SEQUENCE_ALTERNATING,
+    SEQUENCE_NOISE,
+    SEQUENCE_COUNT,
+} sequence_t;
+
+static uint32_t random_state;
+
+static int8_t sample(sequence_t sequence, int index) {
+    switch (sequence) {
+    case SEQUENCE_CONSTANT:
+        return -67;
+    case SEQUENCE_STEP:
+        return index < SEQUENCE_LENGTH / 2 ? -85 : -45;
+    case SEQUENCE_ALTERNATING:
+        return index % 2 ? -50 : -90;
+    default: {
+        random_state = random_state * 1664525u + 1013904223u;
+        int level = -70 + (index / 200) % 3 * 10;
+        int noise = (int)(random_state >> 24) % 17 - 8; // -8..8 dB
+        return (int8_t)(level + noise);
+    }
+    }
+}
+
+typedef struct {
+    double estimate;
+    double variance;
+    double error;
+} max_error_t;
+
+static void track(max_error_t *max, const rssi_filter_t *filter, const reference_filter_t *reference) {
+    max->estimate = fmax(max->estimate, fabs(q8(filter->estimate) - reference->estimate));
+    max->variance = fmax(max->variance, fabs(q8(filter->variance) - reference->variance));
+    max->error = fmax(max->error, fabs(q16(filter->error) - reference->error));
+}
+
+static void test_ema(uint8_t alpha_q8) {
+    for (sequence_t sequence = 0; sequence < SEQUENCE_COUNT; sequence++) {
+        rssi_filter_t filter = {0};
+        reference_filter_t reference = {0};
+        max_error_t max = {0};
+        random_state = 1;
+        for (int i = 0; i < SEQUENCE_LENGTH; i++) {
+            int8_t rssi = sample(sequence, i);
+            rssi_filter_ema_update(&filter, rssi, alpha_q8);
+            reference_ema(&reference, rssi, alpha_q8 / 256.0);
+            track(&max, &filter, &reference);
+        }
+        CHECK(max.estimate <= ESTIMATE_TOLERANCE);
+        CHECK(max.variance <= VARIANCE_TOLERANCE);
+    }
+}
+
+static void test_kalman(int32_t process_noise, int32_t measurement_noise) {
+    for (sequence_t sequence = 0; sequence < SEQUENCE_COUNT; sequence++) {
+        rssi_filter_t filter = {0};
+        reference_filter_t reference = {0};
+        max_error_t max = {0};
+        random_state = 1;
+        for (int i = 0; i < SEQUENCE_LENGTH; i++) {
+            int8_t rssi = sample(sequence, i);
+            rssi_filter_kalman_update(&filter, rssi, process_noise, measurement_noise);
+            reference_kalman(&reference, rssi, q8(process_noise), q8(measurement_noise));
+            track(&max, &filter, &reference);
+        }
+        CHECK(max.estimate <= ESTIMATE_TOLERANCE);
+        CHECK(max.variance <= VARIANCE_TOLERANCE);
+        CHECK(max.error <= ESTIMATE_TOLERANCE);
+    }
+}
+
+// Wektor policzony ręcznie: alpha = 0.25, próbki -60, -64, -64
+static void test_ema_vector(void) {
+    rssi_filter_t filter = {0};
+    rssi_filter_ema_update(&filter, -60, 64);
+    CHECK(filter.estimate == -60 * RSSI_FILTER_ONE && filter.variance == 0);
+
+    rssi_filter_ema_update(&filter, -64, 64);
+    CHECK(filter.estimate == -61 * RSSI_FILTER_ONE);     // -60 + 0.25 * -4
+    CHECK(filter.variance == 4 * RSSI_FILTER_ONE);       // 0.25 * 16
+    CHECK(rssi_filter_rssi(&filter) == -61);
+
+    rssi_filter_ema_update(&filter, -64, 64);
+    CHECK(filter.estimate == -61 * RSSI_FILTER_ONE - 3 * RSSI_FILTER_ONE / 4);  // -61.75
+    CHECK(filter.variance == 5 * RSSI_FILTER_ONE + RSSI_FILTER_ONE / 4);        // 4 + 0.25 * (9 - 4)
+    CHECK(rssi_filter_rssi(&filter) == -62);
+    CHECK(rssi_filter_rssi_tenths(&filter) == -618);
+    CHECK(rssi_filter_variance_tenths(&filter) == 53);
+}
+
+// Przy stałych szumach P zbiega do rozwiązania P^2 + Q P - Q R = 0
+static void test_kalman_steady_state(void) {
+    const double q = 0.25;
+    const double r = 16;
+    rssi_filter_t filter = {0};
+    for (int i = 0; i < 500; i++) {
+        rssi_filter_kalman_update(&filter, -70, (int32_t)(q * RSSI_FILTER_ONE), (int32_t)(r * RSSI_FILTER_ONE));
+    }
+    double steady = (-q + sqrt(q * q + 4 * q * r)) / 2;
+    CHECK(fabs(q16(filter.error) - steady) <= ESTIMATE_TOLERANCE);
+    CHECK(filter.estimate == -70 * RSSI_FILTER_ONE && filter.variance == 0);
+}
+
+int main(void) {
+    test_ema_vector();
+    test_kalman_steady_state();
+
+    // Domyślne z Kconfig: alpha 64, szum procesu 0.25 dB^2 i pomiaru 16 dB^2 (Q8: 64 i 4096)
+    const uint8_t alphas[] = {16, 64, 128, 230};
+    for (size_t i = 0; i < sizeof(alphas) / sizeof(alphas[0]); i++) {
+        test_ema(alphas[i]);
+    }
+    test_kalman(64, 4096);
+    test_kalman(16, 1024);
+    test_kalman(256, 256);
+    return test_result("rssi_filter_test");
+}
@@ -0,0 +1,288 @@
+// Test scan_filter: kompilacja reguł z tekstu (NVS, /boards_command, TLV z GATT),
+// komunikaty błędów, ocena zdarzeń każdym rodzajem reguły i liczniki trafień.
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "memory_flash.h"
+#include "scan_filter.h"
+#include "tag_allowlist.h"
+#include "test_check.h"
+
+static const uint8_t BDA[SIGHTING_BDA_LEN] = {0xAA, 0xBB, 0xCC, 0x11, 0x22, 0x33};
+static const uint8_t OTHER_BDA[SIGHTING_BDA_LEN] = {0x10, 0x20, 0x30, 0x40, 0x50, 0x60};
+
+// Reklama: nazwa "Mi Tag 7", UUID16 0xFEAA, UUID32 0x1234FEAA, firma 0x004C
+static const uint8_t ADV[] = {
+    0x02, ADV_TYPE_FLAGS, 0x06,
+    0x09, ADV_TYPE_NAME_COMPLETE, 'M', 'i', ' ', 'T', 'a', 'g', ' ', '7',
+    0x03, ADV_TYPE_UUID16_COMPLETE, 0xAA, 0xFE,
+    0x05, ADV_TYPE_UUID32_COMPLETE, 0xAA, 0xFE, 0x34, 0x12,
+    0x05, ADV_TYPE_MANUFACTURER, 0x4C, 0x00, 0x02, 0x15,
+};
+
+// Odpowiedź na skanowanie: UUID128 0000feaa-0000-1000-8000-00805f9b34fb jako dane usługi
+static const uint8_t SCAN_RSP[] = {
+    0x13, ADV_TYPE_SERVICE_DATA128,
+    0xFB, 0x34, 0x9B, 0x5F, 0x80, 0x00, 0x00, 0x80, 0x00, 0x10, 0x00, 0x00, 0xAA, 0xFE, 0x00, 0x00,
+    0x01, 0x02,
+};
+
+static uint8_t data[sizeof(ADV) + sizeof(SCAN_RSP)];
+static adv_fields_t fields;
+
+static scan_filter_event_t make_event(const uint8_t *bda, uint8_t addr_type, int8_t rssi, bool with_data) {
+    memcpy(data, ADV, sizeof(ADV));
+    memcpy(data + sizeof(ADV), SCAN_RSP, sizeof(SCAN_RSP));
+    scan_filter_event_t event = {
+        .bda = bda,
+        .addr_type = addr_type,
+        .rssi = rssi,
+        .data = data,
+        .adv_len = with_data ? sizeof(ADV) : 0,
+        .scan_rsp_len = with_data ? sizeof(SCAN_RSP) : 0,
+        .fields = &fields,
+    };
+    return event;
+}
+
+static bool accepts(const char *rules, const uint8_t *bda, uint8_t addr_type, int8_t rssi, bool with_data) {
+    scan_filter_t filter;
+    char error[64] = "";
+    if (!scan_filter_compile(rules, &filter, error, sizeof(error))) {
+        fprintf(stderr, "'%s': %s\n", rules, error);
+        CHECK(false);
+        return false;
+    }
+    scan_filter_install(&filter);
+    scan_filter_event_t event = make_event(bda, addr_type, rssi, with_data);
+    return scan_filter_accept(&event);
+}
+
+// Reguła pasuje, gdy przy "include X; default exclude" zdarzenie jest przyjęte
+static bool matches(const char *rule, const uint8_t *bda, uint8_t addr_type, int8_t rssi, bool with_data) {
+    char rules[128];
+    snprintf(rules, sizeof(rules), "include %s; default exclude", rule);
+    return accepts(rules, bda, addr_type, rssi, with_data);
+}
+
+static bool match_default(const char *rule) {
+    return matches(rule, BDA, 0, -60, true);
+}
+
+static void check_error(const char *rules, const char *expected) {
+    scan_filter_t filter;
+    char error[64] = "";
+    CHECK(!scan_filter_compile(rules, &filter, error, sizeof(error)));
+    if (strcmp(error, expected) != 0) {
+        fprintf(stderr, "'%s': got '%s', expected '%s'\n", rules, error, expected);
+        CHECK(false);
+    }
+}
+
+static void test_address_rules(void) {
+    CHECK(match_default("mac aa"));
+    CHECK(match_default("mac AA:bb:cc:11:22:33"));
+    CHECK(match_default("mac aa-bb-cc"));
+    CHECK(match_default("mac aabbcc1122"));
+    CHECK(!match_default("mac aa:bb:cd"));
+    CHECK(!matches("mac aa:bb", OTHER_BDA, 0, -60, true));
+    CHECK(match_default("oui aa:bb:cc"));
+    CHECK(!matches("oui aa:bb:cc", OTHER_BDA, 0, -60, true));
+
+    CHECK(matches("addr_type public", BDA, 0, -60, false));
+    CHECK(matches("addr_type random", BDA, 1, -60, false));
+    CHECK(matches("addr_type rpa_public", BDA, 2, -60, false));
+    CHECK(matches("addr_type rpa_random", BDA, 3, -60, false));
+    CHECK(matches("addr_type 1", BDA, 1, -60, false));
+    CHECK(!matches("addr_type random", BDA, 0, -60, false));
+
+    CHECK(matches("rssi_min -70", BDA, 0, -70, false));
+    CHECK(!matches("rssi_min -70", BDA, 0, -71, false));
+    CHECK(matches("rssi_max -90", BDA, 0, -90, false));
+    CHECK(!matches("rssi_max -90", BDA, 0, -89, false));
+    CHECK(matches("rssi_min -128", BDA, 0, -128, false));
+}
+
+static void test_registered(void) {
+    static memory_flash_t area;
+    tag_allowlist_flash_t flash = memory_flash_init(&area);
+    CHECK(tag_allowlist_init(&flash, 16, 10000, true));
+
+    // Pusta lista nie zawiera żadnego adresu
+    CHECK(!match_default("registered"));
+
+    CHECK(tag_allowlist_begin(1));
+    CHECK(tag_allowlist_append(BDA, sizeof(BDA)));
+    CHECK(tag_allowlist_commit());
+    CHECK(match_default("registered"));
+    CHECK(!matches("registered", OTHER_BDA, 0, -60, true));
+}
+
+static void test_data_rules(void) {
+    CHECK(match_default("named"));
+    CHECK(!matches("named", BDA, 0, -60, false));
+    CHECK(match_default("name_prefix Mi"));
+    CHECK(match_default("name_prefix Mi Tag 7"));
+    CHECK(!match_default("name_prefix Tag"));
+    CHECK(!match_default("name_prefix Mi Tag 77"));
+    CHECK(match_default("name_contains Tag"));
+    CHECK(match_default("name_contains 7"));
+    CHECK(!match_default("name_contains tag"));
+
+    // UUID zapisywane big-endian, w danych reklamy little-endian
+    CHECK(match_default("uuid16 feaa"));
+    CHECK(match_default("uuid16 FE:AA"));
+    CHECK(!match_default("uuid16 aafe"));
+    CHECK(match_default("uuid32 1234feaa"));
+    CHECK(!match_default("uuid32 0000feaa"));
+    CHECK(match_default("uuid128 0000feaa-0000-1000-8000-00805f9b34fb"));
+    CHECK(!match_default("uuid128 fb349b5f-8000-0080-0010-0000aafe0000"));
+
+    CHECK(match_default("company 0x004c"));
+    CHECK(match_default("company 76"));
+    CHECK(!match_default("company 0x4c00"));
+}
+
+// Reguły adresowe nie wymagają parsowania reklamy
+static void test_lazy_parse(void) {
+    scan_filter_t filter;
+    char error[64];
+    CHECK(scan_filter_compile("exclude rssi_max -90; include oui aa:bb:cc; include named", &filter, error,
+                              sizeof(error)));
+    scan_filter_install(&filter);
+
+    scan_filter_event_t event = make_event(BDA, 0, -60, true);
+    CHECK(scan_filter_accept(&event) && !event.parsed);
+    event = make_event(OTHER_BDA, 0, -60, true);
+    CHECK(scan_filter_accept(&event) && event.parsed);
+    CHECK(scan_filter_event_fields(&event)->name.len == 8);
+}
+
+static void test_default_action(void) {
+    scan_filter_t filter;
+    char error[64];
+
+    // Lista zaczynająca się od include działa jak lista dozwolonych
+    CHECK(scan_filter_compile("include named", &filter, error, sizeof(error)));
+    CHECK(filter.count == 1 && filter.default_action == SCAN_FILTER_EXCLUDE);
+    CHECK(scan_filter_compile("exclude rssi_max -90; include named", &filter, error, sizeof(error)));
+    CHECK(filter.default_action == SCAN_FILTER_INCLUDE);
+    CHECK(scan_filter_compile("", &filter, error, sizeof(error)));
+    CHECK(filter.count == 0 && filter.default_action == SCAN_FILTER_INCLUDE);
+    CHECK(scan_filter_compile(" ;\n; ", &filter, error, sizeof(error)));
+    CHECK(filter.count == 0);
+    CHECK(scan_filter_compile("include named; default include", &filter, error, sizeof(error)));
+    CHECK(filter.default_action == SCAN_FILTER_INCLUDE);
+    CHECK(scan_filter_compile("default exclude", &filter, error, sizeof(error)));
+    CHECK(filter.count == 0 && filter.default_action == SCAN_FILTER_EXCLUDE);
+
+    CHECK(!accepts("include named", BDA, 0, -60, false));
+    CHECK(accepts("exclude named", BDA, 0, -60, false));
+    CHECK(!accepts("exclude named", BDA, 0, -60, true));
+
+    // Domyślne reguły firmware
+    CHECK(scan_filter_compile(SCAN_FILTER_DEFAULT_RULES, &filter, error, sizeof(error)));
+    CHECK(filter.count == 1 && filter.rules[0].kind == SCAN_FILTER_NAMED);
+}
+
+static void test_errors(void) {
+    check_error("include", "rule 1: expected '<action> <kind> [value]'");
+    check_error("allow named", "rule 1: unknown action");
+    check_error("include nam", "rule 1: unknown kind");
+    check_error("default maybe", "rule 1: expected 'default include|exclude'");
+    check_error("default include now", "rule 1: expected 'default include|exclude'");
+    check_error("include named; include named x", "rule 2: unexpected value");
+    check_error("include registered yes", "rule 1: unexpected value");
+
+    // Niepoprawny zapis szesnastkowy i nieparzysta liczba cyfr
+    check_error("include mac", "rule 1: invalid address prefix");
+    check_error("include mac zz", "rule 1: invalid address prefix");
+    check_error("include mac abc", "rule 1: invalid address prefix");
+    check_error("include mac a:bc", "rule 1: invalid address prefix");
+    check_error("include mac aa:bb:cc:dd:ee:ff:00", "rule 1: invalid address prefix");
+    check_error("include oui aa:bb", "rule 1: invalid address prefix");
+    check_error("include uuid16 fea", "rule 1: invalid UUID");
+    check_error("include uuid16 feaa01", "rule 1: invalid UUID");
+    check_error("include uuid32 feaa", "rule 1: invalid UUID");
+    check_error("include uuid128 0000feaa-0000-1000-8000-00805f9b34f", "rule 1: invalid UUID");
+    check_error("include uuid128 0000feaa-0000-1000-8000-00805f9b34fb00", "rule 1: invalid UUID");
+
+    check_error("include addr_type 4", "rule 1: invalid address type");
+    check_error("include addr_type static", "rule 1: invalid address type");
+    check_error("include rssi_min -129", "rule 1: invalid RSSI threshold");
+    check_error("include rssi_max 128", "rule 1: invalid RSSI threshold");
+    check_error("include rssi_min -70dB", "rule 1: invalid RSSI threshold");
+    check_error("include company 0x10000", "rule 1: invalid company ID");
+    check_error("include company apple", "rule 1: invalid company ID");
+    check_error("include name_prefix", "rule 1: name must be 1-16 characters");
+    check_error("include name_contains 12345678901234567", "rule 1: name must be 1-16 characters");
+
+    // Reguła dłuższa niż RULE_TEXT_MAX_LEN
+    char rules[512];
+    snprintf(rules, sizeof(rules), "include named; exclude name_contains %080d", 0);
+    check_error(rules, "rule 2: rule too long");
+
+    // SCAN_FILTER_MAX_RULES reguł jest poprawne, jedna więcej już nie
+    size_t len = 0;
+    for (int i = 0; i < SCAN_FILTER_MAX_RULES; i++) {
+        len += (size_t)snprintf(rules + len, sizeof(rules) - len, "exclude rssi_max %d;", -100 + i);
+    }
+    scan_filter_t filter;
+    char error[64];
+    CHECK(scan_filter_compile(rules, &filter, error, sizeof(error)));
+    CHECK(filter.count == SCAN_FILTER_MAX_RULES);
+    snprintf(rules + len, sizeof(rules) - len, "default exclude\ninclude named");
+    char expected[64];
+    snprintf(expected, sizeof(expected), "rule %d: too many rules", SCAN_FILTER_MAX_RULES + 2);
+    check_error(rules, expected);
+
+    // Opis błędu jest obcinany do bufora
+    CHECK(!scan_filter_compile("include nam", &filter, error, 8));
+    CHECK(strcmp(error, "rule 1:") == 0);
+}
+
+static void test_hits(void) {
+    scan_filter_t filter;
+    char error[64];
+    CHECK(scan_filter_compile("exclude rssi_max -90; include named; default exclude", &filter, error,
+                              sizeof(error)));
+    scan_filter_install(&filter);
+
+    scan_filter_event_t event;
+    for (int i = 0; i < 3; i++) {
+        event = make_event(BDA, 0, -95, true);
+        CHECK(!scan_filter_accept(&event));
+    }
+    for (int i = 0; i < 2; i++) {
+        event = make_event(BDA, 0, -60, true);
+        CHECK(scan_filter_accept(&event));
+    }
+    event = make_event(BDA, 0, -60, false);
+    CHECK(!scan_filter_accept(&event));
+
+    uint32_t hits[SCAN_FILTER_MAX_RULES];
+    uint32_t default_hits = 0;
+    CHECK(scan_filter_get_hits(hits, SCAN_FILTER_MAX_RULES, &default_hits) == 2);
+    CHECK(hits[0] == 3 && hits[1] == 2 && default_hits == 1);
+    CHECK(scan_filter_get_hits(hits, 1, &default_hits) == 1 && hits[0] == 3);
+
+    // Nowe reguły zerują liczniki przy następnym zdarzeniu
+    scan_filter_install(&filter);
+    event = make_event(BDA, 0, -60, true);
+    scan_filter_accept(&event);
+    CHECK(scan_filter_get_hits(hits, SCAN_FILTER_MAX_RULES, &default_hits) == 2);
+    CHECK(hits[0] == 0 && hits[1] == 1 && default_hits == 0);
+}
+
+int main(void) {
+    test_address_rules();
+    test_registered();
+    test_data_rules();
+    test_lazy_parse();
+    test_default_action();
+    test_errors();
+    test_hits();
+    return test_result("scan_filter_test");
+}
@@ -0,0 +1,132 @@
+// Test sighting_format: nazwy urządzeń i płytki z '"' i '\' muszą dawać
+// poprawny JSON we wszystkich formatach tekstowych.
+
+#include <stdbool.h>
+#include <string.h>
+
+#include "json_string.h"
+#include "sighting_format.h"
+#include "test_check.h"
+
+#define AWKWARD_NAME "Tag \"A\" \\ 1"
+#define AWKWARD_NAME_JSON "Tag \\\"A\\\" \\\\ 1"
+
+static device_entry_t make_entry(const char *name) {
+    device_entry_t entry;
+    memset(&entry, 0, sizeof(entry));
+    entry.used = true;
+    memcpy(entry.bda, "\xC0\x11\x22\x33\x44\x55", SIGHTING_BDA_LEN);
+    snprintf(entry.name, sizeof(entry.name), "%s", name);
+    entry.first_seen_us = 1000;
+    entry.last_seen_us = 2000;
+    entry.count = 1;
+    entry.rssi_min = -60;
+    entry.rssi_max = -60;
+    entry.rssi_sum = -60;
+    rssi_filter_seed(&entry.rssi_filter, -60);
+    return entry;
+}
+
+// Napisy zamknięte i nawiasy zrównoważone poza napisami
+static bool json_well_formed(const char *text) {
+    int depth = 0;
+    bool in_string = false;
+    for (const char *c = text; *c; c++) {
+        if (in_string) {
+            if (*c == '\\') {
+                if (c[1] != '"' && c[1] != '\\') {
+                    return false;
+                }
+                c++;
+            } else if (*c == '"') {
+                in_string = false;
+            } else if ((unsigned char)*c < 0x20) {
+                return false;
+            }
+            continue;
+        }
+        if (*c == '"') {
+            in_string = true;
+        } else if (*c == '{' || *c == '[') {
+            depth++;
+        } else if (*c == '}' || *c == ']') {
+            if (--depth < 0) {
+                return false;
+            }
+        }
+    }
+    return !in_string && depth == 0;
+}
+
+static void test_json_string(void) {
+    char out[16];
+    CHECK(json_append_string(out, sizeof(out), 0, "a\"b\\c\n") == 8);
+    CHECK(strcmp(out, "a\\\"b\\\\c ") == 0);
+    CHECK(json_string_length("a\"b\\c\n") == 8);
+
+    // Obcięcie nie rozdziela sekwencji ucieczki
+    CHECK(json_append_string(out, 6, 0, "ab\"\"") == 4);
+    CHECK(strcmp(out, "ab\\\"") == 0);
+}
+
+static void test_device_json(void) {
+    char buffer[512];
+    device_entry_t entry = make_entry(AWKWARD_NAME);
+    size_t length = sighting_format_device_json(&entry, buffer, sizeof(buffer));
+    CHECK(length > 0 && length == strlen(buffer));
+    CHECK(strstr(buffer, "\"name\": \"" AWKWARD_NAME_JSON "\"") != NULL);
+    CHECK(json_well_formed(buffer));
+
+    // Nazwa złożona z samych znaków do escapowania mieści się w pełnej długości
+    char quotes[SIGHTING_NAME_MAX_LEN];
+    memset(quotes, '"', sizeof(quotes) - 1);
+    quotes[sizeof(quotes) - 1] = '\0';
+    entry = make_entry(quotes);
+    length = sighting_format_device_json(&entry, buffer, sizeof(buffer));
+    CHECK(length > 0 && json_well_formed(buffer));
+    CHECK(json_string_length(entry.name) == 2 * strlen(entry.name));
+    CHECK(strstr(buffer, "\\\"\", \"address\"") != NULL);
+
+    CHECK(sighting_format_device_json(&entry, buffer, 40) == 0);
+}
+
+static void test_presence_json(void) {
+    char buffer[512];
+    device_entry_t entry = make_entry(AWKWARD_NAME);
+    size_t length = sighting_format_presence_json("enter", &entry, 5000, buffer, sizeof(buffer));
+    CHECK(length > 0);
+    CHECK(strstr(buffer, "\"name\": \"" AWKWARD_NAME_JSON "\"") != NULL);
+    CHECK(json_well_formed(buffer));
+}
+
+static void test_batch(void) {
+    char buffer[1024];
+    sighting_batch_t batch;
+    device_entry_t entries[2] = {make_entry(AWKWARD_NAME), make_entry("plain")};
+
+    sighting_batch_begin(&batch, SIGHTING_PAYLOAD_JSON, buffer, sizeof(buffer), "hall \"b\"", 1000);
+    CHECK(sighting_batch_add(&batch, &entries[0]));
+    CHECK(sighting_batch_add(&batch, &entries[1]));
+    size_t length = sighting_batch_finish(&batch);
+    CHECK(length == strlen(buffer));
+    CHECK(strncmp(buffer, "{\"board\": \"hall \\\"b\\\"\", \"timestamp_ms\": ", 40) == 0);
+    CHECK(strstr(buffer, AWKWARD_NAME_JSON) != NULL);
+    CHECK(json_well_formed(buffer));
+
+    sighting_batch_begin(&batch, SIGHTING_PAYLOAD_PRESENCE_JSON, buffer, sizeof(buffer), "\\", 1000);
+    CHECK(sighting_batch_add(&batch, &entries[0]));
+    sighting_batch_finish(&batch);
+    CHECK(json_well_formed(buffer));
+
+    // Nagłówek, który się nie mieści
+    sighting_batch_begin(&batch, SIGHTING_PAYLOAD_JSON, buffer, 20, "hall \"b\"", 1000);
+    CHECK(batch.length == 0);
+}
+
+int main(void) {
+    test_json_string();
+    test_device_json();
+    test_presence_json();
+    test_batch();
+    return test_result("sighting_format_test");
+}
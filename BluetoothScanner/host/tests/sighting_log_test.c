@@ -0,0 +1,252 @@
+// Test dziennika obserwacji (main/sighting_log.h) na obszarze flash w pliku: zawinięcie
+// pierścienia, przerwany zapis ostatniego rekordu i kolejność odtwarzania, także po
+// ponownym sighting_log_init (restart płytki).
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "sighting_log.h"
+#include "test_check.h"
+
+// Plik udający NOR flash: kasowanie ustawia 0xFF, zapis może tylko zerować bity.
+// torn_budget >= 0 przerywa zapis po tylu bajtach, jak utrata zasilania.
+typedef struct {
+    FILE *file;
+    size_t size;
+    long torn_budget;
+} file_flash_t;
+
+static bool file_read(void *ctx, size_t offset, void *data, size_t length) {
+    file_flash_t *flash = ctx;
+    return offset + length <= flash->size && fseek(flash->file, (long)offset, SEEK_SET) == 0 &&
+           fread(data, 1, length, flash->file) == length;
+}
+
+static bool file_write(void *ctx, size_t offset, const void *data, size_t length) {
+    file_flash_t *flash = ctx;
+    uint8_t current[SIGHTING_LOG_SECTOR_SIZE];
+    if (length > sizeof(current) || !file_read(ctx, offset, current, length)) {
+        return false;
+    }
+    bool torn = flash->torn_budget >= 0 && (size_t)flash->torn_budget < length;
+    size_t written = torn ? (size_t)flash->torn_budget : length;
+    const uint8_t *bytes = data;
+    for (size_t i = 0; i < written; i++) {
+        current[i] &= bytes[i];
+    }
+    if (fseek(flash->file, (long)offset, SEEK_SET) != 0 || fwrite(current, 1, written, flash->file) != written) {
+        return false;
+    }
+    fflush(flash->file);
+    return !torn;
+}
+
+static bool file_erase_sector(void *ctx, size_t offset) {
+    file_flash_t *flash = ctx;
+    uint8_t erased[SIGHTING_LOG_SECTOR_SIZE];
+    memset(erased, 0xFF, sizeof(erased));
+    return offset + SIGHTING_LOG_SECTOR_SIZE <= flash->size && fseek(flash->file, (long)offset, SEEK_SET) == 0 &&
+           fwrite(erased, 1, sizeof(erased), flash->file) == sizeof(erased);
+}
+
+static file_flash_t backing;
+
+// Nowy, wyczyszczony obszar; stan jak po `parttool.py erase_partition`
+static void open_area(uint32_t sectors) {
+    if (backing.file) {
+        fclose(backing.file);
+    }
+    backing.file = tmpfile();
+    backing.size = (size_t)sectors * SIGHTING_LOG_SECTOR_SIZE;
+    backing.torn_budget = -1;
+    for (uint32_t sector = 0; sector < sectors; sector++) {
+        file_erase_sector(&backing, (size_t)sector * SIGHTING_LOG_SECTOR_SIZE);
+    }
+}
+
+// Restart: stan dziennika odtwarzany wyłącznie z zawartości pliku
+static bool reboot(void) {
+    sighting_log_flash_t flash = {
+        .ctx = &backing,
+        .size = backing.size,
+        .read = file_read,
+        .write = file_write,
+        .erase_sector = file_erase_sector,
+    };
+    return sighting_log_init(&flash, 0);
+}
+
+static void make_record(uint32_t index, sighting_log_record_t *record) {
+    memset(record, 0, sizeof(*record));
+    record->window_start_us = 1700000000000000LL + (int64_t)(index / 4) * 10000000;
+    record->last_seen_us = record->window_start_us + (int64_t)(index % 4) * 1000;
+    record->flags = index % 2 ? SIGHTING_LOG_FLAG_EPOCH : 0;
+    record->boot_id = (uint16_t)(0xB000 + index);
+    for (int i = 0; i < SIGHTING_BDA_LEN; i++) {
+        record->bda[i] = (uint8_t)(index >> (8 * (i % 4)));
+    }
+    record->addr_type = (uint8_t)(index % 4);
+    record->rssi = (int8_t)(-40 - (int)(index % 50));
+    record->rssi_min = (int8_t)(record->rssi - 3);
+    record->rssi_max = (int8_t)(record->rssi + 3);
+    record->count = (uint16_t)(index + 1);
+    record->name_len = (uint8_t)snprintf(record->name, sizeof(record->name), "dev%u", (unsigned)index);
+}
+
+static bool same_record(const sighting_log_record_t *a, const sighting_log_record_t *b) {
+    return a->window_start_us == b->window_start_us && a->last_seen_us == b->last_seen_us &&
+           a->flags == b->flags && a->boot_id == b->boot_id && memcmp(a->bda, b->bda, SIGHTING_BDA_LEN) == 0 &&
+           a->addr_type == b->addr_type && a->rssi == b->rssi && a->rssi_min == b->rssi_min &&
+           a->rssi_max == b->rssi_max && a->count == b->count && a->name_len == b->name_len &&
+           strcmp(a->name, b->name) == 0;
+}
+
+static void append_range(uint32_t first, uint32_t end) {
+    sighting_log_record_t record;
+    for (uint32_t index = first; index < end; index++) {
+        make_record(index, &record);
+        CHECK(sighting_log_append(&record));
+    }
+}
+
+// Zdejmuje z dziennika wszystkie rekordy i sprawdza, że są kolejnymi rekordami od first.
+// Zwraca indeks za ostatnim odczytanym rekordem.
+static uint32_t replay_all(uint32_t first, size_t batch) {
+    sighting_log_record_t records[SIGHTING_LOG_PEEK_MAX];
+    sighting_log_record_t expected;
+    uint32_t next = first;
+    size_t count;
+    while ((count = sighting_log_peek(records, batch)) > 0) {
+        for (size_t i = 0; i < count; i++) {
+            make_record(next, &expected);
+            CHECK(same_record(&records[i], &expected));
+            next++;
+        }
+        sighting_log_consume(count);
+    }
+    CHECK(sighting_log_empty());
+    return next;
+}
+
+static void test_replay_order(void) {
+    open_area(4);
+    CHECK(reboot());
+    append_range(0, 300); // Ponad dwa sektory
+
+    // Częściowe potwierdzenie: niepotwierdzone rekordy wracają przy kolejnym peek
+    sighting_log_record_t records[SIGHTING_LOG_PEEK_MAX];
+    sighting_log_record_t expected;
+    CHECK(sighting_log_peek(records, 16) == 16);
+    sighting_log_consume(10);
+    CHECK(sighting_log_peek(records, 4) == 4);
+    make_record(10, &expected);
+    CHECK(same_record(&records[0], &expected));
+
+    // Potwierdzone rekordy nie wracają po restarcie
+    CHECK(reboot());
+    sighting_log_stats_t stats;
+    sighting_log_get_stats(&stats);
+    CHECK(stats.pending == 290);
+    CHECK(stats.corrupted == 0);
+    CHECK(replay_all(10, 7) == 300);
+
+    // Nowe rekordy po restarcie trafiają za stare
+    append_range(300, 320);
+    CHECK(reboot());
+    CHECK(replay_all(300, SIGHTING_LOG_PEEK_MAX) == 320);
+    CHECK(reboot());
+    CHECK(sighting_log_empty());
+}
+
+static void test_wrap_around(void) {
+    open_area(3);
+    CHECK(reboot());
+    const uint32_t total = 2000; // Kilka obiegów pierścienia
+    append_range(0, total);
+
+    sighting_log_stats_t stats;
+    sighting_log_get_stats(&stats);
+    CHECK(stats.appended == total);
+    CHECK(stats.dropped_oldest > 0);
+    CHECK(stats.pending + stats.dropped_oldest == total);
+    CHECK(stats.pending > SIGHTING_LOG_SECTOR_SIZE / 64); // Co najmniej jeden pełny sektor
+
+    // Zostają najnowsze rekordy, w kolejności zapisu, także po restarcie
+    uint32_t first = total - stats.pending;
+    CHECK(reboot());
+    sighting_log_get_stats(&stats);
+    CHECK(stats.pending == total - first);
+    CHECK(replay_all(first, SIGHTING_LOG_PEEK_MAX) == total);
+
+    // Zawinięcie przy częściowo wysłanym dzienniku
+    append_range(total, total + 150);
+    sighting_log_record_t records[SIGHTING_LOG_PEEK_MAX];
+    size_t count = sighting_log_peek(records, 5);
+    sighting_log_consume(count);
+    append_range(total + 150, total + 600);
+    sighting_log_get_stats(&stats);
+    first = total + 600 - stats.pending;
+    CHECK(first > total + 5);
+    CHECK(replay_all(first, 9) == total + 600);
+}
+
+static void test_torn_tail(void) {
+    open_area(3);
+    CHECK(reboot());
+    append_range(0, 20);
+
+    // Zasilanie znika w trakcie zapisu rekordu 20 - zapisane są tylko długość i stan
+    backing.torn_budget = 2;
+    sighting_log_record_t record;
+    make_record(20, &record);
+    CHECK(!sighting_log_append(&record));
+    backing.torn_budget = -1;
+
+    CHECK(reboot());
+    sighting_log_stats_t stats;
+    sighting_log_get_stats(&stats);
+    CHECK(stats.pending == 20);
+    CHECK(stats.corrupted == 1);
+
+    // Zapis po restarcie omija uszkodzony rekord, odtwarzanie też
+    append_range(21, 30);
+    CHECK(reboot());
+    sighting_log_record_t records[SIGHTING_LOG_PEEK_MAX];
+    sighting_log_record_t expected;
+    uint32_t next = 0;
+    size_t count;
+    while ((count = sighting_log_peek(records, SIGHTING_LOG_PEEK_MAX)) > 0) {
+        for (size_t i = 0; i < count; i++) {
+            if (next == 20) {
+                next++;
+            }
+            make_record(next++, &expected);
+            CHECK(same_record(&records[i], &expected));
+        }
+        sighting_log_consume(count);
+    }
+    CHECK(next == 30);
+
+    // Zapis przerwany w danych rekordu, po kilku pełnych sektorach
+    append_range(100, 220);
+    backing.torn_budget = 10;
+    make_record(220, &record);
+    sighting_log_append(&record);
+    backing.torn_budget = -1;
+    CHECK(reboot());
+    append_range(221, 230);
+    sighting_log_get_stats(&stats);
+    CHECK(stats.pending == 129);
+    CHECK(stats.corrupted == 2); // Oba przerwane zapisy są jeszcze w pierścieniu
+    CHECK(sighting_log_peek(records, 1) == 1);
+    make_record(100, &expected);
+    CHECK(same_record(&records[0], &expected));
+}
+
+int main(void) {
+    test_replay_order();
+    test_wrap_around();
+    test_torn_tail();
+    return test_result("sighting_log_test");
+}
@@ -0,0 +1,70 @@
+// Test sighting_parser agregatora: wiadomości z /+/devices z dowolnie głębokim
+// zagnieżdżeniem są odrzucane bez przepełnienia stosu i liczone w stats().rejected.
+
+#include <string>
+#include <vector>
+
+#include "aggregator.h"
+#include "sighting_parser.h"
+#include "test_check.h"
+
+using namespace aggregator;
+
+static const char DEVICE[] = "{\"address\": \"aa:bb:cc:dd:ee:01\", \"rssi\": -61, \"timestamp_us\": 1000}";
+
+static std::string nested(size_t depth, const std::string &inner) {
+    return std::string(depth, '[') + inner + std::string(depth, ']');
+}
+
+static void test_batch() {
+    std::vector<sighting> out;
+    std::string batch = std::string("{\"board\": \"hall\", \"timestamp_ms\": 1, \"devices\": [") + DEVICE + "]}";
+    CHECK(parse_devices_json(batch, out));
+    CHECK(out.size() == 1 && out[0].address == 0xaabbccddee01 && out[0].rssi == -61 && out[0].timestamp_us == 1000);
+}
+
+static void test_depth_limit() {
+    std::vector<sighting> out;
+    // Obiekt urządzenia to jeden poziom
+    CHECK(parse_devices_json(nested(JSON_MAX_DEPTH - 1, DEVICE), out));
+    CHECK(out.size() == 1);
+    CHECK(!parse_devices_json(nested(JSON_MAX_DEPTH, DEVICE), out));
+    CHECK(out.size() == 1);
+
+    CHECK(parse_devices_json(nested(JSON_MAX_DEPTH, ""), out));
+    CHECK(!parse_devices_json(nested(JSON_MAX_DEPTH + 1, ""), out));
+
+    // Kilkaset KB nawiasów - bez zamknięcia i z zamknięciem, tablice i obiekty
+    std::string open(400000, '[');
+    CHECK(!parse_devices_json(open, out));
+    CHECK(!parse_devices_json(nested(400000, ""), out));
+    std::string objects;
+    for (int i = 0; i < 100000; i++) {
+        objects += "{\"a\": ";
+    }
+    CHECK(!parse_devices_json(objects, out));
+}
+
+static void test_rejected_counted() {
+    board_map boards;
+    aggregator_config config;
+    config.shards = 2;
+    class aggregator state(boards, config);
+    uint16_t hall = boards.id("hall");
+
+    state.submit(hall, nested(400000, ""), false, 1);
+    state.submit(hall, DEVICE, false, 2);
+    state.submit(hall, nested(JSON_MAX_DEPTH + 1, ""), false, 3);
+    state.drain();
+
+    aggregator_stats stats = state.stats();
+    CHECK(stats.rejected == 2);
+    CHECK(stats.sightings == 1);
+}
+
+int main() {
+    test_batch();
+    test_depth_limit();
+    test_rejected_counted();
+    return test_result("sighting_parser_test");
+}
@@ -0,0 +1,175 @@
+// Test sighting_wire: zapis i odczyt formatu binarnego, wiadomości ucięte
+// na każdej długości i nadmiarowe bajty po ostatnim rekordzie.
+
+#include <stdint.h>
+#include <string.h>
+
+#include "sighting_wire.h"
+#include "test_check.h"
+
+#define BASE_TIMESTAMP_US 1700000000123456LL
+
+typedef struct {
+    uint8_t bda[SIGHTING_WIRE_BDA_LEN];
+    uint8_t addr_type;
+    int8_t rssi;
+    int64_t timestamp_us;
+    const char *name;
+} sample_t;
+
+static const sample_t samples[] = {
+    {{0xC0, 0x11, 0x22, 0x33, 0x44, 0x55}, 1, -67, BASE_TIMESTAMP_US + 1000, "Tag 1"},
+    {{0x00, 0x00, 0x00, 0x00, 0x00, 0x01}, 0, -127, BASE_TIMESTAMP_US, ""},
+    {{0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF}, 3, 20, BASE_TIMESTAMP_US + 65535000, "edge"},
+    {{0x12, 0x34, 0x56, 0x78, 0x9A, 0xBC}, 2, -1, BASE_TIMESTAMP_US + 99999999, "kitchen \"scale\""},
+};
+#define SAMPLE_COUNT (sizeof(samples) / sizeof(samples[0]))
+
+static size_t encode_samples(uint8_t *buffer, size_t capacity) {
+    sighting_wire_writer_t writer;
+    CHECK(sighting_wire_writer_begin(&writer, buffer, capacity, BASE_TIMESTAMP_US));
+    for (size_t i = 0; i < SAMPLE_COUNT; i++) {
+        const sample_t *s = &samples[i];
+        CHECK(sighting_wire_writer_add(&writer, s->bda, s->addr_type, s->rssi, s->timestamp_us, s->name,
+                                       strlen(s->name)));
+    }
+    return sighting_wire_writer_finish(&writer);
+}
+
+// Odczytuje wszystkie rekordy; zwraca status kończący odczyt i liczbę rekordów OK
+static sighting_wire_status_t decode_all(const uint8_t *data, size_t length, size_t *records) {
+    sighting_wire_reader_t reader;
+    sighting_wire_record_t record;
+    *records = 0;
+    sighting_wire_status_t status = sighting_wire_reader_init(&reader, data, length);
+    if (status != SIGHTING_WIRE_OK) {
+        return status;
+    }
+    while ((status = sighting_wire_reader_next(&reader, &record)) == SIGHTING_WIRE_OK) {
+        // Nazwa to widok do danych wejściowych - musi w nich leżeć
+        CHECK((const uint8_t *)record.name + record.name_len <= data + length);
+        (*records)++;
+    }
+    return status;
+}
+
+static void test_round_trip(void) {
+    uint8_t buffer[256];
+    size_t length = encode_samples(buffer, sizeof(buffer));
+
+    size_t expected = SIGHTING_WIRE_HEADER_LEN;
+    for (size_t i = 0; i < SAMPLE_COUNT; i++) {
+        expected += SIGHTING_WIRE_RECORD_FIXED_LEN + strlen(samples[i].name);
+    }
+    CHECK(length == expected);
+
+    sighting_wire_reader_t reader;
+    sighting_wire_record_t record;
+    CHECK(sighting_wire_reader_init(&reader, buffer, length) == SIGHTING_WIRE_OK);
+    CHECK(reader.count == SAMPLE_COUNT);
+    CHECK(reader.base_timestamp_us == BASE_TIMESTAMP_US);
+
+    for (size_t i = 0; i < SAMPLE_COUNT; i++) {
+        const sample_t *s = &samples[i];
+        CHECK(sighting_wire_reader_next(&reader, &record) == SIGHTING_WIRE_OK);
+        CHECK(memcmp(record.bda, s->bda, SIGHTING_WIRE_BDA_LEN) == 0);
+        CHECK(record.addr_type == s->addr_type);
+        CHECK(record.rssi == s->rssi);
+        CHECK(record.name_len == strlen(s->name));
+        CHECK(memcmp(record.name, s->name, record.name_len) == 0);
+
+        // Różnica czasu w całych milisekundach, nasycana do SIGHTING_WIRE_MAX_DELTA_MS
+        int64_t delta_ms = (s->timestamp_us - BASE_TIMESTAMP_US) / 1000;
+        if (delta_ms > SIGHTING_WIRE_MAX_DELTA_MS) {
+            delta_ms = SIGHTING_WIRE_MAX_DELTA_MS;
+        }
+        CHECK(record.timestamp_us == BASE_TIMESTAMP_US + delta_ms * 1000);
+    }
+    CHECK(sighting_wire_reader_next(&reader, &record) == SIGHTING_WIRE_END);
+    CHECK(sighting_wire_reader_next(&reader, &record) == SIGHTING_WIRE_END);
+}
+
+static void test_empty_and_limits(void) {
+    uint8_t buffer[SIGHTING_WIRE_HEADER_LEN + SIGHTING_WIRE_RECORD_FIXED_LEN + UINT8_MAX];
+    sighting_wire_writer_t writer;
+    size_t records;
+
+    // Paczka bez rekordów jest poprawna
+    CHECK(sighting_wire_writer_begin(&writer, buffer, sizeof(buffer), -5000));
+    size_t length = sighting_wire_writer_finish(&writer);
+    CHECK(length == SIGHTING_WIRE_HEADER_LEN);
+    CHECK(decode_all(buffer, length, &records) == SIGHTING_WIRE_END && records == 0);
+
+    // Nazwa dłuższa niż 255 bajtów jest obcinana, czas sprzed bazy daje różnicę 0
+    char name[300];
+    memset(name, 'n', sizeof(name));
+    CHECK(sighting_wire_writer_add(&writer, samples[0].bda, 0, -50, -9000, name, sizeof(name)));
+    CHECK(!sighting_wire_writer_add(&writer, samples[0].bda, 0, -50, 0, "", 0));
+    length = sighting_wire_writer_finish(&writer);
+    CHECK(length == sizeof(buffer));
+
+    sighting_wire_reader_t reader;
+    sighting_wire_record_t record;
+    CHECK(sighting_wire_reader_init(&reader, buffer, length) == SIGHTING_WIRE_OK);
+    CHECK(reader.base_timestamp_us == -5000);
+    CHECK(sighting_wire_reader_next(&reader, &record) == SIGHTING_WIRE_OK);
+    CHECK(record.name_len == UINT8_MAX && record.timestamp_us == -5000);
+    CHECK(sighting_wire_reader_next(&reader, &record) == SIGHTING_WIRE_END);
+
+    // Bufor mniejszy niż nagłówek
+    CHECK(!sighting_wire_writer_begin(&writer, buffer, SIGHTING_WIRE_HEADER_LEN - 1, 0));
+    CHECK(!sighting_wire_writer_add(&writer, samples[0].bda, 0, -50, 0, "", 0));
+    CHECK(sighting_wire_writer_finish(&writer) == 0);
+}
+
+static void test_truncated(void) {
+    uint8_t buffer[256];
+    size_t length = encode_samples(buffer, sizeof(buffer));
+    size_t records;
+
+    // Każdy prefiks pełnej wiadomości kończy się błędem, nigdy końcem paczki
+    for (size_t cut = 0; cut < length; cut++) {
+        CHECK(decode_all(buffer, cut, &records) == SIGHTING_WIRE_ERR_TRUNCATED);
+        CHECK(records < SAMPLE_COUNT);
+    }
+    CHECK(decode_all(buffer, length, &records) == SIGHTING_WIRE_END && records == SAMPLE_COUNT);
+
+    // Liczba rekordów w nagłówku większa niż zapisana
+    buffer[2]++;
+    CHECK(decode_all(buffer, length, &records) == SIGHTING_WIRE_ERR_TRUNCATED && records == SAMPLE_COUNT);
+}
+
+static void test_trailing(void) {
+    uint8_t buffer[256];
+    size_t length = encode_samples(buffer, sizeof(buffer));
+    size_t records;
+
+    buffer[length] = 0;
+    CHECK(decode_all(buffer, length + 1, &records) == SIGHTING_WIRE_ERR_TRAILING && records == SAMPLE_COUNT);
+
+    // Liczba rekordów w nagłówku mniejsza niż zapisana
+    buffer[2]--;
+    CHECK(decode_all(buffer, length, &records) == SIGHTING_WIRE_ERR_TRAILING && records == SAMPLE_COUNT - 1);
+}
+
+static void test_header(void) {
+    uint8_t buffer[256];
+    size_t length = encode_samples(buffer, sizeof(buffer));
+    size_t records;
+
+    buffer[0] ^= 0xFF;
+    CHECK(decode_all(buffer, length, &records) == SIGHTING_WIRE_ERR_MAGIC);
+    buffer[0] ^= 0xFF;
+    buffer[1] = SIGHTING_WIRE_VERSION + 1;
+    CHECK(decode_all(buffer, length, &records) == SIGHTING_WIRE_ERR_VERSION);
+    CHECK(strcmp(sighting_wire_status_str(SIGHTING_WIRE_ERR_VERSION), "unsupported version") == 0);
+}
+
+int main(void) {
+    test_round_trip();
+    test_empty_and_limits();
+    test_truncated();
+    test_trailing();
+    test_header();
+    return test_result("sighting_wire_test");
+}
@@ -0,0 +1,194 @@
+// Test tag_allowlist: odsetek fałszywych trafień filtra Blooma względem
+// oczekiwanego, sprawdzenie dokładne na liście we flash i błędy wgrywania
+// (nieposortowana lista, za krótka, za dużo tagów).
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "memory_flash.h"
+#include "tag_allowlist.h"
+#include "test_check.h"
+
+#define CAPACITY 5000
+#define FP_RATE_PPM 10000
+#define PROBES 200000
+
+static memory_flash_t area;
+static tag_allowlist_flash_t flash;
+static uint32_t filter[TAG_ALLOWLIST_FILTER_MAX_BYTES(CAPACITY, FP_RATE_PPM) / 4];
+static uint8_t tags[CAPACITY * SIGHTING_BDA_LEN];
+
+static uint32_t random_state = 1;
+
+static void random_bda(uint8_t *bda) {
+    for (int i = 0; i < SIGHTING_BDA_LEN; i++) {
+        random_state = random_state * 1664525u + 1013904223u;
+        bda[i] = (uint8_t)(random_state >> 24);
+    }
+}
+
+static int compare_bda(const void *a, const void *b) {
+    return memcmp(a, b, SIGHTING_BDA_LEN);
+}
+
+// Posortowane adresy bez powtórzeń; zwraca ich liczbę
+static uint32_t make_tags(uint32_t count) {
+    for (uint32_t i = 0; i < count; i++) {
+        random_bda(tags + (size_t)i * SIGHTING_BDA_LEN);
+    }
+    qsort(tags, count, SIGHTING_BDA_LEN, compare_bda);
+    uint32_t unique = 0;
+    for (uint32_t i = 0; i < count; i++) {
+        const uint8_t *bda = tags + (size_t)i * SIGHTING_BDA_LEN;
+        if (unique == 0 || memcmp(tags + (size_t)(unique - 1) * SIGHTING_BDA_LEN, bda, SIGHTING_BDA_LEN) != 0) {
+            memmove(tags + (size_t)unique++ * SIGHTING_BDA_LEN, bda, SIGHTING_BDA_LEN);
+        }
+    }
+    return unique;
+}
+
+// Wgrywanie fragmentami o zmiennej długości, jak dane z esp-mqtt
+static bool upload(const uint8_t *data, uint32_t count) {
+    if (!tag_allowlist_begin(count)) {
+        return false;
+    }
+    size_t total = (size_t)count * SIGHTING_BDA_LEN;
+    for (size_t offset = 0, step = 1; offset < total; step = step * 7 % 1021 + 1) {
+        size_t length = step < total - offset ? step : total - offset;
+        if (!tag_allowlist_append(data + offset, length)) {
+            return false;
+        }
+        offset += length;
+    }
+    return tag_allowlist_commit();
+}
+
+static uint32_t count_members(const uint8_t *data, uint32_t count) {
+    uint32_t found = 0;
+    for (uint32_t i = 0; i < count; i++) {
+        found += tag_allowlist_contains(data + (size_t)i * SIGHTING_BDA_LEN);
+    }
+    return found;
+}
+
+typedef struct {
+    uint32_t non_members;
+    uint32_t accepted;
+    uint32_t filter_positives;
+    uint32_t false_positives;
+} probe_result_t;
+
+static probe_result_t probe_non_members(uint32_t count) {
+    tag_allowlist_stats_t before;
+    tag_allowlist_stats_t after;
+    probe_result_t result = {0};
+    tag_allowlist_get_stats(&before);
+    for (uint32_t i = 0; i < PROBES; i++) {
+        uint8_t bda[SIGHTING_BDA_LEN];
+        random_bda(bda);
+        if (bsearch(bda, tags, count, SIGHTING_BDA_LEN, compare_bda)) {
+            continue;
+        }
+        result.non_members++;
+        result.accepted += tag_allowlist_contains(bda);
+    }
+    tag_allowlist_get_stats(&after);
+    result.filter_positives = after.filter_positives - before.filter_positives;
+    result.false_positives = after.false_positives - before.false_positives;
+    return result;
+}
+
+static void test_false_positive_rate(void) {
+    uint32_t count = make_tags(CAPACITY);
+    CHECK(upload(tags, count));
+    CHECK(count_members(tags, count) == count);
+
+    tag_allowlist_stats_t stats;
+    tag_allowlist_get_stats(&stats);
+    CHECK(stats.tags == count);
+    CHECK(stats.memory_bytes <= sizeof(filter));
+    // Filtr dobrany do pojemności: przy pełnej liście przewidywany odsetek bliski docelowemu
+    // (liczba funkcji skrótu jest zaokrąglana)
+    CHECK(stats.expected_fp_ppm > 0 && stats.expected_fp_ppm <= FP_RATE_PPM * 11 / 10);
+
+    // Sprawdzenie dokładne odrzuca każde fałszywe trafienie filtra
+    probe_result_t result = probe_non_members(count);
+    double measured_ppm = 1e6 * result.filter_positives / result.non_members;
+    CHECK(result.non_members > PROBES / 2);
+    CHECK(result.filter_positives > 0);
+    CHECK(measured_ppm <= 2.0 * stats.expected_fp_ppm + 100);
+    CHECK(result.accepted == 0);
+    CHECK(result.false_positives == result.filter_positives);
+
+    // Układ obszaru flash (tag_allowlist.h), wczytywany po restarcie
+    const uint8_t *header = area.data;
+    CHECK((uint32_t)(header[0] | header[1] << 8 | header[2] << 16 | (uint32_t)header[3] << 24) ==
+          TAG_ALLOWLIST_MAGIC);
+    CHECK((uint32_t)(header[4] | header[5] << 8 | header[6] << 16 | (uint32_t)header[7] << 24) == count);
+    CHECK(memcmp(area.data + TAG_ALLOWLIST_HEADER_LEN, tags, (size_t)count * SIGHTING_BDA_LEN) == 0);
+}
+
+static void check_upload_error(const uint8_t *data, uint32_t announced, size_t length, const char *expected) {
+    bool ok = tag_allowlist_begin(announced) && tag_allowlist_append(data, length) && tag_allowlist_commit();
+    CHECK(!ok);
+    if (strcmp(tag_allowlist_error(), expected) != 0) {
+        fprintf(stderr, "got '%s', expected '%s'\n", tag_allowlist_error(), expected);
+        CHECK(false);
+    }
+    // Błąd po begin zostawia pustą listę
+    CHECK(count_members(tags, 3) == 0);
+    tag_allowlist_stats_t stats;
+    tag_allowlist_get_stats(&stats);
+    CHECK(stats.tags == 0);
+}
+
+static void test_upload_errors(void) {
+    uint32_t count = make_tags(3);
+    CHECK(count == 3);
+    uint8_t reversed[3 * SIGHTING_BDA_LEN];
+    for (int i = 0; i < 3; i++) {
+        memcpy(reversed + i * SIGHTING_BDA_LEN, tags + (2 - i) * SIGHTING_BDA_LEN, SIGHTING_BDA_LEN);
+    }
+    uint8_t duplicated[2 * SIGHTING_BDA_LEN];
+    memcpy(duplicated, tags, SIGHTING_BDA_LEN);
+    memcpy(duplicated + SIGHTING_BDA_LEN, tags, SIGHTING_BDA_LEN);
+
+    CHECK(upload(tags, 3));
+    check_upload_error(reversed, 3, sizeof(reversed), "addresses not sorted or duplicated");
+    CHECK(upload(tags, 3));
+    check_upload_error(duplicated, 2, sizeof(duplicated), "addresses not sorted or duplicated");
+
+    // Za krótka lista: mniej adresów niż zapowiedziano albo urwany adres
+    CHECK(upload(tags, 3));
+    check_upload_error(tags, 3, 2 * SIGHTING_BDA_LEN, "incomplete list");
+    CHECK(upload(tags, 3));
+    check_upload_error(tags, 1, SIGHTING_BDA_LEN - 1, "incomplete list");
+    CHECK(upload(tags, 3));
+    check_upload_error(tags, 2, 3 * SIGHTING_BDA_LEN, "more data than announced");
+
+    // Za dużo tagów: begin odrzucone, bieżąca lista zostaje
+    CHECK(upload(tags, 3));
+    tag_allowlist_stats_t stats;
+    tag_allowlist_get_stats(&stats);
+    CHECK(!tag_allowlist_begin(stats.max_tags + 1));
+    CHECK(strcmp(tag_allowlist_error(), "too many tags") == 0);
+    CHECK(count_members(tags, 3) == 3);
+    CHECK(!tag_allowlist_append(tags, SIGHTING_BDA_LEN));
+    CHECK(!tag_allowlist_commit());
+
+    // Pusta lista jest poprawna
+    CHECK(tag_allowlist_begin(0) && tag_allowlist_commit());
+    CHECK(count_members(tags, 3) == 0);
+}
+
+int main(void) {
+    flash = memory_flash_init(&area);
+    tag_allowlist_use_buffer(filter, sizeof(filter));
+    CHECK(tag_allowlist_init(&flash, CAPACITY, FP_RATE_PPM, true));
+
+    test_false_positive_rate();
+    test_upload_errors();
+    return test_result("tag_allowlist_test");
+}
@@ -0,0 +1,28 @@
+#ifndef HOST_TESTS_TEST_CHECK_H_
+#define HOST_TESTS_TEST_CHECK_H_
+
+#include <stdio.h>
+
+// Minimalne sprawdzenia dla testów hosta (ctest): błąd jest wypisywany, a test
+// kończy się kodem 1 po wykonaniu wszystkich przypadków.
+
+static int test_failures = 0;
+
+#define CHECK(condition)                                                                      \
+    do {                                                                                      \
+        if (!(condition)) {                                                                   \
+            fprintf(stderr, "%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #condition);     \
+            test_failures++;                                                                  \
+        }                                                                                     \
+    } while (0)
+
+static inline int test_result(const char *name) {
+    if (test_failures > 0) {
+        fprintf(stderr, "%s: %d checks failed\n", name, test_failures);
+        return 1;
+    }
+    printf("%s: ok\n", name);
+    return 0;
+}
+
+#endif
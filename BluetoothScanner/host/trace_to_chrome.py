@@ -0,0 +1,108 @@
+#!/usr/bin/env python3
+"""Converts a trace dump (main/trace.h) to Chrome trace event JSON.
+
+The dump may come from the serial console ("trace <board> uart") or from
+/<board_name>/trace, e.g. `mosquitto_sub -t /pokoj_1/trace > dump.txt`.
+Other lines (logs, topic prefixes) are ignored. Open the output in
+chrome://tracing or https://ui.perfetto.dev.
+
+    trace_to_chrome.py dump.txt > trace.json
+"""
+
+import json
+import re
+import sys
+
+BEGIN_RE = re.compile(r"TRACE BEGIN (\d+) (\d+)")
+ENTRY_RE = re.compile(r"\bT (\d+) (\d+) (\S+) ([BEi]) (\d+)")
+
+CYCLE_WRAP = 1 << 32
+
+
+def unwrap(reference, cycles):
+    """Places a 32-bit counter value on the unwrapped timeline nearest to reference.
+
+    Only a difference larger than half of the counter range counts as a wrap,
+    so entries slightly out of order do not shift the rest of the trace.
+    """
+    delta = (cycles - reference) % CYCLE_WRAP
+    if delta >= CYCLE_WRAP // 2:
+        delta -= CYCLE_WRAP
+    return reference + delta
+
+
+def parse(lines):
+    cpu_mhz = 160
+    entries = []  # (core, cycles, name, phase, arg), cycles unwrapped per core
+    last_cycles = {}
+
+    for line in lines:
+        match = BEGIN_RE.search(line)
+        if match:
+            # Każdy zrzut zaczyna nową sekwencję liczników
+            cpu_mhz = int(match.group(1))
+            last_cycles.clear()
+            continue
+
+        match = ENTRY_RE.search(line)
+        if not match:
+            continue
+        core, cycles, name, phase, arg = match.groups()
+        core, cycles = int(core), int(cycles)
+
+        cycles = unwrap(last_cycles.get(core, cycles), cycles)
+        last_cycles[core] = cycles
+        entries.append((core, cycles, name, phase, int(arg)))
+
+    # Wpisy zapisane przez starsze wersje firmware mogą być nieznacznie poza kolejnością
+    entries.sort(key=lambda entry: (entry[0], entry[1]))
+    return cpu_mhz, entries
+
+
+def to_chrome(cpu_mhz, entries):
+    events = []
+    if not entries:
+        return {"traceEvents": events}
+
+    start = {}
+    for core, cycles, _, _, _ in entries:
+        start[core] = min(start.get(core, cycles), cycles)
+
+    for core in sorted(start):
+        events.append({"name": "thread_name", "ph": "M", "pid": 1, "tid": core,
+                       "args": {"name": "core %d" % core}})
+
+    # Liczniki rdzeni nie są zsynchronizowane - każdy rdzeń liczy czas od swojego pierwszego wpisu
+    for core, cycles, name, phase, arg in entries:
+        event = {
+            "name": name,
+            "ph": phase,
+            "ts": (cycles - start[core]) / cpu_mhz,
+            "pid": 1,
+            "tid": core,
+            "args": {"arg": arg},
+        }
+        if phase == "i":
+            event["s"] = "t"
+        events.append(event)
+
+    return {"traceEvents": events, "displayTimeUnit": "ns"}
+
+
+def main():
+    if len(sys.argv) > 2:
+        print(__doc__.strip(), file=sys.stderr)
+        return 2
+
+    source = open(sys.argv[1], errors="replace") if len(sys.argv) == 2 else sys.stdin
+    with source:
+        cpu_mhz, entries = parse(source)
+
+    json.dump(to_chrome(cpu_mhz, entries), sys.stdout)
+    sys.stdout.write("\n")
+    print("%d trace entries" % len(entries), file=sys.stderr)
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
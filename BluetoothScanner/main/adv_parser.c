@@ -0,0 +1,129 @@
+#include "adv_parser.h"
+
+#include <string.h>
+
+static bool add_view(adv_view_t *views, uint8_t *count, uint8_t max, const uint8_t *data, uint8_t len) {
+    if (*count >= max) {
+        return false;
+    }
+    views[*count].data = data;
+    views[*count].len = len;
+    (*count)++;
+    return true;
+}
+
+static bool parse_service_data(adv_fields_t *fields, uint8_t type, const uint8_t *value, uint8_t len) {
+    uint8_t uuid_len = type == ADV_TYPE_SERVICE_DATA16 ? 2 : (type == ADV_TYPE_SERVICE_DATA32 ? 4 : 16);
+    if (len < uuid_len || fields->service_data_count >= ADV_MAX_SERVICE_DATA) {
+        return false;
+    }
+    adv_service_data_t *entry = &fields->service_data[fields->service_data_count++];
+    entry->type = type;
+    entry->uuid.data = value;
+    entry->uuid.len = uuid_len;
+    entry->data.data = value + uuid_len;
+    entry->data.len = len - uuid_len;
+    return true;
+}
+
+static bool parse_manufacturer_data(adv_fields_t *fields, const uint8_t *value, uint8_t len) {
+    if (len < 2 || fields->manufacturer_count >= ADV_MAX_MANUFACTURER_DATA) {
+        return false;
+    }
+    adv_manufacturer_data_t *entry = &fields->manufacturer[fields->manufacturer_count++];
+    entry->company_id = (uint16_t)(value[0] | (value[1] << 8));
+    entry->data.data = value + 2;
+    entry->data.len = len - 2;
+    return true;
+}
+
+static bool parse_field(adv_fields_t *fields, uint8_t type, const uint8_t *value, uint8_t len) {
+    switch (type) {
+    case ADV_TYPE_FLAGS:
+        if (len < 1) {
+            return false;
+        }
+        fields->has_flags = true;
+        fields->flags = value[0];
+        return true;
+
+    case ADV_TYPE_NAME_COMPLETE:
+        fields->name.data = value;
+        fields->name.len = len;
+        fields->name_complete = true;
+        return true;
+
+    case ADV_TYPE_NAME_SHORT:
+        // Pełna nazwa ma pierwszeństwo niezależnie od kolejności pól
+        if (!fields->name_complete) {
+            fields->name.data = value;
+            fields->name.len = len;
+        }
+        return true;
+
+    case ADV_TYPE_TX_POWER:
+        if (len < 1) {
+            return false;
+        }
+        fields->has_tx_power = true;
+        fields->tx_power = (int8_t)value[0];
+        return true;
+
+    case ADV_TYPE_UUID16_INCOMPLETE:
+    case ADV_TYPE_UUID16_COMPLETE:
+        return len % 2 == 0 && add_view(fields->uuid16, &fields->uuid16_count, ADV_MAX_UUID_LISTS, value, len);
+
+    case ADV_TYPE_UUID32_INCOMPLETE:
+    case ADV_TYPE_UUID32_COMPLETE:
+        return len % 4 == 0 && add_view(fields->uuid32, &fields->uuid32_count, ADV_MAX_UUID_LISTS, value, len);
+
+    case ADV_TYPE_UUID128_INCOMPLETE:
+    case ADV_TYPE_UUID128_COMPLETE:
+        return len % 16 == 0 && add_view(fields->uuid128, &fields->uuid128_count, ADV_MAX_UUID_LISTS, value, len);
+
+    case ADV_TYPE_SERVICE_DATA16:
+    case ADV_TYPE_SERVICE_DATA32:
+    case ADV_TYPE_SERVICE_DATA128:
+        return parse_service_data(fields, type, value, len);
+
+    case ADV_TYPE_MANUFACTURER:
+        return parse_manufacturer_data(fields, value, len);
+
+    default:
+        // Nieobsługiwane typy są pomijane
+        return true;
+    }
+}
+
+static bool parse_segment(adv_fields_t *fields, const uint8_t *data, size_t len) {
+    bool ok = true;
+    size_t offset = 0;
+
+    while (offset < len) {
+        uint8_t field_len = data[offset];
+        if (field_len == 0) {
+            // Zerowa długość kończy znaczące dane (reszta to wypełnienie)
+            break;
+        }
+        if (field_len > len - offset - 1) {
+            return false;
+        }
+        if (!parse_field(fields, data[offset + 1], &data[offset + 2], field_len - 1)) {
+            ok = false;
+        }
+        offset += 1 + (size_t)field_len;
+    }
+    return ok;
+}
+
+bool adv_parse(const uint8_t *data, size_t adv_len, size_t scan_rsp_len, adv_fields_t *fields) {
+    memset(fields, 0, sizeof(*fields));
+
+    bool ok = parse_segment(fields, data, adv_len);
+    if (!parse_segment(fields, data + adv_len, scan_rsp_len)) {
+        ok = false;
+    }
+
+    fields->malformed = !ok;
+    return ok;
+}
@@ -0,0 +1,90 @@
+#ifndef MAIN_ADV_PARSER_H_
+#define MAIN_ADV_PARSER_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Jednoprzebiegowy parser struktur AD (Core Spec Vol 3, Part C, 11) z danych
+// reklamy i odpowiedzi na skanowanie. Nie kopiuje danych - wszystkie pola są
+// widokami do bufora wejściowego, ważnymi tak długo jak ten bufor.
+// Moduł nie zależy od ESP-IDF.
+
+#define ADV_TYPE_FLAGS 0x01
+#define ADV_TYPE_UUID16_INCOMPLETE 0x02
+#define ADV_TYPE_UUID16_COMPLETE 0x03
+#define ADV_TYPE_UUID32_INCOMPLETE 0x04
+#define ADV_TYPE_UUID32_COMPLETE 0x05
+#define ADV_TYPE_UUID128_INCOMPLETE 0x06
+#define ADV_TYPE_UUID128_COMPLETE 0x07
+#define ADV_TYPE_NAME_SHORT 0x08
+#define ADV_TYPE_NAME_COMPLETE 0x09
+#define ADV_TYPE_TX_POWER 0x0A
+#define ADV_TYPE_SERVICE_DATA16 0x16
+#define ADV_TYPE_SERVICE_DATA32 0x20
+#define ADV_TYPE_SERVICE_DATA128 0x21
+#define ADV_TYPE_MANUFACTURER 0xFF
+
+// Reklama i odpowiedź na skanowanie mogą zawierać to samo pole
+#define ADV_MAX_UUID_LISTS 2
+#define ADV_MAX_SERVICE_DATA 4
+#define ADV_MAX_MANUFACTURER_DATA 2
+
+typedef struct {
+    const uint8_t *data;
+    uint8_t len;
+} adv_view_t;
+
+typedef struct {
+    uint8_t type;   // ADV_TYPE_SERVICE_DATA16/32/128
+    adv_view_t uuid;
+    adv_view_t data;
+} adv_service_data_t;
+
+typedef struct {
+    uint16_t company_id;
+    adv_view_t data; // Dane po identyfikatorze firmy
+} adv_manufacturer_data_t;
+
+typedef struct {
+    adv_view_t name;
+    bool name_complete;
+
+    bool has_flags;
+    uint8_t flags;
+
+    bool has_tx_power;
+    int8_t tx_power;
+
+    // Listy UUID jako surowe bajty (little-endian), po 2/4/16 bajtów na UUID
+    adv_view_t uuid16[ADV_MAX_UUID_LISTS];
+    uint8_t uuid16_count;
+    adv_view_t uuid32[ADV_MAX_UUID_LISTS];
+    uint8_t uuid32_count;
+    adv_view_t uuid128[ADV_MAX_UUID_LISTS];
+    uint8_t uuid128_count;
+
+    adv_service_data_t service_data[ADV_MAX_SERVICE_DATA];
+    uint8_t service_data_count;
+
+    adv_manufacturer_data_t manufacturer[ADV_MAX_MANUFACTURER_DATA];
+    uint8_t manufacturer_count;
+
+    // Struktura wychodząca poza bufor, pole o błędnej długości albo brak miejsca na widok
+    bool malformed;
+} adv_fields_t;
+
+// Parsuje adv_len bajtów reklamy i następujące po nich scan_rsp_len bajtów
+// odpowiedzi (układ jak w ble_adv zdarzenia ESP_GAP_BLE_SCAN_RESULT_EVT).
+// Zwraca false, jeśli dane były uszkodzone - poprawne pola są mimo to wypełnione.
+bool adv_parse(const uint8_t *data, size_t adv_len, size_t scan_rsp_len, adv_fields_t *fields);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
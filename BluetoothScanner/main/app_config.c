@@ -0,0 +1,220 @@
+#include "app_config.h"
+
+#include <inttypes.h>
+#include <stddef.h>
+#include <string.h>
+
+#include "esp_log.h"
+#include "esp_system.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "nvs.h"
+#include "scan_filter.h"
+#include "tags.h"
+
+#define NVS_NAMESPACE "wifi_config"
+
+typedef struct {
+    const char *nvs_key;
+    size_t offset;
+    size_t size;
+    const char *default_value;
+} field_descriptor_t;
+
+static const field_descriptor_t fields[APP_CONFIG_FIELD_COUNT] = {
+    [APP_CONFIG_WIFI_SSID] = {"ssid", offsetof(app_config_t, wifi_ssid), APP_CONFIG_SSID_LEN, "not set"},
+    [APP_CONFIG_WIFI_PASSWORD] = {"password", offsetof(app_config_t, wifi_password), APP_CONFIG_PASSWORD_LEN, ""},
+    [APP_CONFIG_BROKER_URI] = {"broker", offsetof(app_config_t, broker_uri), APP_CONFIG_BROKER_URI_LEN,
+                               "mqtt://192.168.241.246"},
+    [APP_CONFIG_BOARD_NAME] = {"board_name", offsetof(app_config_t, board_name), APP_CONFIG_BOARD_NAME_LEN,
+                               "pokoj_1"},
+    [APP_CONFIG_SCAN_FILTER] = {"scan_filter", offsetof(app_config_t, scan_filter), APP_CONFIG_SCAN_FILTER_LEN,
+                                SCAN_FILTER_DEFAULT_RULES},
+    [APP_CONFIG_SCAN_PARAMS] = {"scan_params", offsetof(app_config_t, scan_params), APP_CONFIG_SCAN_PARAMS_LEN, ""},
+};
+
+static app_config_t config;
+static uint32_t stored_fields = 0; // Pola mające wartość w NVS lub ustawione przez app_config_set_str
+static uint32_t dirty_fields = 0;  // Pola czekające na zapis do NVS
+static uint32_t generation = 0;
+static portMUX_TYPE config_lock = portMUX_INITIALIZER_UNLOCKED;
+
+static esp_timer_handle_t commit_timer = NULL;
+
+static char *field_value(app_config_t *cfg, app_config_field_t field) {
+    return (char *)cfg + fields[field].offset;
+}
+
+static void commit_timer_callback(void *arg) {
+    app_config_commit();
+}
+
+void app_config_init(void) {
+    for (int field = 0; field < APP_CONFIG_FIELD_COUNT; field++) {
+        strcpy(field_value(&config, field), fields[field].default_value);
+    }
+
+    nvs_handle_t nvs_handle;
+    if (nvs_open(NVS_NAMESPACE, NVS_READONLY, &nvs_handle) == ESP_OK) {
+        for (int field = 0; field < APP_CONFIG_FIELD_COUNT; field++) {
+            char value[APP_CONFIG_SCAN_FILTER_LEN]; // Najdłuższe pole
+            size_t len = fields[field].size;
+            if (nvs_get_str(nvs_handle, fields[field].nvs_key, value, &len) == ESP_OK) {
+                strcpy(field_value(&config, field), value);
+                stored_fields |= 1u << field;
+            }
+        }
+        nvs_close(nvs_handle);
+    } else {
+        ESP_LOGI(GATTS_TAG, "No NVS Namespace found, using defaults");
+    }
+
+    const esp_timer_create_args_t timer_args = {
+        .callback = commit_timer_callback,
+        .name = "config_commit",
+    };
+    ESP_ERROR_CHECK(esp_timer_create(&timer_args, &commit_timer));
+
+    // Zmiany zaplanowane tuż przed esp_restart (np. z charakterystyki restartu) nie mogą przepaść
+    ESP_ERROR_CHECK(esp_register_shutdown_handler(app_config_commit));
+
+    ESP_LOGI(GATTS_TAG, "Config loaded: board=%s broker=%s ssid=%s", config.board_name,
+             config.broker_uri, config.wifi_ssid);
+}
+
+void app_config_get(app_config_t *out) {
+    taskENTER_CRITICAL(&config_lock);
+    *out = config;
+    taskEXIT_CRITICAL(&config_lock);
+}
+
+bool app_config_get_str(app_config_field_t field, char *out, size_t len) {
+    if (field >= APP_CONFIG_FIELD_COUNT || len == 0) {
+        return false;
+    }
+    taskENTER_CRITICAL(&config_lock);
+    strncpy(out, field_value(&config, field), len - 1);
+    out[len - 1] = '\0';
+    bool stored = (stored_fields & (1u << field)) != 0;
+    taskEXIT_CRITICAL(&config_lock);
+    return stored;
+}
+
+bool app_config_set_str(app_config_field_t field, const char *value) {
+    if (field >= APP_CONFIG_FIELD_COUNT || strlen(value) >= fields[field].size) {
+        return false;
+    }
+
+    taskENTER_CRITICAL(&config_lock);
+    char *current = field_value(&config, field);
+    bool changed = strcmp(current, value) != 0 || !(stored_fields & (1u << field));
+    if (changed) {
+        strcpy(current, value);
+        stored_fields |= 1u << field;
+        dirty_fields |= 1u << field;
+        generation++;
+    }
+    taskEXIT_CRITICAL(&config_lock);
+
+    if (changed && commit_timer) {
+        // Każda zmiana przesuwa zapis - seria zapisów z GATT kończy się jednym commitem
+        esp_timer_stop(commit_timer);
+        esp_timer_start_once(commit_timer, (uint64_t)CONFIG_APP_CONFIG_COMMIT_DELAY_MS * 1000);
+    }
+    return true;
+}
+
+bool app_config_set_fields(const app_config_t *values, uint32_t mask) {
+    for (int field = 0; field < APP_CONFIG_FIELD_COUNT; field++) {
+        if ((mask & (1u << field)) && strnlen((const char *)values + fields[field].offset, fields[field].size) >=
+                                          fields[field].size) {
+            return false;
+        }
+    }
+
+    uint32_t changed = 0;
+    taskENTER_CRITICAL(&config_lock);
+    for (int field = 0; field < APP_CONFIG_FIELD_COUNT; field++) {
+        if (!(mask & (1u << field))) {
+            continue;
+        }
+        char *current = field_value(&config, field);
+        const char *value = (const char *)values + fields[field].offset;
+        if (strcmp(current, value) != 0 || !(stored_fields & (1u << field))) {
+            strcpy(current, value);
+            changed |= 1u << field;
+        }
+    }
+    stored_fields |= changed;
+    dirty_fields |= changed;
+    if (changed) {
+        generation++; // Jedna zmiana - mqtt_task nie zobaczy połowy konfiguracji
+    }
+    taskEXIT_CRITICAL(&config_lock);
+
+    if (changed) {
+        if (commit_timer) {
+            esp_timer_stop(commit_timer);
+        }
+        app_config_commit();
+    }
+    return true;
+}
+
+uint32_t app_config_generation(void) {
+    taskENTER_CRITICAL(&config_lock);
+    uint32_t value = generation;
+    taskEXIT_CRITICAL(&config_lock);
+    return value;
+}
+
+void app_config_commit(void) {
+    app_config_t snapshot;
+    taskENTER_CRITICAL(&config_lock);
+    uint32_t dirty = dirty_fields;
+    dirty_fields = 0;
+    snapshot = config;
+    taskEXIT_CRITICAL(&config_lock);
+
+    if (dirty == 0) {
+        return;
+    }
+
+    nvs_handle_t nvs_handle;
+    esp_err_t err = nvs_open(NVS_NAMESPACE, NVS_READWRITE, &nvs_handle);
+    if (err != ESP_OK) {
+        ESP_LOGE(GATTS_TAG, "Error opening NVS: %s", esp_err_to_name(err));
+        taskENTER_CRITICAL(&config_lock);
+        dirty_fields |= dirty;
+        taskEXIT_CRITICAL(&config_lock);
+        return;
+    }
+
+    uint32_t failed = 0;
+    for (int field = 0; field < APP_CONFIG_FIELD_COUNT; field++) {
+        if (!(dirty & (1u << field))) {
+            continue;
+        }
+        err = nvs_set_str(nvs_handle, fields[field].nvs_key, field_value(&snapshot, field));
+        if (err != ESP_OK) {
+            ESP_LOGE(GATTS_TAG, "Error writing %s to NVS: %s", fields[field].nvs_key, esp_err_to_name(err));
+            failed |= 1u << field;
+        }
+    }
+
+    err = nvs_commit(nvs_handle);
+    nvs_close(nvs_handle);
+    if (err != ESP_OK) {
+        ESP_LOGE(GATTS_TAG, "Error committing to NVS: %s", esp_err_to_name(err));
+        failed = dirty;
+    } else {
+        ESP_LOGI(GATTS_TAG, "Saved config to NVS (fields 0x%02" PRIx32 ")", dirty & ~failed);
+    }
+
+    // Nieudane pola zostaną zapisane przy następnym commicie
+    if (failed) {
+        taskENTER_CRITICAL(&config_lock);
+        dirty_fields |= failed;
+        taskEXIT_CRITICAL(&config_lock);
+    }
+}
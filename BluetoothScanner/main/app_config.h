@@ -0,0 +1,60 @@
+#ifndef MAIN_APP_CONFIG_H_
+#define MAIN_APP_CONFIG_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Konfiguracja płytki trzymana w RAM. NVS jest czytany raz w app_config_init,
+// a zmiany są zapisywane zbiorczo po CONFIG_APP_CONFIG_COMMIT_DELAY_MS bez
+// kolejnych zapisów (oraz przy esp_restart). Odczyty nie dotykają flash.
+
+#define APP_CONFIG_SSID_LEN 33       // wifi_sta_config_t.ssid + '\0'
+#define APP_CONFIG_PASSWORD_LEN 65   // wifi_sta_config_t.password + '\0'
+#define APP_CONFIG_BROKER_URI_LEN 64
+#define APP_CONFIG_BOARD_NAME_LEN 30
+#define APP_CONFIG_SCAN_FILTER_LEN 256 // Reguły filtra skanowania (scan_filter.h)
+#define APP_CONFIG_SCAN_PARAMS_LEN 64  // Parametry skanowania (scan_config_format), puste = Kconfig
+
+typedef enum {
+    APP_CONFIG_WIFI_SSID = 0,
+    APP_CONFIG_WIFI_PASSWORD,
+    APP_CONFIG_BROKER_URI,
+    APP_CONFIG_BOARD_NAME,
+    APP_CONFIG_SCAN_FILTER,
+    APP_CONFIG_SCAN_PARAMS,
+    APP_CONFIG_FIELD_COUNT,
+} app_config_field_t;
+
+typedef struct {
+    char wifi_ssid[APP_CONFIG_SSID_LEN];
+    char wifi_password[APP_CONFIG_PASSWORD_LEN];
+    char broker_uri[APP_CONFIG_BROKER_URI_LEN];
+    char board_name[APP_CONFIG_BOARD_NAME_LEN];
+    char scan_filter[APP_CONFIG_SCAN_FILTER_LEN];
+    char scan_params[APP_CONFIG_SCAN_PARAMS_LEN];
+} app_config_t;
+
+// Wymaga zainicjalizowanego nvs_flash
+void app_config_init(void);
+
+// Kopia całej konfiguracji; pola bez wartości w NVS mają wartości domyślne
+void app_config_get(app_config_t *config);
+
+// Kopiuje pole do out; zwraca false, gdy pole nie było ustawione (out zawiera wartość domyślną)
+bool app_config_get_str(app_config_field_t field, char *out, size_t len);
+
+// Zmienia pole w RAM i planuje zapis do NVS. Zwraca false dla zbyt długiej wartości.
+bool app_config_set_str(app_config_field_t field, const char *value);
+
+// Zmienia naraz pola z maski (bity app_config_field_t) i od razu zapisuje je do NVS
+// jednym commitem. Zwraca false bez zmian, gdy któraś wartość jest za długa.
+bool app_config_set_fields(const app_config_t *values, uint32_t mask);
+
+// Rośnie przy każdej zmianie - pozwala wykryć zmianę konfiguracji bez callbacków
+uint32_t app_config_generation(void);
+
+// Natychmiast zapisuje oczekujące zmiany do NVS
+void app_config_commit(void);
+
+#endif
@@ -0,0 +1,102 @@
+#include "app_tasks.h"
+
+#include <inttypes.h>
+
+#include "esp_log.h"
+#include "perf_counters.h"
+#include "sdkconfig.h"
+#include "tags.h"
+
+#if CONFIG_TASK_LAYOUT_UNPINNED
+// Układ odniesienia do porównań: te same priorytety i stosy, bez przypisania rdzeni.
+// Dotyczy także tasków LwIP i esp-mqtt, przypinanych tylko przez sdkconfig.
+#if !CONFIG_LWIP_TCPIP_TASK_AFFINITY_NO_AFFINITY || CONFIG_MQTT_TASK_CORE_SELECTION_ENABLED
+#error "CONFIG_TASK_LAYOUT_UNPINNED needs CONFIG_LWIP_TCPIP_TASK_AFFINITY_NO_AFFINITY=y and CONFIG_MQTT_TASK_CORE_SELECTION_ENABLED unset (see README)"
+#endif
+#define TASK_CORE(core) APP_TASK_ANY_CORE
+#else
+#define TASK_CORE(core) (core)
+#endif
+
+// id, nazwa, przyrostek opcji Kconfig (CONFIG_TASK_<x>_CORE/_PRIORITY/_STACK_SIZE)
+#define APP_TASKS(X)                                  \
+    X(APP_TASK_DISPLAY, "display_task", DISPLAY)     \
+    X(APP_TASK_BUTTON, "button_task", BUTTON)        \
+    X(APP_TASK_MQTT, "mqtt_task", MQTT)              \
+    X(APP_TASK_SCANNER, "scanner_task", SCANNER)     \
+    X(APP_TASK_BLINK_LED, "blink_led_task", BLINK_LED)
+
+#define TASK_CONFIG(id, name, option) \
+    [id] = {name, TASK_CORE(CONFIG_TASK_##option##_CORE), CONFIG_TASK_##option##_PRIORITY, \
+            CONFIG_TASK_##option##_STACK_SIZE},
+
+static const app_task_config_t tasks[APP_TASK_COUNT] = {APP_TASKS(TASK_CONFIG)};
+
+#if CONFIG_STATIC_ALLOCATION
+// Stosy w .bss pod nazwami task_stack_<x> - tak widać je w memory_budget.txt
+#define TASK_STACK(id, name, option) static StackType_t task_stack_##option[CONFIG_TASK_##option##_STACK_SIZE];
+APP_TASKS(TASK_STACK)
+
+#define TASK_STACK_POINTER(id, name, option) [id] = task_stack_##option,
+static StackType_t *const task_stacks[APP_TASK_COUNT] = {APP_TASKS(TASK_STACK_POINTER)};
+
+static StaticTask_t task_buffers[APP_TASK_COUNT];
+#endif
+
+static TaskHandle_t task_handles[APP_TASK_COUNT];
+
+const app_task_config_t *app_task_config(app_task_id_t id) {
+    return &tasks[id];
+}
+
+TaskHandle_t app_task_start(app_task_id_t id, TaskFunction_t function, void *arg) {
+    const app_task_config_t *task = &tasks[id];
+    BaseType_t core = task->core == APP_TASK_ANY_CORE ? tskNO_AFFINITY : task->core;
+
+#if CONFIG_STATIC_ALLOCATION
+    // Stos i blok kontrolny są jedne na zadanie - drugie uruchomienie nadpisałoby działające
+    if (task_handles[id] != NULL) {
+        ESP_LOGE(APP_TASKS_TAG, "%s is already running", task->name);
+        return NULL;
+    }
+    TaskHandle_t handle = xTaskCreateStaticPinnedToCore(function, task->name, task->stack_size, arg, task->priority,
+                                                        task_stacks[id], &task_buffers[id], core);
+#else
+    TaskHandle_t handle = NULL;
+    if (xTaskCreatePinnedToCore(function, task->name, task->stack_size, arg, task->priority, &handle, core) !=
+        pdPASS) {
+        handle = NULL;
+    }
+#endif
+    if (handle == NULL) {
+        ESP_LOGE(APP_TASKS_TAG, "Failed to create %s (stack %" PRIu32 ")", task->name, task->stack_size);
+        return NULL;
+    }
+    ESP_LOGI(APP_TASKS_TAG, "%s: core %s, priority %u, stack %" PRIu32, task->name,
+             task->core == APP_TASK_ANY_CORE ? "any" : task->core == 0 ? "0" : "1", (unsigned)task->priority,
+             task->stack_size);
+    task_handles[id] = handle;
+    perf_watch_task(handle, task->name);
+    return handle;
+}
+
+size_t app_tasks_check_stacks(void) {
+    size_t over_budget = 0;
+    for (int id = 0; id < APP_TASK_COUNT; id++) {
+        if (task_handles[id] == NULL) {
+            continue;
+        }
+        const app_task_config_t *task = &tasks[id];
+        uint32_t free_bytes = uxTaskGetStackHighWaterMark(task_handles[id]);
+        uint32_t used_bytes = task->stack_size - free_bytes;
+        if (free_bytes < CONFIG_MEMORY_BUDGET_STACK_MARGIN) {
+            over_budget++;
+            ESP_LOGW(APP_TASKS_TAG, "%s: %" PRIu32 " of %" PRIu32 " stack bytes used, %" PRIu32 " free (margin %d)", task->name,
+                     used_bytes, task->stack_size, free_bytes, CONFIG_MEMORY_BUDGET_STACK_MARGIN);
+        } else {
+            ESP_LOGD(APP_TASKS_TAG, "%s: %" PRIu32 " of %" PRIu32 " stack bytes used", task->name, used_bytes,
+                     task->stack_size);
+        }
+    }
+    return over_budget;
+}
@@ -0,0 +1,43 @@
+#ifndef MAIN_APP_TASKS_H_
+#define MAIN_APP_TASKS_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+// Tabela zadań aplikacji: nazwa, rdzeń, priorytet i stos każdego zadania w jednym
+// miejscu (Kconfig, menu "Task layout"). Domyślnie przetwarzanie skanowania zostaje
+// na rdzeniu Bluedroid (0), a publikacja MQTT i stos sieciowy na rdzeniu 1.
+
+#define APP_TASK_ANY_CORE -1
+
+typedef enum {
+    APP_TASK_DISPLAY = 0,
+    APP_TASK_BUTTON,
+    APP_TASK_MQTT,
+    APP_TASK_SCANNER,
+    APP_TASK_BLINK_LED,
+    APP_TASK_COUNT,
+} app_task_id_t;
+
+typedef struct {
+    const char *name;
+    int core; // APP_TASK_ANY_CORE - bez przypisania
+    UBaseType_t priority;
+    uint32_t stack_size;
+} app_task_config_t;
+
+const app_task_config_t *app_task_config(app_task_id_t id);
+
+// Tworzy zadanie według tabeli i rejestruje je w perf_watch_task; zwraca NULL przy błędzie.
+// Przy CONFIG_STATIC_ALLOCATION stos i blok kontrolny są statyczne, a zadanie można
+// uruchomić tylko raz.
+TaskHandle_t app_task_start(app_task_id_t id, TaskFunction_t function, void *arg);
+
+// Porównuje zapas stosu uruchomionych zadań z CONFIG_MEMORY_BUDGET_STACK_MARGIN;
+// zwraca liczbę zadań poniżej marginesu (każde jest logowane jako ostrzeżenie)
+size_t app_tasks_check_stacks(void);
+
+#endif
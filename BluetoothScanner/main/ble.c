@@ -1,4 +1,6 @@
 #include "ble.h"
+#include "config_tlv.h"
+#include "esp_timer.h"
 
 static uint8_t adv_config_done = 0;
 
@@ -6,6 +8,8 @@ static configuration_received_callback wifi_ssid_callback;
 static configuration_received_callback wifi_password_callback;
 static configuration_received_callback broker_ip_callback;
 static configuration_received_callback board_name_callback;
+static bulk_config_write_callback bulk_config_write;
+static bulk_config_read_callback bulk_config_read;
 
 // UUIDs for BLE
 static const uint8_t WIFI_CONFIG_SERVICE_UUID_128[16] = {
@@ -38,6 +42,11 @@ static const uint8_t RESTART_CHAR_UUID_128[16] = {
     0x00, 0x80, 0x5F, 0x9B, 0x34, 0xFB, 0x00, 0x00
 };
 
+static const uint8_t BULK_CONFIG_CHAR_UUID_128[16] = {
+    0x00, 0x00, 0xFF, 0x06, 0x00, 0x10, 0x00, 0x80,
+    0x00, 0x80, 0x5F, 0x9B, 0x34, 0xFB, 0x00, 0x00
+};
+
 static esp_ble_adv_data_t adv_data = {
     .set_scan_rsp = false,
     .include_name = true,
@@ -68,6 +77,14 @@ static struct gatts_profile_inst gl_profile_tab[PROFILE_NUM];
 
 static prepare_type_env_t a_prepare_write_env;
 
+// MTU uzgodnione z klientem (ESP_GATTS_MTU_EVT); odpowiedź na odczyt ma najwyżej MTU - 1 bajtów
+static uint16_t negotiated_mtu = ESP_GATT_DEF_BLE_MTU_SIZE;
+
+// Zakodowana konfiguracja dla odczytu zbiorczego. Odczyt długi (Read Blob) jest
+// obsługiwany z kopii zrobionej przy offsecie 0, żeby kolejne fragmenty do siebie pasowały.
+static uint8_t bulk_read_buf[CONFIG_TLV_MAX_LEN];
+static size_t bulk_read_len = 0;
+
 void gap_event_handler(esp_gap_ble_cb_event_t event, esp_ble_gap_cb_param_t *param) {
     switch (event) {
     case ESP_GAP_BLE_ADV_DATA_SET_COMPLETE_EVT:
@@ -96,13 +113,143 @@ void gap_event_handler(esp_gap_ble_cb_event_t event, esp_ble_gap_cb_param_t *par
     }
 }
 
-void exec_write_event_env(prepare_type_env_t *prepare_write_env, 
-                                         esp_ble_gatts_cb_param_t *param) {
-    if (prepare_write_env->prepare_buf) {
-        free(prepare_write_env->prepare_buf);
-        prepare_write_env->prepare_buf = NULL;
+// Zapis do charakterystyki z pełną wartością (zwykły albo złożony z fragmentów)
+static esp_gatt_status_t handle_write(uint16_t handle, const uint8_t *value, uint16_t len, bool *restart) {
+    if (handle == gl_profile_tab[PROFILE_APP_ID].bulk_config_char_handle) {
+        char error[64];
+        if (!bulk_config_write(value, len, restart, error, sizeof(error))) {
+            ESP_LOGE(GATTS_TAG, "Rejected bulk config: %s", error);
+            return ESP_GATT_ILLEGAL_PARAMETER;
+        }
+        return ESP_GATT_OK;
+    }
+
+    // Zdarzenia GATTS są obsługiwane kolejno w zadaniu BTC, więc bufor może być statyczny
+    static char str_value[ESP_GATT_MAX_ATTR_LEN + 1];
+    if (len > ESP_GATT_MAX_ATTR_LEN) {
+        return ESP_GATT_INVALID_ATTR_LEN;
+    }
+    memcpy(str_value, value, len);
+    str_value[len] = '\0';
+
+    if (handle == gl_profile_tab[PROFILE_APP_ID].ssid_char_handle) {
+        ESP_LOGI(GATTS_TAG, "Received SSID: %s", str_value);
+        wifi_ssid_callback(str_value, NULL);
+    } else if (handle == gl_profile_tab[PROFILE_APP_ID].pass_char_handle) {
+        ESP_LOGI(GATTS_TAG, "Received Password: %s", str_value);
+        wifi_password_callback(str_value, NULL);
+    } else if (handle == gl_profile_tab[PROFILE_APP_ID].broker_ip_char_handle) {
+        ESP_LOGI(GATTS_TAG, "Received Broker IP: %s", str_value);
+        broker_ip_callback(str_value, NULL);
+    } else if (handle == gl_profile_tab[PROFILE_APP_ID].board_name_char_handle) {
+        ESP_LOGI(GATTS_TAG, "Received Board Name: %s", str_value);
+        board_name_callback(str_value, NULL);
+    } else if (handle == gl_profile_tab[PROFILE_APP_ID].restart_char_handle) {
+        *restart = true;
+    }
+    return ESP_GATT_OK;
+}
+
+static esp_timer_handle_t restart_timer = NULL;
+
+static void restart_timer_callback(void *arg) {
+    ESP_LOGI(GATTS_TAG, "RESTARTING BOARD");
+    esp_restart();
+}
+
+// esp_ble_gatts_send_response tylko kolejkuje odpowiedź - restart z opóźnieniem,
+// żeby klient dostał Write Response przed zerwaniem połączenia
+static void restart_board(void) {
+    ESP_LOGI(GATTS_TAG, "Restarting board in %d ms", RESTART_DELAY_MS);
+    // Przy już zaplanowanym restarcie zwraca ESP_ERR_INVALID_STATE - termin się nie zmienia
+    esp_timer_start_once(restart_timer, (uint64_t)RESTART_DELAY_MS * 1000);
+}
+
+void prepare_write_event_env(esp_gatt_if_t gatts_if, prepare_type_env_t *prepare_write_env,
+                             esp_ble_gatts_cb_param_t *param) {
+    esp_gatt_status_t status = ESP_GATT_OK;
+    if (prepare_write_env->prepare_len == 0) {
+        prepare_write_env->handle = param->write.handle;
+        prepare_write_env->status = ESP_GATT_OK;
+    }
+    if (param->write.handle != prepare_write_env->handle) {
+        // Fragmenty różnych charakterystyk w jednej kolejce - obsługujemy tylko jedną
+        status = ESP_GATT_PREPARE_Q_FULL;
+    } else if (param->write.offset > PREPARE_BUF_MAX_SIZE) {
+        status = ESP_GATT_INVALID_OFFSET;
+    } else if (param->write.offset + param->write.len > PREPARE_BUF_MAX_SIZE) {
+        status = ESP_GATT_INVALID_ATTR_LEN;
+    }
+
+    if (status == ESP_GATT_OK) {
+        memcpy(prepare_write_env->prepare_buf + param->write.offset, param->write.value, param->write.len);
+        if (param->write.offset + param->write.len > prepare_write_env->prepare_len) {
+            prepare_write_env->prepare_len = param->write.offset + param->write.len;
+        }
+    } else if (prepare_write_env->status == ESP_GATT_OK) {
+        prepare_write_env->status = status;
+    }
+
+    if (param->write.need_rsp) {
+        // Odpowiedź na Prepare Write powtarza otrzymany fragment
+        static esp_gatt_rsp_t rsp; // esp_gatt_rsp_t ma ponad 500 bajtów - poza stosem BTC
+        memset(&rsp, 0, sizeof(rsp));
+        rsp.attr_value.handle = param->write.handle;
+        rsp.attr_value.offset = param->write.offset;
+        rsp.attr_value.len = param->write.len;
+        rsp.attr_value.auth_req = ESP_GATT_AUTH_REQ_NONE;
+        memcpy(rsp.attr_value.value, param->write.value, param->write.len);
+        esp_ble_gatts_send_response(gatts_if, param->write.conn_id, param->write.trans_id, status, &rsp);
+    }
+}
+
+void exec_write_event_env(esp_gatt_if_t gatts_if, prepare_type_env_t *prepare_write_env,
+                          esp_ble_gatts_cb_param_t *param) {
+    esp_gatt_status_t status = prepare_write_env->status;
+    bool restart = false;
+    if (param->exec_write.exec_write_flag == ESP_GATT_PREP_WRITE_EXEC && status == ESP_GATT_OK &&
+        prepare_write_env->prepare_len > 0) {
+        status = handle_write(prepare_write_env->handle, prepare_write_env->prepare_buf,
+                              prepare_write_env->prepare_len, &restart);
+    } else if (param->exec_write.exec_write_flag != ESP_GATT_PREP_WRITE_EXEC) {
+        status = ESP_GATT_OK; // Klient anulował kolejkę
     }
     prepare_write_env->prepare_len = 0;
+    prepare_write_env->status = ESP_GATT_OK;
+
+    esp_ble_gatts_send_response(gatts_if, param->exec_write.conn_id, param->exec_write.trans_id, status, NULL);
+    if (restart) {
+        restart_board();
+    }
+}
+
+// Fragment odczytu zbiorczego od param->read.offset, najwyżej MTU - 1 bajtów
+static void bulk_config_read_event(esp_gatt_if_t gatts_if, esp_ble_gatts_cb_param_t *param) {
+    if (param->read.offset == 0) {
+        bulk_read_len = bulk_config_read(bulk_read_buf, sizeof(bulk_read_buf));
+    }
+
+    static esp_gatt_rsp_t rsp; // Poza stosem BTC
+    memset(&rsp, 0, sizeof(rsp));
+    rsp.attr_value.handle = param->read.handle;
+    rsp.attr_value.offset = param->read.offset;
+    if (param->read.offset > bulk_read_len) {
+        esp_ble_gatts_send_response(gatts_if, param->read.conn_id, param->read.trans_id, ESP_GATT_INVALID_OFFSET,
+                                    &rsp);
+        return;
+    }
+
+    size_t len = bulk_read_len - param->read.offset;
+    size_t max_len = negotiated_mtu - 1;
+    if (max_len > ESP_GATT_MAX_ATTR_LEN) {
+        max_len = ESP_GATT_MAX_ATTR_LEN;
+    }
+    if (len > max_len) {
+        len = max_len;
+    }
+    rsp.attr_value.len = len;
+    memcpy(rsp.attr_value.value, bulk_read_buf + param->read.offset, len);
+    esp_ble_gatts_send_response(gatts_if, param->read.conn_id, param->read.trans_id, ESP_GATT_OK, &rsp);
 }
 
 void gatts_profile_event_handler(esp_gatts_cb_event_t event,
@@ -206,6 +353,20 @@ void gatts_profile_event_handler(esp_gatts_cb_event_t event,
 		                           &attr_value, NULL);
 		}
 
+		{
+			esp_attr_value_t attr_value = {
+	            .attr_max_len = CONFIG_TLV_MAX_LEN,
+	            .attr_len = 0,
+	            .attr_value = NULL,
+	        };
+
+		    esp_bt_uuid_t bulk_config_uuid = { .len = ESP_UUID_LEN_128 };
+		    memcpy(bulk_config_uuid.uuid.uuid128, BULK_CONFIG_CHAR_UUID_128, ESP_UUID_LEN_128);
+		    esp_ble_gatts_add_char(gl_profile_tab[PROFILE_APP_ID].service_handle, &bulk_config_uuid,
+		                          ESP_GATT_PERM_READ | ESP_GATT_PERM_WRITE, ESP_GATT_CHAR_PROP_BIT_READ | ESP_GATT_CHAR_PROP_BIT_WRITE,
+		                           &attr_value, NULL);
+		}
+
         esp_ble_gatts_start_service(gl_profile_tab[PROFILE_APP_ID].service_handle);
         break;
         
@@ -226,41 +387,32 @@ void gatts_profile_event_handler(esp_gatts_cb_event_t event,
 		} else if (memcmp(param->add_char.char_uuid.uuid.uuid128, RESTART_CHAR_UUID_128, ESP_UUID_LEN_128) == 0) {
 		    gl_profile_tab[PROFILE_APP_ID].restart_char_handle = param->add_char.attr_handle;
 		    ESP_LOGI(GATTS_TAG, "RESTART CHAR HANDLE = %d", param->add_char.attr_handle);
+		} else if (memcmp(param->add_char.char_uuid.uuid.uuid128, BULK_CONFIG_CHAR_UUID_128, ESP_UUID_LEN_128) == 0) {
+		    gl_profile_tab[PROFILE_APP_ID].bulk_config_char_handle = param->add_char.attr_handle;
+		    ESP_LOGI(GATTS_TAG, "BULK CONFIG CHAR HANDLE = %d", param->add_char.attr_handle);
 		}
         break;
         
     case ESP_GATTS_WRITE_EVT: {
-        char *str_value = (char*)malloc(param->write.len + 1);
-        if (str_value) {
-            memcpy(str_value, param->write.value, param->write.len);
-            str_value[param->write.len] = '\0';
-
-            if (param->write.handle == gl_profile_tab[PROFILE_APP_ID].ssid_char_handle) {
-                ESP_LOGI(GATTS_TAG, "Received SSID: %s", str_value);
-                wifi_ssid_callback(str_value, NULL);
-            } else if (param->write.handle == gl_profile_tab[PROFILE_APP_ID].pass_char_handle) {
-                ESP_LOGI(GATTS_TAG, "Received Password: %s", str_value);
-                wifi_password_callback(str_value, NULL);
-            }
-            if (param->write.handle == gl_profile_tab[PROFILE_APP_ID].broker_ip_char_handle) {
-			    ESP_LOGI(GATTS_TAG, "Received Broker IP: %s", str_value);
-			    broker_ip_callback(str_value, NULL);
-			} else if (param->write.handle == gl_profile_tab[PROFILE_APP_ID].board_name_char_handle) {
-			    ESP_LOGI(GATTS_TAG, "Received Board Name: %s", str_value);
-			    board_name_callback(str_value, NULL);
-			} else if (param->write.handle == gl_profile_tab[PROFILE_APP_ID].restart_char_handle) {
-				ESP_LOGI(GATTS_TAG, "RESTARTING BOARD");
-                esp_restart();
-            }
-
-            free(str_value);
+        // Fragmenty długiego zapisu przychodzą jako WRITE_EVT z is_prep
+        if (param->write.is_prep) {
+            prepare_write_event_env(gatts_if, &a_prepare_write_env, param);
+            break;
+        }
+        bool restart = false;
+        esp_gatt_status_t status = handle_write(param->write.handle, param->write.value, param->write.len, &restart);
+        esp_ble_gatts_send_response(gatts_if, param->write.conn_id, param->write.trans_id, status, NULL);
+        if (restart) {
+            restart_board();
         }
-        esp_ble_gatts_send_response(gatts_if, param->write.conn_id, param->write.trans_id, ESP_GATT_OK, NULL);
         break;
     }
     case ESP_GATTS_EXEC_WRITE_EVT:
-        esp_ble_gatts_send_response(gatts_if, param->exec_write.conn_id, param->exec_write.trans_id, ESP_GATT_OK, NULL);
-        exec_write_event_env(&a_prepare_write_env, param);
+        exec_write_event_env(gatts_if, &a_prepare_write_env, param);
+        break;
+    case ESP_GATTS_MTU_EVT:
+        ESP_LOGI(GATTS_TAG, "MTU %d", param->mtu.mtu);
+        negotiated_mtu = param->mtu.mtu;
         break;
     case ESP_GATTS_CONNECT_EVT:
         ESP_LOGI(GATTS_TAG, "Client connected, conn_id=%d", param->connect.conn_id);
@@ -268,10 +420,16 @@ void gatts_profile_event_handler(esp_gatts_cb_event_t event,
         break;
     case ESP_GATTS_DISCONNECT_EVT:
         ESP_LOGI(GATTS_TAG, "Client disconnected, restarting advertising...");
+        negotiated_mtu = ESP_GATT_DEF_BLE_MTU_SIZE;
+        a_prepare_write_env.prepare_len = 0;
         esp_ble_gap_start_advertising(&adv_params);
         break;
 	case ESP_GATTS_READ_EVT: {
             uint16_t char_handle = param->read.handle;
+            if (char_handle == gl_profile_tab[PROFILE_APP_ID].bulk_config_char_handle) {
+                bulk_config_read_event(gatts_if, param);
+                break;
+            }
             esp_gatt_rsp_t rsp;
             memset(&rsp, 0, sizeof(esp_gatt_rsp_t));
             rsp.attr_value.handle = param->read.handle;
@@ -321,12 +479,22 @@ void gatts_event_handler(esp_gatts_cb_event_t event,
 void initialize_ble(configuration_received_callback ssid_callback, 
 					configuration_received_callback password_callback,
 					configuration_received_callback _broker_ip_callback, 
-					configuration_received_callback _board_name_callback) {
+					configuration_received_callback _board_name_callback,
+					bulk_config_write_callback _bulk_config_write_callback,
+					bulk_config_read_callback _bulk_config_read_callback) {
 								
 	wifi_ssid_callback = ssid_callback;
 	wifi_password_callback = password_callback; 					
 	broker_ip_callback = _broker_ip_callback;
 	board_name_callback = _board_name_callback;
+	bulk_config_write = _bulk_config_write_callback;
+	bulk_config_read = _bulk_config_read_callback;
+
+    const esp_timer_create_args_t restart_timer_args = {
+        .callback = restart_timer_callback,
+        .name = "ble_restart",
+    };
+    ESP_ERROR_CHECK(esp_timer_create(&restart_timer_args, &restart_timer));
 								
 	ESP_ERROR_CHECK(esp_bt_controller_mem_release(ESP_BT_MODE_CLASSIC_BT));
     esp_bt_controller_config_t bt_cfg = BT_CONTROLLER_INIT_CONFIG_DEFAULT();
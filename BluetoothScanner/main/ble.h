@@ -5,8 +5,9 @@
 
 #define PROFILE_NUM 1
 #define PROFILE_APP_ID 0
-#define GATTS_NUM_HANDLE 12
-#define PREPARE_BUF_MAX_SIZE 1024
+#define GATTS_NUM_HANDLE 14
+#define PREPARE_BUF_MAX_SIZE 1024 // Najdłuższy zapis kolejkowany (prepared write)
+#define RESTART_DELAY_MS 200 // Czas na wysłanie Write Response przed restartem
 
 #define adv_config_flag      (1 << 0)
 #define scan_rsp_config_flag (1 << 1)
@@ -15,6 +16,13 @@
 
 typedef void (*configuration_received_callback)(const char*, char*);
 
+// Zapis charakterystyki zbiorczej (config_tlv.h). Zwraca false z opisem w error, gdy
+// konfiguracja została odrzucona; restart oznacza restart po wysłaniu odpowiedzi.
+typedef bool (*bulk_config_write_callback)(const uint8_t *data, size_t len, bool *restart,
+                                           char *error, size_t error_len);
+// Odczyt charakterystyki zbiorczej - zwraca długość zakodowanej konfiguracji
+typedef size_t (*bulk_config_read_callback)(uint8_t *out, size_t capacity);
+
 struct gatts_profile_inst {
     esp_gatts_cb_t gatts_cb;
     uint16_t gatts_if;
@@ -26,19 +34,26 @@ struct gatts_profile_inst {
     uint16_t broker_ip_char_handle;
     uint16_t board_name_char_handle;
     uint16_t restart_char_handle;
+    uint16_t bulk_config_char_handle;
 };
 
+// Zapis kolejkowany (ATT Prepare Write), składany do ESP_GATTS_EXEC_WRITE_EVT
 typedef struct {
-    uint8_t *prepare_buf;
+    uint8_t prepare_buf[PREPARE_BUF_MAX_SIZE];
     int prepare_len;
+    uint16_t handle;
+    esp_gatt_status_t status; // Pierwszy błąd fragmentu - zwracany przy wykonaniu
 } prepare_type_env_t;
 
 esp_ble_adv_params_t* get_adv_params();
 
 void gap_event_handler(esp_gap_ble_cb_event_t event, esp_ble_gap_cb_param_t *param);
 
-void exec_write_event_env(prepare_type_env_t *prepare_write_env, 
-                                         esp_ble_gatts_cb_param_t *param);
+void prepare_write_event_env(esp_gatt_if_t gatts_if, prepare_type_env_t *prepare_write_env,
+                             esp_ble_gatts_cb_param_t *param);
+
+void exec_write_event_env(esp_gatt_if_t gatts_if, prepare_type_env_t *prepare_write_env,
+                          esp_ble_gatts_cb_param_t *param);
 
 void gatts_profile_event_handler(esp_gatts_cb_event_t event,
                                         esp_gatt_if_t gatts_if,
@@ -51,6 +66,8 @@ void gatts_event_handler(esp_gatts_cb_event_t event,
 void initialize_ble(configuration_received_callback ssid_callback, 
 					configuration_received_callback password_callback,
 					configuration_received_callback _broker_ip_callback, 
-					configuration_received_callback _board_name_callback);
+					configuration_received_callback _board_name_callback,
+					bulk_config_write_callback _bulk_config_write_callback,
+					bulk_config_read_callback _bulk_config_read_callback);
 
 #endif
\ No newline at end of file
@@ -1,27 +1,174 @@
 #include "ble_scanner.h"
 #include "esp_gap_ble_api.h"
 #include "tags.h"
+#include "esp_timer.h"
+#include "adv_parser.h"
+#include "scan_capture.h"
+#include "scan_filter.h"
+#include "perf_counters.h"
+#include "trace.h"
+#include "app_tasks.h"
+#include "sighting_queue.h"
 #include <ctype.h>
+#include <stdatomic.h>
 
-static ble_device_found_callback on_discovery_callback = NULL;
+static ble_scan_result_callback on_discovery_callback = NULL;
+static ble_device_found_callback legacy_callback = NULL;
+static ble_scan_window_end_callback on_window_end_callback = NULL;
 
-#define SCAN_DURATION 10   // Czas skanowania w sekundach
-#define SCAN_INTERVAL 5    // Czas między kolejnymi skanowaniami w sekundach
+// Konfiguracja zamówiona przez ble_scanner_set_config (scan_config_pack), czytana
+// przez zadanie skanera na początku każdego okna
+static _Atomic uint64_t requested_config = 0;
+
+// Parametry radia przekazane ostatnio do esp_ble_gap_set_scan_params
+static esp_ble_scan_params_t scan_params = {
+    .own_addr_type = BLE_ADDR_TYPE_PUBLIC,
+    .scan_filter_policy = BLE_SCAN_FILTER_ALLOW_ALL,
+#if CONFIG_SCAN_MODE_CONTINUOUS
+    .scan_duplicate = BLE_SCAN_DUPLICATE_ENABLE,
+#else
+    .scan_duplicate = BLE_SCAN_DUPLICATE_DISABLE,
+#endif
+};
+
+// Zadanie skanera - tworzone przy pierwszym ESP_GAP_BLE_SCAN_PARAM_SET_COMPLETE_EVT
+static TaskHandle_t scanner_task_handle = NULL;
+// Skanowanie ma ruszyć po zakończeniu zmiany parametrów radia
+static volatile bool resume_after_params = false;
+// Skaner nasłuchuje (start potwierdzony, okno jeszcze się nie skończyło)
+static volatile bool scanning = false;
+
+// Liczba wyników skanowania w bieżącym oknie - do porównania trybów skanowania
+static uint32_t window_results = 0;
+static int64_t window_start_us = 0;
+
+// Chwila potwierdzenia startu skanowania (0, gdy skaner stoi) - do wypełnienia okna
+static int64_t scan_started_us = 0;
+
+static void current_config(scan_config_t *config) {
+    scan_config_unpack(atomic_load(&requested_config), config);
+}
+
+// Wysyła parametry radia, jeśli różnią się od ostatnio wysłanych. Zwraca true, gdy
+// zmiana trwa (resume_after_params ustawione) - skanowanie ruszy po jej zakończeniu.
+static bool set_scan_params(const scan_config_t *config) {
+    scan_config_t applied = {
+        .interval = scan_params.scan_interval,
+        .window = scan_params.scan_window,
+        .active = scan_params.scan_type == BLE_SCAN_TYPE_ACTIVE,
+    };
+    if (!scan_config_radio_differs(config, &applied)) {
+        return false;
+    }
+    scan_params.scan_interval = config->interval;
+    scan_params.scan_window = config->window;
+    scan_params.scan_type = config->active ? BLE_SCAN_TYPE_ACTIVE : BLE_SCAN_TYPE_PASSIVE;
+    ESP_LOGI(GATTS_TAG, "Scan parameters: interval=%u window=%u %s", config->interval, config->window,
+             config->active ? "active" : "passive");
+    resume_after_params = true;
+    esp_err_t err = esp_ble_gap_set_scan_params(&scan_params);
+    if (err != ESP_OK) {
+        ESP_LOGE(GATTS_TAG, "Failed to set scan parameters: %s", esp_err_to_name(err));
+        resume_after_params = false;
+        return false;
+    }
+    return true;
+}
+
+// Ustawia nowe parametry radia, jeśli się zmieniły; skanowanie rusza wtedy dopiero
+// w obsłudze ESP_GAP_BLE_SCAN_PARAM_SET_COMPLETE_EVT. Gdy poprzednia zmiana jeszcze
+// trwa, nic nie wysyła - obsługa zdarzenia sama sprawdzi zamówioną konfigurację.
+static bool update_scan_params(const scan_config_t *config) {
+    if (resume_after_params) {
+        return true;
+    }
+    return set_scan_params(config);
+}
+
+#if CONFIG_SCAN_MODE_CONTINUOUS
+
+// Ustawiane przed zatrzymaniem skanowania, które ma być od razu wznowione
+static volatile bool restart_pending = false;
 
 void start_scanner(void) {
-    ESP_LOGI(GATTS_TAG, "Starting BLE scan for %d seconds", SCAN_DURATION);
-    esp_ble_gap_start_scanning(SCAN_DURATION);
+    ESP_LOGI(GATTS_TAG, "Starting continuous BLE scan");
+    esp_ble_gap_start_scanning(0);
 }
 
-// Task do cyklicznego uruchamiania i zatrzymywania skanera
+// Start nowego okna: najpierw ewentualna zmiana parametrów radia
+static void start_window(void) {
+    scan_config_t config;
+    current_config(&config);
+    if (!update_scan_params(&config)) {
+        start_scanner();
+    }
+}
+
+// Skanowanie ciągłe z filtrem duplikatów w kontrolerze. Co duration sekund
+// skanowanie jest zatrzymywane: zatrzymanie kończy okno (ESP_GAP_BLE_SCAN_STOP_COMPLETE_EVT),
+// a ponowne uruchomienie w obsłudze tego zdarzenia czyści pamięć filtra,
+// więc każde urządzenie jest raportowane ponownie w kolejnym oknie.
+// Nowa konfiguracja (powiadomienie zadania) kończy bieżące okno od razu.
 void scanner_task(void *param) {
+    window_start_us = esp_timer_get_time();
+    start_window();
     while (1) {
-        start_scanner();
-        vTaskDelay((SCAN_DURATION + SCAN_INTERVAL) * 1000 / portTICK_PERIOD_MS);
+        scan_config_t config;
+        current_config(&config);
+        ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(config.duration_s * 1000));
+        restart_pending = true;
+        esp_ble_gap_stop_scanning();
     }
 }
 
+#else
+
+void start_scanner(void) {
+    scan_config_t config;
+    current_config(&config);
+    ESP_LOGI(GATTS_TAG, "Starting BLE scan for %u seconds", config.duration_s);
+    window_start_us = esp_timer_get_time();
+    esp_ble_gap_start_scanning(config.duration_s);
+}
+
+// Task do cyklicznego uruchamiania i zatrzymywania skanera. Nowa konfiguracja
+// (powiadomienie zadania) przerywa bieżące okno i przerwę - kolejne okno startuje
+// od razu z nowymi parametrami.
+void scanner_task(void *param) {
+    while (1) {
+        scan_config_t config;
+        current_config(&config);
+        if (!update_scan_params(&config)) {
+            start_scanner();
+        }
+        if (ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS((config.duration_s + config.pause_s) * 1000)) > 0 &&
+            scanning) {
+            // Koniec okna zgłosi ESP_GAP_BLE_SCAN_STOP_COMPLETE_EVT; kolejne polecenia
+            // Bluedroid wykonuje po kolei, więc nowe parametry trafią do zatrzymanego skanera
+            esp_ble_gap_stop_scanning();
+        }
+    }
+}
+
+#endif
+
+void ble_scanner_get_config(scan_config_t *config) {
+    current_config(config);
+}
+
+bool ble_scanner_set_config(const scan_config_t *config, char *error, size_t error_len) {
+    if (!scan_config_validate(config, error, error_len)) {
+        return false;
+    }
+    atomic_store(&requested_config, scan_config_pack(config));
+    if (scanner_task_handle != NULL) {
+        xTaskNotifyGive(scanner_task_handle);
+    }
+    return true;
+}
+
 void sanitize_name(char* name, char* sanitized_name, size_t max_length) {
+    TRACE(TRACE_SANITIZE_BEGIN, 0);
     size_t i, j = 0;
     for (i = 0; name[i] != '\0' && j < max_length - 1; i++) {
         if (isprint((unsigned char)name[i])) {
@@ -31,13 +178,155 @@ void sanitize_name(char* name, char* sanitized_name, size_t max_length) {
         }
     }
     sanitized_name[j] = '\0';
+    TRACE(TRACE_SANITIZE_END, j);
+}
+
+#if CONFIG_SCAN_CAPTURE_UART
+// Zrzut surowego zdarzenia na UART w formacie scan_capture.h (wejście dla host/scan_replay)
+static void capture_scan_event(const struct ble_scan_result_evt_param *scan_result, int64_t timestamp_us) {
+    scan_capture_event_t event = {
+        .timestamp_us = timestamp_us,
+    };
+
+    if (scan_result == NULL) {
+        event.kind = SCAN_CAPTURE_WINDOW_END;
+    } else {
+        event.kind = SCAN_CAPTURE_ADV;
+        memcpy(event.bda, scan_result->bda, sizeof(event.bda));
+        event.addr_type = scan_result->ble_addr_type;
+        event.evt_type = scan_result->ble_evt_type;
+        event.rssi = (int8_t)scan_result->rssi;
+        event.adv_len = scan_result->adv_data_len;
+        event.scan_rsp_len = scan_result->scan_rsp_len;
+        memcpy(event.data, scan_result->ble_adv, event.adv_len + event.scan_rsp_len);
+    }
+
+    char line[SCAN_CAPTURE_LINE_MAX_LEN];
+    if (scan_capture_format(&event, line, sizeof(line)) > 0) {
+        printf("%s\n", line);
+    }
+}
+#endif
+
+static void end_scan_window(void) {
+    int64_t now_us = esp_timer_get_time();
+#if CONFIG_SCAN_CAPTURE_UART
+    capture_scan_event(NULL, now_us);
+#endif
+    ESP_LOGI(GATTS_TAG, "Scan window ended: %" PRIu32 " results in %" PRId64 " ms",
+             window_results, (now_us - window_start_us) / 1000);
+    window_results = 0;
+    window_start_us = now_us;
+    scanning = false;
+    perf_count(PERF_SCAN_WINDOWS);
+    if (scan_started_us != 0) {
+        perf_add(PERF_SCAN_ACTIVE_MS, (uint32_t)((now_us - scan_started_us) / 1000));
+        scan_started_us = 0;
+    }
+    on_window_end_callback(now_us);
+}
+
+#if CONFIG_TASK_LAYOUT_BENCHMARK
+#define BENCHMARK_DEVICES 64
+#if CONFIG_TASK_LAYOUT_UNPINNED
+#define BENCHMARK_LAYOUT "unpinned"
+#else
+#define BENCHMARK_LAYOUT "pinned"
+#endif
+
+// Zamiast skanowania: syntetyczne wyniki przez ten sam handler GAP (filtr, sighting,
+// kolejka), w paczkach co tick, z końcem okna co duration sekund. Porównanie układów
+// zadań to porównanie liczby rekordów przyjętych do kolejki na sekundę.
+static void benchmark_task(void *param) {
+    esp_ble_gap_cb_param_t result = {0};
+    struct ble_scan_result_evt_param *scan_result = &result.scan_rst;
+    scan_result->search_evt = ESP_GAP_SEARCH_INQ_RES_EVT;
+    scan_result->ble_evt_type = ESP_BLE_EVT_CONN_ADV;
+    scan_result->ble_addr_type = BLE_ADDR_TYPE_RANDOM;
+    static const uint8_t bda_prefix[] = {0xC0, 0xBE, 0x4C, 0x00, 0x00};
+    memcpy(scan_result->bda, bda_prefix, sizeof(bda_prefix));
+
+    uint8_t *adv = scan_result->ble_adv;
+    adv[0] = 2;
+    adv[1] = ESP_BLE_AD_TYPE_FLAG;
+    adv[2] = 0x06;
+
+    sighting_queue_stats_t last_queue;
+    sighting_queue_get_stats(&last_queue);
+    uint32_t last_published = perf_counter(PERF_DEVICES_PUBLISHED);
+    uint32_t offered = 0;
+    uint32_t sequence = 0;
+    TickType_t window_start = xTaskGetTickCount();
+    window_start_us = esp_timer_get_time();
+    ESP_LOGI(GATTS_TAG, "Benchmark: %d synthetic scan results per tick", CONFIG_TASK_LAYOUT_BENCHMARK_BURST);
+
+    while (1) {
+        for (int i = 0; i < CONFIG_TASK_LAYOUT_BENCHMARK_BURST; i++, sequence++) {
+            uint8_t device = sequence % BENCHMARK_DEVICES;
+            scan_result->bda[5] = device;
+            scan_result->rssi = -40 - (int)(sequence % 50);
+            int name_len = snprintf((char *)adv + 5, SIGHTING_NAME_MAX_LEN, "bench-%02u", device);
+            adv[3] = (uint8_t)(name_len + 1);
+            adv[4] = ESP_BLE_AD_TYPE_NAME_CMPL;
+            scan_result->adv_data_len = (uint8_t)(5 + name_len);
+            gap_scan_event_handler(ESP_GAP_BLE_SCAN_RESULT_EVT, &result);
+        }
+        offered += CONFIG_TASK_LAYOUT_BENCHMARK_BURST;
+        vTaskDelay(1);
+
+        TickType_t now = xTaskGetTickCount();
+        scan_config_t config;
+        current_config(&config);
+        if (now - window_start < pdMS_TO_TICKS(config.duration_s * 1000)) {
+            continue;
+        }
+        end_scan_window();
+
+        sighting_queue_stats_t queue;
+        sighting_queue_get_stats(&queue);
+        uint32_t published = perf_counter(PERF_DEVICES_PUBLISHED);
+        uint64_t elapsed_ms = pdTICKS_TO_MS(now - window_start);
+        ESP_LOGI(GATTS_TAG,
+                 "Benchmark (%s layout): %" PRIu64 " offered/s, %" PRIu64 " queued/s, %" PRIu64
+                 " dropped/s, %" PRIu64 " devices/s published",
+                 BENCHMARK_LAYOUT, offered * 1000ULL / elapsed_ms,
+                 (queue.pushed - last_queue.pushed) * 1000ULL / elapsed_ms,
+                 (queue.overflows - last_queue.overflows) * 1000ULL / elapsed_ms,
+                 (published - last_published) * 1000ULL / elapsed_ms);
+        last_queue = queue;
+        last_published = published;
+        offered = 0;
+        window_start = now;
+    }
 }
+#endif
 
 void gap_scan_event_handler(esp_gap_ble_cb_event_t event, esp_ble_gap_cb_param_t *param) {
+    TRACE(TRACE_GAP_EVENT_BEGIN, event);
     switch (event) {
         case ESP_GAP_BLE_SCAN_PARAM_SET_COMPLETE_EVT:
-            ESP_LOGI(GATTS_TAG, "Scan parameters set, starting scan...");
-            xTaskCreate(scanner_task, "scanner_task", 4096, NULL, 5, NULL);
+            if (param->scan_param_cmpl.status != ESP_BT_STATUS_SUCCESS) {
+                ESP_LOGE(GATTS_TAG, "Failed to set scan parameters");
+            }
+            // Zadanie skanera powstaje raz; kolejne zmiany parametrów tylko wznawiają skanowanie
+            if (scanner_task_handle == NULL) {
+                ESP_LOGI(GATTS_TAG, "Scan parameters set, starting scan...");
+#if CONFIG_TASK_LAYOUT_BENCHMARK
+                scanner_task_handle = app_task_start(APP_TASK_SCANNER, benchmark_task, NULL);
+#else
+                scanner_task_handle = app_task_start(APP_TASK_SCANNER, scanner_task, NULL);
+#endif
+            } else if (resume_after_params) {
+                // Konfiguracja zamówiona w trakcie zmiany - wysyłana, zanim skaner ruszy.
+                // Flaga zostaje ustawiona do decyzji, żeby zadanie skanera nie wysłało
+                // parametrów równolegle.
+                scan_config_t config;
+                current_config(&config);
+                if (!set_scan_params(&config)) {
+                    resume_after_params = false;
+                    start_scanner();
+                }
+            }
             break;
 
         case ESP_GAP_BLE_SCAN_START_COMPLETE_EVT:
@@ -45,6 +334,8 @@ void gap_scan_event_handler(esp_gap_ble_cb_event_t event, esp_ble_gap_cb_param_t
                 ESP_LOGE(GATTS_TAG, "Failed to start scanning");
             } else {
                 ESP_LOGI(GATTS_TAG, "Scanning started successfully");
+                scan_started_us = esp_timer_get_time();
+                scanning = true;
             }
             break;
 
@@ -53,24 +344,62 @@ void gap_scan_event_handler(esp_gap_ble_cb_event_t event, esp_ble_gap_cb_param_t
             struct ble_scan_result_evt_param *scan_result = &param->scan_rst;
 
             if (scan_result->search_evt == ESP_GAP_SEARCH_INQ_RES_EVT) {
-				int rssi = scan_result->rssi;
-				char addr_str[18];
-				
-				// Formatuj adres MAC jako string szesnastkowy z dwukropkami
-				snprintf(addr_str, sizeof(addr_str),
-				         "%02x:%02x:%02x:%02x:%02x:%02x",
-				         scan_result->bda[0], scan_result->bda[1], scan_result->bda[2],
-				         scan_result->bda[3], scan_result->bda[4], scan_result->bda[5]);         
-			                
-                uint8_t length = 0;
-				uint8_t* name = esp_ble_resolve_adv_data(scan_result->ble_adv, ESP_BLE_AD_TYPE_NAME_CMPL, &length);
-				
-				if(name) {
-					char sanitized_name[ESP_BLE_ADV_DATA_LEN_MAX] = {0};
-					sanitize_name((char*)name, sanitized_name, ESP_BLE_ADV_DATA_LEN_MAX);
-				
-					on_discovery_callback(sanitized_name, addr_str, rssi);
+                int64_t event_us = esp_timer_get_time();
+                window_results++;
+                perf_count(PERF_ADV_RECEIVED);
+#if CONFIG_SCAN_CAPTURE_UART
+                capture_scan_event(scan_result, event_us);
+#endif
+                // Filtr przed jakąkolwiek obróbką - dane reklamy są parsowane tylko, gdy reguła ich wymaga
+                adv_fields_t fields;
+                scan_filter_event_t filter_event = {
+                    .bda = scan_result->bda,
+                    .addr_type = scan_result->ble_addr_type,
+                    .rssi = (int8_t)scan_result->rssi,
+                    .data = scan_result->ble_adv,
+                    .adv_len = scan_result->adv_data_len,
+                    .scan_rsp_len = scan_result->scan_rsp_len,
+                    .fields = &fields,
+                };
+                if (!scan_filter_accept(&filter_event)) {
+                    perf_count(PERF_ADV_FILTERED);
+                    perf_record(PERF_HIST_GAP_EVENT_US, (uint32_t)(esp_timer_get_time() - event_us));
+                    break;
+                }
+                scan_filter_event_fields(&filter_event);
+
+				ble_scan_result_t result = {
+					.adv_data = scan_result->ble_adv,
+					.adv_len = scan_result->adv_data_len,
+					.scan_rsp = scan_result->ble_adv + scan_result->adv_data_len,
+					.scan_rsp_len = scan_result->scan_rsp_len,
+				};
+				ble_sighting_t *sighting = &result.sighting;
+				sighting->timestamp_us = event_us;
+				sighting->kind = SIGHTING_KIND_ADV;
+				memcpy(sighting->bda, scan_result->bda, SIGHTING_BDA_LEN);
+				sighting->addr_type = scan_result->ble_addr_type;
+				sighting->evt_type = scan_result->ble_evt_type;
+				sighting->rssi = (int8_t)scan_result->rssi;
+
+				// Urządzenia bez nazwy przechodzą, jeśli dopuszczają je reguły filtra
+				uint8_t length = fields.name.len;
+				if (length > SIGHTING_NAME_MAX_LEN - 1) {
+					length = SIGHTING_NAME_MAX_LEN - 1;
 				}
+				char raw_name[SIGHTING_NAME_MAX_LEN];
+				if (length > 0) {
+					memcpy(raw_name, fields.name.data, length);
+				}
+				raw_name[length] = '\0';
+				sanitize_name(raw_name, sighting->name, SIGHTING_NAME_MAX_LEN);
+				sighting->name_len = (uint8_t)strlen(sighting->name);
+
+				on_discovery_callback(&result);
+				perf_record(PERF_HIST_GAP_EVENT_US, (uint32_t)(esp_timer_get_time() - event_us));
+            } else if (scan_result->search_evt == ESP_GAP_SEARCH_INQ_CMPL_EVT) {
+                // Upłynął czas okna (duration) - koniec okna skanowania
+                end_scan_window();
             }
             break;
         }
@@ -80,27 +409,89 @@ void gap_scan_event_handler(esp_gap_ble_cb_event_t event, esp_ble_gap_cb_param_t
                 ESP_LOGE(GATTS_TAG, "Failed to stop scanning");
             } else {
                 ESP_LOGI(GATTS_TAG, "Scanning stopped successfully");
+                end_scan_window();
+#if CONFIG_SCAN_MODE_CONTINUOUS
+                if (restart_pending) {
+                    restart_pending = false;
+                    start_window();
+                }
+#endif
             }
             break;
 
         default:
             break;
     }
+    TRACE(TRACE_GAP_EVENT_END, event);
+}
+
+#if CONFIG_SCAN_MODE_CONTINUOUS
+// Dodaje adresy z listy "aa:bb:cc:dd:ee:ff,..." do listy wyjątków filtra duplikatów,
+// aby kontroler raportował każdą ich reklamę (pełna historia RSSI)
+static void add_duplicate_exceptions(const char *addresses) {
+    const char *cursor = addresses;
+    while (*cursor) {
+        esp_duplicate_info_t bda;
+        unsigned int b[6];
+        int consumed = 0;
+        if (sscanf(cursor, " %2x:%2x:%2x:%2x:%2x:%2x%n", &b[0], &b[1], &b[2], &b[3], &b[4], &b[5], &consumed) != 6) {
+            ESP_LOGE(GATTS_TAG, "Invalid address in duplicate exception list: %s", cursor);
+            return;
+        }
+        for (int i = 0; i < 6; i++) {
+            bda[i] = (uint8_t)b[i];
+        }
+
+        esp_err_t err = esp_ble_gap_update_duplicate_scan_exceptional_list(ESP_BLE_DUPLICATE_EXCEPTIONAL_LIST_ADD,
+                                                                           ESP_BLE_DUPLICATE_SCAN_EXCEPTIONAL_INFO_ADV_ADDR,
+                                                                           bda);
+        if (err != ESP_OK) {
+            ESP_LOGE(GATTS_TAG, "Failed to add duplicate scan exception: %s", esp_err_to_name(err));
+        }
+
+        cursor += consumed;
+        while (*cursor == ',' || *cursor == ' ') {
+            cursor++;
+        }
+    }
 }
+#endif
 
-void initialize_ble_scanner(ble_device_found_callback on_discovery) {
+void ble_scanner_set_legacy_callback(ble_device_found_callback callback) {
+    legacy_callback = callback;
+}
+
+void ble_scanner_legacy_adapter(const ble_scan_result_t *result) {
+    const ble_sighting_t *sighting = &result->sighting;
+    if (legacy_callback == NULL || sighting->name_len == 0) {
+        return;
+    }
+    char address[18];
+    snprintf(address, sizeof(address), "%02x:%02x:%02x:%02x:%02x:%02x", sighting->bda[0], sighting->bda[1],
+             sighting->bda[2], sighting->bda[3], sighting->bda[4], sighting->bda[5]);
+    legacy_callback(sighting->name, address, sighting->rssi);
+}
+
+void initialize_ble_scanner(ble_scan_result_callback on_discovery,
+                            ble_scan_window_end_callback on_window_end) {
 	on_discovery_callback = on_discovery;
+	on_window_end_callback = on_window_end;
 	
 	ESP_ERROR_CHECK(esp_ble_gap_register_callback(gap_scan_event_handler));
-	
-	esp_ble_scan_params_t scan_params = {
-        .scan_type              = BLE_SCAN_TYPE_ACTIVE,
-        .own_addr_type          = BLE_ADDR_TYPE_PUBLIC,
-        .scan_filter_policy     = BLE_SCAN_FILTER_ALLOW_ALL,
-        .scan_interval = 0xA0,
-		.scan_window = 0xA0,
-        .scan_duplicate         = BLE_SCAN_DUPLICATE_DISABLE
-    };
+
+	// Konfiguracja z Kconfig, chyba że ble_scanner_set_config wywołano wcześniej (NVS)
+	scan_config_t config;
+	scan_config_default(&config);
+	uint64_t expected = 0;
+	atomic_compare_exchange_strong(&requested_config, &expected, scan_config_pack(&config));
+	current_config(&config);
+	scan_params.scan_interval = config.interval;
+	scan_params.scan_window = config.window;
+	scan_params.scan_type = config.active ? BLE_SCAN_TYPE_ACTIVE : BLE_SCAN_TYPE_PASSIVE;
+
+#if CONFIG_SCAN_MODE_CONTINUOUS
+    add_duplicate_exceptions(CONFIG_SCAN_DUPLICATE_EXCEPTIONAL_ADDRS);
+#endif
 
     ESP_ERROR_CHECK(esp_ble_gap_set_scan_params(&scan_params));
-}
\ No newline at end of file
+}
@@ -2,11 +2,47 @@
 #define MAIN_BLE_SCANNER_H_
 
 #include "common.h"
+#include "scan_config.h"
+#include "sighting.h"
 
-typedef void (*ble_device_found_callback)(const char*, const char*, int);
+// Wynik skanowania przekazywany do callbacku: gotowy rekord oraz widoki surowych
+// danych reklamy i odpowiedzi na skanowanie. Widoki wskazują na bufor zdarzenia GAP
+// i są ważne tylko w czasie wywołania callbacku - do kolejki trafia sam rekord.
+typedef struct {
+    ble_sighting_t sighting;
+    const uint8_t *adv_data;
+    uint8_t adv_len;
+    const uint8_t *scan_rsp;
+    uint8_t scan_rsp_len;
+} ble_scan_result_t;
+
+// Wywoływany w kontekście callbacku GAP - nie może blokować
+typedef void (*ble_scan_result_callback)(const ble_scan_result_t *result);
+
+// Dawne API: nazwa, adres "aa:bb:cc:dd:ee:ff" i RSSI, tylko dla urządzeń z nazwą.
+// Adres jest formatowany przy każdym zdarzeniu - nowy kod używa ble_scan_result_callback.
+typedef void (*ble_device_found_callback)(const char *name, const char *address, int rssi);
+
+// Wywoływany w kontekście callbacku GAP po zakończeniu okna skanowania
+typedef void (*ble_scan_window_end_callback)(int64_t timestamp_us);
 
 void gap_scan_event_handler(esp_gap_ble_cb_event_t event, esp_ble_gap_cb_param_t *param);
 
-void initialize_ble_scanner(ble_device_found_callback on_discovery);
+// Ustawia parametry radia i uruchamia skanowanie z konfiguracją z Kconfig albo
+// przekazaną wcześniej przez ble_scanner_set_config
+void initialize_ble_scanner(ble_scan_result_callback on_discovery,
+                            ble_scan_window_end_callback on_window_end);
+
+void ble_scanner_get_config(scan_config_t *config);
+
+// Zmienia konfigurację bez restartu, z dowolnego zadania. Bieżące okno skanowania
+// kończy się od razu, a kolejne startuje z nowymi parametrami - parametry radia są
+// ustawiane przy zatrzymanym skanerze, bez tworzenia nowego zadania.
+bool ble_scanner_set_config(const scan_config_t *config, char *error, size_t error_len);
+
+// Adapter dawnego API: initialize_ble_scanner(ble_scanner_legacy_adapter, ...) po
+// ble_scanner_set_legacy_callback
+void ble_scanner_set_legacy_callback(ble_device_found_callback callback);
+void ble_scanner_legacy_adapter(const ble_scan_result_t *result);
 
 #endif 
\ No newline at end of file
@@ -0,0 +1,122 @@
+#include "board_command.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#include "json_string.h"
+
+static const board_command_t *commands = NULL;
+static size_t command_count = 0;
+static const char *own_name = "";
+
+void board_command_init(const board_command_t *table, size_t count, const char *board_name) {
+    commands = table;
+    command_count = count;
+    own_name = board_name;
+}
+
+// Odcina pierwsze słowo z *cursor; zwraca je (pusty napis na końcu tekstu)
+static char *next_word(char **cursor) {
+    char *word = *cursor;
+    while (*word == ' ') {
+        word++;
+    }
+    char *end = word + strcspn(word, " ");
+    *cursor = end;
+    if (*end) {
+        *end = '\0';
+        *cursor = end + 1;
+    }
+    return word;
+}
+
+// Dopisuje text od pozycji len; zwraca capacity, gdy się nie zmieścił
+static size_t append_text(char *out, size_t capacity, size_t len, const char *text) {
+    if (len >= capacity) {
+        return capacity;
+    }
+    int written = snprintf(out + len, capacity - len, "%s", text);
+    if (written < 0 || (size_t)written >= capacity - len) {
+        return capacity;
+    }
+    return len + (size_t)written;
+}
+
+static size_t format_ack(char *ack, size_t capacity, const char *id, const char *command, bool ok,
+                         const char *result) {
+    if (capacity < 64) {
+        return 0;
+    }
+    size_t len = append_text(ack, capacity, 0, "{\"id\": \"");
+    len = json_append_string(ack, capacity, len, id);
+    len = append_text(ack, capacity, len, "\", \"command\": \"");
+    len = json_append_string(ack, capacity, len, command);
+    len = append_text(ack, capacity, len, ok ? "\", \"status\": \"ok\", \"result\": \""
+                                             : "\", \"status\": \"error\", \"result\": \"");
+    // Zapas na zamknięcie obiektu
+    if (len < capacity - 3) {
+        len = json_append_string(ack, capacity - 3, len, result);
+    }
+    len = append_text(ack, capacity, len, "\"}");
+    return len < capacity ? len : 0;
+}
+
+size_t board_command_dispatch(board_command_source_t source, const char *data, size_t len, char *ack,
+                              size_t ack_capacity) {
+    char text[BOARD_COMMAND_MAX_LEN];
+    char id[BOARD_COMMAND_ID_LEN] = "";
+    char result[BOARD_COMMAND_RESULT_LEN] = "";
+
+    if (len >= sizeof(text)) {
+        if (source == BOARD_COMMAND_DIRECT) {
+            return format_ack(ack, ack_capacity, "", "", false, "command too long");
+        }
+        return 0;
+    }
+    memcpy(text, data, len);
+    text[len] = '\0';
+    // Końcowe znaki nowej linii z narzędzi typu mosquitto_pub -l
+    while (len > 0 && (text[len - 1] == '\n' || text[len - 1] == '\r')) {
+        text[--len] = '\0';
+    }
+
+    char *cursor = text;
+    char *word = next_word(&cursor);
+    if (word[0] == '@') {
+        snprintf(id, sizeof(id), "%s", word + 1);
+        word = next_word(&cursor);
+    }
+
+    const board_command_t *command = NULL;
+    for (size_t i = 0; i < command_count; i++) {
+        if (strcmp(commands[i].name, word) == 0) {
+            command = &commands[i];
+            break;
+        }
+    }
+    if (command == NULL) {
+        if (source == BOARD_COMMAND_DIRECT) {
+            // Nieznane słowo pochodzi z wiadomości - w potwierdzeniu tylko jego początek
+            char echoed[BOARD_COMMAND_ECHO_LEN];
+            snprintf(echoed, sizeof(echoed), "%s", word);
+            return format_ack(ack, ack_capacity, id, echoed, false, "unknown command");
+        }
+        return 0;
+    }
+
+    if (source == BOARD_COMMAND_BROADCAST && !(command->flags & BOARD_COMMAND_NO_TARGET)) {
+        char *target = next_word(&cursor);
+        if (strcmp(target, own_name) != 0 && strcmp(target, "*") != 0) {
+            return 0;
+        }
+    }
+    while (*cursor == ' ') {
+        cursor++;
+    }
+
+    bool ok = command->handler(cursor, result, sizeof(result));
+    if (command->flags & BOARD_COMMAND_NO_ACK) {
+        return 0;
+    }
+    return format_ack(ack, ack_capacity, id, command->name, ok, result);
+}
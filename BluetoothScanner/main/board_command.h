@@ -0,0 +1,62 @@
+#ifndef MAIN_BOARD_COMMAND_H_
+#define MAIN_BOARD_COMMAND_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Polecenia zdalne z tabeli. Ta sama tabela obsługuje oba tematy:
+//
+//   /boards_command          [@<id>] <polecenie> <płytka|*> [argumenty]
+//   /<board_name>/command    [@<id>] <polecenie> [argumenty]
+//
+// Polecenia z BOARD_COMMAND_NO_TARGET (introduce) nie mają pola płytki także na
+// /boards_command. Po wykonaniu płytka publikuje potwierdzenie na
+// /<board_name>/command/ack (chyba że polecenie ma BOARD_COMMAND_NO_ACK):
+//
+//   {"id": "17", "command": "scan", "status": "ok", "result": "interval=160 ..."}
+//
+// Nieznane polecenie na /<board_name>/command daje status "error"; na
+// /boards_command jest pomijane, bo nie wiadomo, do której płytki było skierowane.
+// Moduł nie zależy od ESP-IDF.
+
+#define BOARD_COMMAND_MAX_LEN 320   // filter + nazwa płytki + APP_CONFIG_SCAN_FILTER_LEN
+#define BOARD_COMMAND_ID_LEN 24
+#define BOARD_COMMAND_ECHO_LEN 32  // Nieznane polecenie powtarzane w potwierdzeniu
+#define BOARD_COMMAND_RESULT_LEN 160
+#define BOARD_COMMAND_ACK_LEN 384
+
+#define BOARD_COMMAND_NO_TARGET 0x01
+#define BOARD_COMMAND_NO_ACK 0x02
+
+typedef enum {
+    BOARD_COMMAND_BROADCAST = 0, // /boards_command
+    BOARD_COMMAND_DIRECT,        // /<board_name>/command
+} board_command_source_t;
+
+// args bez nazwy polecenia i płytki (pusty napis, gdy brak). Wynik albo opis błędu
+// trafia do result; zwraca false przy błędzie.
+typedef bool (*board_command_handler)(const char *args, char *result, size_t result_len);
+
+typedef struct {
+    const char *name;
+    board_command_handler handler;
+    uint8_t flags;
+} board_command_t;
+
+void board_command_init(const board_command_t *table, size_t count, const char *board_name);
+
+// Wykonuje polecenie, jeśli jest dla tej płytki. Zwraca długość potwierdzenia w ack
+// albo 0, gdy nie ma czego publikować.
+size_t board_command_dispatch(board_command_source_t source, const char *data, size_t len, char *ack,
+                              size_t ack_capacity);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,99 @@
+#include "board_stats.h"
+
+#include <inttypes.h>
+#include <stdarg.h>
+#include <stdbool.h>
+#include <stdio.h>
+
+#include "esp_system.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "perf_counters.h"
+#include "sighting_queue.h"
+#include "time_sync.h"
+
+typedef struct {
+    char *out;
+    size_t len;
+    size_t used;
+    bool overflow;
+} stats_writer_t;
+
+// Stan z poprzedniej wiadomości - wypełnienie skanowania jest liczone za interwał
+static int64_t last_format_us = 0;
+static uint32_t last_scan_active_ms = 0;
+
+static void append(stats_writer_t *writer, const char *format, ...) {
+    if (writer->overflow) {
+        return;
+    }
+    va_list args;
+    va_start(args, format);
+    int written = vsnprintf(writer->out + writer->used, writer->len - writer->used, format, args);
+    va_end(args);
+    if (written < 0 || (size_t)written >= writer->len - writer->used) {
+        writer->overflow = true;
+        return;
+    }
+    writer->used += (size_t)written;
+}
+
+static void append_histogram(stats_writer_t *writer, const char *name, perf_histogram_t histogram) {
+    uint32_t buckets[PERF_HISTOGRAM_BUCKETS];
+    perf_histogram_get(histogram, buckets);
+    append(writer, ",\"%s\":[", name);
+    for (int i = 0; i < PERF_HISTOGRAM_BUCKETS; i++) {
+        append(writer, i == 0 ? "%" PRIu32 : ",%" PRIu32, buckets[i]);
+    }
+    append(writer, "]");
+}
+
+size_t board_stats_format(esp_mqtt_client_handle_t client, char *out, size_t len) {
+    stats_writer_t writer = {.out = out, .len = len};
+    int64_t now_us = esp_timer_get_time();
+
+    sighting_queue_stats_t queue;
+    sighting_queue_get_stats(&queue);
+
+    uint32_t scan_active_ms = perf_counter(PERF_SCAN_ACTIVE_MS);
+    int64_t interval_ms = (now_us - last_format_us) / 1000;
+    uint32_t duty_pct = interval_ms > 0 ? (uint32_t)((scan_active_ms - last_scan_active_ms) * 100 / interval_ms) : 0;
+    last_format_us = now_us;
+    last_scan_active_ms = scan_active_ms;
+
+    append(&writer, "{\"uptime_s\":%" PRId64 ",\"time_synced\":%s", now_us / 1000000,
+           time_sync_synced() ? "true" : "false");
+    append(&writer, ",\"adv\":{\"received\":%" PRIu32 ",\"filtered\":%" PRIu32 ",\"queued\":%" PRIu32
+           ",\"dropped\":%" PRIu32 "}",
+           perf_counter(PERF_ADV_RECEIVED), perf_counter(PERF_ADV_FILTERED), queue.pushed, queue.overflows);
+    append(&writer, ",\"devices\":{\"published\":%" PRIu32 ",\"dropped\":%" PRIu32 "}",
+           perf_counter(PERF_DEVICES_PUBLISHED), perf_counter(PERF_DEVICES_DROPPED));
+    append(&writer, ",\"mqtt\":{\"messages\":%" PRIu32 ",\"failures\":%" PRIu32 ",\"outbox_bytes\":%d}",
+           perf_counter(PERF_MESSAGES_PUBLISHED), perf_counter(PERF_PUBLISH_FAILURES),
+           client ? esp_mqtt_client_get_outbox_size(client) : 0);
+    append(&writer, ",\"heap\":{\"free\":%" PRIu32 ",\"min_free\":%" PRIu32 "}",
+           esp_get_free_heap_size(), esp_get_minimum_free_heap_size());
+    append(&writer, ",\"scan\":{\"windows\":%" PRIu32 ",\"duty_pct\":%" PRIu32 "}",
+           perf_counter(PERF_SCAN_WINDOWS), duty_pct > 100 ? 100 : duty_pct);
+    append(&writer, ",\"wifi_reconnects\":%" PRIu32, perf_counter(PERF_WIFI_RECONNECTS));
+
+    perf_task_t tasks[PERF_MAX_TASKS];
+    size_t task_count = perf_watched_tasks(tasks, PERF_MAX_TASKS);
+    append(&writer, ",\"stack_free\":{");
+    for (size_t i = 0; i < task_count; i++) {
+        // Zapas w bajtach (w ESP-IDF jednostką stosu jest bajt)
+        append(&writer, "%s\"%s\":%u", i == 0 ? "" : ",", tasks[i].name,
+               (unsigned)uxTaskGetStackHighWaterMark((TaskHandle_t)tasks[i].task));
+    }
+    append(&writer, "}");
+
+    append_histogram(&writer, "gap_event_us", PERF_HIST_GAP_EVENT_US);
+    append_histogram(&writer, "publish_us", PERF_HIST_PUBLISH_US);
+    append_histogram(&writer, "capture_to_publish_ms", PERF_HIST_CAPTURE_TO_PUBLISH_MS);
+    append_histogram(&writer, "publish_to_ack_ms", PERF_HIST_PUBLISH_TO_ACK_MS);
+    append_histogram(&writer, "capture_to_ack_ms", PERF_HIST_CAPTURE_TO_ACK_MS);
+    append(&writer, "}");
+
+    return writer.overflow ? 0 : writer.used;
+}
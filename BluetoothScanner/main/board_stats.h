@@ -0,0 +1,28 @@
+#ifndef MAIN_BOARD_STATS_H_
+#define MAIN_BOARD_STATS_H_
+
+#include <stddef.h>
+
+#include "mqtt_client.h"
+
+// Zbiorcza wiadomość ze stanem płytki publikowana co CONFIG_BOARD_STATS_INTERVAL_MS
+// na /<board_name>/stats: liczniki z perf_counters.h, stan kolejki, sterty,
+// skrzynki nadawczej MQTT i zapas stosów zadań. Przykład (bez białych znaków):
+// {"uptime_s":120,"time_synced":true,
+//  "adv":{"received":5120,"filtered":410,"queued":4710,"dropped":0},
+//  "devices":{"published":230,"dropped":0},
+//  "mqtt":{"messages":24,"failures":0,"outbox_bytes":0},
+//  "heap":{"free":123456,"min_free":98765},
+//  "scan":{"windows":8,"duty_pct":66},
+//  "wifi_reconnects":0,
+//  "stack_free":{"mqtt_task":5120,...},
+//  "gap_event_us":[0,0,...],"publish_us":[...],
+//  "capture_to_publish_ms":[...],"publish_to_ack_ms":[...],"capture_to_ack_ms":[...]}
+// Histogramy mają koszyki potęg dwójki (perf_counters.h).
+
+#define BOARD_STATS_MESSAGE_MAX_LEN 1024
+
+// Zwraca długość wiadomości albo 0, gdy nie zmieściła się w buforze
+size_t board_stats_format(esp_mqtt_client_handle_t client, char *out, size_t len);
+
+#endif
@@ -0,0 +1,115 @@
+#include "config_tlv.h"
+
+#include <stdio.h>
+#include <string.h>
+
+typedef struct {
+    uint8_t type;
+    size_t offset;
+    size_t size;
+} tlv_field_t;
+
+// Typy rekordów są częścią formatu - nie zależą od kolejności app_config_field_t
+static const tlv_field_t tlv_fields[APP_CONFIG_FIELD_COUNT] = {
+    [APP_CONFIG_WIFI_SSID] = {CONFIG_TLV_WIFI_SSID, offsetof(app_config_t, wifi_ssid), APP_CONFIG_SSID_LEN},
+    [APP_CONFIG_WIFI_PASSWORD] = {CONFIG_TLV_WIFI_PASSWORD, offsetof(app_config_t, wifi_password),
+                                  APP_CONFIG_PASSWORD_LEN},
+    [APP_CONFIG_BROKER_URI] = {CONFIG_TLV_BROKER_URI, offsetof(app_config_t, broker_uri), APP_CONFIG_BROKER_URI_LEN},
+    [APP_CONFIG_BOARD_NAME] = {CONFIG_TLV_BOARD_NAME, offsetof(app_config_t, board_name), APP_CONFIG_BOARD_NAME_LEN},
+    [APP_CONFIG_SCAN_FILTER] = {CONFIG_TLV_SCAN_FILTER, offsetof(app_config_t, scan_filter),
+                                APP_CONFIG_SCAN_FILTER_LEN},
+    [APP_CONFIG_SCAN_PARAMS] = {CONFIG_TLV_SCAN_PARAMS, offsetof(app_config_t, scan_params),
+                                APP_CONFIG_SCAN_PARAMS_LEN},
+};
+
+uint8_t config_tlv_type(app_config_field_t field) {
+    return field < APP_CONFIG_FIELD_COUNT ? tlv_fields[field].type : 0;
+}
+
+app_config_field_t config_tlv_field(uint8_t type) {
+    for (int field = 0; field < APP_CONFIG_FIELD_COUNT; field++) {
+        if (tlv_fields[field].type == type) {
+            return field;
+        }
+    }
+    return APP_CONFIG_FIELD_COUNT;
+}
+
+char *config_tlv_value(app_config_t *config, app_config_field_t field, size_t *size) {
+    *size = tlv_fields[field].size;
+    return (char *)config + tlv_fields[field].offset;
+}
+
+bool config_tlv_decode(const uint8_t *data, size_t len, config_tlv_update_t *update, char *error,
+                       size_t error_len) {
+    memset(update, 0, sizeof(*update));
+    size_t pos = 0;
+    while (pos < len) {
+        if (len - pos < 2 || len - pos - 2 < data[pos + 1]) {
+            snprintf(error, error_len, "truncated record at %u", (unsigned)pos);
+            return false;
+        }
+        uint8_t type = data[pos];
+        uint8_t value_len = data[pos + 1];
+        const uint8_t *value = data + pos + 2;
+
+        if (type == CONFIG_TLV_RESTART) {
+            update->restart = true;
+        } else {
+            app_config_field_t field = config_tlv_field(type);
+            if (field == APP_CONFIG_FIELD_COUNT) {
+                snprintf(error, error_len, "unknown type 0x%02x", type);
+                return false;
+            }
+            if (update->fields & (1u << field)) {
+                snprintf(error, error_len, "duplicate type 0x%02x", type);
+                return false;
+            }
+            size_t size;
+            char *target = config_tlv_value(&update->values, field, &size);
+            if (value_len >= size) {
+                snprintf(error, error_len, "type 0x%02x longer than %u", type, (unsigned)(size - 1));
+                return false;
+            }
+            if (memchr(value, '\0', value_len) != NULL) {
+                snprintf(error, error_len, "type 0x%02x contains NUL", type);
+                return false;
+            }
+            memcpy(target, value, value_len);
+            target[value_len] = '\0';
+            update->fields |= 1u << field;
+        }
+        pos += 2 + (size_t)value_len;
+    }
+    return true;
+}
+
+static bool append_record(uint8_t type, const char *value, uint8_t *out, size_t capacity, size_t *len) {
+    size_t value_len = strlen(value);
+    if (value_len > UINT8_MAX || *len + 2 + value_len > capacity) {
+        return false;
+    }
+    out[*len] = type;
+    out[*len + 1] = (uint8_t)value_len;
+    memcpy(out + *len + 2, value, value_len);
+    *len += 2 + value_len;
+    return true;
+}
+
+size_t config_tlv_encode(const app_config_t *config, uint32_t fields, const char *error, uint8_t *out,
+                         size_t capacity) {
+    size_t len = 0;
+    for (int field = 0; field < APP_CONFIG_FIELD_COUNT; field++) {
+        if (!(fields & (1u << field))) {
+            continue;
+        }
+        const char *value = (const char *)config + tlv_fields[field].offset;
+        if (!append_record(tlv_fields[field].type, value, out, capacity, &len)) {
+            return 0;
+        }
+    }
+    if (error && error[0] && !append_record(CONFIG_TLV_ERROR, error, out, capacity, &len)) {
+        return 0;
+    }
+    return len;
+}
@@ -0,0 +1,61 @@
+#ifndef MAIN_CONFIG_TLV_H_
+#define MAIN_CONFIG_TLV_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "app_config.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Cała konfiguracja płytki w jednej wartości charakterystyki GATT: ciąg rekordów
+//
+//   typ (1 bajt) | długość (1 bajt) | wartość (tekst bez '\0')
+//
+// Zapis ustawia tylko pola obecne w wiadomości i jest odrzucany w całości przy
+// pierwszym błędzie (nieznany typ, powtórzone pole, za długa wartość, ucięty rekord).
+// Odczyt zwraca wszystkie pola poza hasłem oraz błąd ostatniego zapisu, jeśli był.
+// Moduł nie zależy od ESP-IDF.
+
+#define CONFIG_TLV_MAX_LEN 1024 // Mieści wszystkie pola w maksymalnej długości
+
+typedef enum {
+    CONFIG_TLV_WIFI_SSID = 0x01,
+    CONFIG_TLV_WIFI_PASSWORD = 0x02,
+    CONFIG_TLV_BROKER_URI = 0x03,   // "mqtt://host[:port]" albo sam adres (dodawane jest mqtt://)
+    CONFIG_TLV_BOARD_NAME = 0x04,
+    CONFIG_TLV_SCAN_FILTER = 0x05,  // Reguły jak w poleceniu filter (scan_filter.h)
+    CONFIG_TLV_SCAN_PARAMS = 0x06,  // Pary jak w poleceniu scan (scan_config.h)
+    CONFIG_TLV_RESTART = 0x7E,      // Bez wartości - restart po zapisaniu konfiguracji
+    CONFIG_TLV_ERROR = 0x7F,        // Tylko w odczycie - błąd ostatniego zapisu
+} config_tlv_type_t;
+
+typedef struct {
+    app_config_t values;
+    uint32_t fields; // Bity app_config_field_t obecnych pól
+    bool restart;
+} config_tlv_update_t;
+
+bool config_tlv_decode(const uint8_t *data, size_t len, config_tlv_update_t *update, char *error,
+                       size_t error_len);
+
+// Koduje pola z maski fields i (gdy niepusty) error. Zwraca długość albo 0, gdy
+// bufor jest za mały.
+size_t config_tlv_encode(const app_config_t *config, uint32_t fields, const char *error, uint8_t *out,
+                         size_t capacity);
+
+// Typ rekordu dla pola konfiguracji i odwrotnie; 0 / APP_CONFIG_FIELD_COUNT, gdy brak
+uint8_t config_tlv_type(app_config_field_t field);
+app_config_field_t config_tlv_field(uint8_t type);
+
+// Pole w app_config_t i jego rozmiar razem z '\0'
+char *config_tlv_value(app_config_t *config, app_config_field_t field, size_t *size);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,198 @@
+#include "device_table.h"
+
+#include <string.h>
+
+#if (DEVICE_TABLE_CAPACITY & (DEVICE_TABLE_CAPACITY - 1)) != 0
+#error "CONFIG_DEVICE_TABLE_CAPACITY must be a power of two"
+#endif
+
+#define DEVICE_TABLE_MASK (DEVICE_TABLE_CAPACITY - 1)
+
+#if CONFIG_RSSI_FILTER_KALMAN
+// Parametry z Kconfig są w setnych dB^2, filtr używa Q8
+#define KALMAN_PROCESS_NOISE (CONFIG_RSSI_FILTER_KALMAN_PROCESS_NOISE * RSSI_FILTER_ONE / 100)
+#define KALMAN_MEASUREMENT_NOISE (CONFIG_RSSI_FILTER_KALMAN_MEASUREMENT_NOISE * RSSI_FILTER_ONE / 100)
+#endif
+
+static device_entry_t entries[DEVICE_TABLE_CAPACITY];
+static uint32_t entry_count = 0;
+static uint32_t eviction_count = 0;
+static uint32_t window_eviction_count = 0;
+static device_table_visitor evict_callback = NULL;
+static void *evict_callback_ctx = NULL;
+
+static uint32_t bda_hash(const uint8_t *bda) {
+    // FNV-1a po 6 bajtach adresu
+    uint32_t hash = 2166136261u;
+    for (int i = 0; i < SIGHTING_BDA_LEN; i++) {
+        hash ^= bda[i];
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+static uint32_t find_slot(const uint8_t *bda) {
+    uint32_t slot = bda_hash(bda) & DEVICE_TABLE_MASK;
+    while (entries[slot].used && memcmp(entries[slot].bda, bda, SIGHTING_BDA_LEN) != 0) {
+        slot = (slot + 1) & DEVICE_TABLE_MASK;
+    }
+    return slot;
+}
+
+// Usuwanie z przesunięciem wstecz - nie zostawia znaczników usunięcia
+static void remove_slot(uint32_t slot) {
+    uint32_t next = (slot + 1) & DEVICE_TABLE_MASK;
+    while (entries[next].used) {
+        uint32_t home = bda_hash(entries[next].bda) & DEVICE_TABLE_MASK;
+        // Przesuń wpis, jeśli jego pozycja docelowa nie leży w (slot, next]
+        if (((next - home) & DEVICE_TABLE_MASK) >= ((next - slot) & DEVICE_TABLE_MASK)) {
+            entries[slot] = entries[next];
+            slot = next;
+        }
+        next = (next + 1) & DEVICE_TABLE_MASK;
+    }
+    entries[slot].used = false;
+    entry_count--;
+}
+
+// Usuwa najdawniej widziany wpis, w pierwszej kolejności spośród niewidzianych
+// w bieżącym oknie. Wpis trafia najpierw do evict_callback.
+static void evict_least_recently_seen(void) {
+    uint32_t oldest = 0;
+    int64_t oldest_seen = INT64_MAX;
+    bool oldest_in_window = true;
+    for (uint32_t i = 0; i < DEVICE_TABLE_CAPACITY; i++) {
+        if (!entries[i].used) {
+            continue;
+        }
+        bool in_window = entries[i].count > 0;
+        if ((oldest_in_window && !in_window) ||
+            (oldest_in_window == in_window && entries[i].last_seen_us < oldest_seen)) {
+            oldest_seen = entries[i].last_seen_us;
+            oldest = i;
+            oldest_in_window = in_window;
+        }
+    }
+
+    if (oldest_in_window) {
+        window_eviction_count++;
+    }
+    if (evict_callback) {
+        evict_callback(&entries[oldest], evict_callback_ctx);
+    }
+    remove_slot(oldest);
+    eviction_count++;
+}
+
+void device_table_clear(void) {
+    memset(entries, 0, sizeof(entries));
+    entry_count = 0;
+    eviction_count = 0;
+    window_eviction_count = 0;
+}
+
+void device_table_set_evict_callback(device_table_visitor visitor, void *ctx) {
+    evict_callback = visitor;
+    evict_callback_ctx = ctx;
+}
+
+device_entry_t* device_table_update(const ble_sighting_t *sighting) {
+    uint32_t slot = find_slot(sighting->bda);
+    device_entry_t *entry = &entries[slot];
+
+    if (!entry->used) {
+        if (entry_count >= DEVICE_TABLE_MAX_ENTRIES) {
+            evict_least_recently_seen();
+            slot = find_slot(sighting->bda);
+            entry = &entries[slot];
+        }
+        memset(entry, 0, sizeof(*entry));
+        entry->used = true;
+        memcpy(entry->bda, sighting->bda, SIGHTING_BDA_LEN);
+        entry->first_seen_us = sighting->timestamp_us;
+        entry_count++;
+    }
+
+    entry->addr_type = sighting->addr_type;
+    entry->last_seen_us = sighting->timestamp_us;
+    if (sighting->name_len > 0) {
+        memcpy(entry->name, sighting->name, sizeof(entry->name));
+    }
+
+    if (entry->count == 0 || sighting->rssi < entry->rssi_min) {
+        entry->rssi_min = sighting->rssi;
+    }
+    if (entry->count == 0 || sighting->rssi > entry->rssi_max) {
+        entry->rssi_max = sighting->rssi;
+    }
+    entry->rssi_sum += sighting->rssi;
+    entry->count++;
+
+#if CONFIG_RSSI_FILTER_EMA
+    rssi_filter_ema_update(&entry->rssi_filter, sighting->rssi, CONFIG_RSSI_FILTER_EMA_ALPHA);
+#elif CONFIG_RSSI_FILTER_KALMAN
+    rssi_filter_kalman_update(&entry->rssi_filter, sighting->rssi, KALMAN_PROCESS_NOISE, KALMAN_MEASUREMENT_NOISE);
+#endif
+
+    return entry;
+}
+
+const device_entry_t* device_table_find(const uint8_t *bda) {
+    uint32_t slot = find_slot(bda);
+    return entries[slot].used ? &entries[slot] : NULL;
+}
+
+void device_table_foreach_in_window(device_table_visitor visitor, void *ctx) {
+    for (uint32_t i = 0; i < DEVICE_TABLE_CAPACITY; i++) {
+        if (entries[i].used && entries[i].count > 0) {
+            visitor(&entries[i], ctx);
+        }
+    }
+}
+
+void device_table_foreach(device_table_mutable_visitor visitor, void *ctx) {
+    for (uint32_t i = 0; i < DEVICE_TABLE_CAPACITY; i++) {
+        if (entries[i].used) {
+            visitor(&entries[i], ctx);
+        }
+    }
+}
+
+void device_table_reset_window(void) {
+    for (uint32_t i = 0; i < DEVICE_TABLE_CAPACITY; i++) {
+        entries[i].count = 0;
+        entries[i].rssi_sum = 0;
+        entries[i].rssi_min = 0;
+        entries[i].rssi_max = 0;
+    }
+}
+
+int8_t device_entry_rssi_mean(const device_entry_t *entry) {
+    if (entry->count == 0) {
+        return 0;
+    }
+    // Zaokrąglenie do najbliższej wartości
+    int32_t count = (int32_t)entry->count;
+    int32_t sum = entry->rssi_sum;
+    return (int8_t)(sum < 0 ? (sum - count / 2) / count : (sum + count / 2) / count);
+}
+
+int8_t device_entry_rssi(const device_entry_t *entry) {
+#if CONFIG_RSSI_FILTER_REPLACE_RAW
+    return rssi_filter_rssi(&entry->rssi_filter);
+#else
+    return device_entry_rssi_mean(entry);
+#endif
+}
+
+uint32_t device_table_size(void) {
+    return entry_count;
+}
+
+uint32_t device_table_evictions(void) {
+    return eviction_count;
+}
+
+uint32_t device_table_window_evictions(void) {
+    return window_eviction_count;
+}
@@ -0,0 +1,80 @@
+#ifndef MAIN_DEVICE_TABLE_H_
+#define MAIN_DEVICE_TABLE_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "sdkconfig.h"
+#include "sighting.h"
+#include "rssi_filter.h"
+
+// Tablica urządzeń z adresowaniem otwartym, kluczem jest surowy 6-bajtowy BDA.
+// Używana tylko z wątku publikującego - bez blokad.
+
+#define DEVICE_TABLE_CAPACITY CONFIG_DEVICE_TABLE_CAPACITY
+// Maksymalne zapełnienie (3/4), powyżej którego usuwany jest najdawniej widziany wpis
+#define DEVICE_TABLE_MAX_ENTRIES (DEVICE_TABLE_CAPACITY - DEVICE_TABLE_CAPACITY / 4)
+
+typedef struct {
+    bool used;
+    uint8_t bda[SIGHTING_BDA_LEN];
+    uint8_t addr_type;
+    char name[SIGHTING_NAME_MAX_LEN];
+    int64_t first_seen_us;
+    int64_t last_seen_us;
+
+    // Statystyki bieżącego okna skanowania
+    uint32_t count;
+    int8_t rssi_min;
+    int8_t rssi_max;
+    int32_t rssi_sum;
+
+    // Wygładzone RSSI - stan zachowywany między oknami
+    rssi_filter_t rssi_filter;
+
+    // Stan obecności (presence.h) - zachowywany między oknami
+    uint8_t presence_state;
+    int8_t presence_rssi;        // Ostatnia wartość porównana z progami
+    int64_t presence_pending_us; // Początek oczekiwania na wejście albo wyjście
+    int64_t present_since_us;
+} device_entry_t;
+
+typedef void (*device_table_visitor)(const device_entry_t*, void*);
+typedef void (*device_table_mutable_visitor)(device_entry_t*, void*);
+
+void device_table_clear(void);
+
+// Wywoływane z device_table_update przed usunięciem każdego wpisu, żeby można było
+// opublikować statystyki bieżącego okna (count > 0) albo wyjście obecnego urządzenia.
+// Wizytator nie może zmieniać tablicy. Przeżywa device_table_clear.
+void device_table_set_evict_callback(device_table_visitor visitor, void *ctx);
+
+// Dodaje obserwację do wpisu urządzenia, tworząc go w razie potrzeby.
+// Zwrócony wskaźnik jest ważny do następnego wywołania device_table_update.
+device_entry_t* device_table_update(const ble_sighting_t *sighting);
+
+const device_entry_t* device_table_find(const uint8_t *bda);
+
+// Odwiedza wpisy widziane w bieżącym oknie (count > 0)
+void device_table_foreach_in_window(device_table_visitor visitor, void *ctx);
+
+// Odwiedza wszystkie wpisy; wizytator może zmieniać stan wpisu, ale nie usuwać go
+void device_table_foreach(device_table_mutable_visitor visitor, void *ctx);
+
+// Zeruje statystyki okna, zachowując wpisy urządzeń
+void device_table_reset_window(void);
+
+int8_t device_entry_rssi_mean(const device_entry_t *entry);
+
+// RSSI raportowane dla urządzenia: wygładzone, jeśli włączono CONFIG_RSSI_FILTER_REPLACE_RAW,
+// w przeciwnym razie średnia z okna
+int8_t device_entry_rssi(const device_entry_t *entry);
+
+uint32_t device_table_size(void);
+
+uint32_t device_table_evictions(void);
+
+// Usunięte wpisy, które miały statystyki bieżącego okna
+uint32_t device_table_window_evictions(void);
+
+#endif
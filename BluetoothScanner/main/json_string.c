@@ -0,0 +1,30 @@
+#include "json_string.h"
+
+static int needs_escape(char c) {
+    return c == '"' || c == '\\';
+}
+
+size_t json_append_string(char *out, size_t capacity, size_t len, const char *text) {
+    if (len >= capacity) {
+        return len;
+    }
+    for (; *text && len + 2 < capacity; text++) {
+        char c = *text;
+        if (needs_escape(c)) {
+            out[len++] = '\\';
+            out[len++] = c;
+        } else {
+            out[len++] = (unsigned char)c < 0x20 ? ' ' : c;
+        }
+    }
+    out[len] = '\0';
+    return len;
+}
+
+size_t json_string_length(const char *text) {
+    size_t len = 0;
+    for (; *text; text++) {
+        len += needs_escape(*text) ? 2 : 1;
+    }
+    return len;
+}
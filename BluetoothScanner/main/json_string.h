@@ -0,0 +1,17 @@
+#ifndef MAIN_JSON_STRING_H_
+#define MAIN_JSON_STRING_H_
+
+#include <stddef.h>
+
+// Tekst w napisach JSON publikowanych przez płytkę. Moduł nie zależy od ESP-IDF.
+
+// Dopisuje text do out od pozycji len jako zawartość napisu JSON (bez cudzysłowów):
+// przed '"' i '\' wstawia '\', znaki sterujące zamienia na spacje. Tekst, który się
+// nie mieści, jest obcinany; out zawsze kończy '\0'. Zwraca nową długość. Przy
+// len >= capacity nic nie zapisuje i zwraca len.
+size_t json_append_string(char *out, size_t capacity, size_t len, const char *text);
+
+// Długość text po json_append_string (bez '\0')
+size_t json_string_length(const char *text);
+
+#endif
@@ -0,0 +1,61 @@
+#include "latency_probe.h"
+
+#include <stdatomic.h>
+#include <stdbool.h>
+
+#include "perf_counters.h"
+
+// msg_id jest zerowany przed zapisem czasów i ustawiany po nim; potwierdzenie
+// przyjmuje czasy tylko wtedy, gdy zdoła wyzerować ten sam msg_id
+typedef struct {
+    atomic_int msg_id;
+    int64_t capture_us;
+    int64_t publish_us;
+} probe_slot_t;
+
+static probe_slot_t slots[LATENCY_PROBE_SLOTS];
+static atomic_uint_fast32_t unmatched = 0;
+
+static uint32_t to_ms(int64_t us) {
+    if (us < 0) {
+        return 0;
+    }
+    return us / 1000 > UINT32_MAX ? UINT32_MAX : (uint32_t)(us / 1000);
+}
+
+void latency_probe_sent(int msg_id, int64_t capture_us, int64_t publish_us) {
+    if (msg_id <= 0 || capture_us == 0) {
+        return;
+    }
+    perf_record(PERF_HIST_CAPTURE_TO_PUBLISH_MS, to_ms(publish_us - capture_us));
+
+    probe_slot_t *slot = &slots[(unsigned)msg_id % LATENCY_PROBE_SLOTS];
+    atomic_store(&slot->msg_id, 0);
+    slot->capture_us = capture_us;
+    slot->publish_us = publish_us;
+    atomic_store(&slot->msg_id, msg_id);
+}
+
+void latency_probe_acked(int msg_id, int64_t now_us) {
+    if (msg_id <= 0) {
+        return;
+    }
+    probe_slot_t *slot = &slots[(unsigned)msg_id % LATENCY_PROBE_SLOTS];
+    if (atomic_load(&slot->msg_id) != msg_id) {
+        atomic_fetch_add_explicit(&unmatched, 1, memory_order_relaxed);
+        return;
+    }
+    int64_t capture_us = slot->capture_us;
+    int64_t publish_us = slot->publish_us;
+    int expected = msg_id;
+    if (!atomic_compare_exchange_strong(&slot->msg_id, &expected, 0)) {
+        atomic_fetch_add_explicit(&unmatched, 1, memory_order_relaxed);
+        return;
+    }
+    perf_record(PERF_HIST_PUBLISH_TO_ACK_MS, to_ms(now_us - publish_us));
+    perf_record(PERF_HIST_CAPTURE_TO_ACK_MS, to_ms(now_us - capture_us));
+}
+
+uint32_t latency_probe_unmatched(void) {
+    return atomic_load_explicit(&unmatched, memory_order_relaxed);
+}
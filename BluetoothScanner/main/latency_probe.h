@@ -0,0 +1,21 @@
+#ifndef MAIN_LATENCY_PROBE_H_
+#define MAIN_LATENCY_PROBE_H_
+
+#include <stdint.h>
+
+// Pomiar opóźnienia wiadomości z wynikami skanowania: od przechwycenia obserwacji
+// w callbacku GAP, przez przekazanie do esp_mqtt_client_publish, do potwierdzenia
+// PUBACK (QoS 1). Wyniki trafiają do histogramów PERF_HIST_*_MS (perf_counters.h).
+// sent i acked mogą być wywoływane z różnych zadań. Moduł nie zależy od ESP-IDF.
+
+#define LATENCY_PROBE_SLOTS 32 // Wiadomości oczekujące na PUBACK; starsze są nadpisywane
+
+// capture_us == 0 - wiadomość bez świeżej obserwacji (powtórka z dziennika, heartbeat), pomijana
+void latency_probe_sent(int msg_id, int64_t capture_us, int64_t publish_us);
+
+void latency_probe_acked(int msg_id, int64_t now_us);
+
+// Potwierdzenia bez zapisanej wiadomości (nadpisane sloty, wiadomości spoza sondy)
+uint32_t latency_probe_unmatched(void);
+
+#endif
@@ -11,6 +11,8 @@ void app_main(void)
     
     lcd_send_string(" --------------");
     
+    lcd_flush();
+    
     vTaskDelay(pdMS_TO_TICKS(5000));
     
     lcd_clear();
@@ -34,6 +36,8 @@ void app_main(void)
     	
     	lcd_send_int(i);
     	
+    	lcd_flush();
+    	
     	vTaskDelay(pdMS_TO_TICKS(1000));
 	}
     
@@ -0,0 +1,172 @@
+#include "lcd_display.h"
+
+#include <stdbool.h>
+#include <string.h>
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "app_tasks.h"
+
+typedef struct {
+    char text[DISPLAY_TEXT_MAX_LEN + 1];
+    bool scroll;
+    bool pending; // Tekst zmieniony przez producenta, jeszcze nie odebrany przez zadanie
+} display_region_t;
+
+typedef struct {
+    char text[DISPLAY_TEXT_MAX_LEN + 1];
+    uint8_t length;
+    bool scroll;
+    uint8_t offset;
+    TickType_t next_step;
+} display_line_t;
+
+// Sloty współdzielone z producentami, chronione sekcją krytyczną
+static display_region_t regions[LCD_LINES];
+static portMUX_TYPE regions_lock = portMUX_INITIALIZER_UNLOCKED;
+
+// Stan zadania wyświetlacza
+static display_line_t lines[LCD_LINES];
+static TaskHandle_t display_task_handle = NULL;
+
+static void store_region(uint8_t line, const char *text, bool scroll) {
+    display_region_t *region = &regions[line];
+    strncpy(region->text, text ? text : "", DISPLAY_TEXT_MAX_LEN);
+    region->text[DISPLAY_TEXT_MAX_LEN] = '\0';
+    region->scroll = scroll;
+    region->pending = true;
+}
+
+static void wake_display_task(void) {
+    if (display_task_handle) {
+        xTaskNotifyGive(display_task_handle);
+    }
+}
+
+static void post_line(uint8_t line, const char *text, bool scroll) {
+    if (line >= LCD_LINES) {
+        return;
+    }
+
+    taskENTER_CRITICAL(&regions_lock);
+    store_region(line, text, scroll);
+    taskEXIT_CRITICAL(&regions_lock);
+    wake_display_task();
+}
+
+void display_set_line(uint8_t line, const char *text) {
+    post_line(line, text, false);
+}
+
+void display_scroll_line(uint8_t line, const char *text) {
+    post_line(line, text, true);
+}
+
+void display_show(const char *first_line, const char *second_line) {
+    // Obie linie w jednej sekcji krytycznej - zadanie odbiera je razem
+    taskENTER_CRITICAL(&regions_lock);
+    store_region(0, first_line, false);
+    store_region(1, second_line, false);
+    taskEXIT_CRITICAL(&regions_lock);
+    wake_display_task();
+}
+
+// Przenosi oczekujące teksty do stanu zadania
+static void take_pending(TickType_t now) {
+    taskENTER_CRITICAL(&regions_lock);
+    for (int i = 0; i < LCD_LINES; i++) {
+        if (!regions[i].pending) {
+            continue;
+        }
+        memcpy(lines[i].text, regions[i].text, sizeof(lines[i].text));
+        lines[i].scroll = regions[i].scroll;
+        regions[i].pending = false;
+
+        lines[i].length = (uint8_t)strlen(lines[i].text);
+        lines[i].offset = 0;
+        lines[i].next_step = now + pdMS_TO_TICKS(DISPLAY_SCROLL_PAUSE_MS);
+    }
+    taskEXIT_CRITICAL(&regions_lock);
+}
+
+static bool is_scrolling(const display_line_t *line) {
+    return line->scroll && line->length > LCD_CHARACTERS;
+}
+
+// Przesuwa przewijane linie, których krok już minął
+static void advance_scroll(TickType_t now) {
+    for (int i = 0; i < LCD_LINES; i++) {
+        display_line_t *line = &lines[i];
+        if (!is_scrolling(line) || (int32_t)(now - line->next_step) < 0) {
+            continue;
+        }
+
+        uint8_t last_offset = line->length - LCD_CHARACTERS;
+        if (line->offset < last_offset) {
+            line->offset++;
+            line->next_step = now + pdMS_TO_TICKS(line->offset == last_offset
+                                                  ? DISPLAY_SCROLL_PAUSE_MS : DISPLAY_SCROLL_STEP_MS);
+        } else {
+            line->offset = 0;
+            line->next_step = now + pdMS_TO_TICKS(DISPLAY_SCROLL_PAUSE_MS);
+        }
+    }
+}
+
+// Czas do najbliższego kroku przewijania albo portMAX_DELAY, gdy nic się nie przewija
+static TickType_t next_wakeup(TickType_t now) {
+    TickType_t wait = portMAX_DELAY;
+    for (int i = 0; i < LCD_LINES; i++) {
+        if (!is_scrolling(&lines[i])) {
+            continue;
+        }
+        int32_t remaining = (int32_t)(lines[i].next_step - now);
+        TickType_t line_wait = remaining > 0 ? (TickType_t)remaining : 0;
+        if (line_wait < wait) {
+            wait = line_wait;
+        }
+    }
+    return wait;
+}
+
+static void render(void) {
+    char window[LCD_CHARACTERS];
+
+    for (int i = 0; i < LCD_LINES; i++) {
+        const display_line_t *line = &lines[i];
+        memset(window, ' ', sizeof(window));
+        uint8_t visible = line->length - line->offset;
+        if (visible > LCD_CHARACTERS) {
+            visible = LCD_CHARACTERS;
+        }
+        memcpy(window, line->text + line->offset, visible);
+
+        if (i == 0) {
+            lcd_first_line();
+        } else {
+            lcd_second_line();
+        }
+        lcd_send_char_array(window, LCD_CHARACTERS);
+    }
+
+    // Wysyła tylko zmienione znaki
+    lcd_flush();
+}
+
+static void display_task(void *arg) {
+    i2c_master_init();
+    lcd_init();
+
+    while (1) {
+        TickType_t now = xTaskGetTickCount();
+        take_pending(now);
+        advance_scroll(now);
+        render();
+
+        ulTaskNotifyTake(pdTRUE, next_wakeup(xTaskGetTickCount()));
+    }
+}
+
+void display_init(void) {
+    display_task_handle = app_task_start(APP_TASK_DISPLAY, display_task, NULL);
+}
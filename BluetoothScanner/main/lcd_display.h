@@ -0,0 +1,28 @@
+#ifndef MAIN_LCD_DISPLAY_H_
+#define MAIN_LCD_DISPLAY_H_
+
+#include <stdint.h>
+
+#include "lcd_i2c.h"
+
+// Zadanie wyświetlacza - jedyny użytkownik magistrali I2C i sterownika lcd_i2c.
+// Funkcje display_* nigdy nie blokują: zapisują tekst w slocie linii i budzą
+// zadanie. Nowszy tekst dla tej samej linii zastępuje jeszcze nie wyświetlony.
+
+#define DISPLAY_TEXT_MAX_LEN 40     // Długość linii w DDRAM HD44780
+#define DISPLAY_SCROLL_STEP_MS 500  // Czas jednego kroku przewijania
+#define DISPLAY_SCROLL_PAUSE_MS 1500 // Postój na początku i końcu tekstu
+
+// Tworzy zadanie, które inicjalizuje I2C i wyświetlacz, a potem rysuje zmiany
+void display_init(void);
+
+// Ustawia tekst linii (0 lub 1); nadmiar ponad LCD_CHARACTERS jest obcinany
+void display_set_line(uint8_t line, const char *text);
+
+// Ekran statusu: obie linie naraz (NULL oznacza pustą linię)
+void display_show(const char *first_line, const char *second_line);
+
+// Ustawia tekst linii, który jest przewijany w pętli, jeśli nie mieści się na ekranie
+void display_scroll_line(uint8_t line, const char *text);
+
+#endif
@@ -1,4 +1,20 @@
 #include "lcd_i2c.h"
+#include "trace.h"
+
+// Bufor ekranu (shadow) i ostatni stan wysłany na wyświetlacz
+static char shadow[LCD_LINES][LCD_CHARACTERS];
+static char screen[LCD_LINES][LCD_CHARACTERS];
+static bool screen_valid = false;
+
+static uint8_t cursor_line = 0;
+static uint8_t cursor_column = 0;
+
+// Adres DDRAM, pod który trafi następny znak, albo -1, gdy nieznany
+static int hardware_address = -1;
+
+static lcd_stats_t stats;
+
+static const uint8_t line_addresses[LCD_LINES] = {LCD_LINE_ADDRESS_1, LCD_LINE_ADDRESS_2};
 
 void i2c_master_init() {
     i2c_config_t conf = {
@@ -18,6 +34,7 @@ void lcd_send_nibble(uint8_t nibble) {
     i2c_master_write_to_device(I2C_MASTER_NUM, LCD_ADDR, &data, 1, pdMS_TO_TICKS(I2C_MASTER_TIMEOUT_MS));
     data &= ~LCD_ENABLE;  // Wyłączenie EN
     i2c_master_write_to_device(I2C_MASTER_NUM, LCD_ADDR, &data, 1, pdMS_TO_TICKS(I2C_MASTER_TIMEOUT_MS));
+    stats.bytes_sent += 2;
 }
 
 void lcd_send_byte(uint8_t data, uint8_t mode) {
@@ -43,22 +60,108 @@ void lcd_init() {
     lcd_send_byte(0x01, 0); // Wyczyść wyświetlacz
     lcd_send_byte(0x06, 0); // Przesuwanie kursora w prawo
     lcd_send_byte(0x0C, 0); // Włącz wyświetlacz, wyłącz kursor
+
+    // Po 0x01 wyświetlacz jest pusty, a kursor na początku pierwszej linii
+    memset(shadow, ' ', sizeof(shadow));
+    memset(screen, ' ', sizeof(screen));
+    screen_valid = true;
+    hardware_address = LCD_LINE_ADDRESS_1;
+    cursor_line = 0;
+    cursor_column = 0;
+}
+
+// Wysyła znaki z shadow (wszystkie albo tylko zmienione), zaczynając od
+// adresu address. Zwraca liczbę bajtów HD44780; przy dry_run nic nie wysyła.
+static uint32_t write_cells(bool all, bool dry_run, int address) {
+    uint32_t bytes = 0;
+
+    for (int line = 0; line < LCD_LINES; line++) {
+        for (int column = 0; column < LCD_CHARACTERS; column++) {
+            char character = shadow[line][column];
+            if (!all && screen_valid && screen[line][column] == character) {
+                continue;
+            }
+
+            // Przeskok nad niezmienionymi znakami (i zmiana linii) kosztuje jedną komendę
+            int cell_address = line_addresses[line] + column;
+            if (address != cell_address) {
+                if (!dry_run) {
+                    lcd_send_byte(LCD_SET_DDRAM_ADDR | cell_address, 0);
+                }
+                bytes++;
+            }
+            if (!dry_run) {
+                lcd_send_byte((uint8_t)character, LCD_RS);
+                screen[line][column] = character;
+            }
+            bytes++;
+            address = cell_address + 1;
+        }
+    }
+
+    if (!dry_run) {
+        hardware_address = address;
+    }
+    return bytes;
+}
+
+void lcd_flush() {
+    TRACE(TRACE_LCD_FLUSH_BEGIN, 0);
+    uint32_t sent_before = stats.bytes_sent;
+
+    if (!screen_valid) {
+        // Powrót kursora cofa też przesunięcie ekranu po lcd_scroll_*
+        lcd_send_byte(0x02, 0);
+        vTaskDelay(pdMS_TO_TICKS(2));
+        hardware_address = LCD_LINE_ADDRESS_1;
+    }
+
+    // Rozproszone zmiany mogą kosztować więcej komend adresu niż przepisanie
+    // wszystkich znaków, więc wybierany jest tańszy wariant
+    bool all = write_cells(true, true, hardware_address) < write_cells(false, true, hardware_address);
+    write_cells(all, false, hardware_address);
+    screen_valid = true;
+
+    // Pełne przerysowanie: komenda adresu i wszystkie znaki każdej linii
+    uint32_t full_redraw = LCD_LINES * (1 + LCD_CHARACTERS) * 4;
+    uint32_t sent = stats.bytes_sent - sent_before;
+    stats.flushes++;
+    if (sent < full_redraw) {
+        stats.bytes_saved += full_redraw - sent;
+    }
+    TRACE(TRACE_LCD_FLUSH_END, sent);
+}
+
+void lcd_get_stats(lcd_stats_t *out) {
+    *out = stats;
 }
 
 void lcd_first_line() {
-	lcd_send_byte(0x80, 0);
+	cursor_line = 0;
+	cursor_column = 0;
 }
 
 void lcd_second_line() {
-	lcd_send_byte(0xC0, 0);
+	cursor_line = 1;
+	cursor_column = 0;
 }
 
 void lcd_clear() {
-	lcd_send_byte(0x01, 0);
+	memset(shadow, ' ', sizeof(shadow));
+	cursor_line = 0;
+	cursor_column = 0;
 }
 
+// Przewijany tekst jest dłuższy niż linia bufora, więc idzie bezpośrednio na
+// wyświetlacz; następny lcd_flush cofa przesunięcie i przerysowuje cały ekran.
 void lcd_scroll_text(const char *text) {
-    lcd_send_string(text);
+    lcd_flush();
+    lcd_send_byte(LCD_SET_DDRAM_ADDR | (line_addresses[cursor_line] + cursor_column), 0);
+    for (const char *c = text; *c; c++) {
+        lcd_send_byte((uint8_t)*c, LCD_RS);
+    }
+    screen_valid = false;
+    hardware_address = -1;
 	
 	vTaskDelay(1000 / portTICK_PERIOD_MS);
 	
@@ -67,14 +170,17 @@ void lcd_scroll_text(const char *text) {
 
 void lcd_scroll_left() {
 	lcd_send_byte(0x1C, 0);
+	screen_valid = false;
 }
 
 void lcd_scroll_right() {
 	lcd_send_byte(0x18, 0);
+	screen_valid = false;
 }
 
 void lcd_scroll(int direction) {
 	lcd_send_byte(direction, 0);
+	screen_valid = false;
 }
 
 void lcd_scroll_by(int characters, int direction) {
@@ -82,10 +188,14 @@ void lcd_scroll_by(int characters, int direction) {
 		vTaskDelay(500 / portTICK_PERIOD_MS);
         lcd_send_byte(direction, 0);  // Przesuń w lewo
     }
+    screen_valid = false;
 }
 
 void lcd_send_char(char character) {
-    lcd_send_byte(character, LCD_RS);
+    // Znaki poza końcem linii są obcinane
+    if (cursor_column < LCD_CHARACTERS) {
+        shadow[cursor_line][cursor_column++] = character;
+    }
 }
 
 void lcd_send_string(const char *str) {
@@ -103,7 +213,7 @@ void lcd_send_char_array(char* str, int size) {
 void lcd_send_int(int value) {
 	char str[12];
 
-	itoa(value, str, 10);
+	snprintf(str, sizeof(str), "%d", value);
 	
 	lcd_send_string(str);
 }
\ No newline at end of file
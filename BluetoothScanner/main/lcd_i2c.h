@@ -27,6 +27,17 @@
 
 #define LCD_DELAY() vTaskDelay(500 / portTICK_PERIOD_MS)
 
+#define LCD_LINE_ADDRESS_1 0x00 // Adres DDRAM początku pierwszej linii
+#define LCD_LINE_ADDRESS_2 0x40 // Adres DDRAM początku drugiej linii
+#define LCD_SET_DDRAM_ADDR 0x80 // Komenda ustawienia kursora (| adres)
+
+// Liczniki bajtów wysłanych po I2C (każdy bajt HD44780 to 4 zapisy do PCF8574)
+typedef struct {
+    uint32_t flushes;
+    uint32_t bytes_sent;
+    uint32_t bytes_saved; // Względem przerysowania całego ekranu przy każdym lcd_flush (nie maleje)
+} lcd_stats_t;
+
 void i2c_master_init();
 
 void lcd_send_nibble(uint8_t nibble);
@@ -35,6 +46,13 @@ void lcd_send_byte(uint8_t data, uint8_t mode);
 
 void lcd_init();
 
+// lcd_clear, lcd_first_line, lcd_second_line i lcd_send_* piszą tylko do bufora
+// w RAM. Na wyświetlacz trafiają dopiero w lcd_flush(), który wysyła wyłącznie
+// zmienione znaki.
+void lcd_flush();
+
+void lcd_get_stats(lcd_stats_t *stats);
+
 void lcd_send_char(char character);
 
 void lcd_send_string(const char *str);
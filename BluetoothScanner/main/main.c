@@ -1,25 +1,31 @@
 #include "common.h"
 #include "ble.h"
-#include "lcd_i2c.h"
+#include "lcd_display.h"
 #include "esp_system.h"
+#include "esp_random.h"
 #include "mqtt_client.h"
+#include "esp_timer.h"
 #include "ble_scanner.h"
-
-#define NVS_NAMESPACE "wifi_config"
-#define NVS_KEY_SSID  "ssid"
-#define NVS_KEY_PASS  "password"
-
-#define NVS_KEY_BROKER "broker"
-#define NVS_KEY_BOARD_NAME "board_name"
-
-#define DEFAULT_BOARD_NAME "pokoj_1"
+#include "sighting_queue.h"
+#include "device_table.h"
+#include "sighting_publisher.h"
+#include "sighting_log.h"
+#include "app_config.h"
+#include "scan_filter.h"
+#include "tag_allowlist.h"
+#include "perf_counters.h"
+#include "board_stats.h"
+#include "trace.h"
+#include "app_tasks.h"
+#include "time_sync.h"
+#include "latency_probe.h"
+#include "board_command.h"
+#include "config_tlv.h"
 
 // Button configuration
 #define BUTTON_GPIO        GPIO_NUM_0
 #define BUTTON_ACTIVE_LEVEL 0
 
-#define DEFAULT_MQTT_BROKER_IP "mqtt://192.168.241.246"
-
 #include "driver/gpio.h"
 
 #define LED_PIN GPIO_NUM_18 // Wybierz GPIO dla diody LED
@@ -32,12 +38,12 @@ static bool wifi_connected = false;
 static bool wifi_mode = false; // Wi-Fi connection mode ON/OFF
 static bool mqtt_connected = false;
 
-static char board_name[30] = {0};
-static char broker_ip[30] = {0};
+static char board_name[APP_CONFIG_BOARD_NAME_LEN] = {0};
+static char broker_ip[APP_CONFIG_BROKER_URI_LEN] = {0};
 
 static void wifi_init_sta(const char *ssid, const char *pass);
 static void wifi_stop(void);
-static void wifi_try_connect_from_nvs(void);
+static void wifi_try_connect_from_config(void);
 
 // Funkcja taska migania diodą LED
 void blink_led_task(void *pvParameter) {
@@ -56,146 +62,17 @@ void blink_led_task(void *pvParameter) {
 }
 
 ////////////////////////////////////////
-// NVS Handling
+// Configuration
 ////////////////////////////////////////
 
-static esp_err_t save_str_to_nvs(const char* key, const char* value) {
-    nvs_handle_t nvs_handle;
-    esp_err_t err = nvs_open(NVS_NAMESPACE, NVS_READWRITE, &nvs_handle);
-    if (err != ESP_OK) {
-        ESP_LOGE(GATTS_TAG, "Error opening NVS: %s", esp_err_to_name(err));
-        return err;
-    }
-    err = nvs_set_str(nvs_handle, key, value);
-    if (err != ESP_OK) {
-        ESP_LOGE(GATTS_TAG, "Error writing to NVS: %s", esp_err_to_name(err));
-        nvs_close(nvs_handle);
-        return err;
-    }
-    err = nvs_commit(nvs_handle);
-    nvs_close(nvs_handle);
-    if (err != ESP_OK) {
-        ESP_LOGE(GATTS_TAG, "Error committing to NVS: %s", esp_err_to_name(err));
-    } else {
-        ESP_LOGI(GATTS_TAG, "Saved %s to NVS", key);
-    }
-    return err;
-}
-
-static bool print_current_nvs_creds(void) {
-    nvs_handle_t nvs_handle;
-    char ssid[64] = {0}, pass[64] = {0};
-    size_t len;
+static void print_current_creds(void) {
+    app_config_t config;
+    app_config_get(&config);
 
-    if (nvs_open(NVS_NAMESPACE, NVS_READONLY, &nvs_handle) != ESP_OK) {
-        ESP_LOGI(GATTS_TAG, "No NVS Namespace found");
-        return false;
-    }
-    len = sizeof(ssid);
-    if (nvs_get_str(nvs_handle, NVS_KEY_SSID, ssid, &len) != ESP_OK) {
-        nvs_close(nvs_handle);
-        ESP_LOGI(GATTS_TAG, "No SSID in NVS");
-        return false;
-    }
-    len = sizeof(pass);
-    if (nvs_get_str(nvs_handle, NVS_KEY_PASS, pass, &len) != ESP_OK) {
-        nvs_close(nvs_handle);
-        ESP_LOGI(GATTS_TAG, "No PASS in NVS");
-        return false;
-    }
-    nvs_close(nvs_handle);
-
-    ESP_LOGI(GATTS_TAG, "Current NVS creds: SSID=%s PASS=%s", ssid, pass);
-    
-    lcd_clear();
-    
-    lcd_first_line();
-    
-    lcd_send_string(ssid);
-    
-    lcd_second_line();
-    
-    lcd_send_string(pass);
+    ESP_LOGI(GATTS_TAG, "Current creds: SSID=%s PASS=%s", config.wifi_ssid, config.wifi_password);
     
-    return true;
-}
-
-static bool get_broker_ip_from_nvs(char* broker_ip, size_t len) {
-    nvs_handle_t nvs_handle;
-    esp_err_t err;
-
-    // Otwarcie przestrzeni nazw NVS w trybie tylko do odczytu
-    err = nvs_open(NVS_NAMESPACE, NVS_READONLY, &nvs_handle);
-    if (err != ESP_OK) {
-        ESP_LOGI(GATTS_TAG, "No NVS Namespace found");
-        snprintf(broker_ip, len, DEFAULT_MQTT_BROKER_IP);  // Domyślny adres IP brokera
-        return false;
-    }
-
-    // Odczytanie wartości IP brokera z NVS
-    err = nvs_get_str(nvs_handle, NVS_KEY_BROKER, broker_ip, &len);
-    nvs_close(nvs_handle);
-
-    if (err != ESP_OK) {
-        ESP_LOGI(GATTS_TAG, "No broker IP in NVS, using default");
-        snprintf(broker_ip, len, DEFAULT_MQTT_BROKER_IP);  // Domyślny adres IP brokera
-        return false;
-    }
-
-    ESP_LOGI(GATTS_TAG, "Broker IP from NVS: %s", broker_ip);
-    return true;
-}
-
-// Funkcja do odczytu nazwy płytki
-static bool get_board_name_from_nvs(char* board_name, size_t len) {
-    nvs_handle_t nvs_handle;
-    esp_err_t err;
-
-    // Otwarcie przestrzeni nazw NVS w trybie tylko do odczytu
-    err = nvs_open(NVS_NAMESPACE, NVS_READONLY, &nvs_handle);
-    if (err != ESP_OK) {
-        ESP_LOGI(GATTS_TAG, "No NVS Namespace found");
-        snprintf(board_name, len, DEFAULT_BOARD_NAME);  // Domyślna nazwa płytki
-        return false;
-    }
-
-    // Odczytanie nazwy płytki z NVS
-    err = nvs_get_str(nvs_handle, NVS_KEY_BOARD_NAME, board_name, &len);
-    nvs_close(nvs_handle);
-
-    if (err != ESP_OK) {
-        ESP_LOGI(GATTS_TAG, "No board name in NVS, using default");
-        snprintf(board_name, len, DEFAULT_BOARD_NAME);  // Domyślna nazwa płytki
-        return false;
-    }
-
-    ESP_LOGI(GATTS_TAG, "Board name from NVS: %s", board_name);
-    return true;
-}
-
-// Funkcja do odczytu nazwy płytki
-static bool get_wifi_ssid_from_nvs(char* wifi_ssid, size_t len) {
-    nvs_handle_t nvs_handle;
-    esp_err_t err;
-
-    err = nvs_open(NVS_NAMESPACE, NVS_READONLY, &nvs_handle);
-    if (err != ESP_OK) {
-        ESP_LOGI(GATTS_TAG, "No NVS Namespace found");
-        snprintf(wifi_ssid, len, "not set");
-        return false;
-    }
-
-    err = nvs_get_str(nvs_handle, NVS_KEY_SSID, wifi_ssid, &len);
-    nvs_close(nvs_handle);
-
-    if (err != ESP_OK) {
-        ESP_LOGI(GATTS_TAG, "No wifi ssid in NVS");
-        snprintf(wifi_ssid, len, "not set");
-        return false;
-    }
-
-    ESP_LOGI(GATTS_TAG, "Board name from NVS: %s", wifi_ssid);
-    return true;
+    display_scroll_line(0, config.wifi_ssid);
+    display_scroll_line(1, config.wifi_password);
 }
 
 ////////////////////////////////////////
@@ -206,6 +83,7 @@ static int wifi_connection_attempt_count = 0;
 
 static void wifi_event_handler(void *arg, esp_event_base_t event_base, 
                                int32_t event_id, void *event_data) {
+    TRACE(TRACE_WIFI_EVENT_BEGIN, event_id);
     if (event_base == WIFI_EVENT && event_id == WIFI_EVENT_STA_START && wifi_mode) {
         ESP_LOGI(WIFI_TAG, "Wi-Fi STA start event, attempting to connect...");
         esp_wifi_connect();
@@ -220,13 +98,11 @@ static void wifi_event_handler(void *arg, esp_event_base_t event_base,
             ESP_LOGI(WIFI_TAG, "Wi-Fi mode is ON, retrying connection...");
             
             wifi_connection_attempt_count++;
+            perf_count(PERF_WIFI_RECONNECTS);
             
-            lcd_clear();
-            lcd_first_line();
-            lcd_send_string("Connecting wifi");
-            lcd_second_line();
-            lcd_send_string("Attempt: ");
-            lcd_send_int(wifi_connection_attempt_count);       
+            char attempt[DISPLAY_TEXT_MAX_LEN + 1];
+            snprintf(attempt, sizeof(attempt), "Attempt: %d", wifi_connection_attempt_count);
+            display_show("Connecting wifi", attempt);
             
             esp_wifi_connect();
         } else {
@@ -239,10 +115,10 @@ static void wifi_event_handler(void *arg, esp_event_base_t event_base,
         wifi_connected = true;
         wifi_connection_attempt_count = 0;
         xEventGroupSetBits(wifi_event_group, WIFI_CONNECTED_BIT);
-        lcd_clear();
-        lcd_first_line();
-        lcd_send_string("Connected Wi-Fi");
+        display_show("Connected Wi-Fi", NULL);
+        time_sync_start(CONFIG_TIME_SYNC_SERVER);
     }
+    TRACE(TRACE_WIFI_EVENT_END, event_id);
 }
 
 static esp_err_t unregister_wifi_event_handlers(void) {
@@ -262,7 +138,11 @@ static esp_err_t unregister_wifi_event_handlers(void) {
 }
 
 static void wifi_init_sta(const char *ssid, const char *pass) {
-	esp_netif_create_default_wifi_sta();
+	// Interfejs STA jest tworzony raz; każde wywołanie alokowałoby nowy
+	static esp_netif_t *sta_netif = NULL;
+	if(sta_netif == NULL) {
+		sta_netif = esp_netif_create_default_wifi_sta();
+	}
 	
 	wifi_init_config_t cfg = WIFI_INIT_CONFIG_DEFAULT();
     ESP_ERROR_CHECK(esp_wifi_init(&cfg));
@@ -281,12 +161,16 @@ static void wifi_init_sta(const char *ssid, const char *pass) {
         wifi_stop();
     }
 	
-	if(wifi_event_group != NULL) {
-		vEventGroupDelete(wifi_event_group);
-		wifi_event_group = NULL;
+	// Grupa zdarzeń tworzona raz - przy ponownym łączeniu tylko czyszczone są bity
+	if(wifi_event_group == NULL) {
+#if CONFIG_STATIC_ALLOCATION
+		static StaticEventGroup_t wifi_event_group_buffer;
+		wifi_event_group = xEventGroupCreateStatic(&wifi_event_group_buffer);
+#else
+		wifi_event_group = xEventGroupCreate();
+#endif
 	}
-	
-    wifi_event_group = xEventGroupCreate();
+	xEventGroupClearBits(wifi_event_group, WIFI_CONNECTED_BIT | WIFI_DISCONNECTED_BIT);
     
     wifi_config_t wifi_config = {0};
     strncpy((char*)wifi_config.sta.ssid, ssid, sizeof(wifi_config.sta.ssid));
@@ -322,32 +206,18 @@ static void wifi_stop(void) {
     }
 }
 
-static void wifi_try_connect_from_nvs(void) {
+static void wifi_try_connect_from_config(void) {
     if (!wifi_mode) {
         ESP_LOGI(WIFI_TAG, "Wi-Fi mode is OFF, not connecting");
         return;
     }
 
-    nvs_handle_t nvs_handle;
-    char ssid[64] = {0}, pass[64] = {0};
-    size_t len;
-    bool creds_found = false;
-
-    if (nvs_open(NVS_NAMESPACE, NVS_READONLY, &nvs_handle) == ESP_OK) {
-        len = sizeof(ssid);
-        if (nvs_get_str(nvs_handle, NVS_KEY_SSID, ssid, &len) == ESP_OK) {
-			ESP_LOGI(WIFI_TAG, "Got SSID: %s", ssid);
-            len = sizeof(pass);
-            if (nvs_get_str(nvs_handle, NVS_KEY_PASS, pass, &len) == ESP_OK) {
-				ESP_LOGI(WIFI_TAG, "Got password: %s", pass);
-                creds_found = true;
-            }
-        }
-        nvs_close(nvs_handle);
-    }
+    char ssid[APP_CONFIG_SSID_LEN], pass[APP_CONFIG_PASSWORD_LEN];
+    bool creds_found = app_config_get_str(APP_CONFIG_WIFI_SSID, ssid, sizeof(ssid)) &&
+                       app_config_get_str(APP_CONFIG_WIFI_PASSWORD, pass, sizeof(pass));
 
     if (creds_found) {
-        ESP_LOGI(WIFI_TAG, "Connecting Wi-Fi using NVS creds");
+        ESP_LOGI(WIFI_TAG, "Connecting Wi-Fi using stored creds: SSID=%s", ssid);
         wifi_init_sta(ssid, pass);
     } else {
         ESP_LOGI(WIFI_TAG, "No creds in NVS, cannot connect Wi-Fi");
@@ -380,11 +250,7 @@ static void button_task(void *arg) {
                 } else {
                     ESP_LOGI(BUTTON_TAG, "Wi-Fi mode OFF, stopping Wi-Fi if running");     
                                 
-                    lcd_clear();
-                    lcd_first_line();
-    				lcd_send_string("Configuration");
-    				lcd_second_line();
-    				lcd_send_string("mode"); 	            
+                    display_show("Configuration", "mode");
                                    
                     wifi_stop();
                     esp_ble_gap_start_advertising(get_adv_params());
@@ -399,33 +265,36 @@ static void button_task(void *arg) {
 // Main Application
 ////////////////////////////////////////
 
+// Odczyty charakterystyk GATT są obsługiwane z RAM, zapisy trafiają do NVS z opóźnieniem
 void on_ssid_received(const char* ssid, char* retrive_buffer) {
 	if(retrive_buffer) {
-		get_wifi_ssid_from_nvs(retrive_buffer, RETRIVE_BUFFER_SIZE);
+		app_config_get_str(APP_CONFIG_WIFI_SSID, retrive_buffer, RETRIVE_BUFFER_SIZE);
 	}
 	else {
-		save_str_to_nvs(NVS_KEY_SSID, ssid);
+		app_config_set_str(APP_CONFIG_WIFI_SSID, ssid);
 	
-		print_current_nvs_creds();
+		print_current_creds();
 	}
 }
 
 void on_password_received(const char* password, char* retrive_buffer) {
-	save_str_to_nvs(NVS_KEY_PASS, password);
+	if(password) {
+		app_config_set_str(APP_CONFIG_WIFI_PASSWORD, password);
 	
-	print_current_nvs_creds();
+		print_current_creds();
+	}
 }
 
 void on_broker_ip_received(const char* broker_ip, char* retrive_buffer) {
 	if(retrive_buffer) {
-		get_broker_ip_from_nvs(retrive_buffer, RETRIVE_BUFFER_SIZE);
+		app_config_get_str(APP_CONFIG_BROKER_URI, retrive_buffer, RETRIVE_BUFFER_SIZE);
 	}
 	else {
-		char prefixed_broker_ip[64];
+		char prefixed_broker_ip[APP_CONFIG_BROKER_URI_LEN];
 
     	snprintf(prefixed_broker_ip, sizeof(prefixed_broker_ip), "mqtt://%s", broker_ip);
 
-    	save_str_to_nvs(NVS_KEY_BROKER, prefixed_broker_ip);
+    	app_config_set_str(APP_CONFIG_BROKER_URI, prefixed_broker_ip);
 
     	ESP_LOGI(MAIN_TAG, "Saved broker IP: %s", prefixed_broker_ip);
 	}
@@ -434,10 +303,10 @@ void on_broker_ip_received(const char* broker_ip, char* retrive_buffer) {
 void on_board_name_received(const char* board_name, char* retrive_buffer) {
 	
 	if(retrive_buffer) {
-		get_board_name_from_nvs(retrive_buffer, RETRIVE_BUFFER_SIZE);
+		app_config_get_str(APP_CONFIG_BOARD_NAME, retrive_buffer, RETRIVE_BUFFER_SIZE);
 	}
 	else {
-		save_str_to_nvs(NVS_KEY_BOARD_NAME, board_name);
+		app_config_set_str(APP_CONFIG_BOARD_NAME, board_name);
 	}
 }
 
@@ -448,10 +317,324 @@ static void log_error_if_nonzero(const char *message, int error_code)
     }
 }
 
+// Filtr skanowania
+
+// Kompiluje i instaluje reguły filtra; przy persist zapisuje je w konfiguracji
+static bool apply_scan_filter(const char *rules, bool persist, char *error, size_t error_len) {
+    static scan_filter_t filter; // Poza stosem wywołującego zadania
+    if (persist && strlen(rules) >= APP_CONFIG_SCAN_FILTER_LEN) {
+        snprintf(error, error_len, "rules longer than %d characters", APP_CONFIG_SCAN_FILTER_LEN - 1);
+        return false;
+    }
+    if (!scan_filter_compile(rules, &filter, error, error_len)) {
+        return false;
+    }
+    scan_filter_install(&filter);
+    if (persist) {
+        app_config_set_str(APP_CONFIG_SCAN_FILTER, rules);
+    }
+    ESP_LOGI(MAIN_TAG, "Scan filter: %d rules, default %s", filter.count,
+             filter.default_action == SCAN_FILTER_INCLUDE ? "include" : "exclude");
+    return true;
+}
+
+static void load_scan_filter(void) {
+    char rules[APP_CONFIG_SCAN_FILTER_LEN];
+    char error[64];
+    app_config_get_str(APP_CONFIG_SCAN_FILTER, rules, sizeof(rules));
+    if (!apply_scan_filter(rules, false, error, sizeof(error))) {
+        ESP_LOGE(MAIN_TAG, "Invalid stored scan filter (%s), using: %s", error, SCAN_FILTER_DEFAULT_RULES);
+    }
+}
+
 static esp_mqtt_client_handle_t mqtt_client = NULL;
 
+// Parametry skanowania
+
+// Konfiguracja zapisana poleceniem scan; pusta oznacza wartości z Kconfig
+static void load_scan_params(void) {
+    char text[APP_CONFIG_SCAN_PARAMS_LEN];
+    char error[64];
+    scan_config_t config;
+    app_config_get_str(APP_CONFIG_SCAN_PARAMS, text, sizeof(text));
+    if (text[0] == '\0') {
+        return;
+    }
+    scan_config_default(&config);
+    if (!scan_config_parse(text, &config, error, sizeof(error)) ||
+        !ble_scanner_set_config(&config, error, sizeof(error))) {
+        ESP_LOGE(MAIN_TAG, "Invalid stored scan params (%s), using defaults", error);
+    }
+}
+
+#if CONFIG_TRACE
+#define TRACE_CHUNK_SIZE 1024
+
+// Zrzut śladu wysyłany na /<płytka>/trace w wiadomościach z pełnymi liniami
+typedef struct {
+    esp_mqtt_client_handle_t client;
+    char topic[64];
+    char chunk[TRACE_CHUNK_SIZE];
+    size_t length;
+} trace_mqtt_writer_t;
+
+static void trace_publish_chunk(trace_mqtt_writer_t *writer) {
+    if (writer->length > 0) {
+        esp_mqtt_client_publish(writer->client, writer->topic, writer->chunk, writer->length, 0, 0);
+        writer->length = 0;
+    }
+}
+
+static void trace_write_mqtt(const char *text, size_t length, void *ctx) {
+    trace_mqtt_writer_t *writer = ctx;
+    if (writer->length + length > sizeof(writer->chunk)) {
+        trace_publish_chunk(writer);
+    }
+    memcpy(writer->chunk + writer->length, text, length);
+    writer->length += length;
+}
+
+static void trace_write_uart(const char *text, size_t length, void *ctx) {
+    fwrite(text, 1, length, stdout);
+}
+#endif
+
+// Polecenia zdalne (board_command.h)
+
+static bool command_introduce(const char *args, char *result, size_t result_len) {
+    int msg_id = esp_mqtt_client_publish(mqtt_client, "/boards", board_name, 0, 1, 0);
+    ESP_LOGI(MAIN_TAG, "Published board name '%s' to topic '/boards', msg_id=%d", board_name, msg_id);
+    return true;
+}
+
+// "filter <reguły>" - poza potwierdzeniem odpowiedź "ok"/"error: ..." na /<płytka>/filter
+static bool command_filter(const char *args, char *result, size_t result_len) {
+    char reply[80];
+    bool ok = apply_scan_filter(args, true, result, result_len);
+    if (ok) {
+        snprintf(reply, sizeof(reply), "ok");
+    } else {
+        ESP_LOGE(MAIN_TAG, "Rejected scan filter: %s", result);
+        snprintf(reply, sizeof(reply), "error: %s", result);
+    }
+
+    char topic[64];
+    snprintf(topic, sizeof(topic), "/%s/filter", board_name);
+    esp_mqtt_client_publish(mqtt_client, topic, reply, 0, 1, 0);
+    return ok;
+}
+
+#if CONFIG_TRACE
+// "trace [uart]" - zrzut na /<płytka>/trace albo na konsolę
+static bool command_trace(const char *args, char *result, size_t result_len) {
+    if (strcmp(args, "uart") == 0) {
+        trace_dump(trace_write_uart, NULL);
+        fflush(stdout);
+        return true;
+    }
+
+    static trace_mqtt_writer_t writer; // Poza stosem zadania esp-mqtt
+    writer.client = mqtt_client;
+    writer.length = 0;
+    snprintf(writer.topic, sizeof(writer.topic), "/%s/trace", board_name);
+    trace_dump(trace_write_mqtt, &writer);
+    trace_publish_chunk(&writer);
+    return true;
+}
+#endif
+
+// "scan [interval=N] [window=N] [duration=S] [pause=S] [type=active|passive]" -
+// bez argumentów zwraca bieżącą konfigurację, pominięte klucze zostają bez zmian
+static bool command_scan(const char *args, char *result, size_t result_len) {
+    scan_config_t config;
+    ble_scanner_get_config(&config);
+    if (args[0] != '\0') {
+        if (!scan_config_parse(args, &config, result, result_len) ||
+            !ble_scanner_set_config(&config, result, result_len)) {
+            ESP_LOGE(MAIN_TAG, "Rejected scan params: %s", result);
+            return false;
+        }
+        char text[SCAN_CONFIG_TEXT_LEN];
+        scan_config_format(&config, text, sizeof(text));
+        app_config_set_str(APP_CONFIG_SCAN_PARAMS, text);
+        ESP_LOGI(MAIN_TAG, "Scan params: %s", text);
+    }
+    scan_config_format(&config, result, result_len);
+    return true;
+}
+
+static const board_command_t board_commands[] = {
+    {"introduce", command_introduce, BOARD_COMMAND_NO_TARGET | BOARD_COMMAND_NO_ACK},
+    {"filter", command_filter, 0},
+#if CONFIG_TRACE
+    {"trace", command_trace, 0},
+#endif
+    {"scan", command_scan, 0},
+};
+
+// /<płytka>/command, ustawiany w app_main
+static char command_topic[APP_CONFIG_BOARD_NAME_LEN + 16];
+
+static bool is_topic(esp_mqtt_event_handle_t event, const char *topic) {
+    int len = strlen(topic);
+    return event->topic_len == len && strncmp(event->topic, topic, len) == 0;
+}
+
+static void handle_board_command(esp_mqtt_client_handle_t client, board_command_source_t source,
+                                 esp_mqtt_event_handle_t event) {
+    // Polecenia mieszczą się w jednym zdarzeniu; dłuższych wiadomości nie składamy
+    if (event->current_data_offset != 0 || event->data_len != event->total_data_len) {
+        ESP_LOGE(MAIN_TAG, "Command too long (%d bytes)", event->total_data_len);
+        return;
+    }
+    static char ack[BOARD_COMMAND_ACK_LEN]; // Poza stosem zadania esp-mqtt
+    size_t ack_len = board_command_dispatch(source, event->data, event->data_len, ack, sizeof(ack));
+    if (ack_len > 0) {
+        char topic[64];
+        snprintf(topic, sizeof(topic), "/%s/command/ack", board_name);
+        esp_mqtt_client_publish(client, topic, ack, ack_len, 1, 0);
+    }
+}
+
+// Konfiguracja zbiorcza przez GATT (config_tlv.h)
+
+// Błąd ostatniego odrzuconego zapisu, zwracany w odczycie zbiorczym
+static char bulk_config_error[64] = "";
+
+// Wszystkie pola są sprawdzane przed zmianą czegokolwiek; zapis do NVS jednym commitem
+bool on_bulk_config_received(const uint8_t *data, size_t len, bool *restart, char *error, size_t error_len) {
+    static config_tlv_update_t update; // Poza stosem zadania BTC
+    static scan_filter_t filter;
+    scan_config_t scan;
+    uint32_t fields = 0;
+
+    bool ok = config_tlv_decode(data, len, &update, error, error_len);
+    if (ok) {
+        fields = update.fields;
+    }
+    if (ok && (fields & (1u << APP_CONFIG_BOARD_NAME)) && update.values.board_name[0] == '\0') {
+        snprintf(error, error_len, "empty board name");
+        ok = false;
+    }
+    if (ok && (fields & (1u << APP_CONFIG_BROKER_URI)) && strstr(update.values.broker_uri, "://") == NULL) {
+        char uri[APP_CONFIG_BROKER_URI_LEN];
+        if (snprintf(uri, sizeof(uri), "mqtt://%s", update.values.broker_uri) >= (int)sizeof(uri)) {
+            snprintf(error, error_len, "broker address too long");
+            ok = false;
+        } else {
+            strcpy(update.values.broker_uri, uri);
+        }
+    }
+    if (ok && (fields & (1u << APP_CONFIG_SCAN_FILTER))) {
+        ok = scan_filter_compile(update.values.scan_filter, &filter, error, error_len);
+    }
+    if (ok && (fields & (1u << APP_CONFIG_SCAN_PARAMS))) {
+        scan_config_default(&scan);
+        ok = scan_config_parse(update.values.scan_params, &scan, error, error_len) &&
+             scan_config_validate(&scan, error, error_len);
+        if (ok && update.values.scan_params[0] != '\0') {
+            scan_config_format(&scan, update.values.scan_params, sizeof(update.values.scan_params));
+        }
+    }
+    if (!ok) {
+        snprintf(bulk_config_error, sizeof(bulk_config_error), "%s", error);
+        return false;
+    }
+
+    app_config_set_fields(&update.values, fields);
+    bulk_config_error[0] = '\0';
+    ESP_LOGI(MAIN_TAG, "Bulk config saved (fields 0x%02" PRIx32 "%s)", fields, update.restart ? ", restart" : "");
+
+    if (fields & (1u << APP_CONFIG_SCAN_FILTER)) {
+        scan_filter_install(&filter);
+    }
+    if (fields & (1u << APP_CONFIG_SCAN_PARAMS)) {
+        ble_scanner_set_config(&scan, error, error_len);
+    }
+    if (fields & ((1u << APP_CONFIG_WIFI_SSID) | (1u << APP_CONFIG_WIFI_PASSWORD))) {
+        print_current_creds();
+    }
+    *restart = update.restart;
+    return true;
+}
+
+size_t on_bulk_config_read(uint8_t *out, size_t capacity) {
+    static app_config_t config; // Poza stosem zadania BTC
+    app_config_get(&config);
+    uint32_t fields = ((1u << APP_CONFIG_FIELD_COUNT) - 1) & ~(1u << APP_CONFIG_WIFI_PASSWORD);
+    return config_tlv_encode(&config, fields, bulk_config_error, out, capacity);
+}
+
+#if CONFIG_TAG_ALLOWLIST
+#if CONFIG_TAG_ALLOWLIST_EXACT_CHECK
+#define TAG_ALLOWLIST_EXACT_CHECK true
+#else
+#define TAG_ALLOWLIST_EXACT_CHECK false
+#endif
+
+// Lista tagów na /<płytka>/tags: posortowane rosnąco 6-bajtowe adresy bez separatorów.
+// Duże wiadomości esp-mqtt dostarcza w kilku zdarzeniach, topic ma tylko pierwsze.
+static bool tags_upload_active = false;
+
+static void publish_tags_status(esp_mqtt_client_handle_t client, const char *status) {
+    char topic[64];
+    snprintf(topic, sizeof(topic), "/%s/tags/status", board_name);
+    esp_mqtt_client_publish(client, topic, status, 0, 1, 0);
+}
+
+static void fail_tags_upload(esp_mqtt_client_handle_t client, const char *error) {
+    char status[64];
+    tags_upload_active = false;
+    ESP_LOGE(MAIN_TAG, "Tag list upload failed: %s", error);
+    snprintf(status, sizeof(status), "error: %s", error);
+    publish_tags_status(client, status);
+}
+
+static bool is_tags_topic(esp_mqtt_event_handle_t event) {
+    char topic[64];
+    int len = snprintf(topic, sizeof(topic), "/%s/tags", board_name);
+    return event->topic_len == len && strncmp(event->topic, topic, len) == 0;
+}
+
+static void handle_tags_upload(esp_mqtt_client_handle_t client, esp_mqtt_event_handle_t event) {
+    if (event->current_data_offset == 0) {
+        if (event->total_data_len % SIGHTING_BDA_LEN != 0) {
+            fail_tags_upload(client, "length is not a multiple of 6");
+            return;
+        }
+        tags_upload_active = tag_allowlist_begin(event->total_data_len / SIGHTING_BDA_LEN);
+        if (!tags_upload_active) {
+            fail_tags_upload(client, tag_allowlist_error());
+            return;
+        }
+    }
+    if (!tags_upload_active) {
+        return;
+    }
+
+    if (!tag_allowlist_append((const uint8_t *)event->data, event->data_len)) {
+        fail_tags_upload(client, tag_allowlist_error());
+        return;
+    }
+    if (event->current_data_offset + event->data_len < event->total_data_len) {
+        return;
+    }
+
+    tags_upload_active = false;
+    if (!tag_allowlist_commit()) {
+        fail_tags_upload(client, tag_allowlist_error());
+        return;
+    }
+    char status[32];
+    snprintf(status, sizeof(status), "ok %d", event->total_data_len / SIGHTING_BDA_LEN);
+    ESP_LOGI(MAIN_TAG, "Tag list updated: %d tags", event->total_data_len / SIGHTING_BDA_LEN);
+    publish_tags_status(client, status);
+}
+#endif
+
 static void mqtt_event_handler(void *handler_args, esp_event_base_t base, int32_t event_id, void *event_data)
 {
+    TRACE(TRACE_MQTT_EVENT_BEGIN, event_id);
     esp_mqtt_event_handle_t event = event_data;
     mqtt_client = event->client;
     esp_mqtt_client_handle_t client = event->client;
@@ -463,9 +646,20 @@ static void mqtt_event_handler(void *handler_args, esp_event_base_t base, int32_
         //msg_id = esp_mqtt_client_publish(client, "/topic/ble_devices", "device:smartphone2;rssi:-42", 0, 1, 0);
         //msg_id = esp_mqtt_client_publish(client, "/topic/ble_devices", "device:smartphone3;rssi:-48", 0, 1, 0);
         mqtt_connected = true;
+        sighting_publisher_set_connected(true);
         
         msg_id = esp_mqtt_client_subscribe(client, "/boards_command", 0);  // 0 to QoS (Quality of Service)
         ESP_LOGI(MAIN_TAG, "Subscribed to /boards_command, msg_id=%d", msg_id);
+
+        msg_id = esp_mqtt_client_subscribe(client, command_topic, 1);
+        ESP_LOGI(MAIN_TAG, "Subscribed to %s, msg_id=%d", command_topic, msg_id);
+
+#if CONFIG_TAG_ALLOWLIST
+        char tags_topic[64];
+        snprintf(tags_topic, sizeof(tags_topic), "/%s/tags", board_name);
+        msg_id = esp_mqtt_client_subscribe(client, tags_topic, 1);
+        ESP_LOGI(MAIN_TAG, "Subscribed to %s, msg_id=%d", tags_topic, msg_id);
+#endif
         
         msg_id = esp_mqtt_client_publish(client, "/boards", board_name, 0, 1, 0);
         ESP_LOGI(MAIN_TAG, "Published board name '%s' to topic '%s', msg_id=%d", board_name, "boards", msg_id);
@@ -475,6 +669,7 @@ static void mqtt_event_handler(void *handler_args, esp_event_base_t base, int32_
     case MQTT_EVENT_DISCONNECTED:
         ESP_LOGI(MAIN_TAG, "MQTT_EVENT_DISCONNECTED");
         mqtt_connected = false;
+        sighting_publisher_set_connected(false);
         break;
 
     case MQTT_EVENT_SUBSCRIBED:
@@ -485,8 +680,15 @@ static void mqtt_event_handler(void *handler_args, esp_event_base_t base, int32_
         break;
     case MQTT_EVENT_PUBLISHED:
         ESP_LOGI(MAIN_TAG, "MQTT_EVENT_PUBLISHED, msg_id=%d", event->msg_id);
+        latency_probe_acked(event->msg_id, esp_timer_get_time());
         break;
     case MQTT_EVENT_DATA:
+#if CONFIG_TAG_ALLOWLIST
+        if (event->current_data_offset > 0 ? tags_upload_active : is_tags_topic(event)) {
+            handle_tags_upload(client, event);
+            break;
+        }
+#endif
     	ESP_LOGI(MAIN_TAG, "MQTT_EVENT_DATA");
     
     	// Wyświetlenie topicu i wiadomości
@@ -495,16 +697,10 @@ static void mqtt_event_handler(void *handler_args, esp_event_base_t base, int32_
     
         ESP_LOGI(MAIN_TAG, "MQTT_EVENT_DATA");
         
-        if (event->topic_len == strlen("/boards_command") && 
-            strncmp(event->topic, "/boards_command", event->topic_len) == 0 &&
-            event->data_len == strlen("introduce") && 
-            strncmp((char*)event->data, "introduce", event->data_len) == 0) {
-            
-            char topic[50];
-            snprintf(topic, sizeof(topic), "/boards");
-            
-            msg_id = esp_mqtt_client_publish(client, topic, board_name, 0, 1, 0);
-            ESP_LOGI(MAIN_TAG, "Published board name '%s' to topic '%s', msg_id=%d", board_name, topic, msg_id);
+        if (is_topic(event, "/boards_command")) {
+            handle_board_command(client, BOARD_COMMAND_BROADCAST, event);
+        } else if (is_topic(event, command_topic)) {
+            handle_board_command(client, BOARD_COMMAND_DIRECT, event);
         }
         break;
     case MQTT_EVENT_ERROR:
@@ -521,11 +717,12 @@ static void mqtt_event_handler(void *handler_args, esp_event_base_t base, int32_
         ESP_LOGI(MAIN_TAG, "Other event id:%d", event->event_id);
         break;
     }
+    TRACE(TRACE_MQTT_EVENT_END, event_id);
 }
 
 static void mqtt_app_start(void)
 {
-	if (get_broker_ip_from_nvs(broker_ip, sizeof(board_name))) {
+	if (app_config_get_str(APP_CONFIG_BROKER_URI, broker_ip, sizeof(broker_ip))) {
         ESP_LOGI(MAIN_TAG, "Got broker IP: %s", broker_ip);
     } else {
 		ESP_LOGI(MAIN_TAG, "Using default broker IP: %s", broker_ip);
@@ -539,42 +736,149 @@ static void mqtt_app_start(void)
     esp_mqtt_client_start(client);
 }
 
-static void mqtt_task() {
+// Przekazuje wiadomość do esp-mqtt, gdy klient jest połączony
+static bool mqtt_publish(const char* topic, const char* payload, size_t length, int64_t capture_us) {
+    if (!mqtt_connected) {
+        return false;
+    }
+    int64_t start_us = esp_timer_get_time();
+    TRACE(TRACE_MQTT_PUBLISH_BEGIN, length);
+    int msg_id = esp_mqtt_client_publish(mqtt_client, topic, payload, length, 1, 0);
+    TRACE(TRACE_MQTT_PUBLISH_END, msg_id);
+    perf_record(PERF_HIST_PUBLISH_US, (uint32_t)(esp_timer_get_time() - start_us));
+    if (msg_id < 0) {
+        perf_count(PERF_PUBLISH_FAILURES);
+        return false;
+    }
+    latency_probe_sent(msg_id, capture_us, start_us);
+    return true;
+}
+
+static void log_sighting_queue_stats(void) {
+    sighting_queue_stats_t stats;
+    sighting_queue_get_stats(&stats);
+    ESP_LOGI(MAIN_TAG, "Sighting queue: depth=%" PRIu32 "/%d high_watermark=%" PRIu32
+             " pushed=%" PRIu32 " overflows=%" PRIu32,
+             stats.depth, SIGHTING_QUEUE_LENGTH, stats.high_watermark,
+             stats.pushed, stats.overflows);
+    ESP_LOGI(MAIN_TAG, "Device table: %" PRIu32 "/%d entries, %" PRIu32 " evictions (%" PRIu32 " in window)",
+             device_table_size(), DEVICE_TABLE_MAX_ENTRIES, device_table_evictions(),
+             device_table_window_evictions());
+
+#if CONFIG_SIGHTING_LOG
+    sighting_log_stats_t log_stats;
+    sighting_log_get_stats(&log_stats);
+    ESP_LOGI(MAIN_TAG, "Sighting log: %" PRIu32 " pending, %" PRIu32 " appended, %" PRIu32
+             " replayed, %" PRIu32 " dropped oldest, %" PRIu32 " corrupted, %" PRIu32 " erases",
+             log_stats.pending, log_stats.appended, log_stats.replayed, log_stats.dropped_oldest,
+             log_stats.corrupted, log_stats.sector_erases);
+#endif
+
+    uint32_t filter_hits[SCAN_FILTER_MAX_RULES];
+    uint32_t default_hits;
+    size_t rule_count = scan_filter_get_hits(filter_hits, SCAN_FILTER_MAX_RULES, &default_hits);
+    for (size_t i = 0; i < rule_count; i++) {
+        ESP_LOGI(MAIN_TAG, "Scan filter rule %u: %" PRIu32 " hits", (unsigned)(i + 1), filter_hits[i]);
+    }
+    ESP_LOGI(MAIN_TAG, "Scan filter default: %" PRIu32 " hits", default_hits);
+
+#if CONFIG_TAG_ALLOWLIST
+    tag_allowlist_stats_t tag_stats;
+    tag_allowlist_get_stats(&tag_stats);
+    ESP_LOGI(MAIN_TAG, "Tag allowlist: %" PRIu32 " tags, %" PRIu32 " bytes, expected FP %" PRIu32 " ppm, %" PRIu32
+             " lookups, %" PRIu32 " bit probes, %" PRIu32 " positives, %" PRIu32 " flash reads, %" PRIu32
+             " false positives",
+             tag_stats.tags, tag_stats.memory_bytes, tag_stats.expected_fp_ppm, tag_stats.lookups,
+             tag_stats.bit_probes, tag_stats.filter_positives, tag_stats.flash_reads, tag_stats.false_positives);
+#endif
+
+    lcd_stats_t lcd_stats;
+    lcd_get_stats(&lcd_stats);
+    ESP_LOGI(MAIN_TAG, "LCD: %" PRIu32 " flushes, %" PRIu32 " I2C bytes sent, %" PRIu32 " saved",
+             lcd_stats.flushes, lcd_stats.bytes_sent, lcd_stats.bytes_saved);
+}
+
+// Nazwa płytki i broker są używane przez klienta MQTT od startu - zmiana wymaga restartu
+static void log_config_change(void) {
+    app_config_t config;
+    app_config_get(&config);
+    if (strcmp(config.board_name, board_name) != 0 || strcmp(config.broker_uri, broker_ip) != 0) {
+        ESP_LOGI(MAIN_TAG, "Config changed: board=%s broker=%s, restart to apply",
+                 config.board_name, config.broker_uri);
+    }
+}
+
+#if CONFIG_BOARD_STATS_INTERVAL_MS > 0
+static void publish_board_stats(void) {
+    static char message[BOARD_STATS_MESSAGE_MAX_LEN];
+    char topic[50];
+    size_t length = board_stats_format(mqtt_client, message, sizeof(message));
+    if (length == 0) {
+        ESP_LOGW(MAIN_TAG, "Board stats do not fit in %d bytes", BOARD_STATS_MESSAGE_MAX_LEN);
+        return;
+    }
+    snprintf(topic, sizeof(topic), "/%s/stats", board_name);
+    mqtt_publish(topic, message, length, 0); // Nie pochodzi z obserwacji - bez pomiaru opóźnienia
+}
+#endif
+
+// Task publikujący - jedyny konsument kolejki obserwacji
+static void mqtt_task(void *arg) {
+    TickType_t last_stats = xTaskGetTickCount();
+#if CONFIG_BOARD_STATS_INTERVAL_MS > 0
+    TickType_t last_board_stats = xTaskGetTickCount();
+#endif
+    uint32_t config_generation = app_config_generation();
+    ble_sighting_t sighting;
+
 	while(1) {
-		if(mqtt_connected) {
-			// int msg_id = esp_mqtt_client_publish(mqtt_client, "/topic/ble_devices", "device:smartphone3;rssi:-48", 0, 1, 0);
-        	// ESP_LOGI(MAIN_TAG, "sent publish successful, msg_id=%d", msg_id);
+		while(sighting_queue_pop(&sighting)) {
+			sighting_publisher_handle(&sighting);
 		}
-		vTaskDelay(pdMS_TO_TICKS(5000));
-	}
-}
 
-static void on_ble_device_discovery(const char* name, const char* address, int rssi) {
-	ESP_LOGI(GATTS_TAG, "Device discovered:");
-    ESP_LOGI(GATTS_TAG, "Name: %s", name);   
-    ESP_LOGI(GATTS_TAG, "Address: %s", address); 
-    ESP_LOGI(GATTS_TAG, "RSSI: %d", rssi);
-    
-    if(mqtt_connected) {
-        char topic[50];
-        snprintf(topic, sizeof(topic), "/%s/devices", board_name);
+		sighting_publisher_poll(esp_timer_get_time());
 
-        char message[200];
-        snprintf(message, sizeof(message),
-                 "{\"name\": \"%s\", \"address\": \"%s\", \"rssi\": %d}",
-                 name, address, rssi);
+		if(app_config_generation() != config_generation) {
+			config_generation = app_config_generation();
+			log_config_change();
+		}
+
+		if(xTaskGetTickCount() - last_stats >= pdMS_TO_TICKS(CONFIG_SIGHTING_QUEUE_STATS_INTERVAL_MS)) {
+			last_stats = xTaskGetTickCount();
+			log_sighting_queue_stats();
+			app_tasks_check_stacks();
+		}
 
-        int msg_id = esp_mqtt_client_publish(mqtt_client, topic, message, 0, 1, 0);
-        ESP_LOGI(GATTS_TAG, "Published message '%s' to topic '%s', msg_id=%d", message, topic, msg_id);
+#if CONFIG_BOARD_STATS_INTERVAL_MS > 0
+		if(xTaskGetTickCount() - last_board_stats >= pdMS_TO_TICKS(CONFIG_BOARD_STATS_INTERVAL_MS)) {
+			last_board_stats = xTaskGetTickCount();
+			publish_board_stats();
+		}
+#endif
+
+		vTaskDelay(pdMS_TO_TICKS(CONFIG_SIGHTING_PUBLISH_PERIOD_MS));
 	}
 }
 
+// Wywoływane z callbacku GAP: tylko kopiuje rekord do kolejki
+static void on_ble_device_discovery(const ble_scan_result_t* result) {
+    bool queued = sighting_queue_push(&result->sighting);
+    TRACE(TRACE_DISCOVERY, queued);
+}
+
+// Znacznik końca okna idzie tą samą kolejką, aby zachować kolejność
+static void on_scan_window_end(int64_t timestamp_us) {
+    ble_sighting_t marker = {
+        .timestamp_us = timestamp_us,
+        .kind = SIGHTING_KIND_WINDOW_END,
+    };
+    sighting_queue_push(&marker);
+}
+
 void app_main(void)
 {
-	i2c_master_init();
-    lcd_init();
-    
-    lcd_send_string("Initializing");
+    display_init();
+    display_show("Initializing", NULL);
 	
     // Initialize NVS
     esp_err_t ret = nvs_flash_init();
@@ -587,7 +891,9 @@ void app_main(void)
     ESP_ERROR_CHECK(esp_netif_init());
     ESP_ERROR_CHECK(esp_event_loop_create_default());
 	
-	if (get_board_name_from_nvs(board_name, sizeof(board_name))) {
+	app_config_init();
+	
+	if (app_config_get_str(APP_CONFIG_BOARD_NAME, board_name, sizeof(board_name))) {
         ESP_LOGI(MAIN_TAG, "Got board name: %s", board_name);
     } else {
 		ESP_LOGI(MAIN_TAG, "Using default board name: %s", board_name);
@@ -600,19 +906,34 @@ void app_main(void)
     //initialize_wifi();
 	
 	ESP_LOGI(MAIN_TAG, "Attempting to connect Wi-Fi with stored creds...");
-	wifi_try_connect_from_nvs();
+	wifi_try_connect_from_config();
 	
 	initialize_ble(&on_ssid_received,
 	&on_password_received,
 	&on_broker_ip_received,
-	&on_board_name_received);
-	initialize_ble_scanner(on_ble_device_discovery);
+	&on_board_name_received,
+	&on_bulk_config_received,
+	&on_bulk_config_read);
+	load_scan_filter();
+	load_scan_params();
+	board_command_init(board_commands, sizeof(board_commands) / sizeof(board_commands[0]), board_name);
+	snprintf(command_topic, sizeof(command_topic), "/%s/command", board_name);
+#if CONFIG_TAG_ALLOWLIST
+	tag_allowlist_init_partition(CONFIG_TAG_ALLOWLIST_PARTITION_LABEL, CONFIG_TAG_ALLOWLIST_CAPACITY,
+	                             CONFIG_TAG_ALLOWLIST_FP_RATE_PPM, TAG_ALLOWLIST_EXACT_CHECK);
+#endif
+	initialize_ble_scanner(on_ble_device_discovery, on_scan_window_end);
 
     // Create a task to handle the button (short press toggles Wi-Fi mode)
-    xTaskCreate(button_task, "button_task", 8192, NULL, 5, NULL);
+    app_task_start(APP_TASK_BUTTON, button_task, NULL);
     
     // Create a task to send data through mqtt broker
-    xTaskCreate(mqtt_task, "mqtt_task", 8192, NULL, 4, NULL);
+#if CONFIG_SIGHTING_LOG
+    sighting_log_init_partition(CONFIG_SIGHTING_LOG_PARTITION_LABEL,
+                                CONFIG_SIGHTING_LOG_RETENTION_KB * 1024 / SIGHTING_LOG_SECTOR_SIZE);
+#endif
+    sighting_publisher_init(board_name, (uint16_t)esp_random(), mqtt_publish);
+    app_task_start(APP_TASK_MQTT, mqtt_task, NULL);
     
     mqtt_app_start();
 
@@ -621,5 +942,5 @@ void app_main(void)
     // Press and release the button to toggle Wi-Fi mode ON/OFF
     // Update SSID/PASS via BLE anytime
     
-    xTaskCreate(blink_led_task, "Blink LED Task", 2048, NULL, 5, NULL);
+    app_task_start(APP_TASK_BLINK_LED, blink_led_task, NULL);
 }
@@ -0,0 +1,55 @@
+#include "perf_counters.h"
+
+atomic_uint_fast32_t perf_counters[PERF_COUNTER_COUNT];
+
+static atomic_uint_fast32_t histograms[PERF_HISTOGRAM_COUNT][PERF_HISTOGRAM_BUCKETS];
+
+// Slot jest rezerwowany atomowo, a uchwyt zapisywany na końcu - rejestrować mogą różne zadania
+typedef struct {
+    _Atomic(void *) task;
+    const char *name;
+} task_slot_t;
+
+static task_slot_t task_slots[PERF_MAX_TASKS];
+static atomic_uint_fast32_t task_slots_used = 0;
+
+static uint32_t bucket_index(uint32_t value) {
+    uint32_t bucket = value == 0 ? 0 : 32 - (uint32_t)__builtin_clz(value);
+    return bucket < PERF_HISTOGRAM_BUCKETS ? bucket : PERF_HISTOGRAM_BUCKETS - 1;
+}
+
+void perf_record(perf_histogram_t histogram, uint32_t value) {
+    atomic_fetch_add_explicit(&histograms[histogram][bucket_index(value)], 1, memory_order_relaxed);
+}
+
+void perf_histogram_get(perf_histogram_t histogram, uint32_t buckets[PERF_HISTOGRAM_BUCKETS]) {
+    for (int i = 0; i < PERF_HISTOGRAM_BUCKETS; i++) {
+        buckets[i] = atomic_load_explicit(&histograms[histogram][i], memory_order_relaxed);
+    }
+}
+
+void perf_watch_task(void *task, const char *name) {
+    if (task == NULL) {
+        return;
+    }
+    uint32_t slot = atomic_fetch_add(&task_slots_used, 1);
+    if (slot >= PERF_MAX_TASKS) {
+        return;
+    }
+    task_slots[slot].name = name;
+    atomic_store_explicit(&task_slots[slot].task, task, memory_order_release);
+}
+
+size_t perf_watched_tasks(perf_task_t *out, size_t max) {
+    uint32_t used = atomic_load(&task_slots_used);
+    size_t count = 0;
+    for (uint32_t slot = 0; slot < used && slot < PERF_MAX_TASKS && count < max; slot++) {
+        void *task = atomic_load_explicit(&task_slots[slot].task, memory_order_acquire);
+        if (task != NULL) {
+            out[count].task = task;
+            out[count].name = task_slots[slot].name;
+            count++;
+        }
+    }
+    return count;
+}
@@ -0,0 +1,76 @@
+#ifndef MAIN_PERF_COUNTERS_H_
+#define MAIN_PERF_COUNTERS_H_
+
+#include <stdatomic.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Liczniki i histogramy wydajności publikowane na /<board_name>/stats (board_stats.h).
+// Aktualizacja to jedno atomowe dodawanie bez barier, więc liczniki mogą być
+// zwiększane z callbacku GAP i zostają włączone w produkcji. Wartości rosną od
+// startu płytki - odbiorca liczy przyrosty. Moduł nie zależy od ESP-IDF.
+
+typedef enum {
+    PERF_ADV_RECEIVED = 0,   // Wyniki skanowania (reklamy) z kontrolera
+    PERF_ADV_FILTERED,       // Odrzucone przez filtr skanowania
+    PERF_DEVICES_PUBLISHED,  // Wyniki okien urządzeń przekazane do MQTT
+    PERF_DEVICES_DROPPED,    // Wyniki okien utracone (paczka nie wysłana, brak miejsca)
+    PERF_MESSAGES_PUBLISHED, // Wiadomości z urządzeniami przekazane do MQTT
+    PERF_PUBLISH_FAILURES,   // Odrzucone przez esp_mqtt_client_publish
+    PERF_WIFI_RECONNECTS,
+    PERF_SCAN_WINDOWS,
+    PERF_SCAN_ACTIVE_MS,     // Czas, w którym skaner faktycznie skanował
+    PERF_COUNTER_COUNT,
+} perf_counter_t;
+
+typedef enum {
+    PERF_HIST_GAP_EVENT_US = 0, // Obsługa wyniku skanowania w callbacku GAP
+    PERF_HIST_PUBLISH_US,       // Czas wywołania esp_mqtt_client_publish
+    PERF_HIST_CAPTURE_TO_PUBLISH_MS, // Od przechwycenia obserwacji do publikacji (latency_probe.h)
+    PERF_HIST_PUBLISH_TO_ACK_MS,     // Od publikacji do PUBACK
+    PERF_HIST_CAPTURE_TO_ACK_MS,
+    PERF_HISTOGRAM_COUNT,
+} perf_histogram_t;
+
+// Koszyk 0: wartość 0, koszyk i: [2^(i-1), 2^i), ostatni zbiera resztę
+#define PERF_HISTOGRAM_BUCKETS 16
+
+#define PERF_MAX_TASKS 8
+
+extern atomic_uint_fast32_t perf_counters[PERF_COUNTER_COUNT];
+
+static inline void perf_add(perf_counter_t counter, uint32_t value) {
+    atomic_fetch_add_explicit(&perf_counters[counter], value, memory_order_relaxed);
+}
+
+static inline void perf_count(perf_counter_t counter) {
+    perf_add(counter, 1);
+}
+
+static inline uint32_t perf_counter(perf_counter_t counter) {
+    return atomic_load_explicit(&perf_counters[counter], memory_order_relaxed);
+}
+
+void perf_record(perf_histogram_t histogram, uint32_t value);
+
+void perf_histogram_get(perf_histogram_t histogram, uint32_t buckets[PERF_HISTOGRAM_BUCKETS]);
+
+// Zadania, których zapas stosu jest raportowany; task to uchwyt FreeRTOS (NULL jest pomijany)
+typedef struct {
+    void *task;
+    const char *name;
+} perf_task_t;
+
+void perf_watch_task(void *task, const char *name);
+
+size_t perf_watched_tasks(perf_task_t *tasks, size_t max);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,167 @@
+#include "presence.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "sdkconfig.h"
+
+static presence_config_t config;
+static presence_callback transition_callback = NULL;
+static void *callback_ctx = NULL;
+
+static uint32_t enters = 0;
+static uint32_t leaves = 0;
+
+typedef struct {
+    device_table_visitor visitor;
+    void *ctx;
+} present_visit_t;
+
+static int64_t ms_to_us(uint32_t ms) {
+    return (int64_t)ms * 1000;
+}
+
+static void enter(device_entry_t *entry, int64_t now_us) {
+    entry->presence_state = PRESENCE_PRESENT;
+    entry->present_since_us = now_us;
+    enters++;
+    if (transition_callback) {
+        transition_callback(PRESENCE_EVENT_ENTER, entry, now_us, callback_ctx);
+    }
+}
+
+static void notify_leave(const device_entry_t *entry, int64_t now_us) {
+    leaves++;
+    if (transition_callback) {
+        transition_callback(PRESENCE_EVENT_LEAVE, entry, now_us, callback_ctx);
+    }
+}
+
+static void leave(device_entry_t *entry, int64_t now_us) {
+    entry->presence_state = PRESENCE_ABSENT;
+    notify_leave(entry, now_us);
+}
+
+void presence_init(const presence_config_t *presence_config, presence_callback callback, void *ctx) {
+    config = *presence_config;
+    if (config.exit_rssi > config.enter_rssi) {
+        config.exit_rssi = config.enter_rssi;
+    }
+    transition_callback = callback;
+    callback_ctx = ctx;
+    enters = 0;
+    leaves = 0;
+}
+
+void presence_update(device_entry_t *entry, int8_t rssi, int64_t now_us) {
+#if !CONFIG_RSSI_FILTER_NONE
+    rssi = rssi_filter_rssi(&entry->rssi_filter);
+#endif
+    entry->presence_rssi = rssi;
+
+    switch (entry->presence_state) {
+        case PRESENCE_ABSENT:
+            if (rssi >= config.enter_rssi) {
+                entry->presence_state = PRESENCE_ARRIVING;
+                entry->presence_pending_us = now_us;
+            }
+            break;
+
+        case PRESENCE_ARRIVING:
+            if (rssi < config.enter_rssi) {
+                entry->presence_state = PRESENCE_ABSENT;
+            }
+            break;
+
+        case PRESENCE_PRESENT:
+            if (rssi < config.exit_rssi) {
+                entry->presence_state = PRESENCE_LEAVING;
+                entry->presence_pending_us = now_us;
+            }
+            break;
+
+        case PRESENCE_LEAVING:
+            if (rssi >= config.exit_rssi) {
+                entry->presence_state = PRESENCE_PRESENT;
+            }
+            break;
+    }
+
+    // Wejście wymaga próbki ponad progiem także po upływie enter_dwell_ms
+    if (entry->presence_state == PRESENCE_ARRIVING &&
+        now_us - entry->presence_pending_us >= ms_to_us(config.enter_dwell_ms)) {
+        enter(entry, now_us);
+    } else if (entry->presence_state == PRESENCE_LEAVING &&
+               now_us - entry->presence_pending_us >= ms_to_us(config.exit_dwell_ms)) {
+        leave(entry, now_us);
+    }
+}
+
+static void check_timeouts(device_entry_t *entry, void *ctx) {
+    int64_t now_us = *(const int64_t *)ctx;
+    bool silent = now_us - entry->last_seen_us >= ms_to_us(config.absence_timeout_ms);
+
+    switch (entry->presence_state) {
+        case PRESENCE_ARRIVING:
+            if (silent) {
+                entry->presence_state = PRESENCE_ABSENT;
+            }
+            break;
+
+        case PRESENCE_PRESENT:
+            if (silent) {
+                leave(entry, now_us);
+            }
+            break;
+
+        case PRESENCE_LEAVING:
+            if (silent || now_us - entry->presence_pending_us >= ms_to_us(config.exit_dwell_ms)) {
+                leave(entry, now_us);
+            }
+            break;
+
+        default:
+            break;
+    }
+}
+
+void presence_poll(int64_t now_us) {
+    device_table_foreach(check_timeouts, &now_us);
+}
+
+void presence_evict(const device_entry_t *entry, int64_t now_us) {
+    // Wpis zaraz zniknie - stanu nie trzeba zmieniać
+    if (entry->presence_state == PRESENCE_PRESENT || entry->presence_state == PRESENCE_LEAVING) {
+        notify_leave(entry, now_us);
+    }
+}
+
+static void visit_present(device_entry_t *entry, void *ctx) {
+    const present_visit_t *visit = ctx;
+    if (entry->presence_state == PRESENCE_PRESENT || entry->presence_state == PRESENCE_LEAVING) {
+        visit->visitor(entry, visit->ctx);
+    }
+}
+
+void presence_foreach_present(device_table_visitor visitor, void *ctx) {
+    present_visit_t visit = {
+        .visitor = visitor,
+        .ctx = ctx,
+    };
+    device_table_foreach(visit_present, &visit);
+}
+
+static void count_present(const device_entry_t *entry, void *ctx) {
+    (*(uint32_t *)ctx)++;
+}
+
+void presence_get_stats(presence_stats_t *stats) {
+    stats->present = 0;
+    presence_foreach_present(count_present, &stats->present);
+    stats->enters = enters;
+    stats->leaves = leaves;
+}
+
+const char *presence_event_name(presence_event_t event) {
+    return event == PRESENCE_EVENT_ENTER ? "enter" : "leave";
+}
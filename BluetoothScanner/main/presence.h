@@ -0,0 +1,69 @@
+#ifndef MAIN_PRESENCE_H_
+#define MAIN_PRESENCE_H_
+
+#include <stdint.h>
+
+#include "device_table.h"
+
+// Wykrywanie obecności urządzeń na podstawie RSSI z histerezą. Stan każdego
+// urządzenia jest trzymany we wpisie tablicy urządzeń (device_table.h), a na
+// zewnątrz wychodzą tylko przejścia wejście/wyjście. Moduł nie zależy od ESP-IDF.
+//
+//   ABSENT   --RSSI >= enter_rssi-->                    ARRIVING
+//   ARRIVING --RSSI < enter_rssi-->                     ABSENT
+//   ARRIVING --próbka po enter_dwell_ms-->              PRESENT   (zdarzenie ENTER)
+//   PRESENT  --RSSI < exit_rssi-->                      LEAVING
+//   LEAVING  --RSSI >= exit_rssi-->                     PRESENT
+//   LEAVING  --exit_dwell_ms bez silnej próbki-->       ABSENT    (zdarzenie LEAVE)
+//   dowolny  --absence_timeout_ms bez żadnej próbki-->  ABSENT    (LEAVE, jeśli był obecny)
+//   dowolny  --usunięcie z pełnej tablicy urządzeń-->   ABSENT    (LEAVE, jeśli był obecny)
+
+typedef enum {
+    PRESENCE_ABSENT = 0,
+    PRESENCE_ARRIVING,
+    PRESENCE_PRESENT,
+    PRESENCE_LEAVING,
+} presence_state_t;
+
+typedef enum {
+    PRESENCE_EVENT_ENTER = 0,
+    PRESENCE_EVENT_LEAVE,
+} presence_event_t;
+
+typedef struct {
+    int8_t enter_rssi; // Próg wejścia; exit_rssi powyżej niego jest obniżany do enter_rssi
+    int8_t exit_rssi;
+    uint32_t enter_dwell_ms;
+    uint32_t exit_dwell_ms;
+    uint32_t absence_timeout_ms;
+} presence_config_t;
+
+typedef struct {
+    uint32_t present; // Urządzenia w stanie PRESENT lub LEAVING
+    uint32_t enters;
+    uint32_t leaves;
+} presence_stats_t;
+
+typedef void (*presence_callback)(presence_event_t event, const device_entry_t *entry, int64_t now_us, void *ctx);
+
+void presence_init(const presence_config_t *config, presence_callback callback, void *ctx);
+
+// Próbka RSSI urządzenia, którego wpis właśnie zaktualizował device_table_update.
+// Z włączonym filtrem RSSI progi są porównywane z wartością wygładzoną.
+void presence_update(device_entry_t *entry, int8_t rssi, int64_t now_us);
+
+// Wywoływane cyklicznie: kończy wyjścia po exit_dwell_ms i wykrywa zniknięcia
+void presence_poll(int64_t now_us);
+
+// Wywoływane z callbacku usuwania wpisu (device_table_set_evict_callback):
+// dla urządzenia obecnego (PRESENT lub LEAVING) zgłasza LEAVE
+void presence_evict(const device_entry_t *entry, int64_t now_us);
+
+// Odwiedza urządzenia obecne (PRESENT i LEAVING) - do wiadomości heartbeat
+void presence_foreach_present(device_table_visitor visitor, void *ctx);
+
+void presence_get_stats(presence_stats_t *stats);
+
+const char *presence_event_name(presence_event_t event);
+
+#endif
@@ -0,0 +1,73 @@
+#include "rssi_filter.h"
+
+// Dzielenie z zaokrągleniem do najbliższej liczby całkowitej (także dla ujemnych)
+static int64_t div_round(int64_t value, int64_t divisor) {
+    return value >= 0 ? (value + divisor / 2) / divisor : (value - divisor / 2) / divisor;
+}
+
+static void initialize(rssi_filter_t *filter, int32_t sample, int32_t error) {
+    filter->estimate = sample;
+    filter->variance = 0;
+    filter->error = error;
+    filter->initialized = 1;
+}
+
+// Wzmocnienie i P filtru Kalmana w Q16: w Q8 krok 1/256 to kilka procent
+// typowego K ~ 0.1, a zaokrąglenia P przesuwają jego stan ustalony
+#define KALMAN_Q 16
+#define KALMAN_ONE (1 << KALMAN_Q)
+
+// Aktualizuje wariancję próbek wagą gain / gain_one na podstawie innowacji (Q8)
+static void update_variance(rssi_filter_t *filter, int32_t innovation, int64_t gain, int64_t gain_one) {
+    int64_t squared = div_round((int64_t)innovation * innovation, RSSI_FILTER_ONE);
+    filter->variance += (int32_t)div_round(gain * (squared - filter->variance), gain_one);
+}
+
+void rssi_filter_ema_update(rssi_filter_t *filter, int8_t rssi, uint8_t alpha_q8) {
+    int32_t sample = (int32_t)rssi * RSSI_FILTER_ONE;
+    if (!filter->initialized) {
+        initialize(filter, sample, 0);
+        return;
+    }
+
+    int32_t innovation = sample - filter->estimate;
+    filter->estimate += (int32_t)div_round((int64_t)alpha_q8 * innovation, RSSI_FILTER_ONE);
+    update_variance(filter, innovation, alpha_q8, RSSI_FILTER_ONE);
+}
+
+void rssi_filter_kalman_update(rssi_filter_t *filter, int8_t rssi, int32_t process_noise,
+                               int32_t measurement_noise) {
+    int32_t sample = (int32_t)rssi * RSSI_FILTER_ONE;
+    if (!filter->initialized) {
+        initialize(filter, sample, measurement_noise << (KALMAN_Q - RSSI_FILTER_Q));
+        return;
+    }
+
+    // Predykcja: stan bez zmian, niepewność rośnie o szum procesu
+    int64_t predicted_error = (int64_t)filter->error + ((int64_t)process_noise << (KALMAN_Q - RSSI_FILTER_Q));
+
+    // Wzmocnienie K = P / (P + R)
+    int64_t noise = (int64_t)measurement_noise << (KALMAN_Q - RSSI_FILTER_Q);
+    int64_t gain = div_round(predicted_error * KALMAN_ONE, predicted_error + noise);
+
+    int32_t innovation = sample - filter->estimate;
+    filter->estimate += (int32_t)div_round(gain * innovation, KALMAN_ONE);
+    filter->error = (int32_t)div_round((KALMAN_ONE - gain) * predicted_error, KALMAN_ONE);
+    update_variance(filter, innovation, gain, KALMAN_ONE);
+}
+
+void rssi_filter_seed(rssi_filter_t *filter, int8_t rssi) {
+    initialize(filter, (int32_t)rssi * RSSI_FILTER_ONE, 0);
+}
+
+int8_t rssi_filter_rssi(const rssi_filter_t *filter) {
+    return (int8_t)div_round(filter->estimate, RSSI_FILTER_ONE);
+}
+
+int32_t rssi_filter_rssi_tenths(const rssi_filter_t *filter) {
+    return (int32_t)div_round((int64_t)filter->estimate * 10, RSSI_FILTER_ONE);
+}
+
+int32_t rssi_filter_variance_tenths(const rssi_filter_t *filter) {
+    return (int32_t)div_round((int64_t)filter->variance * 10, RSSI_FILTER_ONE);
+}
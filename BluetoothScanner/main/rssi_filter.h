@@ -0,0 +1,47 @@
+#ifndef MAIN_RSSI_FILTER_H_
+#define MAIN_RSSI_FILTER_H_
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Wygładzanie RSSI pojedynczego urządzenia w arytmetyce stałoprzecinkowej.
+// Wartości są przechowywane w formacie Q8 (dBm * 256, dB^2 * 256), poza P filtru
+// Kalmana w Q16.
+// Aktualizacja nie alokuje pamięci i nie używa liczb zmiennoprzecinkowych.
+
+#define RSSI_FILTER_Q 8
+#define RSSI_FILTER_ONE (1 << RSSI_FILTER_Q)
+
+typedef struct {
+    int32_t estimate;  // Wygładzone RSSI, Q8 dBm
+    int32_t variance;  // Wykładniczo ważona wariancja próbek wokół estymaty, Q8 dB^2
+    int32_t error;     // Wariancja błędu estymaty filtru Kalmana (P), Q16 dB^2
+    uint8_t initialized;
+} rssi_filter_t;
+
+// Średnia wykładnicza: estimate += alpha * (rssi - estimate), alpha = alpha_q8 / 256
+void rssi_filter_ema_update(rssi_filter_t *filter, int8_t rssi, uint8_t alpha_q8);
+
+// Jednowymiarowy filtr Kalmana z modelem błądzenia losowego.
+// process_noise i measurement_noise w Q8 dB^2.
+void rssi_filter_kalman_update(rssi_filter_t *filter, int8_t rssi, int32_t process_noise,
+                               int32_t measurement_noise);
+
+// Ustawia estymatę na rssi bez historii (np. dla wpisu odtworzonego z sighting_log)
+void rssi_filter_seed(rssi_filter_t *filter, int8_t rssi);
+
+// Estymata zaokrąglona do całych dBm
+int8_t rssi_filter_rssi(const rssi_filter_t *filter);
+
+// Estymata i wariancja w dziesiątych częściach (do formatowania bez float)
+int32_t rssi_filter_rssi_tenths(const rssi_filter_t *filter);
+int32_t rssi_filter_variance_tenths(const rssi_filter_t *filter);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,111 @@
+#include "scan_capture.h"
+
+#include <inttypes.h>
+#include <stdio.h>
+#include <string.h>
+
+static const char hex_digits[] = "0123456789abcdef";
+
+static char *put_hex(char *out, const uint8_t *data, size_t len) {
+    if (len == 0) {
+        *out++ = '-';
+        return out;
+    }
+    for (size_t i = 0; i < len; i++) {
+        *out++ = hex_digits[data[i] >> 4];
+        *out++ = hex_digits[data[i] & 0x0F];
+    }
+    return out;
+}
+
+static int hex_value(char c) {
+    if (c >= '0' && c <= '9') {
+        return c - '0';
+    }
+    if (c >= 'a' && c <= 'f') {
+        return c - 'a' + 10;
+    }
+    if (c >= 'A' && c <= 'F') {
+        return c - 'A' + 10;
+    }
+    return -1;
+}
+
+// Dekoduje token hex (albo "-") do out, zwraca liczbę bajtów lub -1
+static int get_hex(const char *token, uint8_t *out, size_t max_len) {
+    if (strcmp(token, "-") == 0) {
+        return 0;
+    }
+    size_t len = strlen(token);
+    if (len % 2 != 0 || len / 2 > max_len) {
+        return -1;
+    }
+    for (size_t i = 0; i < len / 2; i++) {
+        int high = hex_value(token[2 * i]);
+        int low = hex_value(token[2 * i + 1]);
+        if (high < 0 || low < 0) {
+            return -1;
+        }
+        out[i] = (uint8_t)((high << 4) | low);
+    }
+    return (int)(len / 2);
+}
+
+size_t scan_capture_format(const scan_capture_event_t *event, char *line, size_t capacity) {
+    if (event->kind == SCAN_CAPTURE_WINDOW_END) {
+        int len = snprintf(line, capacity, "END %" PRId64, event->timestamp_us);
+        return (len < 0 || (size_t)len >= capacity) ? 0 : (size_t)len;
+    }
+
+    // Najgorszy przypadek: prefiks (~40 znaków) + 2 * 62 znaki hex
+    if (capacity < SCAN_CAPTURE_LINE_MAX_LEN ||
+        event->adv_len + event->scan_rsp_len > SCAN_CAPTURE_DATA_MAX_LEN) {
+        return 0;
+    }
+
+    int len = snprintf(line, capacity, "ADV %" PRId64 " ", event->timestamp_us);
+    char *out = put_hex(line + len, event->bda, sizeof(event->bda));
+    out += sprintf(out, " %u %u %d ", event->addr_type, event->evt_type, event->rssi);
+    out = put_hex(out, event->data, event->adv_len);
+    *out++ = ' ';
+    out = put_hex(out, event->data + event->adv_len, event->scan_rsp_len);
+    *out = '\0';
+    return (size_t)(out - line);
+}
+
+bool scan_capture_parse(const char *line, scan_capture_event_t *event) {
+    memset(event, 0, sizeof(*event));
+
+    if (sscanf(line, "END %" SCNd64, &event->timestamp_us) == 1) {
+        event->kind = SCAN_CAPTURE_WINDOW_END;
+        return true;
+    }
+
+    char bda[13], adv[2 * SCAN_CAPTURE_ADV_MAX_LEN + 1], rsp[2 * SCAN_CAPTURE_ADV_MAX_LEN + 1];
+    unsigned addr_type, evt_type;
+    int rssi;
+    if (sscanf(line, "ADV %" SCNd64 " %12s %u %u %d %62s %62s", &event->timestamp_us, bda,
+               &addr_type, &evt_type, &rssi, adv, rsp) != 7) {
+        return false;
+    }
+
+    if (get_hex(bda, event->bda, sizeof(event->bda)) != (int)sizeof(event->bda)) {
+        return false;
+    }
+    int adv_len = get_hex(adv, event->data, SCAN_CAPTURE_ADV_MAX_LEN);
+    if (adv_len < 0) {
+        return false;
+    }
+    int rsp_len = get_hex(rsp, event->data + adv_len, SCAN_CAPTURE_ADV_MAX_LEN);
+    if (rsp_len < 0) {
+        return false;
+    }
+
+    event->kind = SCAN_CAPTURE_ADV;
+    event->addr_type = (uint8_t)addr_type;
+    event->evt_type = (uint8_t)evt_type;
+    event->rssi = (int8_t)rssi;
+    event->adv_len = (uint8_t)adv_len;
+    event->scan_rsp_len = (uint8_t)rsp_len;
+    return true;
+}
@@ -0,0 +1,52 @@
+#ifndef MAIN_SCAN_CAPTURE_H_
+#define MAIN_SCAN_CAPTURE_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Tekstowy format zapisu zdarzeń skanowania, wspólny dla trybu przechwytywania
+// na płytce (UART) i narzędzia host/scan_replay. Jedna linia na zdarzenie:
+//
+//   ADV <timestamp_us> <bda:12 hex> <addr_type> <evt_type> <rssi> <adv hex|-> <scan_rsp hex|->
+//   END <timestamp_us>
+//
+// END oznacza koniec okna skanowania (ESP_GAP_SEARCH_INQ_CMPL_EVT / SCAN_STOP).
+// Moduł nie zależy od ESP-IDF.
+
+#define SCAN_CAPTURE_ADV_MAX_LEN 31
+#define SCAN_CAPTURE_DATA_MAX_LEN (2 * SCAN_CAPTURE_ADV_MAX_LEN)
+#define SCAN_CAPTURE_LINE_MAX_LEN 192
+
+typedef enum {
+    SCAN_CAPTURE_ADV = 0,
+    SCAN_CAPTURE_WINDOW_END,
+} scan_capture_kind_t;
+
+typedef struct {
+    scan_capture_kind_t kind;
+    int64_t timestamp_us;
+    uint8_t bda[6];
+    uint8_t addr_type;
+    uint8_t evt_type;
+    int8_t rssi;
+    uint8_t adv_len;
+    uint8_t scan_rsp_len;
+    uint8_t data[SCAN_CAPTURE_DATA_MAX_LEN]; // Reklama, a zaraz za nią odpowiedź na skanowanie
+} scan_capture_event_t;
+
+// Zwraca długość linii (bez '\n') albo 0, gdy bufor jest za mały
+size_t scan_capture_format(const scan_capture_event_t *event, char *line, size_t capacity);
+
+// Zwraca false dla linii, które nie są zdarzeniem (np. zwykłe logi z UART)
+bool scan_capture_parse(const char *line, scan_capture_event_t *event);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
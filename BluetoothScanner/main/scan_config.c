@@ -0,0 +1,131 @@
+#include "scan_config.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+void scan_config_default(scan_config_t *config) {
+    config->interval = CONFIG_SCAN_RADIO_INTERVAL;
+    config->window = CONFIG_SCAN_RADIO_WINDOW;
+    config->duration_s = CONFIG_SCAN_DURATION_S;
+#ifdef CONFIG_SCAN_INTERVAL_S
+    config->pause_s = CONFIG_SCAN_INTERVAL_S;
+#else
+    config->pause_s = 0;
+#endif
+#if CONFIG_SCAN_PASSIVE
+    config->active = false;
+#else
+    config->active = true;
+#endif
+}
+
+static bool parse_number(const char *value, long min, long max, uint16_t *out) {
+    char *end;
+    long number = strtol(value, &end, 0);
+    if (end == value || *end != '\0' || number < min || number > max) {
+        return false;
+    }
+    *out = (uint16_t)number;
+    return true;
+}
+
+bool scan_config_parse(const char *text, scan_config_t *config, char *error, size_t error_len) {
+    scan_config_t parsed = *config;
+    char token[32];
+    const char *cursor = text;
+
+    while (*cursor) {
+        while (*cursor == ' ' || *cursor == '\t') {
+            cursor++;
+        }
+        size_t len = strcspn(cursor, " \t");
+        if (len == 0) {
+            break;
+        }
+        if (len >= sizeof(token)) {
+            snprintf(error, error_len, "token too long");
+            return false;
+        }
+        memcpy(token, cursor, len);
+        token[len] = '\0';
+        cursor += len;
+
+        char *value = strchr(token, '=');
+        if (value == NULL) {
+            snprintf(error, error_len, "expected key=value: %s", token);
+            return false;
+        }
+        *value++ = '\0';
+
+        bool ok;
+        if (strcmp(token, "interval") == 0) {
+            ok = parse_number(value, SCAN_CONFIG_RADIO_MIN, SCAN_CONFIG_RADIO_MAX, &parsed.interval);
+        } else if (strcmp(token, "window") == 0) {
+            ok = parse_number(value, SCAN_CONFIG_RADIO_MIN, SCAN_CONFIG_RADIO_MAX, &parsed.window);
+        } else if (strcmp(token, "duration") == 0) {
+            ok = parse_number(value, 1, SCAN_CONFIG_SECONDS_MAX, &parsed.duration_s);
+        } else if (strcmp(token, "pause") == 0) {
+            ok = parse_number(value, 0, SCAN_CONFIG_SECONDS_MAX, &parsed.pause_s);
+        } else if (strcmp(token, "type") == 0) {
+            ok = strcmp(value, "active") == 0 || strcmp(value, "passive") == 0;
+            parsed.active = strcmp(value, "active") == 0;
+        } else {
+            snprintf(error, error_len, "unknown key: %s", token);
+            return false;
+        }
+        if (!ok) {
+            snprintf(error, error_len, "invalid %s: %s", token, value);
+            return false;
+        }
+    }
+
+    if (!scan_config_validate(&parsed, error, error_len)) {
+        return false;
+    }
+    *config = parsed;
+    return true;
+}
+
+bool scan_config_validate(const scan_config_t *config, char *error, size_t error_len) {
+    if (config->interval < SCAN_CONFIG_RADIO_MIN || config->interval > SCAN_CONFIG_RADIO_MAX ||
+        config->window < SCAN_CONFIG_RADIO_MIN || config->window > SCAN_CONFIG_RADIO_MAX) {
+        snprintf(error, error_len, "interval and window must be %d-%d", SCAN_CONFIG_RADIO_MIN, SCAN_CONFIG_RADIO_MAX);
+        return false;
+    }
+    if (config->window > config->interval) {
+        snprintf(error, error_len, "window %u longer than interval %u", config->window, config->interval);
+        return false;
+    }
+    if (config->duration_s < 1 || config->duration_s > SCAN_CONFIG_SECONDS_MAX ||
+        config->pause_s > SCAN_CONFIG_SECONDS_MAX) {
+        snprintf(error, error_len, "duration must be 1-%d s, pause 0-%d s", SCAN_CONFIG_SECONDS_MAX,
+                 SCAN_CONFIG_SECONDS_MAX);
+        return false;
+    }
+    return true;
+}
+
+size_t scan_config_format(const scan_config_t *config, char *buffer, size_t capacity) {
+    int len = snprintf(buffer, capacity, "interval=%u window=%u duration=%u pause=%u type=%s", config->interval,
+                       config->window, config->duration_s, config->pause_s, config->active ? "active" : "passive");
+    return len < 0 || (size_t)len >= capacity ? 0 : (size_t)len;
+}
+
+uint64_t scan_config_pack(const scan_config_t *config) {
+    // 15 bitów na interval i window (do 0x4000), 12 na czasy (do 3600 s), 1 na typ
+    return (uint64_t)config->interval | (uint64_t)config->window << 15 | (uint64_t)config->duration_s << 30 |
+           (uint64_t)config->pause_s << 42 | (uint64_t)(config->active ? 1 : 0) << 54;
+}
+
+void scan_config_unpack(uint64_t packed, scan_config_t *config) {
+    config->interval = (uint16_t)(packed & 0x7FFF);
+    config->window = (uint16_t)((packed >> 15) & 0x7FFF);
+    config->duration_s = (uint16_t)((packed >> 30) & 0xFFF);
+    config->pause_s = (uint16_t)((packed >> 42) & 0xFFF);
+    config->active = (packed >> 54) & 1;
+}
+
+bool scan_config_radio_differs(const scan_config_t *a, const scan_config_t *b) {
+    return a->interval != b->interval || a->window != b->window || a->active != b->active;
+}
@@ -0,0 +1,59 @@
+#ifndef MAIN_SCAN_CONFIG_H_
+#define MAIN_SCAN_CONFIG_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "sdkconfig.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Parametry skanowania zmieniane w czasie pracy (polecenie "scan", NVS).
+// Tekstowa postać - pary klucz=wartość rozdzielone spacjami, pominięte klucze
+// zachowują dotychczasową wartość:
+//   interval=160     odstęp między początkami nasłuchu radia, jednostki 0.625 ms
+//   window=80        czas nasłuchu w każdym odstępie, jednostki 0.625 ms (<= interval)
+//   duration=10      długość okna skanowania w sekundach (agregacja i publikacja)
+//   pause=5          przerwa między oknami w sekundach (tylko skanowanie z przerwami)
+//   type=active      active - zapytania o scan response, passive - tylko nasłuch
+// Moduł nie zależy od ESP-IDF.
+
+#define SCAN_CONFIG_RADIO_MIN 0x0004
+#define SCAN_CONFIG_RADIO_MAX 0x4000
+#define SCAN_CONFIG_SECONDS_MAX 3600
+#define SCAN_CONFIG_TEXT_LEN 64
+
+typedef struct {
+    uint16_t interval;
+    uint16_t window;
+    uint16_t duration_s;
+    uint16_t pause_s;
+    bool active;
+} scan_config_t;
+
+// Wartości z Kconfig
+void scan_config_default(scan_config_t *config);
+
+// Nakłada pary z text na config; przy błędzie config pozostaje bez zmian
+bool scan_config_parse(const char *text, scan_config_t *config, char *error, size_t error_len);
+
+bool scan_config_validate(const scan_config_t *config, char *error, size_t error_len);
+
+// Pełna postać tekstowa, zwraca długość (bufor SCAN_CONFIG_TEXT_LEN wystarcza)
+size_t scan_config_format(const scan_config_t *config, char *buffer, size_t capacity);
+
+// Konfiguracja w jednym słowie - przekazywana między zadaniami przez zmienną atomową
+uint64_t scan_config_pack(const scan_config_t *config);
+void scan_config_unpack(uint64_t packed, scan_config_t *config);
+
+// Czy zmiana wymaga ponownego ustawienia parametrów radia (esp_ble_gap_set_scan_params)
+bool scan_config_radio_differs(const scan_config_t *a, const scan_config_t *b);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,407 @@
+#include "scan_filter.h"
+
+#include <ctype.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "sighting.h"
+#include "tag_allowlist.h"
+
+// Długość pojedynczej reguły w postaci tekstowej
+#define RULE_TEXT_MAX_LEN 80
+
+// Przekazanie nowych reguł do kontekstu callbacku GAP bez blokady:
+// zapisujący wypełnia staged, a callback kopiuje go do active przy następnym zdarzeniu
+enum {
+    STAGE_IDLE,
+    STAGE_WRITING,
+    STAGE_READY,
+    STAGE_TAKING,
+};
+
+// Używane tylko z kontekstu scan_filter_accept
+static scan_filter_t active = {
+    .rules = {{.kind = SCAN_FILTER_NAMED, .action = SCAN_FILTER_INCLUDE}},
+    .count = 1,
+    .default_action = SCAN_FILTER_EXCLUDE,
+};
+static uint32_t hits[SCAN_FILTER_MAX_RULES + 1]; // Ostatni licznik - akcja domyślna
+
+static scan_filter_t staged;
+static atomic_int stage_state = STAGE_IDLE;
+
+typedef struct {
+    const char *name;
+    scan_filter_kind_t kind;
+} kind_name_t;
+
+static const kind_name_t kind_names[] = {
+    {"mac", SCAN_FILTER_MAC_PREFIX},
+    {"oui", SCAN_FILTER_MAC_PREFIX},
+    {"addr_type", SCAN_FILTER_ADDR_TYPE},
+    {"rssi_min", SCAN_FILTER_RSSI_MIN},
+    {"rssi_max", SCAN_FILTER_RSSI_MAX},
+    {"registered", SCAN_FILTER_REGISTERED},
+    {"named", SCAN_FILTER_NAMED},
+    {"name_prefix", SCAN_FILTER_NAME_PREFIX},
+    {"name_contains", SCAN_FILTER_NAME_CONTAINS},
+    {"uuid16", SCAN_FILTER_UUID},
+    {"uuid32", SCAN_FILTER_UUID},
+    {"uuid128", SCAN_FILTER_UUID},
+    {"company", SCAN_FILTER_COMPANY},
+};
+
+static const char *const addr_type_names[] = {"public", "random", "rpa_public", "rpa_random"};
+
+static int hex_digit(char c) {
+    if (c >= '0' && c <= '9') {
+        return c - '0';
+    }
+    c = (char)tolower((unsigned char)c);
+    if (c >= 'a' && c <= 'f') {
+        return c - 'a' + 10;
+    }
+    return -1;
+}
+
+// Parsuje bajty zapisane szesnastkowo, opcjonalnie rozdzielone ':' lub '-'.
+// Zwraca liczbę bajtów albo -1.
+static int parse_hex_bytes(const char *text, uint8_t *out, size_t max) {
+    size_t count = 0;
+    while (*text) {
+        if (*text == ':' || *text == '-') {
+            text++;
+            continue;
+        }
+        int high = hex_digit(text[0]);
+        int low = high >= 0 ? hex_digit(text[1]) : -1;
+        if (low < 0 || count == max) {
+            return -1;
+        }
+        out[count++] = (uint8_t)(high << 4 | low);
+        text += 2;
+    }
+    return (int)count;
+}
+
+static bool parse_long(const char *text, long min, long max, long *out) {
+    char *end;
+    long value = strtol(text, &end, 0);
+    if (end == text || *end != '\0' || value < min || value > max) {
+        return false;
+    }
+    *out = value;
+    return true;
+}
+
+static bool parse_action(const char *text, uint8_t *action) {
+    if (strcmp(text, "include") == 0) {
+        *action = SCAN_FILTER_INCLUDE;
+    } else if (strcmp(text, "exclude") == 0) {
+        *action = SCAN_FILTER_EXCLUDE;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+// Wartość reguły to reszta tekstu po nazwie rodzaju (nazwy mogą zawierać spacje)
+static const char *parse_value(scan_filter_rule_t *rule, const char *kind, const char *value) {
+    size_t value_len = strlen(value);
+    long number;
+
+    switch (rule->kind) {
+        case SCAN_FILTER_MAC_PREFIX: {
+            int count = parse_hex_bytes(value, rule->value, SIGHTING_BDA_LEN);
+            if (count <= 0 || (strcmp(kind, "oui") == 0 && count != 3)) {
+                return "invalid address prefix";
+            }
+            rule->len = (uint8_t)count;
+            return NULL;
+        }
+
+        case SCAN_FILTER_ADDR_TYPE:
+            for (size_t i = 0; i < sizeof(addr_type_names) / sizeof(addr_type_names[0]); i++) {
+                if (strcmp(value, addr_type_names[i]) == 0) {
+                    rule->number = (int8_t)i;
+                    return NULL;
+                }
+            }
+            if (!parse_long(value, 0, 3, &number)) {
+                return "invalid address type";
+            }
+            rule->number = (int8_t)number;
+            return NULL;
+
+        case SCAN_FILTER_RSSI_MIN:
+        case SCAN_FILTER_RSSI_MAX:
+            if (!parse_long(value, -128, 127, &number)) {
+                return "invalid RSSI threshold";
+            }
+            rule->number = (int8_t)number;
+            return NULL;
+
+        case SCAN_FILTER_REGISTERED:
+        case SCAN_FILTER_NAMED:
+            return value_len == 0 ? NULL : "unexpected value";
+
+        case SCAN_FILTER_NAME_PREFIX:
+        case SCAN_FILTER_NAME_CONTAINS:
+            if (value_len == 0 || value_len > SCAN_FILTER_VALUE_MAX_LEN) {
+                return "name must be 1-16 characters";
+            }
+            memcpy(rule->value, value, value_len);
+            rule->len = (uint8_t)value_len;
+            return NULL;
+
+        case SCAN_FILTER_UUID: {
+            // Rozmiar UUID wynika z nazwy rodzaju: uuid16 / uuid32 / uuid128
+            int expected = atoi(kind + 4) / 8;
+            uint8_t big_endian[SCAN_FILTER_VALUE_MAX_LEN];
+            if (parse_hex_bytes(value, big_endian, sizeof(big_endian)) != expected) {
+                return "invalid UUID";
+            }
+            for (int i = 0; i < expected; i++) {
+                rule->value[i] = big_endian[expected - 1 - i];
+            }
+            rule->len = (uint8_t)expected;
+            return NULL;
+        }
+
+        case SCAN_FILTER_COMPANY:
+            if (!parse_long(value, 0, 0xFFFF, &number)) {
+                return "invalid company ID";
+            }
+            rule->value[0] = (uint8_t)(number & 0xFF);
+            rule->value[1] = (uint8_t)(number >> 8);
+            rule->len = 2;
+            return NULL;
+    }
+    return "unknown rule";
+}
+
+// Kompiluje jedną regułę; tekst jest modyfikowany (podział na słowa)
+static const char *compile_rule(char *text, scan_filter_t *filter, bool *has_default) {
+    char *save = NULL;
+    char *action = strtok_r(text, " \t", &save);
+    char *kind = strtok_r(NULL, " \t", &save);
+    char *value = strtok_r(NULL, "", &save);
+    if (value == NULL) {
+        value = text + strlen(text); // Reguła bez wartości
+    }
+    while (isspace((unsigned char)*value)) {
+        value++;
+    }
+    size_t value_len = strlen(value);
+    while (value_len > 0 && isspace((unsigned char)value[value_len - 1])) {
+        value[--value_len] = '\0';
+    }
+
+    if (kind == NULL) {
+        return "expected '<action> <kind> [value]'";
+    }
+
+    if (strcmp(action, "default") == 0) {
+        if (!parse_action(kind, &filter->default_action) || value_len > 0) {
+            return "expected 'default include|exclude'";
+        }
+        *has_default = true;
+        return NULL;
+    }
+
+    if (filter->count == SCAN_FILTER_MAX_RULES) {
+        return "too many rules";
+    }
+    scan_filter_rule_t *rule = &filter->rules[filter->count];
+    memset(rule, 0, sizeof(*rule));
+    if (!parse_action(action, &rule->action)) {
+        return "unknown action";
+    }
+
+    size_t kind_index = 0;
+    while (kind_index < sizeof(kind_names) / sizeof(kind_names[0]) &&
+           strcmp(kind, kind_names[kind_index].name) != 0) {
+        kind_index++;
+    }
+    if (kind_index == sizeof(kind_names) / sizeof(kind_names[0])) {
+        return "unknown kind";
+    }
+    rule->kind = kind_names[kind_index].kind;
+
+    const char *error = parse_value(rule, kind, value);
+    if (error == NULL) {
+        filter->count++;
+    }
+    return error;
+}
+
+bool scan_filter_compile(const char *text, scan_filter_t *filter, char *error, size_t error_len) {
+    memset(filter, 0, sizeof(*filter));
+    bool has_default = false;
+    int index = 0;
+
+    const char *cursor = text;
+    while (*cursor) {
+        size_t len = strcspn(cursor, ";\n");
+        const char *next = cursor[len] ? cursor + len + 1 : cursor + len;
+
+        char rule[RULE_TEXT_MAX_LEN];
+        size_t start = 0;
+        while (start < len && isspace((unsigned char)cursor[start])) {
+            start++;
+        }
+        if (start == len) {
+            cursor = next; // Pusta reguła (np. ';' na końcu)
+            continue;
+        }
+
+        const char *rule_error = NULL;
+        if (len - start >= sizeof(rule)) {
+            rule_error = "rule too long";
+        } else {
+            memcpy(rule, cursor + start, len - start);
+            rule[len - start] = '\0';
+            rule_error = compile_rule(rule, filter, &has_default);
+        }
+        if (rule_error) {
+            snprintf(error, error_len, "rule %d: %s", index + 1, rule_error);
+            return false;
+        }
+        index++;
+        cursor = next;
+    }
+
+    // Bez jawnej akcji domyślnej: lista samych wykluczeń przepuszcza resztę
+    // urządzeń, lista zaczynająca się od włączenia działa jak lista dozwolonych
+    if (!has_default) {
+        filter->default_action = (filter->count > 0 && filter->rules[0].action == SCAN_FILTER_INCLUDE)
+                                     ? SCAN_FILTER_EXCLUDE
+                                     : SCAN_FILTER_INCLUDE;
+    }
+    return true;
+}
+
+void scan_filter_install(const scan_filter_t *filter) {
+    int expected = STAGE_IDLE;
+    // Stan TAKING trwa tylko na czas kopiowania w callbacku GAP
+    while (!atomic_compare_exchange_weak(&stage_state, &expected, STAGE_WRITING)) {
+        if (expected == STAGE_TAKING) {
+            expected = STAGE_IDLE;
+        }
+    }
+    staged = *filter;
+    atomic_store_explicit(&stage_state, STAGE_READY, memory_order_release);
+}
+
+static void take_staged(void) {
+    int expected = STAGE_READY;
+    if (atomic_load_explicit(&stage_state, memory_order_acquire) != STAGE_READY ||
+        !atomic_compare_exchange_strong(&stage_state, &expected, STAGE_TAKING)) {
+        return;
+    }
+    active = staged;
+    memset(hits, 0, sizeof(hits));
+    atomic_store_explicit(&stage_state, STAGE_IDLE, memory_order_release);
+}
+
+const adv_fields_t *scan_filter_event_fields(scan_filter_event_t *event) {
+    if (!event->parsed) {
+        adv_parse(event->data, event->adv_len, event->scan_rsp_len, event->fields);
+        event->parsed = true;
+    }
+    return event->fields;
+}
+
+static bool contains(const adv_view_t *haystack, const uint8_t *needle, uint8_t len) {
+    for (size_t i = 0; i + len <= haystack->len; i++) {
+        if (memcmp(haystack->data + i, needle, len) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// UUID na listach o danym rozmiarze albo w danych usługi
+static bool has_uuid(const adv_fields_t *fields, const scan_filter_rule_t *rule) {
+    const adv_view_t *lists = rule->len == 2 ? fields->uuid16 : rule->len == 4 ? fields->uuid32 : fields->uuid128;
+    uint8_t list_count = rule->len == 2 ? fields->uuid16_count
+                         : rule->len == 4 ? fields->uuid32_count
+                                          : fields->uuid128_count;
+    for (uint8_t i = 0; i < list_count; i++) {
+        for (size_t offset = 0; offset + rule->len <= lists[i].len; offset += rule->len) {
+            if (memcmp(lists[i].data + offset, rule->value, rule->len) == 0) {
+                return true;
+            }
+        }
+    }
+    for (uint8_t i = 0; i < fields->service_data_count; i++) {
+        const adv_view_t *uuid = &fields->service_data[i].uuid;
+        if (uuid->len == rule->len && memcmp(uuid->data, rule->value, rule->len) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+static bool rule_matches(const scan_filter_rule_t *rule, scan_filter_event_t *event) {
+    switch (rule->kind) {
+        case SCAN_FILTER_MAC_PREFIX:
+            return memcmp(event->bda, rule->value, rule->len) == 0;
+        case SCAN_FILTER_ADDR_TYPE:
+            return event->addr_type == (uint8_t)rule->number;
+        case SCAN_FILTER_RSSI_MIN:
+            return event->rssi >= rule->number;
+        case SCAN_FILTER_RSSI_MAX:
+            return event->rssi <= rule->number;
+        case SCAN_FILTER_REGISTERED:
+            return tag_allowlist_contains(event->bda);
+        default:
+            break;
+    }
+
+    const adv_fields_t *fields = scan_filter_event_fields(event);
+    switch (rule->kind) {
+        case SCAN_FILTER_NAMED:
+            return fields->name.len > 0;
+        case SCAN_FILTER_NAME_PREFIX:
+            return fields->name.len >= rule->len && memcmp(fields->name.data, rule->value, rule->len) == 0;
+        case SCAN_FILTER_NAME_CONTAINS:
+            return contains(&fields->name, rule->value, rule->len);
+        case SCAN_FILTER_UUID:
+            return has_uuid(fields, rule);
+        case SCAN_FILTER_COMPANY: {
+            uint16_t company_id = (uint16_t)(rule->value[0] | rule->value[1] << 8);
+            for (uint8_t i = 0; i < fields->manufacturer_count; i++) {
+                if (fields->manufacturer[i].company_id == company_id) {
+                    return true;
+                }
+            }
+            return false;
+        }
+        default:
+            return false;
+    }
+}
+
+bool scan_filter_accept(scan_filter_event_t *event) {
+    take_staged();
+
+    for (uint8_t i = 0; i < active.count; i++) {
+        if (rule_matches(&active.rules[i], event)) {
+            hits[i]++;
+            return active.rules[i].action == SCAN_FILTER_INCLUDE;
+        }
+    }
+    hits[SCAN_FILTER_MAX_RULES]++;
+    return active.default_action == SCAN_FILTER_INCLUDE;
+}
+
+size_t scan_filter_get_hits(uint32_t *out, size_t max_rules, uint32_t *default_hits) {
+    // Odczyt bez synchronizacji - liczniki są tylko statystyką
+    size_t count = active.count < max_rules ? active.count : max_rules;
+    memcpy(out, hits, count * sizeof(out[0]));
+    *default_hits = hits[SCAN_FILTER_MAX_RULES];
+    return count;
+}
@@ -0,0 +1,110 @@
+#ifndef MAIN_SCAN_FILTER_H_
+#define MAIN_SCAN_FILTER_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "adv_parser.h"
+#include "sdkconfig.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Filtr wyników skanowania oceniany w callbacku GAP, zanim powstanie obserwacja.
+// Reguły są sprawdzane po kolei, decyduje pierwsza pasująca; gdy żadna nie pasuje,
+// decyduje akcja domyślna. Reguły oparte na adresie i RSSI nie wymagają parsowania
+// danych reklamy - adv_parse jest wywoływany dopiero przy pierwszej regule, która
+// potrzebuje nazwy, UUID lub identyfikatora producenta.
+//
+// Tekstowa postać (NVS, /boards_command) - reguły rozdzielone ';' lub nową linią:
+//   include|exclude mac aa:bb[:cc...]   prefiks adresu, 1-6 bajtów
+//   include|exclude oui aa:bb:cc
+//   include|exclude addr_type public|random|rpa_public|rpa_random
+//   include|exclude rssi_min -70        rssi >= -70
+//   include|exclude rssi_max -90        rssi <= -90
+//   include|exclude registered          adres na liście tagów (tag_allowlist.h)
+//   include|exclude named               urządzenie ma nazwę
+//   include|exclude name_prefix Mi
+//   include|exclude name_contains Tag
+//   include|exclude uuid16 feaa         także uuid32 / uuid128 (zapis big-endian, '-' dozwolone)
+//   include|exclude company 0x004c
+//   default include|exclude
+// Bez reguły "default" akcja domyślna jest przeciwna do akcji pierwszej reguły.
+// Ocena zdarzenia kosztuje co najwyżej SCAN_FILTER_MAX_RULES porównań na płaskiej tablicy.
+// Moduł nie zależy od ESP-IDF.
+
+#define SCAN_FILTER_MAX_RULES CONFIG_SCAN_FILTER_MAX_RULES
+#define SCAN_FILTER_VALUE_MAX_LEN 16
+
+// Reguły obowiązujące, gdy nic nie zapisano w NVS - dotychczasowe zachowanie skanera
+#define SCAN_FILTER_DEFAULT_RULES "include named; default exclude"
+
+typedef enum {
+    SCAN_FILTER_EXCLUDE = 0,
+    SCAN_FILTER_INCLUDE = 1,
+} scan_filter_action_t;
+
+typedef enum {
+    SCAN_FILTER_MAC_PREFIX = 0,
+    SCAN_FILTER_ADDR_TYPE,
+    SCAN_FILTER_RSSI_MIN,
+    SCAN_FILTER_RSSI_MAX,
+    SCAN_FILTER_REGISTERED,
+    // Reguły poniżej wymagają sparsowanych danych reklamy
+    SCAN_FILTER_NAMED,
+    SCAN_FILTER_NAME_PREFIX,
+    SCAN_FILTER_NAME_CONTAINS,
+    SCAN_FILTER_UUID,
+    SCAN_FILTER_COMPANY,
+} scan_filter_kind_t;
+
+// Skompilowana reguła - stały rozmiar, bez wskaźników
+typedef struct {
+    uint8_t kind;    // scan_filter_kind_t
+    uint8_t action;  // scan_filter_action_t
+    uint8_t len;     // Długość value (prefiks MAC, nazwa, UUID w bajtach)
+    int8_t number;   // Typ adresu albo próg RSSI
+    uint8_t value[SCAN_FILTER_VALUE_MAX_LEN]; // UUID little-endian jak w danych reklamy
+} scan_filter_rule_t;
+
+typedef struct {
+    scan_filter_rule_t rules[SCAN_FILTER_MAX_RULES];
+    uint8_t count;
+    uint8_t default_action;
+} scan_filter_t;
+
+// Dane zdarzenia skanowania; fields są wypełniane przy pierwszej potrzebie
+typedef struct {
+    const uint8_t *bda;
+    uint8_t addr_type;
+    int8_t rssi;
+    const uint8_t *data; // Reklama, a zaraz za nią odpowiedź na skanowanie
+    uint8_t adv_len;
+    uint8_t scan_rsp_len;
+    adv_fields_t *fields;
+    bool parsed;
+} scan_filter_event_t;
+
+// Zwraca false i opis błędu (z numerem reguły) dla niepoprawnego tekstu
+bool scan_filter_compile(const char *text, scan_filter_t *filter, char *error, size_t error_len);
+
+// Podmienia aktywne reguły i zeruje liczniki trafień. Może być wołane z innego
+// zadania niż scan_filter_accept - zmiana jest przejmowana przy następnym zdarzeniu.
+void scan_filter_install(const scan_filter_t *filter);
+
+// Ocena zdarzenia aktywnymi regułami (kontekst callbacku GAP)
+bool scan_filter_accept(scan_filter_event_t *event);
+
+// Zwraca sparsowane dane reklamy zdarzenia, parsując je, jeśli filtr tego nie zrobił
+const adv_fields_t *scan_filter_event_fields(scan_filter_event_t *event);
+
+// Kopiuje liczniki trafień aktywnych reguł; zwraca liczbę reguł
+size_t scan_filter_get_hits(uint32_t *hits, size_t max_rules, uint32_t *default_hits);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
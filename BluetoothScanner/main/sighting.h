@@ -0,0 +1,35 @@
+#ifndef MAIN_SIGHTING_H_
+#define MAIN_SIGHTING_H_
+
+#include <stdint.h>
+
+#define SIGHTING_BDA_LEN 6
+#define SIGHTING_NAME_MAX_LEN 32 // ESP_BLE_ADV_DATA_LEN_MAX + '\0'
+
+typedef enum {
+    SIGHTING_KIND_ADV = 0,    // Raport z reklamy urządzenia
+    SIGHTING_KIND_WINDOW_END, // Znacznik końca okna skanowania
+} sighting_kind_t;
+
+// Typ raportu reklamowego; wartości jak esp_ble_evt_type_t
+typedef enum {
+    SIGHTING_EVENT_CONN_ADV = 0,     // ADV_IND
+    SIGHTING_EVENT_CONN_DIR_ADV,     // ADV_DIRECT_IND
+    SIGHTING_EVENT_DISC_ADV,         // ADV_SCAN_IND
+    SIGHTING_EVENT_NON_CONN_ADV,     // ADV_NONCONN_IND
+    SIGHTING_EVENT_SCAN_RSP,         // SCAN_RSP
+} sighting_event_type_t;
+
+// Pojedyncza obserwacja urządzenia BLE, kopiowana z callbacku GAP
+typedef struct {
+    int64_t timestamp_us; // esp_timer_get_time() w chwili odebrania zdarzenia
+    uint8_t kind;         // sighting_kind_t
+    uint8_t bda[SIGHTING_BDA_LEN];
+    uint8_t addr_type;
+    uint8_t evt_type;     // sighting_event_type_t
+    int8_t rssi;
+    uint8_t name_len;
+    char name[SIGHTING_NAME_MAX_LEN];
+} ble_sighting_t;
+
+#endif
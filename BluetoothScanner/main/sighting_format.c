@@ -0,0 +1,186 @@
+#include "sighting_format.h"
+
+#include <inttypes.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "json_string.h"
+#include "sdkconfig.h"
+#include "time_sync.h"
+
+// Miejsce zarezerwowane na zamknięcie "]}" przez sighting_batch_finish
+#define BATCH_TRAILER_LEN 2
+
+// Nazwa urządzenia po escapowaniu: każdy znak najwyżej podwojony
+#define NAME_JSON_LEN (2 * SIGHTING_NAME_MAX_LEN)
+
+void sighting_format_address(const uint8_t *bda, char *address) {
+    static const char hex[] = "0123456789abcdef";
+    for (int i = 0; i < SIGHTING_BDA_LEN; i++) {
+        address[i * 3] = hex[bda[i] >> 4];
+        address[i * 3 + 1] = hex[bda[i] & 0x0F];
+        address[i * 3 + 2] = (i < SIGHTING_BDA_LEN - 1) ? ':' : '\0';
+    }
+}
+
+static size_t format_device_json(const device_entry_t *entry, int64_t timestamp_us, char *buffer,
+                                 size_t capacity) {
+    char address[SIGHTING_ADDRESS_STR_LEN];
+    char name[NAME_JSON_LEN];
+    sighting_format_address(entry->bda, address);
+    json_append_string(name, sizeof(name), 0, entry->name);
+
+    int len = snprintf(buffer, capacity,
+                       "{\"name\": \"%s\", \"address\": \"%s\", \"rssi\": %d, "
+                       "\"rssi_min\": %d, \"rssi_max\": %d, \"count\": %" PRIu32 ", \"timestamp_us\": %" PRId64,
+                       name, address, device_entry_rssi(entry),
+                       entry->rssi_min, entry->rssi_max, entry->count, timestamp_us);
+    if (len < 0 || (size_t)len >= capacity) {
+        return 0;
+    }
+
+#if CONFIG_RSSI_FILTER_EMA || CONFIG_RSSI_FILTER_KALMAN
+    // Wygładzone RSSI i wariancja z jedną cyfrą po przecinku
+    int32_t smoothed = rssi_filter_rssi_tenths(&entry->rssi_filter);
+    int32_t variance = rssi_filter_variance_tenths(&entry->rssi_filter);
+    int extra = snprintf(buffer + len, capacity - (size_t)len,
+                         ", \"rssi_smoothed\": %s%" PRId32 ".%" PRId32 ", \"rssi_variance\": %" PRId32 ".%" PRId32,
+                         smoothed < 0 ? "-" : "", (smoothed < 0 ? -smoothed : smoothed) / 10,
+                         (smoothed < 0 ? -smoothed : smoothed) % 10, variance / 10, variance % 10);
+    if (extra < 0 || (size_t)(len + extra) >= capacity) {
+        return 0;
+    }
+    len += extra;
+#endif
+
+    if ((size_t)len + 2 > capacity) {
+        return 0;
+    }
+    buffer[len++] = '}';
+    buffer[len] = '\0';
+    return (size_t)len;
+}
+
+size_t sighting_format_device_json(const device_entry_t *entry, char *buffer, size_t capacity) {
+    return format_device_json(entry, time_sync_epoch_us(entry->last_seen_us), buffer, capacity);
+}
+
+size_t sighting_format_presence_json(const char *event, const device_entry_t *entry, int64_t now_us,
+                                     char *buffer, size_t capacity) {
+    char address[SIGHTING_ADDRESS_STR_LEN];
+    char name[NAME_JSON_LEN];
+    sighting_format_address(entry->bda, address);
+    json_append_string(name, sizeof(name), 0, entry->name);
+
+    int len = event ? snprintf(buffer, capacity, "{\"event\": \"%s\", \"timestamp_us\": %" PRId64 ", ", event,
+                               time_sync_epoch_us(now_us))
+                    : snprintf(buffer, capacity, "{");
+    if (len < 0 || (size_t)len >= capacity) {
+        return 0;
+    }
+
+    int extra = snprintf(buffer + len, capacity - (size_t)len,
+                         "\"address\": \"%s\", \"name\": \"%s\", \"rssi\": %d, \"present_ms\": %" PRId64 "}",
+                         address, name, entry->presence_rssi, (now_us - entry->present_since_us) / 1000);
+    if (extra < 0 || (size_t)(len + extra) >= capacity) {
+        return 0;
+    }
+    return (size_t)(len + extra);
+}
+
+// Czas wpisu w wiadomości - przeliczany, chyba że paczka zawiera już czas UNIX
+static int64_t batch_epoch_us(const sighting_batch_t *batch, int64_t timestamp_us) {
+    return batch->epoch ? timestamp_us : time_sync_epoch_us(timestamp_us);
+}
+
+static void begin_batch(sighting_batch_t *batch, sighting_payload_format_t format, char *buffer,
+                        size_t capacity, const char *board_name, int64_t base_timestamp_us, bool epoch) {
+    batch->format = format;
+    batch->epoch = epoch;
+    batch->buffer = buffer;
+    batch->capacity = capacity;
+    batch->count = 0;
+    batch->timestamp_us = base_timestamp_us;
+    batch->newest_us = 0;
+
+    if (format == SIGHTING_PAYLOAD_BINARY) {
+        sighting_wire_writer_begin(&batch->wire, (uint8_t *)buffer, capacity, batch_epoch_us(batch, base_timestamp_us));
+        batch->length = batch->wire.length;
+        return;
+    }
+
+    batch->length = 0;
+    size_t len = (size_t)snprintf(buffer, capacity, "{\"board\": \"");
+    if (len + json_string_length(board_name) >= capacity) {
+        return;
+    }
+    len = json_append_string(buffer, capacity, len, board_name);
+    int extra = snprintf(buffer + len, capacity - len, "\", \"timestamp_ms\": %" PRId64 ", \"devices\": [",
+                         batch_epoch_us(batch, base_timestamp_us) / 1000);
+    if (extra >= 0 && len + (size_t)extra < capacity) {
+        batch->length = len + (size_t)extra;
+    }
+}
+
+void sighting_batch_begin(sighting_batch_t *batch, sighting_payload_format_t format, char *buffer,
+                          size_t capacity, const char *board_name, int64_t base_timestamp_us) {
+    begin_batch(batch, format, buffer, capacity, board_name, base_timestamp_us, false);
+}
+
+void sighting_batch_begin_epoch(sighting_batch_t *batch, sighting_payload_format_t format, char *buffer,
+                                size_t capacity, const char *board_name, int64_t base_timestamp_us) {
+    begin_batch(batch, format, buffer, capacity, board_name, base_timestamp_us, true);
+}
+
+static void count_entry(sighting_batch_t *batch, const device_entry_t *entry) {
+    batch->count++;
+    if (entry->last_seen_us > batch->newest_us) {
+        batch->newest_us = entry->last_seen_us;
+    }
+}
+
+bool sighting_batch_add(sighting_batch_t *batch, const device_entry_t *entry) {
+    if (batch->format == SIGHTING_PAYLOAD_BINARY) {
+        if (!sighting_wire_writer_add(&batch->wire, entry->bda, entry->addr_type,
+                                      device_entry_rssi(entry), batch_epoch_us(batch, entry->last_seen_us),
+                                      entry->name, strlen(entry->name))) {
+            return false;
+        }
+        batch->length = batch->wire.length;
+        count_entry(batch, entry);
+        return true;
+    }
+
+    size_t separator = batch->count > 0 ? 2 : 0;
+    if (batch->length + separator + BATCH_TRAILER_LEN >= batch->capacity) {
+        return false;
+    }
+
+    char *out = batch->buffer + batch->length + separator;
+    size_t available = batch->capacity - batch->length - separator - BATCH_TRAILER_LEN;
+    size_t len = batch->format == SIGHTING_PAYLOAD_PRESENCE_JSON
+                     ? sighting_format_presence_json(NULL, entry, batch->timestamp_us, out, available)
+                     : format_device_json(entry, batch_epoch_us(batch, entry->last_seen_us), out, available);
+    if (len == 0) {
+        batch->buffer[batch->length] = '\0';
+        return false;
+    }
+
+    if (separator) {
+        memcpy(batch->buffer + batch->length, ", ", separator);
+    }
+    batch->length += separator + len;
+    count_entry(batch, entry);
+    return true;
+}
+
+size_t sighting_batch_finish(sighting_batch_t *batch) {
+    if (batch->format == SIGHTING_PAYLOAD_BINARY) {
+        batch->length = sighting_wire_writer_finish(&batch->wire);
+        return batch->length;
+    }
+
+    memcpy(batch->buffer + batch->length, "]}", BATCH_TRAILER_LEN + 1);
+    batch->length += BATCH_TRAILER_LEN;
+    return batch->length;
+}
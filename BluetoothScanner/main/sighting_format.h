@@ -0,0 +1,60 @@
+#ifndef MAIN_SIGHTING_FORMAT_H_
+#define MAIN_SIGHTING_FORMAT_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "device_table.h"
+#include "sighting_wire.h"
+
+// Formatowanie wyników skanowania publikowanych na /<board_name>/devices (JSON)
+// albo /<board_name>/devices/bin (sighting_wire.h). Znaczniki czasu przekazywane
+// jako esp_timer_get_time są publikowane jako czas UNIX (time_sync.h).
+
+#define SIGHTING_ADDRESS_STR_LEN 18
+
+typedef enum {
+    SIGHTING_PAYLOAD_JSON = 0,
+    SIGHTING_PAYLOAD_BINARY,
+    SIGHTING_PAYLOAD_PRESENCE_JSON, // Urządzenia obecne (presence.h) - heartbeat na /<board_name>/presence
+} sighting_payload_format_t;
+
+typedef struct {
+    sighting_payload_format_t format;
+    char *buffer;
+    size_t capacity;
+    size_t length;
+    uint32_t count;
+    int64_t timestamp_us;
+    int64_t newest_us; // Najpóźniejsze last_seen_us dodanych wpisów
+    bool epoch;        // Czasy wpisów są już czasem UNIX (sighting_batch_begin_epoch)
+    sighting_wire_writer_t wire;
+} sighting_batch_t;
+
+void sighting_format_address(const uint8_t *bda, char *address);
+
+// Zwraca długość wiadomości albo 0, gdy nie mieści się w buforze
+size_t sighting_format_device_json(const device_entry_t *entry, char *buffer, size_t capacity);
+
+// Przejście obecności ("enter"/"leave"); event == NULL daje wpis heartbeatu bez
+// pól event i timestamp_us. present_ms liczony od wejścia do now_us.
+size_t sighting_format_presence_json(const char *event, const device_entry_t *entry, int64_t now_us,
+                                     char *buffer, size_t capacity);
+
+// base_timestamp_us to początek okna: nagłówek formatu binarnego, "timestamp_ms" w JSON
+void sighting_batch_begin(sighting_batch_t *batch, sighting_payload_format_t format, char *buffer,
+                          size_t capacity, const char *board_name, int64_t base_timestamp_us);
+
+// Jak sighting_batch_begin, ale base_timestamp_us i czasy dodawanych wpisów są już
+// czasem UNIX i nie są przeliczane (rekordy odtwarzane z sighting_log)
+void sighting_batch_begin_epoch(sighting_batch_t *batch, sighting_payload_format_t format, char *buffer,
+                                size_t capacity, const char *board_name, int64_t base_timestamp_us);
+
+// Zwraca false, gdy wpis nie mieści się w buforze - należy wtedy wysłać paczkę i zacząć nową
+bool sighting_batch_add(sighting_batch_t *batch, const device_entry_t *entry);
+
+// Zamyka paczkę i zwraca długość gotowej wiadomości
+size_t sighting_batch_finish(sighting_batch_t *batch);
+
+#endif
@@ -0,0 +1,421 @@
+#include "sighting_log.h"
+
+#include <string.h>
+
+#define RECORD_MAX_LEN (SIGHTING_LOG_RECORD_HEADER_LEN + SIGHTING_LOG_RECORD_FIXED_LEN + SIGHTING_NAME_MAX_LEN)
+#define LENGTH_ERASED 0xFF
+
+typedef struct {
+    uint32_t sector;
+    uint32_t offset;
+} log_position_t;
+
+static sighting_log_flash_t flash;
+static bool initialized = false;
+
+static uint32_t sector_count = 0;
+static uint32_t next_sequence = 1;
+
+// Sektor i przesunięcie, pod które trafi następny rekord.
+// head_formatted == false: pierścień jest pusty i sektor head nie ma jeszcze nagłówka.
+static log_position_t head;
+static bool head_formatted = false;
+
+// Pozycja najstarszego niewysłanego rekordu (albo head, gdy nic nie czeka)
+static log_position_t cursor;
+
+// Pozycje rekordów zwróconych przez ostatni peek i pozycja za ostatnim z nich
+static log_position_t peeked[SIGHTING_LOG_PEEK_MAX];
+static log_position_t peeked_next[SIGHTING_LOG_PEEK_MAX];
+static size_t peeked_count = 0;
+
+static sighting_log_stats_t stats;
+
+static uint8_t crc8(const uint8_t *data, size_t length) {
+    uint8_t crc = 0;
+    for (size_t i = 0; i < length; i++) {
+        crc ^= data[i];
+        for (int bit = 0; bit < 8; bit++) {
+            crc = (crc & 0x80) ? (uint8_t)((crc << 1) ^ 0x07) : (uint8_t)(crc << 1);
+        }
+    }
+    return crc;
+}
+
+static void put_u16(uint8_t *out, uint16_t value) {
+    out[0] = (uint8_t)value;
+    out[1] = (uint8_t)(value >> 8);
+}
+
+static uint16_t get_u16(const uint8_t *in) {
+    return (uint16_t)(in[0] | (in[1] << 8));
+}
+
+static void put_u32(uint8_t *out, uint32_t value) {
+    for (int i = 0; i < 4; i++) {
+        out[i] = (uint8_t)(value >> (8 * i));
+    }
+}
+
+static uint32_t get_u32(const uint8_t *in) {
+    uint32_t value = 0;
+    for (int i = 0; i < 4; i++) {
+        value |= (uint32_t)in[i] << (8 * i);
+    }
+    return value;
+}
+
+static size_t sector_address(uint32_t sector) {
+    return (size_t)sector * SIGHTING_LOG_SECTOR_SIZE;
+}
+
+static uint32_t next_sector(uint32_t sector) {
+    return (sector + 1) % sector_count;
+}
+
+static bool positions_equal(log_position_t a, log_position_t b) {
+    return a.sector == b.sector && a.offset == b.offset;
+}
+
+// Zwraca sekwencję sektora albo 0, gdy sektor nie jest sformatowany
+static uint32_t read_sector_sequence(uint32_t sector) {
+    uint8_t header[SIGHTING_LOG_SECTOR_HEADER_LEN];
+    if (!flash.read(flash.ctx, sector_address(sector), header, sizeof(header)) ||
+        get_u32(header) != SIGHTING_LOG_MAGIC) {
+        return 0;
+    }
+    return get_u32(header + 4);
+}
+
+static bool format_sector(uint32_t sector) {
+    stats.sector_erases++;
+    if (!flash.erase_sector(flash.ctx, sector_address(sector))) {
+        return false;
+    }
+    uint8_t header[SIGHTING_LOG_SECTOR_HEADER_LEN];
+    put_u32(header, SIGHTING_LOG_MAGIC);
+    put_u32(header + 4, next_sequence++);
+    return flash.write(flash.ctx, sector_address(sector), header, sizeof(header));
+}
+
+typedef enum {
+    RECORD_END = 0,  // Koniec danych w sektorze
+    RECORD_OK,
+    RECORD_CORRUPTED,
+} record_status_t;
+
+// Czyta rekord spod position. Dla RECORD_OK i RECORD_CORRUPTED ustawia *size na
+// długość rekordu razem z nagłówkiem.
+static record_status_t read_record(log_position_t position, uint8_t *raw, size_t *size) {
+    if (position.offset + SIGHTING_LOG_RECORD_HEADER_LEN > SIGHTING_LOG_SECTOR_SIZE) {
+        return RECORD_END;
+    }
+    size_t address = sector_address(position.sector) + position.offset;
+    if (!flash.read(flash.ctx, address, raw, SIGHTING_LOG_RECORD_HEADER_LEN)) {
+        return RECORD_END;
+    }
+
+    uint8_t length = raw[0];
+    if (length == LENGTH_ERASED ||
+        position.offset + SIGHTING_LOG_RECORD_HEADER_LEN + length > SIGHTING_LOG_SECTOR_SIZE) {
+        return RECORD_END;
+    }
+
+    *size = SIGHTING_LOG_RECORD_HEADER_LEN + length;
+    if (length < SIGHTING_LOG_RECORD_FIXED_LEN || length > RECORD_MAX_LEN - SIGHTING_LOG_RECORD_HEADER_LEN ||
+        !flash.read(flash.ctx, address + SIGHTING_LOG_RECORD_HEADER_LEN,
+                    raw + SIGHTING_LOG_RECORD_HEADER_LEN, length) ||
+        crc8(raw + SIGHTING_LOG_RECORD_HEADER_LEN, length) != raw[2]) {
+        return RECORD_CORRUPTED;
+    }
+    return RECORD_OK;
+}
+
+static size_t encode_record(const sighting_log_record_t *record, uint8_t *raw) {
+    uint8_t name_len = record->name_len < SIGHTING_NAME_MAX_LEN ? record->name_len : SIGHTING_NAME_MAX_LEN - 1;
+    uint8_t *out = raw + SIGHTING_LOG_RECORD_HEADER_LEN;
+
+    uint64_t window = (uint64_t)record->window_start_us;
+    for (int i = 0; i < 8; i++) {
+        out[i] = (uint8_t)(window >> (8 * i));
+    }
+    int64_t delta_ms = (record->last_seen_us - record->window_start_us) / 1000;
+    put_u16(out + 8, delta_ms < 0 ? 0 : (delta_ms > 0xFFFF ? 0xFFFF : (uint16_t)delta_ms));
+    memcpy(out + 10, record->bda, SIGHTING_BDA_LEN);
+    out[16] = record->addr_type;
+    out[17] = (uint8_t)record->rssi;
+    out[18] = (uint8_t)record->rssi_min;
+    out[19] = (uint8_t)record->rssi_max;
+    put_u16(out + 20, record->count);
+    out[22] = record->flags;
+    put_u16(out + 23, record->boot_id);
+    out[25] = name_len;
+    memcpy(out + SIGHTING_LOG_RECORD_FIXED_LEN, record->name, name_len);
+
+    uint8_t length = SIGHTING_LOG_RECORD_FIXED_LEN + name_len;
+    raw[0] = length;
+    raw[1] = SIGHTING_LOG_STATE_PENDING;
+    raw[2] = crc8(out, length);
+    return SIGHTING_LOG_RECORD_HEADER_LEN + length;
+}
+
+static void decode_record(const uint8_t *raw, sighting_log_record_t *record) {
+    const uint8_t *in = raw + SIGHTING_LOG_RECORD_HEADER_LEN;
+
+    uint64_t window = 0;
+    for (int i = 0; i < 8; i++) {
+        window |= (uint64_t)in[i] << (8 * i);
+    }
+    record->window_start_us = (int64_t)window;
+    record->last_seen_us = record->window_start_us + (int64_t)get_u16(in + 8) * 1000;
+    memcpy(record->bda, in + 10, SIGHTING_BDA_LEN);
+    record->addr_type = in[16];
+    record->rssi = (int8_t)in[17];
+    record->rssi_min = (int8_t)in[18];
+    record->rssi_max = (int8_t)in[19];
+    record->count = get_u16(in + 20);
+    record->flags = in[22];
+    record->boot_id = get_u16(in + 23);
+
+    uint8_t name_len = in[25];
+    if (name_len > raw[0] - SIGHTING_LOG_RECORD_FIXED_LEN) {
+        name_len = raw[0] - SIGHTING_LOG_RECORD_FIXED_LEN;
+    }
+    if (name_len >= SIGHTING_NAME_MAX_LEN) {
+        name_len = SIGHTING_NAME_MAX_LEN - 1;
+    }
+    memcpy(record->name, in + SIGHTING_LOG_RECORD_FIXED_LEN, name_len);
+    record->name[name_len] = '\0';
+    record->name_len = name_len;
+}
+
+// Przechodzi od position do pierwszego niewysłanego rekordu, nie dalej niż head.
+// Zwraca false, gdy takiego rekordu nie ma (position == head).
+static bool seek_pending(log_position_t *position, uint8_t *raw, size_t *size) {
+    while (!positions_equal(*position, head)) {
+        record_status_t status = read_record(*position, raw, size);
+        if (status == RECORD_END) {
+            if (position->sector == head.sector) {
+                // Koniec danych w sektorze head przed zapisaną pozycją - nie powinno się zdarzyć
+                *position = head;
+                return false;
+            }
+            position->sector = next_sector(position->sector);
+            position->offset = SIGHTING_LOG_SECTOR_HEADER_LEN;
+            continue;
+        }
+        if (status == RECORD_OK && raw[1] == SIGHTING_LOG_STATE_PENDING) {
+            return true;
+        }
+        position->offset += (uint32_t)*size;
+    }
+    return false;
+}
+
+// Liczy niewysłane (i opcjonalnie uszkodzone) rekordy w sektorze od podanego przesunięcia
+static uint32_t count_pending_in_sector(uint32_t sector, uint32_t offset, uint32_t *corrupted) {
+    uint8_t raw[RECORD_MAX_LEN];
+    size_t size;
+    uint32_t pending = 0;
+    log_position_t position = {sector, offset};
+
+    record_status_t status;
+    while ((status = read_record(position, raw, &size)) != RECORD_END) {
+        if (status == RECORD_OK && raw[1] == SIGHTING_LOG_STATE_PENDING) {
+            pending++;
+        } else if (status == RECORD_CORRUPTED && corrupted) {
+            (*corrupted)++;
+        }
+        position.offset += (uint32_t)size;
+    }
+    return pending;
+}
+
+bool sighting_log_init(const sighting_log_flash_t *flash_ops, uint32_t max_sectors) {
+    flash = *flash_ops;
+    sector_count = (uint32_t)(flash.size / SIGHTING_LOG_SECTOR_SIZE);
+    if (max_sectors > 0 && max_sectors < sector_count) {
+        sector_count = max_sectors;
+    }
+    memset(&stats, 0, sizeof(stats));
+    peeked_count = 0;
+    initialized = false;
+    if (sector_count < 2) {
+        return false;
+    }
+    stats.sectors = sector_count;
+
+    // Najstarszy i najnowszy sformatowany sektor
+    uint32_t oldest = 0, newest = 0;
+    uint32_t oldest_sequence = UINT32_MAX, newest_sequence = 0;
+    for (uint32_t sector = 0; sector < sector_count; sector++) {
+        uint32_t sequence = read_sector_sequence(sector);
+        if (sequence == 0) {
+            continue;
+        }
+        if (sequence < oldest_sequence) {
+            oldest_sequence = sequence;
+            oldest = sector;
+        }
+        if (sequence > newest_sequence) {
+            newest_sequence = sequence;
+            newest = sector;
+        }
+    }
+
+    initialized = true;
+    if (newest_sequence == 0) {
+        head.sector = 0;
+        head.offset = SIGHTING_LOG_SECTOR_HEADER_LEN;
+        head_formatted = false;
+        cursor = head;
+        return true;
+    }
+    next_sequence = newest_sequence + 1;
+
+    // Koniec danych w najnowszym sektorze; uszkodzone rekordy są pomijane
+    uint8_t raw[RECORD_MAX_LEN];
+    size_t size;
+    head.sector = newest;
+    head.offset = SIGHTING_LOG_SECTOR_HEADER_LEN;
+    head_formatted = true;
+    record_status_t status;
+    while ((status = read_record(head, raw, &size)) != RECORD_END) {
+        head.offset += (uint32_t)size;
+    }
+
+    // Pierścień od najstarszego do najnowszego sektora
+    uint32_t sector = oldest;
+    while (1) {
+        if (read_sector_sequence(sector) != 0) {
+            stats.pending += count_pending_in_sector(sector, SIGHTING_LOG_SECTOR_HEADER_LEN, &stats.corrupted);
+        }
+        if (sector == newest) {
+            break;
+        }
+        sector = next_sector(sector);
+    }
+
+    cursor.sector = oldest;
+    cursor.offset = SIGHTING_LOG_SECTOR_HEADER_LEN;
+    if (!seek_pending(&cursor, raw, &size)) {
+        cursor = head;
+    }
+    return true;
+}
+
+// Przechodzi do następnego sektora, kasując najstarsze dane, jeśli pierścień jest pełny
+static bool advance_head(void) {
+    uint32_t sector = next_sector(head.sector);
+
+    if (cursor.sector == sector && !positions_equal(cursor, head)) {
+        uint32_t dropped = count_pending_in_sector(sector, cursor.offset, NULL);
+        stats.dropped_oldest += dropped;
+        stats.pending -= dropped;
+
+        // Najstarszy niewysłany rekord jest teraz w kolejnym sektorze
+        cursor.sector = next_sector(sector);
+        cursor.offset = SIGHTING_LOG_SECTOR_HEADER_LEN;
+        if (stats.pending == 0) {
+            cursor = head;
+        }
+    }
+    peeked_count = 0;
+
+    bool cursor_at_head = positions_equal(cursor, head);
+    if (!format_sector(sector)) {
+        return false;
+    }
+    head.sector = sector;
+    head.offset = SIGHTING_LOG_SECTOR_HEADER_LEN;
+    if (cursor_at_head) {
+        cursor = head;
+    }
+    return true;
+}
+
+bool sighting_log_append(const sighting_log_record_t *record) {
+    if (!initialized) {
+        return false;
+    }
+
+    uint8_t raw[RECORD_MAX_LEN];
+    size_t size = encode_record(record, raw);
+
+    if (!head_formatted) {
+        if (!format_sector(head.sector)) {
+            stats.write_errors++;
+            return false;
+        }
+        head_formatted = true;
+    }
+    if (head.offset + size > SIGHTING_LOG_SECTOR_SIZE && !advance_head()) {
+        stats.write_errors++;
+        return false;
+    }
+
+    if (!flash.write(flash.ctx, sector_address(head.sector) + head.offset, raw, size)) {
+        stats.write_errors++;
+        return false;
+    }
+    head.offset += (uint32_t)size;
+    stats.appended++;
+    stats.pending++;
+    return true;
+}
+
+size_t sighting_log_peek(sighting_log_record_t *records, size_t max_records) {
+    uint8_t raw[RECORD_MAX_LEN];
+    size_t size;
+    log_position_t position = cursor;
+
+    if (max_records > SIGHTING_LOG_PEEK_MAX) {
+        max_records = SIGHTING_LOG_PEEK_MAX;
+    }
+
+    peeked_count = 0;
+    while (initialized && peeked_count < max_records && seek_pending(&position, raw, &size)) {
+        decode_record(raw, &records[peeked_count]);
+        peeked[peeked_count] = position;
+        position.offset += (uint32_t)size;
+        peeked_next[peeked_count] = position;
+        peeked_count++;
+    }
+    return peeked_count;
+}
+
+void sighting_log_consume(size_t count) {
+    if (count > peeked_count) {
+        count = peeked_count;
+    }
+    if (count == 0) {
+        return;
+    }
+
+    static const uint8_t sent = SIGHTING_LOG_STATE_SENT;
+    for (size_t i = 0; i < count; i++) {
+        size_t address = sector_address(peeked[i].sector) + peeked[i].offset + 1;
+        if (!flash.write(flash.ctx, address, &sent, 1)) {
+            stats.write_errors++;
+        }
+    }
+
+    stats.replayed += (uint32_t)count;
+    stats.pending -= (uint32_t)count;
+
+    cursor = peeked_next[count - 1];
+    uint8_t raw[RECORD_MAX_LEN];
+    size_t size;
+    if (!seek_pending(&cursor, raw, &size)) {
+        cursor = head;
+    }
+    peeked_count = 0;
+}
+
+bool sighting_log_empty(void) {
+    return stats.pending == 0;
+}
+
+void sighting_log_get_stats(sighting_log_stats_t *out) {
+    *out = stats;
+}
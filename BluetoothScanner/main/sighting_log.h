@@ -0,0 +1,111 @@
+#ifndef MAIN_SIGHTING_LOG_H_
+#define MAIN_SIGHTING_LOG_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "sighting.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Dziennik obserwacji w pamięci flash, zapisywany gdy MQTT jest rozłączony
+// i odtwarzany po ponownym połączeniu. Moduł nie zależy od ESP-IDF - dostęp do
+// flash jest wstrzykiwany (partycja na płytce, plik w host/sighting_log_dump).
+//
+// Obszar jest pierścieniem sektorów po SIGHTING_LOG_SECTOR_SIZE bajtów, każdy
+// sektor jest kasowany raz na obieg. Nagłówek sektora (8 bajtów):
+//   u32 magic           SIGHTING_LOG_MAGIC
+//   u32 sequence        rośnie z każdym sformatowanym sektorem
+// a po nim rekordy do pierwszego bajtu 0xFF:
+//   u8  length          długość danych rekordu
+//   u8  state           0xFF - czeka na wysłanie, 0x00 - wysłany
+//   u8  crc             CRC-8 (0x07) danych rekordu
+//   i64 window_start_us początek okna skanowania
+//   u16 last_seen_delta_ms  czas od window_start_us, nasycany do 0xFFFF
+//   u8  bda[6]
+//   u8  addr_type
+//   i8  rssi, rssi_min, rssi_max
+//   u16 count           liczba obserwacji w oknie, nasycana do 0xFFFF
+//   u8  flags           SIGHTING_LOG_FLAG_EPOCH - czasy są już czasem UNIX
+//   u16 boot_id         uruchomienie, w którym zapisano rekord bez synchronizacji czasu
+//   u8  name_len
+//   u8  name[name_len]
+// Wszystkie pola wielobajtowe są little-endian. Gdy pierścień jest pełny,
+// najstarszy sektor jest kasowany razem z niewysłanymi rekordami.
+
+#define SIGHTING_LOG_SECTOR_SIZE 4096
+#define SIGHTING_LOG_MAGIC 0x32474C53 // "SLG2"; sektory "SLG1" są traktowane jak puste
+#define SIGHTING_LOG_SECTOR_HEADER_LEN 8
+#define SIGHTING_LOG_RECORD_HEADER_LEN 3
+#define SIGHTING_LOG_RECORD_FIXED_LEN 26
+#define SIGHTING_LOG_STATE_PENDING 0xFF
+#define SIGHTING_LOG_STATE_SENT 0x00
+#define SIGHTING_LOG_FLAG_EPOCH 0x01
+
+// Maksymalna liczba rekordów zwracanych przez jedno sighting_log_peek
+#define SIGHTING_LOG_PEEK_MAX 32
+
+typedef struct {
+    void *ctx;
+    size_t size; // Rozmiar obszaru w bajtach
+    bool (*read)(void *ctx, size_t offset, void *data, size_t length);
+    bool (*write)(void *ctx, size_t offset, const void *data, size_t length);
+    bool (*erase_sector)(void *ctx, size_t offset);
+} sighting_log_flash_t;
+
+// Rekord przeżywa restart, a czas od startu z poprzedniego uruchomienia nie daje się
+// już zamienić na czas UNIX. Po synchronizacji zapisywany jest więc czas UNIX
+// (SIGHTING_LOG_FLAG_EPOCH), a przed nią czas od startu razem z boot_id.
+typedef struct {
+    int64_t window_start_us;
+    int64_t last_seen_us;
+    uint8_t flags;
+    uint16_t boot_id;
+    uint8_t bda[SIGHTING_BDA_LEN];
+    uint8_t addr_type;
+    int8_t rssi;
+    int8_t rssi_min;
+    int8_t rssi_max;
+    uint16_t count;
+    uint8_t name_len;
+    char name[SIGHTING_NAME_MAX_LEN];
+} sighting_log_record_t;
+
+typedef struct {
+    uint32_t sectors;        // Rozmiar pierścienia
+    uint32_t pending;        // Rekordy czekające na wysłanie
+    uint32_t appended;
+    uint32_t replayed;
+    uint32_t dropped_oldest; // Niewysłane rekordy skasowane przy zawinięciu pierścienia
+    uint32_t corrupted;      // Rekordy z błędnym CRC (np. przerwany zapis)
+    uint32_t write_errors;
+    uint32_t sector_erases;
+} sighting_log_stats_t;
+
+// Odtwarza stan z zawartości flash. max_sectors ogranicza używaną część obszaru
+// (0 - cały obszar). Zwraca false, gdy obszar ma mniej niż dwa sektory.
+bool sighting_log_init(const sighting_log_flash_t *flash, uint32_t max_sectors);
+
+bool sighting_log_append(const sighting_log_record_t *record);
+
+// Czyta do max_records najstarszych niewysłanych rekordów bez zdejmowania ich z dziennika
+size_t sighting_log_peek(sighting_log_record_t *records, size_t max_records);
+
+// Oznacza jako wysłane count pierwszych rekordów z ostatniego sighting_log_peek
+void sighting_log_consume(size_t count);
+
+bool sighting_log_empty(void);
+
+void sighting_log_get_stats(sighting_log_stats_t *stats);
+
+// Tylko na płytce (sighting_log_partition.c): sighting_log_init na partycji danych o podanej etykiecie
+bool sighting_log_init_partition(const char *label, uint32_t max_sectors);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,46 @@
+#include "sighting_log.h"
+
+#include <inttypes.h>
+
+#include "esp_log.h"
+#include "esp_partition.h"
+#include "tags.h"
+
+static bool partition_read(void *ctx, size_t offset, void *data, size_t length) {
+    return esp_partition_read((const esp_partition_t *)ctx, offset, data, length) == ESP_OK;
+}
+
+static bool partition_write(void *ctx, size_t offset, const void *data, size_t length) {
+    return esp_partition_write((const esp_partition_t *)ctx, offset, data, length) == ESP_OK;
+}
+
+static bool partition_erase_sector(void *ctx, size_t offset) {
+    return esp_partition_erase_range((const esp_partition_t *)ctx, offset, SIGHTING_LOG_SECTOR_SIZE) == ESP_OK;
+}
+
+bool sighting_log_init_partition(const char *label, uint32_t max_sectors) {
+    const esp_partition_t *partition = esp_partition_find_first(ESP_PARTITION_TYPE_DATA,
+                                                                ESP_PARTITION_SUBTYPE_ANY, label);
+    if (!partition) {
+        ESP_LOGW(MAIN_TAG, "No '%s' partition, sightings are dropped while MQTT is down", label);
+        return false;
+    }
+
+    sighting_log_flash_t flash = {
+        .ctx = (void *)partition,
+        .size = partition->size,
+        .read = partition_read,
+        .write = partition_write,
+        .erase_sector = partition_erase_sector,
+    };
+    if (!sighting_log_init(&flash, max_sectors)) {
+        ESP_LOGW(MAIN_TAG, "Partition '%s' is too small for the sighting log", label);
+        return false;
+    }
+
+    sighting_log_stats_t stats;
+    sighting_log_get_stats(&stats);
+    ESP_LOGI(MAIN_TAG, "Sighting log: %" PRIu32 " sectors, %" PRIu32 " records pending",
+             stats.sectors, stats.pending);
+    return true;
+}
@@ -0,0 +1,456 @@
+#include "sighting_publisher.h"
+
+#include <inttypes.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "esp_log.h"
+#include "tags.h"
+#include "device_table.h"
+#include "sighting_format.h"
+#include "sighting_log.h"
+#include "perf_counters.h"
+#include "presence.h"
+#include "time_sync.h"
+
+#if CONFIG_SIGHTING_WIRE_FORMAT_BINARY
+#define DEVICES_TOPIC_FORMAT "/%s/devices/bin"
+#define REPLAY_TOPIC_FORMAT "/%s/devices/bin/replay"
+#define DEVICES_PAYLOAD_FORMAT SIGHTING_PAYLOAD_BINARY
+#else
+#define DEVICES_TOPIC_FORMAT "/%s/devices"
+#define REPLAY_TOPIC_FORMAT "/%s/devices/replay"
+#define DEVICES_PAYLOAD_FORMAT SIGHTING_PAYLOAD_JSON
+#endif
+
+#define REPLAY_BUFFER_SIZE 2048
+
+static const char *publisher_board_name = "";
+static char devices_topic[50];
+static char replay_topic[60];
+static sighting_publish_callback publish_callback = NULL;
+static uint16_t publisher_boot_id = 0;
+
+// Ustawiany z handlera zdarzeń MQTT, czytany przez task publikujący
+static atomic_bool connected = false;
+
+// Początek bieżącego okna - czas bazowy dla formatu binarnego
+static int64_t window_start_us = 0;
+
+static bool publish_devices_message(const char *message, size_t length, uint32_t devices, int64_t capture_us) {
+    if (!publish_callback(devices_topic, message, length, capture_us)) {
+        return false;
+    }
+    perf_count(PERF_MESSAGES_PUBLISHED);
+    perf_add(PERF_DEVICES_PUBLISHED, devices);
+    ESP_LOGI(GATTS_TAG, "Published %u bytes to topic '%s'", (unsigned)length, devices_topic);
+    return true;
+}
+
+#if CONFIG_SIGHTING_LOG
+
+static char replay_buffer[REPLAY_BUFFER_SIZE];
+static sighting_log_record_t replay_records[CONFIG_SIGHTING_LOG_REPLAY_BATCH];
+static int64_t last_replay_us = 0;
+
+// Zapisuje wynik okna dla urządzenia w dzienniku flash. Po synchronizacji czasu
+// rekord dostaje od razu czas UNIX, bo dziennik przeżywa restart.
+static void log_device_entry(const device_entry_t *entry, void *ctx) {
+    bool synced = time_sync_synced();
+    sighting_log_record_t record = {
+        .window_start_us = synced ? time_sync_epoch_us(window_start_us) : window_start_us,
+        .last_seen_us = synced ? time_sync_epoch_us(entry->last_seen_us) : entry->last_seen_us,
+        .flags = synced ? SIGHTING_LOG_FLAG_EPOCH : 0,
+        .boot_id = publisher_boot_id,
+        .addr_type = entry->addr_type,
+        .rssi = device_entry_rssi(entry),
+        .rssi_min = entry->rssi_min,
+        .rssi_max = entry->rssi_max,
+        .count = entry->count > UINT16_MAX ? UINT16_MAX : (uint16_t)entry->count,
+        .name_len = (uint8_t)strlen(entry->name),
+    };
+    memcpy(record.bda, entry->bda, sizeof(record.bda));
+    memcpy(record.name, entry->name, record.name_len);
+    sighting_log_append(&record);
+}
+
+// Czas UNIX rekordu. Czas od startu z bieżącego uruchomienia da się jeszcze przeliczyć;
+// z poprzedniego zostaje bez zmian - odbiorca rozpozna go po wartości (time_sync.h).
+static int64_t record_epoch_us(const sighting_log_record_t *record, int64_t timestamp_us) {
+    if ((record->flags & SIGHTING_LOG_FLAG_EPOCH) || record->boot_id != publisher_boot_id) {
+        return timestamp_us;
+    }
+    return time_sync_epoch_us(timestamp_us);
+}
+
+static void record_to_entry(const sighting_log_record_t *record, device_entry_t *entry) {
+    memset(entry, 0, sizeof(*entry));
+    entry->used = true;
+    memcpy(entry->bda, record->bda, sizeof(entry->bda));
+    entry->addr_type = record->addr_type;
+    memcpy(entry->name, record->name, record->name_len + 1);
+    entry->first_seen_us = record_epoch_us(record, record->window_start_us);
+    entry->last_seen_us = record_epoch_us(record, record->last_seen_us);
+    entry->count = record->count;
+    entry->rssi_min = record->rssi_min;
+    entry->rssi_max = record->rssi_max;
+    entry->rssi_sum = (int32_t)record->rssi * record->count;
+    rssi_filter_seed(&entry->rssi_filter, record->rssi);
+}
+
+// Wysyła jedną paczkę zaległych rekordów nie częściej niż co
+// CONFIG_SIGHTING_LOG_REPLAY_INTERVAL_MS, żeby nie blokować bieżących wyników.
+// Paczka zawiera rekordy jednego okna, więc czas bazowy pozostaje poprawny; czasy są
+// brane z rekordów, a nie z przesunięcia zegara w bieżącym uruchomieniu.
+static void replay_log(int64_t now_us) {
+    if (!atomic_load(&connected) || sighting_log_empty() ||
+        now_us - last_replay_us < (int64_t)CONFIG_SIGHTING_LOG_REPLAY_INTERVAL_MS * 1000) {
+        return;
+    }
+    last_replay_us = now_us;
+
+    size_t available = sighting_log_peek(replay_records, CONFIG_SIGHTING_LOG_REPLAY_BATCH);
+    if (available == 0) {
+        return;
+    }
+
+    int64_t window = record_epoch_us(&replay_records[0], replay_records[0].window_start_us);
+    sighting_batch_t replay;
+    sighting_batch_begin_epoch(&replay, DEVICES_PAYLOAD_FORMAT, replay_buffer, sizeof(replay_buffer),
+                               publisher_board_name, window);
+
+    size_t count = 0;
+    device_entry_t entry;
+    while (count < available &&
+           record_epoch_us(&replay_records[count], replay_records[count].window_start_us) == window) {
+        record_to_entry(&replay_records[count], &entry);
+        if (!sighting_batch_add(&replay, &entry)) {
+            break;
+        }
+        count++;
+    }
+
+    if (count == 0) {
+        ESP_LOGW(GATTS_TAG, "Logged sighting does not fit in a replay message, dropped");
+        perf_count(PERF_DEVICES_DROPPED);
+        sighting_log_consume(1);
+        return;
+    }
+
+    size_t length = sighting_batch_finish(&replay);
+    if (publish_callback(replay_topic, replay_buffer, length, 0)) {
+        perf_count(PERF_MESSAGES_PUBLISHED);
+        perf_add(PERF_DEVICES_PUBLISHED, (uint32_t)count);
+        sighting_log_consume(count);
+    }
+}
+
+#endif
+
+#if !CONFIG_SIGHTING_PUBLISH_MODE_PRESENCE
+
+// Bez połączenia z brokerem wyniki okna trafiają do dziennika zamiast do transportu
+static bool store_offline_window(void) {
+#if CONFIG_SIGHTING_LOG
+    if (!atomic_load(&connected)) {
+        device_table_foreach_in_window(log_device_entry, NULL);
+        return true;
+    }
+#endif
+    return false;
+}
+
+static bool store_offline_entry(const device_entry_t *entry) {
+#if CONFIG_SIGHTING_LOG
+    if (!atomic_load(&connected)) {
+        log_device_entry(entry, NULL);
+        return true;
+    }
+#endif
+    return false;
+}
+
+#endif
+
+#if CONFIG_SIGHTING_PUBLISH_MODE_BATCH
+
+static char batch_buffer[CONFIG_SIGHTING_BATCH_BUFFER_SIZE];
+static sighting_batch_t batch;
+// Wpisy w bieżącej paczce - przy nieudanej publikacji trafiają do dziennika. Tablica
+// urządzeń nie zmienia się w trakcie device_table_foreach_in_window.
+static const device_entry_t *batch_entries[CONFIG_SIGHTING_BATCH_MAX_DEVICES];
+
+static void begin_batch(void) {
+    sighting_batch_begin(&batch, DEVICES_PAYLOAD_FORMAT, batch_buffer, sizeof(batch_buffer),
+                         publisher_board_name, window_start_us);
+}
+
+static void flush_batch(void) {
+    if (batch.count > 0) {
+        size_t length = sighting_batch_finish(&batch);
+        if (!publish_devices_message(batch_buffer, length, batch.count, batch.newest_us)) {
+#if CONFIG_SIGHTING_LOG
+            ESP_LOGW(GATTS_TAG, "Publishing %" PRIu32 " devices failed, batch stored in the log", batch.count);
+            for (uint32_t i = 0; i < batch.count; i++) {
+                log_device_entry(batch_entries[i], NULL);
+            }
+#else
+            ESP_LOGW(GATTS_TAG, "Publishing %" PRIu32 " devices failed, batch dropped", batch.count);
+            perf_add(PERF_DEVICES_DROPPED, batch.count);
+#endif
+        }
+    }
+    begin_batch();
+}
+
+// Dodaje urządzenie do paczki, wysyłając ją wcześniej, gdy osiągnie limit
+static void batch_device_entry(const device_entry_t *entry, void *ctx) {
+    if (batch.count >= CONFIG_SIGHTING_BATCH_MAX_DEVICES || !sighting_batch_add(&batch, entry)) {
+        flush_batch();
+        if (!sighting_batch_add(&batch, entry)) {
+            ESP_LOGW(GATTS_TAG, "Device entry does not fit in an empty batch, dropped");
+            perf_count(PERF_DEVICES_DROPPED);
+            return;
+        }
+    }
+    batch_entries[batch.count - 1] = entry;
+}
+
+// Kopie wpisów usuniętych z tablicy w trakcie okna - dołączane do najbliższej paczki
+#define EVICTED_MAX 16
+static device_entry_t evicted_entries[EVICTED_MAX];
+static uint32_t evicted_count = 0;
+
+static void batch_evicted_entries(void) {
+    for (uint32_t i = 0; i < evicted_count; i++) {
+        batch_device_entry(&evicted_entries[i], NULL);
+    }
+}
+
+// Wywoływane przez device_table_update przed usunięciem wpisu
+static void on_device_evicted(const device_entry_t *entry, void *ctx) {
+    if (entry->count == 0 || store_offline_entry(entry)) {
+        return;
+    }
+    if (evicted_count == EVICTED_MAX) {
+        begin_batch();
+        batch_evicted_entries();
+        flush_batch();
+        evicted_count = 0;
+    }
+    evicted_entries[evicted_count++] = *entry;
+}
+
+void sighting_publisher_flush(int64_t now_us) {
+    if (!store_offline_window()) {
+        begin_batch();
+        batch_evicted_entries();
+        device_table_foreach_in_window(batch_device_entry, NULL);
+        flush_batch();
+    } else {
+#if CONFIG_SIGHTING_LOG
+        for (uint32_t i = 0; i < evicted_count; i++) {
+            log_device_entry(&evicted_entries[i], NULL);
+        }
+#endif
+    }
+    evicted_count = 0;
+    device_table_reset_window();
+    window_start_us = now_us;
+}
+
+void sighting_publisher_poll(int64_t now_us) {
+    // Nie trzymaj danych dłużej niż interwał, jeśli znacznik końca okna nie nadszedł
+    if (now_us - window_start_us >= (int64_t)CONFIG_SIGHTING_BATCH_FLUSH_INTERVAL_MS * 1000) {
+        sighting_publisher_flush(now_us);
+    }
+#if CONFIG_SIGHTING_LOG
+    replay_log(now_us);
+#endif
+}
+
+#elif CONFIG_SIGHTING_PUBLISH_MODE_PRESENCE
+
+#define PRESENCE_TOPIC_FORMAT "/%s/presence"
+#define PRESENCE_MESSAGE_SIZE 256
+#define HEARTBEAT_BUFFER_SIZE 2048
+
+static char presence_topic[50];
+static char heartbeat_buffer[HEARTBEAT_BUFFER_SIZE];
+static sighting_batch_t heartbeat;
+static uint32_t heartbeat_messages = 0;
+static int64_t last_heartbeat_us = 0;
+static bool was_connected = false;
+static int64_t update_us = 0; // Czas obserwacji przetwarzanej przez device_table_update
+
+static void publish_presence_message(const char *message, size_t length, uint32_t devices, int64_t capture_us) {
+    if (!publish_callback(presence_topic, message, length, capture_us)) {
+        perf_add(PERF_DEVICES_DROPPED, devices);
+        return;
+    }
+    perf_count(PERF_MESSAGES_PUBLISHED);
+    perf_add(PERF_DEVICES_PUBLISHED, devices);
+}
+
+// Wywoływane przez presence_update/presence_poll w wątku publikującym
+static void on_presence_transition(presence_event_t event, const device_entry_t *entry, int64_t now_us, void *ctx) {
+    char message[PRESENCE_MESSAGE_SIZE];
+    size_t length = sighting_format_presence_json(presence_event_name(event), entry, now_us, message, sizeof(message));
+    if (length == 0) {
+        perf_count(PERF_DEVICES_DROPPED);
+        return;
+    }
+    ESP_LOGI(GATTS_TAG, "Presence: %s", message);
+    // Wyjście po czasie nie wynika z żadnej świeżej obserwacji
+    publish_presence_message(message, length, 1, event == PRESENCE_EVENT_ENTER ? entry->last_seen_us : 0);
+}
+
+// Urządzenie obecne usunięte z pełnej tablicy wychodzi w chwili obserwacji, która je wyparła
+static void on_device_evicted(const device_entry_t *entry, void *ctx) {
+    presence_evict(entry, *(const int64_t *)ctx);
+}
+
+static void flush_heartbeat(void) {
+    size_t length = sighting_batch_finish(&heartbeat);
+    publish_presence_message(heartbeat_buffer, length, heartbeat.count, 0);
+    heartbeat_messages++;
+    sighting_batch_begin(&heartbeat, SIGHTING_PAYLOAD_PRESENCE_JSON, heartbeat_buffer, sizeof(heartbeat_buffer),
+                         publisher_board_name, heartbeat.timestamp_us);
+}
+
+static void heartbeat_device_entry(const device_entry_t *entry, void *ctx) {
+    if (!sighting_batch_add(&heartbeat, entry)) {
+        flush_heartbeat();
+        if (!sighting_batch_add(&heartbeat, entry)) {
+            perf_count(PERF_DEVICES_DROPPED);
+        }
+    }
+}
+
+// Lista obecnych urządzeń, także pusta - potwierdza, że płytka działa
+static void publish_heartbeat(int64_t now_us) {
+    last_heartbeat_us = now_us;
+    heartbeat_messages = 0;
+    sighting_batch_begin(&heartbeat, SIGHTING_PAYLOAD_PRESENCE_JSON, heartbeat_buffer, sizeof(heartbeat_buffer),
+                         publisher_board_name, now_us);
+    presence_foreach_present(heartbeat_device_entry, NULL);
+    if (heartbeat.count > 0 || heartbeat_messages == 0) {
+        flush_heartbeat();
+    }
+
+    presence_stats_t stats;
+    presence_get_stats(&stats);
+    ESP_LOGI(GATTS_TAG, "Presence heartbeat: %" PRIu32 " present, %" PRIu32 " enters, %" PRIu32 " leaves",
+             stats.present, stats.enters, stats.leaves);
+}
+
+void sighting_publisher_flush(int64_t now_us) {
+    // Publikowane są tylko przejścia - okno zeruje jedynie statystyki
+    device_table_reset_window();
+    window_start_us = now_us;
+}
+
+void sighting_publisher_poll(int64_t now_us) {
+    presence_poll(now_us);
+
+    // Po ponownym połączeniu heartbeat od razu odtwarza stan u odbiorców
+    bool is_connected = atomic_load(&connected);
+    bool reconnected = is_connected && !was_connected;
+    was_connected = is_connected;
+    if (reconnected || (CONFIG_PRESENCE_HEARTBEAT_INTERVAL_S > 0 &&
+                        now_us - last_heartbeat_us >= (int64_t)CONFIG_PRESENCE_HEARTBEAT_INTERVAL_S * 1000000)) {
+        publish_heartbeat(now_us);
+    }
+}
+
+#else
+
+// Publikuje zagregowane statystyki jednego urządzenia z zakończonego okna
+static void publish_device_entry(const device_entry_t *entry, void *ctx) {
+    char message[256];
+    size_t length;
+
+#if CONFIG_SIGHTING_WIRE_FORMAT_BINARY
+    sighting_batch_t single;
+    sighting_batch_begin(&single, SIGHTING_PAYLOAD_BINARY, message, sizeof(message),
+                         publisher_board_name, window_start_us);
+    sighting_batch_add(&single, entry);
+    length = sighting_batch_finish(&single);
+#else
+    length = sighting_format_device_json(entry, message, sizeof(message));
+    ESP_LOGI(GATTS_TAG, "Device discovered: %s", message);
+#endif
+
+    if (length > 0 && !publish_devices_message(message, length, 1, entry->last_seen_us)) {
+#if CONFIG_SIGHTING_LOG
+        log_device_entry(entry, NULL);
+#else
+        perf_count(PERF_DEVICES_DROPPED);
+#endif
+    }
+}
+
+// Wpis usuwany z tablicy w trakcie okna jest publikowany od razu, zanim zniknie
+static void on_device_evicted(const device_entry_t *entry, void *ctx) {
+    if (entry->count > 0 && !store_offline_entry(entry)) {
+        publish_device_entry(entry, NULL);
+    }
+}
+
+void sighting_publisher_flush(int64_t now_us) {
+    if (!store_offline_window()) {
+        device_table_foreach_in_window(publish_device_entry, NULL);
+    }
+    device_table_reset_window();
+    window_start_us = now_us;
+}
+
+void sighting_publisher_poll(int64_t now_us) {
+    // W trybie jednej wiadomości na urządzenie okno wyznacza tylko skaner
+#if CONFIG_SIGHTING_LOG
+    replay_log(now_us);
+#endif
+}
+
+#endif
+
+void sighting_publisher_init(const char *board_name, uint16_t boot_id, sighting_publish_callback publish) {
+    publisher_board_name = board_name;
+    publisher_boot_id = boot_id;
+    publish_callback = publish;
+    snprintf(devices_topic, sizeof(devices_topic), DEVICES_TOPIC_FORMAT, board_name);
+    snprintf(replay_topic, sizeof(replay_topic), REPLAY_TOPIC_FORMAT, board_name);
+
+#if CONFIG_SIGHTING_PUBLISH_MODE_PRESENCE
+    snprintf(presence_topic, sizeof(presence_topic), PRESENCE_TOPIC_FORMAT, board_name);
+    presence_config_t presence_config = {
+        .enter_rssi = CONFIG_PRESENCE_ENTER_RSSI,
+        .exit_rssi = CONFIG_PRESENCE_EXIT_RSSI,
+        .enter_dwell_ms = CONFIG_PRESENCE_ENTER_DWELL_MS,
+        .exit_dwell_ms = CONFIG_PRESENCE_EXIT_DWELL_MS,
+        .absence_timeout_ms = CONFIG_PRESENCE_ABSENCE_TIMEOUT_MS,
+    };
+    presence_init(&presence_config, on_presence_transition, NULL);
+    device_table_set_evict_callback(on_device_evicted, &update_us);
+#else
+    device_table_set_evict_callback(on_device_evicted, NULL);
+#endif
+}
+
+void sighting_publisher_set_connected(bool is_connected) {
+    atomic_store(&connected, is_connected);
+}
+
+void sighting_publisher_handle(const ble_sighting_t *sighting) {
+    if (sighting->kind == SIGHTING_KIND_WINDOW_END) {
+        sighting_publisher_flush(sighting->timestamp_us);
+    } else {
+#if CONFIG_SIGHTING_PUBLISH_MODE_PRESENCE
+        update_us = sighting->timestamp_us;
+        presence_update(device_table_update(sighting), sighting->rssi, sighting->timestamp_us);
+#else
+        device_table_update(sighting);
+#endif
+    }
+}
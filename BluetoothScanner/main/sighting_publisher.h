@@ -0,0 +1,41 @@
+#ifndef MAIN_SIGHTING_PUBLISHER_H_
+#define MAIN_SIGHTING_PUBLISHER_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "sdkconfig.h"
+#include "sighting.h"
+
+// Konsument kolejki obserwacji: agreguje je w tablicy urządzeń i publikuje
+// wyniki po każdym oknie skanowania. Transport (MQTT) jest wstrzykiwany,
+// dzięki czemu ten sam kod działa w host/scan_replay.
+
+// Zwraca false, gdy wiadomość nie została przekazana do wysłania. capture_us to czas
+// przechwycenia najświeższej obserwacji w wiadomości (esp_timer_get_time) albo 0 dla
+// wiadomości bez świeżych obserwacji - do pomiaru opóźnienia (latency_probe.h).
+typedef bool (*sighting_publish_callback)(const char *topic, const char *payload, size_t length,
+                                          int64_t capture_us);
+
+// boot_id odróżnia to uruchomienie od poprzednich w rekordach sighting_log zapisanych
+// przed synchronizacją czasu (na płytce losowy, np. z esp_random)
+void sighting_publisher_init(const char *board_name, uint16_t boot_id, sighting_publish_callback publish);
+
+// Stan połączenia z brokerem. Bez połączenia wyniki okien są zapisywane w
+// sighting_log (CONFIG_SIGHTING_LOG), a po połączeniu sighting_publisher_poll
+// wysyła je paczkami na /<board_name>/devices[/bin]/replay.
+void sighting_publisher_set_connected(bool connected);
+
+// Obsługuje rekord pobrany z kolejki (obserwację albo znacznik końca okna)
+void sighting_publisher_handle(const ble_sighting_t *sighting);
+
+// Publikuje urządzenia z bieżącego okna i zaczyna nowe okno
+void sighting_publisher_flush(int64_t now_us);
+
+// Wywoływane cyklicznie: w trybie paczek publikuje okno, jeśli znacznik końca
+// okna nie nadszedł w ciągu CONFIG_SIGHTING_BATCH_FLUSH_INTERVAL_MS; w trybie
+// obecności (presence.h) wykrywa wyjścia i wysyła heartbeat na /<board_name>/presence
+void sighting_publisher_poll(int64_t now_us);
+
+#endif
@@ -0,0 +1,67 @@
+#include "sighting_queue.h"
+
+#include <stdatomic.h>
+
+#if (SIGHTING_QUEUE_LENGTH & (SIGHTING_QUEUE_LENGTH - 1)) != 0
+#error "CONFIG_SIGHTING_QUEUE_LENGTH must be a power of two"
+#endif
+
+#define SIGHTING_QUEUE_MASK (SIGHTING_QUEUE_LENGTH - 1)
+
+static ble_sighting_t slots[SIGHTING_QUEUE_LENGTH];
+
+// head: zapisywany tylko przez producenta, tail: tylko przez konsumenta.
+// Liczniki rosną bez ograniczeń, indeks slotu to licznik & MASK.
+static atomic_uint_fast32_t head = 0;
+static atomic_uint_fast32_t tail = 0;
+
+// Statystyki producenta
+static atomic_uint_fast32_t pushed = 0;
+static atomic_uint_fast32_t overflows = 0;
+static atomic_uint_fast32_t high_watermark = 0;
+
+bool sighting_queue_push(const ble_sighting_t *sighting) {
+    uint32_t h = atomic_load_explicit(&head, memory_order_relaxed);
+    uint32_t t = atomic_load_explicit(&tail, memory_order_acquire);
+    uint32_t depth = h - t;
+
+    if (depth >= SIGHTING_QUEUE_LENGTH) {
+        atomic_fetch_add_explicit(&overflows, 1, memory_order_relaxed);
+        return false;
+    }
+
+    slots[h & SIGHTING_QUEUE_MASK] = *sighting;
+    atomic_store_explicit(&head, h + 1, memory_order_release);
+
+    atomic_fetch_add_explicit(&pushed, 1, memory_order_relaxed);
+    if (depth + 1 > atomic_load_explicit(&high_watermark, memory_order_relaxed)) {
+        atomic_store_explicit(&high_watermark, depth + 1, memory_order_relaxed);
+    }
+    return true;
+}
+
+bool sighting_queue_pop(ble_sighting_t *sighting) {
+    uint32_t t = atomic_load_explicit(&tail, memory_order_relaxed);
+    uint32_t h = atomic_load_explicit(&head, memory_order_acquire);
+
+    if (h == t) {
+        return false;
+    }
+
+    *sighting = slots[t & SIGHTING_QUEUE_MASK];
+    atomic_store_explicit(&tail, t + 1, memory_order_release);
+    return true;
+}
+
+uint32_t sighting_queue_depth(void) {
+    uint32_t h = atomic_load_explicit(&head, memory_order_acquire);
+    uint32_t t = atomic_load_explicit(&tail, memory_order_acquire);
+    return h - t;
+}
+
+void sighting_queue_get_stats(sighting_queue_stats_t *stats) {
+    stats->depth = sighting_queue_depth();
+    stats->high_watermark = atomic_load_explicit(&high_watermark, memory_order_relaxed);
+    stats->pushed = atomic_load_explicit(&pushed, memory_order_relaxed);
+    stats->overflows = atomic_load_explicit(&overflows, memory_order_relaxed);
+}
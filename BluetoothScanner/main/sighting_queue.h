@@ -0,0 +1,33 @@
+#ifndef MAIN_SIGHTING_QUEUE_H_
+#define MAIN_SIGHTING_QUEUE_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "sdkconfig.h"
+#include "sighting.h"
+
+// Single-producer/single-consumer ring of sightings.
+// Producer: GAP callback (Bluedroid BTC task), consumer: mqtt_task.
+// Neither side takes a lock or allocates memory.
+
+#define SIGHTING_QUEUE_LENGTH CONFIG_SIGHTING_QUEUE_LENGTH
+
+typedef struct {
+    uint32_t depth;          // Aktualna liczba rekordów w kolejce
+    uint32_t high_watermark; // Największa zaobserwowana głębokość
+    uint32_t pushed;         // Rekordy przyjęte do kolejki
+    uint32_t overflows;      // Rekordy odrzucone, bo kolejka była pełna
+} sighting_queue_stats_t;
+
+// Wywoływane tylko przez producenta. Zwraca false, gdy kolejka jest pełna.
+bool sighting_queue_push(const ble_sighting_t *sighting);
+
+// Wywoływane tylko przez konsumenta. Zwraca false, gdy kolejka jest pusta.
+bool sighting_queue_pop(ble_sighting_t *sighting);
+
+uint32_t sighting_queue_depth(void);
+
+void sighting_queue_get_stats(sighting_queue_stats_t *stats);
+
+#endif
@@ -0,0 +1,154 @@
+#include "sighting_wire.h"
+
+#include <string.h>
+
+static void put_u16(uint8_t *out, uint16_t value) {
+    out[0] = (uint8_t)value;
+    out[1] = (uint8_t)(value >> 8);
+}
+
+static void put_u64(uint8_t *out, uint64_t value) {
+    for (int i = 0; i < 8; i++) {
+        out[i] = (uint8_t)(value >> (8 * i));
+    }
+}
+
+static uint16_t get_u16(const uint8_t *in) {
+    return (uint16_t)(in[0] | (in[1] << 8));
+}
+
+static uint64_t get_u64(const uint8_t *in) {
+    uint64_t value = 0;
+    for (int i = 0; i < 8; i++) {
+        value |= (uint64_t)in[i] << (8 * i);
+    }
+    return value;
+}
+
+bool sighting_wire_writer_begin(sighting_wire_writer_t *writer, uint8_t *buffer, size_t capacity,
+                                int64_t base_timestamp_us) {
+    writer->buffer = buffer;
+    writer->capacity = capacity;
+    writer->length = 0;
+    writer->count = 0;
+    writer->base_timestamp_us = base_timestamp_us;
+
+    if (capacity < SIGHTING_WIRE_HEADER_LEN) {
+        return false;
+    }
+
+    buffer[0] = SIGHTING_WIRE_MAGIC;
+    buffer[1] = SIGHTING_WIRE_VERSION;
+    put_u16(buffer + 2, 0);
+    put_u64(buffer + 4, (uint64_t)base_timestamp_us);
+    writer->length = SIGHTING_WIRE_HEADER_LEN;
+    return true;
+}
+
+bool sighting_wire_writer_add(sighting_wire_writer_t *writer, const uint8_t *bda, uint8_t addr_type,
+                              int8_t rssi, int64_t timestamp_us, const char *name, size_t name_len) {
+    if (name_len > UINT8_MAX) {
+        name_len = UINT8_MAX;
+    }
+    if (writer->length == 0 || writer->count == UINT16_MAX ||
+        writer->length + SIGHTING_WIRE_RECORD_FIXED_LEN + name_len > writer->capacity) {
+        return false;
+    }
+
+    int64_t delta_ms = (timestamp_us - writer->base_timestamp_us) / 1000;
+    if (delta_ms < 0) {
+        delta_ms = 0;
+    } else if (delta_ms > SIGHTING_WIRE_MAX_DELTA_MS) {
+        delta_ms = SIGHTING_WIRE_MAX_DELTA_MS;
+    }
+
+    uint8_t *out = writer->buffer + writer->length;
+    memcpy(out, bda, SIGHTING_WIRE_BDA_LEN);
+    out[6] = addr_type;
+    out[7] = (uint8_t)rssi;
+    put_u16(out + 8, (uint16_t)delta_ms);
+    out[10] = (uint8_t)name_len;
+    if (name_len > 0) {
+        memcpy(out + SIGHTING_WIRE_RECORD_FIXED_LEN, name, name_len);
+    }
+
+    writer->length += SIGHTING_WIRE_RECORD_FIXED_LEN + name_len;
+    writer->count++;
+    return true;
+}
+
+size_t sighting_wire_writer_finish(sighting_wire_writer_t *writer) {
+    if (writer->length >= SIGHTING_WIRE_HEADER_LEN) {
+        put_u16(writer->buffer + 2, writer->count);
+    }
+    return writer->length;
+}
+
+sighting_wire_status_t sighting_wire_reader_init(sighting_wire_reader_t *reader, const uint8_t *data,
+                                                 size_t length) {
+    memset(reader, 0, sizeof(*reader));
+
+    if (length < SIGHTING_WIRE_HEADER_LEN) {
+        return SIGHTING_WIRE_ERR_TRUNCATED;
+    }
+    if (data[0] != SIGHTING_WIRE_MAGIC) {
+        return SIGHTING_WIRE_ERR_MAGIC;
+    }
+    if (data[1] != SIGHTING_WIRE_VERSION) {
+        return SIGHTING_WIRE_ERR_VERSION;
+    }
+
+    reader->data = data;
+    reader->length = length;
+    reader->offset = SIGHTING_WIRE_HEADER_LEN;
+    reader->count = get_u16(data + 2);
+    reader->base_timestamp_us = (int64_t)get_u64(data + 4);
+    return SIGHTING_WIRE_OK;
+}
+
+sighting_wire_status_t sighting_wire_reader_next(sighting_wire_reader_t *reader,
+                                                 sighting_wire_record_t *record) {
+    if (reader->index == reader->count) {
+        return reader->offset == reader->length ? SIGHTING_WIRE_END : SIGHTING_WIRE_ERR_TRAILING;
+    }
+
+    size_t remaining = reader->length - reader->offset;
+    if (remaining < SIGHTING_WIRE_RECORD_FIXED_LEN) {
+        return SIGHTING_WIRE_ERR_TRUNCATED;
+    }
+
+    const uint8_t *in = reader->data + reader->offset;
+    uint8_t name_len = in[10];
+    if (remaining < (size_t)SIGHTING_WIRE_RECORD_FIXED_LEN + name_len) {
+        return SIGHTING_WIRE_ERR_TRUNCATED;
+    }
+
+    memcpy(record->bda, in, SIGHTING_WIRE_BDA_LEN);
+    record->addr_type = in[6];
+    record->rssi = (int8_t)in[7];
+    record->timestamp_us = reader->base_timestamp_us + (int64_t)get_u16(in + 8) * 1000;
+    record->name_len = name_len;
+    record->name = (const char *)(in + SIGHTING_WIRE_RECORD_FIXED_LEN);
+
+    reader->offset += SIGHTING_WIRE_RECORD_FIXED_LEN + name_len;
+    reader->index++;
+    return SIGHTING_WIRE_OK;
+}
+
+const char *sighting_wire_status_str(sighting_wire_status_t status) {
+    switch (status) {
+    case SIGHTING_WIRE_OK:
+        return "ok";
+    case SIGHTING_WIRE_END:
+        return "end";
+    case SIGHTING_WIRE_ERR_TRUNCATED:
+        return "truncated";
+    case SIGHTING_WIRE_ERR_MAGIC:
+        return "bad magic";
+    case SIGHTING_WIRE_ERR_VERSION:
+        return "unsupported version";
+    case SIGHTING_WIRE_ERR_TRAILING:
+        return "trailing bytes";
+    }
+    return "unknown";
+}
@@ -0,0 +1,99 @@
+#ifndef MAIN_SIGHTING_WIRE_H_
+#define MAIN_SIGHTING_WIRE_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Binarny format obserwacji publikowany na /<board_name>/devices/bin.
+// Moduł nie zależy od ESP-IDF - jest budowany także przez narzędzia w host/.
+//
+// Wszystkie pola wielobajtowe są little-endian.
+//
+// Nagłówek (12 bajtów):
+//   u8  magic           SIGHTING_WIRE_MAGIC
+//   u8  version         SIGHTING_WIRE_VERSION
+//   u16 record_count
+//   u64 base_timestamp_us   czas bazowy paczki: UNIX w mikrosekundach po synchronizacji
+//                           SNTP, wcześniej czas od startu płytki (time_sync.h)
+//
+// Rekord (11 bajtów + nazwa):
+//   u8  bda[6]          surowy adres, kolejność bajtów jak w esp_bd_addr_t
+//   u8  addr_type       esp_ble_addr_type_t
+//   i8  rssi            dBm
+//   u16 timestamp_delta_ms  czas od base_timestamp_us, nasycany do 0xFFFF
+//   u8  name_len
+//   u8  name[name_len]  bez znaku '\0'
+
+#define SIGHTING_WIRE_MAGIC 0xB5
+#define SIGHTING_WIRE_VERSION 1
+
+#define SIGHTING_WIRE_HEADER_LEN 12
+#define SIGHTING_WIRE_RECORD_FIXED_LEN 11
+#define SIGHTING_WIRE_BDA_LEN 6
+#define SIGHTING_WIRE_MAX_DELTA_MS 0xFFFF
+
+typedef enum {
+    SIGHTING_WIRE_OK = 0,
+    SIGHTING_WIRE_END,             // Brak kolejnych rekordów
+    SIGHTING_WIRE_ERR_TRUNCATED,   // Dane kończą się w środku nagłówka lub rekordu
+    SIGHTING_WIRE_ERR_MAGIC,
+    SIGHTING_WIRE_ERR_VERSION,
+    SIGHTING_WIRE_ERR_TRAILING,    // Nadmiarowe bajty po ostatnim rekordzie
+} sighting_wire_status_t;
+
+typedef struct {
+    uint8_t bda[SIGHTING_WIRE_BDA_LEN];
+    uint8_t addr_type;
+    int8_t rssi;
+    int64_t timestamp_us;  // base_timestamp_us + delta
+    const char *name;      // Widok do bufora wejściowego, bez '\0'
+    uint8_t name_len;
+} sighting_wire_record_t;
+
+typedef struct {
+    uint8_t *buffer;
+    size_t capacity;
+    size_t length;
+    uint16_t count;
+    int64_t base_timestamp_us;
+} sighting_wire_writer_t;
+
+typedef struct {
+    const uint8_t *data;
+    size_t length;
+    size_t offset;
+    uint16_t count;
+    uint16_t index;
+    int64_t base_timestamp_us;
+} sighting_wire_reader_t;
+
+// Zwraca false, gdy bufor nie mieści nagłówka
+bool sighting_wire_writer_begin(sighting_wire_writer_t *writer, uint8_t *buffer, size_t capacity,
+                                int64_t base_timestamp_us);
+
+// Zwraca false, gdy rekord nie mieści się w buforze. Nazwa dłuższa niż 255 bajtów jest obcinana.
+bool sighting_wire_writer_add(sighting_wire_writer_t *writer, const uint8_t *bda, uint8_t addr_type,
+                              int8_t rssi, int64_t timestamp_us, const char *name, size_t name_len);
+
+// Uzupełnia liczbę rekordów w nagłówku i zwraca długość wiadomości
+size_t sighting_wire_writer_finish(sighting_wire_writer_t *writer);
+
+sighting_wire_status_t sighting_wire_reader_init(sighting_wire_reader_t *reader, const uint8_t *data,
+                                                 size_t length);
+
+// Zwraca SIGHTING_WIRE_OK i wypełnia record albo SIGHTING_WIRE_END po ostatnim rekordzie
+sighting_wire_status_t sighting_wire_reader_next(sighting_wire_reader_t *reader,
+                                                 sighting_wire_record_t *record);
+
+const char *sighting_wire_status_str(sighting_wire_status_t status);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
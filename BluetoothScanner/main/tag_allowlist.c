@@ -0,0 +1,350 @@
+#include "tag_allowlist.h"
+
+#include <math.h>
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define LN2 0.69314718055994530942
+
+// Bufor zapisu wgrywanej listy - wielokrotność długości adresu
+#define WRITE_BUFFER_LEN (42 * SIGHTING_BDA_LEN)
+
+static tag_allowlist_flash_t flash;
+static bool exact_check = false;
+
+// Filtr Blooma, alokowany raz w tag_allowlist_init albo w buforze z tag_allowlist_use_buffer
+static uint32_t *bits = NULL;
+static uint32_t *filter_buffer = NULL;
+static size_t filter_buffer_size = 0;
+static uint32_t filter_bits = 0;
+static uint32_t hash_count = 0;
+
+static uint32_t tag_count = 0;
+static uint32_t max_tags = 0;
+
+// false w trakcie wgrywania i przebudowy filtra
+static atomic_bool ready = false;
+
+// Stan wgrywania (zadanie MQTT)
+static bool uploading = false;
+static uint32_t upload_count = 0;
+static uint32_t upload_received = 0;
+static uint8_t upload_last[SIGHTING_BDA_LEN];
+static uint8_t write_buffer[WRITE_BUFFER_LEN];
+static size_t write_buffer_len = 0;
+static size_t write_offset = 0;
+static const char *last_error = "";
+
+// Liczniki kontekstu callbacku GAP - odczyt bez synchronizacji
+static uint32_t lookups = 0;
+static uint32_t bit_probes = 0;
+static uint32_t filter_positives = 0;
+static uint32_t exact_checks = 0;
+static uint32_t flash_reads = 0;
+static uint32_t false_positives = 0;
+
+static void put_u32(uint8_t *out, uint32_t value) {
+    for (int i = 0; i < 4; i++) {
+        out[i] = (uint8_t)(value >> (8 * i));
+    }
+}
+
+static uint32_t get_u32(const uint8_t *in) {
+    uint32_t value = 0;
+    for (int i = 0; i < 4; i++) {
+        value |= (uint32_t)in[i] << (8 * i);
+    }
+    return value;
+}
+
+// Mieszanie 48-bitowego adresu (finalizer MurmurHash3); dwie połówki wyniku
+// dają kolejne indeksy metodą podwójnego haszowania
+static uint64_t hash_bda(const uint8_t *bda) {
+    uint64_t x = 0;
+    for (int i = 0; i < SIGHTING_BDA_LEN; i++) {
+        x = x << 8 | bda[i];
+    }
+    x ^= x >> 33;
+    x *= 0xff51afd7ed558ccdULL;
+    x ^= x >> 33;
+    x *= 0xc4ceb9fe1a85ec53ULL;
+    x ^= x >> 33;
+    return x;
+}
+
+// Odwzorowanie 32-bitowego skrótu na [0, filter_bits) bez dzielenia
+static uint32_t bit_index(uint32_t hash) {
+    return (uint32_t)(((uint64_t)hash * filter_bits) >> 32);
+}
+
+static void filter_add(const uint8_t *bda) {
+    uint64_t hash = hash_bda(bda);
+    uint32_t h1 = (uint32_t)hash;
+    uint32_t h2 = (uint32_t)(hash >> 32) | 1;
+    for (uint32_t i = 0; i < hash_count; i++) {
+        uint32_t index = bit_index(h1 + i * h2);
+        bits[index / 32] |= 1u << (index % 32);
+    }
+}
+
+static bool filter_test(const uint8_t *bda) {
+    uint64_t hash = hash_bda(bda);
+    uint32_t h1 = (uint32_t)hash;
+    uint32_t h2 = (uint32_t)(hash >> 32) | 1;
+    for (uint32_t i = 0; i < hash_count; i++) {
+        uint32_t index = bit_index(h1 + i * h2);
+        bit_probes++;
+        if (!(bits[index / 32] & (1u << (index % 32)))) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static size_t entry_offset(uint32_t index) {
+    return TAG_ALLOWLIST_HEADER_LEN + (size_t)index * SIGHTING_BDA_LEN;
+}
+
+// Wyszukiwanie binarne w posortowanej liście na flash
+static bool exact_contains(const uint8_t *bda) {
+    uint32_t low = 0;
+    uint32_t high = tag_count;
+    while (low < high) {
+        uint32_t middle = low + (high - low) / 2;
+        uint8_t entry[SIGHTING_BDA_LEN];
+        flash_reads++;
+        if (!flash.read(flash.ctx, entry_offset(middle), entry, sizeof(entry))) {
+            return false;
+        }
+        int order = memcmp(entry, bda, SIGHTING_BDA_LEN);
+        if (order == 0) {
+            return true;
+        }
+        if (order < 0) {
+            low = middle + 1;
+        } else {
+            high = middle;
+        }
+    }
+    return false;
+}
+
+// Buduje filtr z listy na flash; zwraca false dla pustego lub uszkodzonego obszaru
+static bool load_from_flash(void) {
+    memset(bits, 0, (filter_bits + 31) / 32 * sizeof(uint32_t));
+    tag_count = 0;
+
+    uint8_t header[TAG_ALLOWLIST_HEADER_LEN];
+    if (!flash.read(flash.ctx, 0, header, sizeof(header)) || get_u32(header) != TAG_ALLOWLIST_MAGIC ||
+        get_u32(header + 4) > max_tags) {
+        return false;
+    }
+
+    uint32_t count = get_u32(header + 4);
+    for (uint32_t index = 0; index < count;) {
+        uint32_t batch = count - index < WRITE_BUFFER_LEN / SIGHTING_BDA_LEN ? count - index
+                                                                             : WRITE_BUFFER_LEN / SIGHTING_BDA_LEN;
+        if (!flash.read(flash.ctx, entry_offset(index), write_buffer, batch * SIGHTING_BDA_LEN)) {
+            memset(bits, 0, (filter_bits + 31) / 32 * sizeof(uint32_t));
+            return false;
+        }
+        for (uint32_t i = 0; i < batch; i++) {
+            filter_add(write_buffer + i * SIGHTING_BDA_LEN);
+        }
+        index += batch;
+    }
+    tag_count = count;
+    return true;
+}
+
+void tag_allowlist_use_buffer(uint32_t *buffer, size_t size) {
+    filter_buffer = buffer;
+    filter_buffer_size = size;
+}
+
+bool tag_allowlist_init(const tag_allowlist_flash_t *area, uint32_t capacity, uint32_t fp_rate_ppm,
+                        bool exact) {
+    if (bits != NULL || capacity == 0 || fp_rate_ppm == 0 || fp_rate_ppm >= 1000000 ||
+        area->size < TAG_ALLOWLIST_HEADER_LEN + SIGHTING_BDA_LEN) {
+        return false;
+    }
+
+    // m = -n ln p / (ln 2)^2, k = m / n ln 2
+    double p = fp_rate_ppm / 1e6;
+    double m = ceil(-(double)capacity * log(p) / (LN2 * LN2));
+    filter_bits = ((uint32_t)m + 31) / 32 * 32;
+    hash_count = (uint32_t)lround((double)filter_bits / capacity * LN2);
+    if (hash_count < 1) {
+        hash_count = 1;
+    } else if (hash_count > TAG_ALLOWLIST_MAX_HASHES) {
+        hash_count = TAG_ALLOWLIST_MAX_HASHES;
+    }
+
+    if (filter_buffer != NULL) {
+        if (filter_bits / 8 > filter_buffer_size) {
+            return false;
+        }
+        bits = filter_buffer;
+        memset(bits, 0, filter_bits / 8);
+    } else {
+        bits = calloc(filter_bits / 32, sizeof(uint32_t));
+        if (bits == NULL) {
+            return false;
+        }
+    }
+
+    flash = *area;
+    exact_check = exact;
+    max_tags = (uint32_t)((flash.size - TAG_ALLOWLIST_HEADER_LEN) / SIGHTING_BDA_LEN);
+    atomic_store(&ready, load_from_flash());
+    return true;
+}
+
+bool tag_allowlist_contains(const uint8_t *bda) {
+    if (!atomic_load_explicit(&ready, memory_order_acquire)) {
+        return false;
+    }
+
+    lookups++;
+    if (!filter_test(bda)) {
+        return false;
+    }
+    filter_positives++;
+    if (!exact_check) {
+        return true;
+    }
+
+    exact_checks++;
+    if (!exact_contains(bda)) {
+        false_positives++;
+        return false;
+    }
+    return true;
+}
+
+static bool fail_upload(const char *error) {
+    last_error = error;
+    uploading = false;
+    return false;
+}
+
+static bool flush_write_buffer(void) {
+    if (write_buffer_len == 0) {
+        return true;
+    }
+    if (!flash.write(flash.ctx, write_offset, write_buffer, write_buffer_len)) {
+        return false;
+    }
+    write_offset += write_buffer_len;
+    write_buffer_len = 0;
+    return true;
+}
+
+bool tag_allowlist_begin(uint32_t count) {
+    if (bits == NULL) {
+        return fail_upload("not initialized");
+    }
+    if (count > max_tags) {
+        last_error = "too many tags"; // Bieżąca lista zostaje
+        return false;
+    }
+    atomic_store(&ready, false);
+    tag_count = 0;
+
+    size_t end = entry_offset(count);
+    for (size_t offset = 0; offset < end; offset += TAG_ALLOWLIST_SECTOR_SIZE) {
+        if (!flash.erase_sector(flash.ctx, offset)) {
+            return fail_upload("flash erase failed");
+        }
+    }
+
+    uploading = true;
+    upload_count = count;
+    upload_received = 0;
+    write_buffer_len = 0;
+    write_offset = TAG_ALLOWLIST_HEADER_LEN;
+    last_error = "";
+    return true;
+}
+
+bool tag_allowlist_append(const uint8_t *data, size_t length) {
+    if (!uploading) {
+        return false;
+    }
+
+    for (size_t i = 0; i < length; i++) {
+        if (upload_received == upload_count) {
+            return fail_upload("more data than announced");
+        }
+        write_buffer[write_buffer_len++] = data[i];
+
+        // Pełny adres - sprawdzenie kolejności względem poprzedniego
+        if (write_buffer_len % SIGHTING_BDA_LEN == 0) {
+            const uint8_t *bda = write_buffer + write_buffer_len - SIGHTING_BDA_LEN;
+            if (upload_received > 0 && memcmp(bda, upload_last, SIGHTING_BDA_LEN) <= 0) {
+                return fail_upload("addresses not sorted or duplicated");
+            }
+            memcpy(upload_last, bda, SIGHTING_BDA_LEN);
+            upload_received++;
+
+            if (write_buffer_len == WRITE_BUFFER_LEN && !flush_write_buffer()) {
+                return fail_upload("flash write failed");
+            }
+        }
+    }
+    return true;
+}
+
+bool tag_allowlist_commit(void) {
+    if (!uploading) {
+        return false;
+    }
+    if (upload_received != upload_count || write_buffer_len % SIGHTING_BDA_LEN != 0) {
+        return fail_upload("incomplete list");
+    }
+    if (!flush_write_buffer()) {
+        return fail_upload("flash write failed");
+    }
+
+    // Nagłówek na końcu - przerwane wgrywanie zostawia obszar bez magic, czyli pustą listę
+    uint8_t header[TAG_ALLOWLIST_HEADER_LEN];
+    put_u32(header, TAG_ALLOWLIST_MAGIC);
+    put_u32(header + 4, upload_count);
+    if (!flash.write(flash.ctx, 0, header, sizeof(header))) {
+        return fail_upload("flash write failed");
+    }
+
+    uploading = false;
+    if (!load_from_flash()) {
+        return fail_upload("verification failed");
+    }
+    atomic_store(&ready, true);
+    return true;
+}
+
+const char *tag_allowlist_error(void) {
+    return last_error;
+}
+
+void tag_allowlist_get_stats(tag_allowlist_stats_t *stats) {
+    stats->tags = tag_count;
+    stats->max_tags = max_tags;
+    stats->filter_bits = filter_bits;
+    stats->hash_count = hash_count;
+    stats->memory_bytes = filter_bits / 8;
+
+    // p = (1 - e^(-kn/m))^k
+    stats->expected_fp_ppm = 0;
+    if (filter_bits > 0 && tag_count > 0) {
+        double fill = 1.0 - exp(-(double)hash_count * tag_count / filter_bits);
+        stats->expected_fp_ppm = (uint32_t)lround(pow(fill, hash_count) * 1e6);
+    }
+
+    stats->lookups = lookups;
+    stats->bit_probes = bit_probes;
+    stats->filter_positives = filter_positives;
+    stats->exact_checks = exact_checks;
+    stats->flash_reads = flash_reads;
+    stats->false_positives = false_positives;
+}
@@ -0,0 +1,93 @@
+#ifndef MAIN_TAG_ALLOWLIST_H_
+#define MAIN_TAG_ALLOWLIST_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "sighting.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Lista zarejestrowanych tagów (adresów MAC) dla reguły "registered" filtra skanowania.
+// Pełna lista leży w pamięci flash, w RAM jest tylko filtr Blooma dobrany do
+// pojemności i docelowego odsetka fałszywych trafień. Trafienia filtra mogą być
+// potwierdzane wyszukiwaniem binarnym w posortowanej liście na flash.
+// Moduł nie zależy od ESP-IDF - dostęp do flash jest wstrzykiwany.
+//
+// Układ obszaru:
+//   u32 magic           TAG_ALLOWLIST_MAGIC, zapisywany na końcu wgrywania
+//   u32 count
+//   u8  bda[count][6]   rosnąco, bez powtórzeń
+// Pola wielobajtowe są little-endian.
+
+#define TAG_ALLOWLIST_MAGIC 0x314C4154 // "TAL1"
+#define TAG_ALLOWLIST_HEADER_LEN 8
+#define TAG_ALLOWLIST_SECTOR_SIZE 4096
+#define TAG_ALLOWLIST_MAX_HASHES 16
+
+// Górne oszacowanie rozmiaru filtra w bajtach jako wyrażenie stałe (bufor statyczny):
+// 1.443 * ceil(log2(1 / p)) bitów na tag zamiast -ln p / (ln 2)^2
+#define TAG_ALLOWLIST_CEIL_LOG2(x) ((x) <= 1 ? 0 : 32 - __builtin_clz((unsigned)(x) - 1))
+#define TAG_ALLOWLIST_FILTER_MAX_BYTES(capacity, fp_rate_ppm)                                              \
+    ((((uint64_t)(capacity) * 1443 * TAG_ALLOWLIST_CEIL_LOG2((1000000 + (fp_rate_ppm) - 1) / (fp_rate_ppm)) + \
+       999) / 1000 + 64) / 32 * 4)
+
+typedef struct {
+    void *ctx;
+    size_t size; // Rozmiar obszaru w bajtach
+    bool (*read)(void *ctx, size_t offset, void *data, size_t length);
+    bool (*write)(void *ctx, size_t offset, const void *data, size_t length);
+    bool (*erase_sector)(void *ctx, size_t offset);
+} tag_allowlist_flash_t;
+
+typedef struct {
+    uint32_t tags;            // Zarejestrowane tagi
+    uint32_t max_tags;        // Pojemność obszaru flash
+    uint32_t filter_bits;
+    uint32_t hash_count;
+    uint32_t memory_bytes;    // RAM zajęty przez filtr
+    uint32_t expected_fp_ppm; // Przewidywany odsetek fałszywych trafień filtra dla bieżącej liczby tagów
+    uint32_t lookups;
+    uint32_t bit_probes;      // Sprawdzone bity filtra (koszt wyszukiwania)
+    uint32_t filter_positives;
+    uint32_t exact_checks;
+    uint32_t flash_reads;
+    uint32_t false_positives; // Trafienia filtra odrzucone przez sprawdzenie dokładne
+} tag_allowlist_stats_t;
+
+// Filtr w podanym buforze zamiast alokacji na stercie; wywoływane przed tag_allowlist_init
+void tag_allowlist_use_buffer(uint32_t *buffer, size_t size);
+
+// Rozmiar filtra wynika z capacity i fp_rate_ppm; alokowany raz, chyba że podano bufor
+// (za mały bufor to błąd). Wczytuje listę z flash.
+bool tag_allowlist_init(const tag_allowlist_flash_t *flash, uint32_t capacity, uint32_t fp_rate_ppm,
+                        bool exact_check);
+
+// Kontekst callbacku GAP. Zwraca false, gdy lista jest pusta, niezainicjalizowana
+// albo właśnie wgrywana.
+bool tag_allowlist_contains(const uint8_t *bda);
+
+// Wgrywanie nowej listy: begin kasuje obszar, append przyjmuje kolejne fragmenty
+// (granice fragmentów nie muszą wypadać na granicy adresu), commit zapisuje
+// nagłówek i przebudowuje filtr. Odrzucone begin zachowuje bieżącą listę, błąd
+// w późniejszym kroku zostawia pustą.
+bool tag_allowlist_begin(uint32_t count);
+bool tag_allowlist_append(const uint8_t *data, size_t length);
+bool tag_allowlist_commit(void);
+
+// Opis ostatniego błędu wgrywania
+const char *tag_allowlist_error(void);
+
+void tag_allowlist_get_stats(tag_allowlist_stats_t *stats);
+
+// Dołącza do partycji flash o podanej etykiecie (tylko firmware)
+bool tag_allowlist_init_partition(const char *label, uint32_t capacity, uint32_t fp_rate_ppm, bool exact_check);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
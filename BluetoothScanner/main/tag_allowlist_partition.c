@@ -0,0 +1,80 @@
+#include "tag_allowlist.h"
+
+#include <inttypes.h>
+#include <string.h>
+
+#include "esp_log.h"
+#include "esp_partition.h"
+#include "sdkconfig.h"
+#include "tags.h"
+
+// Odczyty z partycji zmapowanej w przestrzeń danych - wyszukiwanie w callbacku GAP
+// nie przechodzi przez sterownik flash. Zapis unieważnia cache zapisanego zakresu.
+typedef struct {
+    const esp_partition_t *partition;
+    const uint8_t *mapped;
+} tag_partition_t;
+
+static tag_partition_t tag_partition;
+
+#if CONFIG_STATIC_ALLOCATION && CONFIG_TAG_ALLOWLIST
+static uint32_t tag_filter[TAG_ALLOWLIST_FILTER_MAX_BYTES(CONFIG_TAG_ALLOWLIST_CAPACITY,
+                                                          CONFIG_TAG_ALLOWLIST_FP_RATE_PPM) / 4];
+#endif
+
+static bool partition_read(void *ctx, size_t offset, void *data, size_t length) {
+    const tag_partition_t *area = ctx;
+    if (area->mapped) {
+        memcpy(data, area->mapped + offset, length);
+        return true;
+    }
+    return esp_partition_read(area->partition, offset, data, length) == ESP_OK;
+}
+
+static bool partition_write(void *ctx, size_t offset, const void *data, size_t length) {
+    const tag_partition_t *area = ctx;
+    return esp_partition_write(area->partition, offset, data, length) == ESP_OK;
+}
+
+static bool partition_erase_sector(void *ctx, size_t offset) {
+    const tag_partition_t *area = ctx;
+    return esp_partition_erase_range(area->partition, offset, TAG_ALLOWLIST_SECTOR_SIZE) == ESP_OK;
+}
+
+bool tag_allowlist_init_partition(const char *label, uint32_t capacity, uint32_t fp_rate_ppm, bool exact_check) {
+    tag_partition.partition = esp_partition_find_first(ESP_PARTITION_TYPE_DATA, ESP_PARTITION_SUBTYPE_ANY, label);
+    if (!tag_partition.partition) {
+        ESP_LOGW(MAIN_TAG, "No '%s' partition, tag allowlist disabled", label);
+        return false;
+    }
+
+    const void *mapped = NULL;
+    esp_partition_mmap_handle_t mmap_handle;
+    if (esp_partition_mmap(tag_partition.partition, 0, tag_partition.partition->size, ESP_PARTITION_MMAP_DATA,
+                           &mapped, &mmap_handle) == ESP_OK) {
+        tag_partition.mapped = mapped;
+    } else {
+        ESP_LOGW(MAIN_TAG, "Cannot map '%s' partition, tag lookups read through the flash driver", label);
+    }
+
+    tag_allowlist_flash_t flash = {
+        .ctx = &tag_partition,
+        .size = tag_partition.partition->size,
+        .read = partition_read,
+        .write = partition_write,
+        .erase_sector = partition_erase_sector,
+    };
+#if CONFIG_STATIC_ALLOCATION && CONFIG_TAG_ALLOWLIST
+    tag_allowlist_use_buffer(tag_filter, sizeof(tag_filter));
+#endif
+    if (!tag_allowlist_init(&flash, capacity, fp_rate_ppm, exact_check)) {
+        ESP_LOGW(MAIN_TAG, "Tag allowlist initialization failed");
+        return false;
+    }
+
+    tag_allowlist_stats_t stats;
+    tag_allowlist_get_stats(&stats);
+    ESP_LOGI(MAIN_TAG, "Tag allowlist: %" PRIu32 "/%" PRIu32 " tags, filter %" PRIu32 " bytes, %" PRIu32 " hashes",
+             stats.tags, stats.max_tags, stats.memory_bytes, stats.hash_count);
+    return true;
+}
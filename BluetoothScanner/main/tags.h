@@ -5,5 +5,6 @@
 #define WIFI_TAG  "WIFI"
 #define BUTTON_TAG "BUTTON"
 #define MAIN_TAG "MAIN"
+#define APP_TASKS_TAG "APP_TASKS"
 
 #endif
\ No newline at end of file
@@ -0,0 +1,20 @@
+#include "time_sync.h"
+
+#include <stdatomic.h>
+
+// Zapis z zadania SNTP (tcpip), odczyt z wątku publikującego
+static _Atomic int64_t epoch_offset_us = 0;
+static atomic_bool synced = false;
+
+void time_sync_set(int64_t epoch_us, int64_t monotonic_us) {
+    atomic_store(&epoch_offset_us, epoch_us - monotonic_us);
+    atomic_store(&synced, true);
+}
+
+bool time_sync_synced(void) {
+    return atomic_load(&synced);
+}
+
+int64_t time_sync_epoch_us(int64_t monotonic_us) {
+    return monotonic_us + atomic_load(&epoch_offset_us);
+}
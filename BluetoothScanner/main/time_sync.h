@@ -0,0 +1,24 @@
+#ifndef MAIN_TIME_SYNC_H_
+#define MAIN_TIME_SYNC_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Zamiana znaczników czasu z esp_timer_get_time (mikrosekundy od startu, pobierane
+// w callbacku GAP) na czas UNIX w mikrosekundach. Przesunięcie jest ustawiane po
+// każdej synchronizacji SNTP, więc obserwacje sprzed synchronizacji też dostają
+// poprawny czas, jeśli są publikowane po niej. Moduł nie zależy od ESP-IDF.
+
+// Odczyt zegara ściennego i monotonicznego wykonany w tej samej chwili
+void time_sync_set(int64_t epoch_us, int64_t monotonic_us);
+
+bool time_sync_synced(void);
+
+// Czas UNIX w mikrosekundach; przed pierwszą synchronizacją zwraca monotonic_us
+// bez zmian (czas od startu - odbiorca rozpozna go po wartości)
+int64_t time_sync_epoch_us(int64_t monotonic_us);
+
+// Uruchamia SNTP z podanym serwerem; kolejne wywołania są ignorowane (tylko firmware)
+void time_sync_start(const char *server);
+
+#endif
@@ -0,0 +1,35 @@
+#include "time_sync.h"
+
+#include <sys/time.h>
+
+#include "esp_log.h"
+#include "esp_netif_sntp.h"
+#include "esp_timer.h"
+#include "tags.h"
+
+// Wywoływane po każdej synchronizacji (także okresowej, co CONFIG_LWIP_SNTP_UPDATE_DELAY)
+static void on_time_sync(struct timeval *synced_time) {
+    struct timeval now;
+    gettimeofday(&now, NULL);
+    int64_t monotonic_us = esp_timer_get_time();
+    time_sync_set((int64_t)now.tv_sec * 1000000 + now.tv_usec, monotonic_us);
+    ESP_LOGI(WIFI_TAG, "Time synchronized: %lld.%06ld", (long long)now.tv_sec, (long)now.tv_usec);
+}
+
+void time_sync_start(const char *server) {
+    static bool started = false;
+    if (started) {
+        return;
+    }
+    started = true;
+
+    esp_sntp_config_t config = ESP_NETIF_SNTP_DEFAULT_CONFIG(server);
+    config.sync_cb = on_time_sync;
+    esp_err_t err = esp_netif_sntp_init(&config);
+    if (err != ESP_OK) {
+        ESP_LOGE(WIFI_TAG, "Failed to start SNTP: %s", esp_err_to_name(err));
+        started = false;
+        return;
+    }
+    ESP_LOGI(WIFI_TAG, "SNTP started with server %s", server);
+}
@@ -0,0 +1,72 @@
+#include "trace.h"
+
+#if CONFIG_TRACE
+
+#include <stdio.h>
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+#if (TRACE_BUFFER_ENTRIES & (TRACE_BUFFER_ENTRIES - 1)) != 0
+#error "CONFIG_TRACE_BUFFER_ENTRIES must be a power of two"
+#endif
+
+trace_ring_t trace_rings[TRACE_CORES];
+atomic_bool trace_enabled = true;
+
+typedef struct {
+    const char *name;
+    char phase; // B - początek, E - koniec, i - zdarzenie chwilowe
+} trace_event_info_t;
+
+static const trace_event_info_t event_info[TRACE_EVENT_COUNT] = {
+    [TRACE_GAP_EVENT_BEGIN] = {"gap_event", 'B'},
+    [TRACE_GAP_EVENT_END] = {"gap_event", 'E'},
+    [TRACE_SANITIZE_BEGIN] = {"sanitize_name", 'B'},
+    [TRACE_SANITIZE_END] = {"sanitize_name", 'E'},
+    [TRACE_DISCOVERY] = {"device_discovery", 'i'},
+    [TRACE_MQTT_EVENT_BEGIN] = {"mqtt_event", 'B'},
+    [TRACE_MQTT_EVENT_END] = {"mqtt_event", 'E'},
+    [TRACE_MQTT_PUBLISH_BEGIN] = {"mqtt_publish", 'B'},
+    [TRACE_MQTT_PUBLISH_END] = {"mqtt_publish", 'E'},
+    [TRACE_WIFI_EVENT_BEGIN] = {"wifi_event", 'B'},
+    [TRACE_WIFI_EVENT_END] = {"wifi_event", 'E'},
+    [TRACE_LCD_FLUSH_BEGIN] = {"lcd_flush", 'B'},
+    [TRACE_LCD_FLUSH_END] = {"lcd_flush", 'E'},
+};
+
+void trace_dump(trace_write_callback write, void *ctx) {
+    char line[64];
+    int length;
+
+    atomic_store(&trace_enabled, false);
+    // Zapis rozpoczęty przed wyłączeniem kończy się w kilku instrukcjach
+    vTaskDelay(1);
+
+    length = snprintf(line, sizeof(line), "TRACE BEGIN %d %d\n", CONFIG_ESP_DEFAULT_CPU_FREQ_MHZ, TRACE_CORES);
+    write(line, length, ctx);
+
+    for (int core = 0; core < TRACE_CORES; core++) {
+        trace_ring_t *ring = &trace_rings[core];
+        uint32_t head = atomic_load(&ring->head);
+        uint32_t first = head > TRACE_BUFFER_ENTRIES ? head - TRACE_BUFFER_ENTRIES : 0;
+        for (uint32_t i = first; i < head; i++) {
+            const trace_entry_t *entry = &ring->entries[i % TRACE_BUFFER_ENTRIES];
+            if (entry->event >= TRACE_EVENT_COUNT) {
+                continue;
+            }
+            const trace_event_info_t *info = &event_info[entry->event];
+            length = snprintf(line, sizeof(line), "T %d %lu %s %c %lu\n", core, (unsigned long)entry->cycles,
+                              info->name, info->phase, (unsigned long)entry->arg);
+            write(line, length, ctx);
+        }
+        atomic_store(&ring->head, 0);
+    }
+
+    length = snprintf(line, sizeof(line), "TRACE END\n");
+    write(line, length, ctx);
+
+    atomic_store(&trace_enabled, true);
+}
+
+#endif
@@ -0,0 +1,94 @@
+#ifndef MAIN_TRACE_H_
+#define MAIN_TRACE_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "sdkconfig.h"
+
+// Punkty śledzenia gorącej ścieżki (CONFIG_TRACE): zdarzenie, licznik cykli,
+// rdzeń i argument trafiają do pierścienia danego rdzenia bez blokad (przerwania
+// są wyłączone tylko na czas zapisu wpisu). Zrzut
+// (trace_dump) jest tekstowy, host/trace_to_chrome.py zamienia go na JSON
+// dla chrome://tracing / Perfetto. Bez CONFIG_TRACE makro TRACE znika
+// razem z argumentami.
+//
+// Format zrzutu, linia po linii:
+//   TRACE BEGIN <MHz> <rdzenie>
+//   T <rdzeń> <cykle> <nazwa> <B|E|i> <arg>
+//   TRACE END
+// Liczniki cykli są 32-bitowe (przepełnienie co 2^32 cykli) i niezależne na każdym rdzeniu.
+
+typedef enum {
+    TRACE_GAP_EVENT_BEGIN = 0, // arg: esp_gap_ble_cb_event_t
+    TRACE_GAP_EVENT_END,
+    TRACE_SANITIZE_BEGIN,
+    TRACE_SANITIZE_END,
+    TRACE_DISCOVERY,           // arg: 1 - obserwacja w kolejce, 0 - kolejka pełna
+    TRACE_MQTT_EVENT_BEGIN,    // arg: esp_mqtt_event_id_t
+    TRACE_MQTT_EVENT_END,
+    TRACE_MQTT_PUBLISH_BEGIN,  // arg: długość wiadomości
+    TRACE_MQTT_PUBLISH_END,    // arg: msg_id
+    TRACE_WIFI_EVENT_BEGIN,    // arg: identyfikator zdarzenia
+    TRACE_WIFI_EVENT_END,
+    TRACE_LCD_FLUSH_BEGIN,
+    TRACE_LCD_FLUSH_END,       // arg: bajty wysłane po I2C
+    TRACE_EVENT_COUNT,
+} trace_event_t;
+
+// Przyjmuje kolejne fragmenty zrzutu (pełne linie zakończone '\n')
+typedef void (*trace_write_callback)(const char *text, size_t length, void *ctx);
+
+#if CONFIG_TRACE
+
+#include <stdatomic.h>
+#include <stdbool.h>
+
+#include "esp_cpu.h"
+#include "freertos/FreeRTOS.h"
+
+#define TRACE_BUFFER_ENTRIES CONFIG_TRACE_BUFFER_ENTRIES
+#define TRACE_CORES CONFIG_FREERTOS_NUMBER_OF_CORES
+
+typedef struct {
+    uint32_t cycles;
+    uint32_t arg;
+    uint8_t event;
+} trace_entry_t;
+
+typedef struct {
+    atomic_uint_fast32_t head; // Licznik zapisów, slot to head % TRACE_BUFFER_ENTRIES
+    trace_entry_t entries[TRACE_BUFFER_ENTRIES];
+} trace_ring_t;
+
+extern trace_ring_t trace_rings[TRACE_CORES];
+extern atomic_bool trace_enabled;
+
+static inline void trace_record(uint8_t event, uint32_t arg) {
+    if (!atomic_load_explicit(&trace_enabled, memory_order_relaxed)) {
+        return;
+    }
+    // Przy wyłączonych przerwaniach zadanie nie zostanie wywłaszczone ani
+    // przeniesione na inny rdzeń między rezerwacją slotu a odczytem licznika,
+    // więc kolejność wpisów w pierścieniu jest kolejnością cykli
+    UBaseType_t interrupts = portSET_INTERRUPT_MASK_FROM_ISR();
+    trace_ring_t *ring = &trace_rings[esp_cpu_get_core_id()];
+    uint32_t slot = atomic_fetch_add_explicit(&ring->head, 1, memory_order_relaxed) % TRACE_BUFFER_ENTRIES;
+    ring->entries[slot].cycles = esp_cpu_get_cycle_count();
+    ring->entries[slot].arg = arg;
+    ring->entries[slot].event = event;
+    portCLEAR_INTERRUPT_MASK_FROM_ISR(interrupts);
+}
+
+#define TRACE(event, arg) trace_record((event), (uint32_t)(arg))
+
+// Wstrzymuje zapis, przekazuje zawartość pierścieni do write i je czyści
+void trace_dump(trace_write_callback write, void *ctx);
+
+#else
+
+#define TRACE(event, arg) ((void)0)
+
+#endif
+
+#endif